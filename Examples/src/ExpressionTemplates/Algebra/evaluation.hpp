@@ -0,0 +1,111 @@
+#ifndef HH_EVALUATION_HPP
+#define HH_EVALUATION_HPP
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+namespace ET
+{
+//! Tools to evaluate expressions, not meant for the user
+/*!
+  The elements are processed in chunks of chunkSize elements. A chunk is the
+  unit of work of the threads (if compiled with OpenMP, and only for vectors
+  of at least parallelThreshold elements) and of the partial sums of the
+  reductions. The partial sums are added in the order of the chunks, so a
+  reduction gives the same result with any number of threads.
+
+  The loops inside a chunk are simple loops on raw pointers, which the
+  compiler can vectorize. The sums use eight independent accumulators, so
+  that they can be vectorized without -ffast-math.
+ */
+namespace internals
+{
+  //! The number of elements in a chunk
+  inline constexpr std::size_t chunkSize = 4096u;
+  //! Vectors shorter than this are processed by a single thread
+  inline constexpr std::size_t parallelThreshold = 1u << 16;
+
+  //! Calls kernel(begin, end) on the chunks of [0,n)
+  template <class Kernel>
+  void
+  forChunks(std::size_t n, Kernel const &kernel)
+  {
+    std::size_t const numChunks = (n + chunkSize - 1u) / chunkSize;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(n >= parallelThreshold)
+#endif
+    for(std::size_t c = 0u; c < numChunks; ++c)
+      kernel(c * chunkSize, std::min(n, (c + 1u) * chunkSize));
+  }
+
+  //! The sum of f(i) for i in [begin,end)
+  template <class F>
+  double
+  sumRange(std::size_t begin, std::size_t end, F const &f)
+  {
+    constexpr std::size_t width = 8u;
+    double                s[width] = {};
+    // a precomputed bound, otherwise gcc does not vectorize the sums
+    std::size_t const last = begin + (end - begin) / width * width;
+    for(std::size_t i = begin; i < last; i += width)
+      for(std::size_t k = 0u; k < width; ++k)
+        s[k] += f(i + k);
+    for(std::size_t i = last; i < end; ++i)
+      s[0] += f(i);
+    return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+  }
+
+  //! The sum of kernel(begin, end) on the chunks of [0,n)
+  template <class Kernel>
+  double
+  reduceChunks(std::size_t n, Kernel const &kernel)
+  {
+    std::size_t const numChunks = (n + chunkSize - 1u) / chunkSize;
+    double            result = 0.;
+#ifdef _OPENMP
+    if(n >= parallelThreshold)
+      {
+        std::vector<double> partial(numChunks);
+#pragma omp parallel for schedule(static)
+        for(std::size_t c = 0u; c < numChunks; ++c)
+          partial[c] = kernel(c * chunkSize, std::min(n, (c + 1u) * chunkSize));
+        for(auto p : partial)
+          result += p;
+        return result;
+      }
+#endif
+    for(std::size_t c = 0u; c < numChunks; ++c)
+      result += kernel(c * chunkSize, std::min(n, (c + 1u) * chunkSize));
+    return result;
+  }
+} // namespace internals
+
+//  THE UPDATES OF THE ELEMENTS IN AN ASSIGNMENT
+//! y=x
+struct Assign
+{
+  void
+  operator()(double &y, double x) const
+  {
+    y = x;
+  }
+};
+//! y+=x
+struct AddAssign
+{
+  void
+  operator()(double &y, double x) const
+  {
+    y += x;
+  }
+};
+//! y-=x
+struct SubtractAssign
+{
+  void
+  operator()(double &y, double x) const
+  {
+    y -= x;
+  }
+};
+} // namespace ET
+#endif
@@ -0,0 +1,140 @@
+#include "chrono.hpp"
+#include "operators.hpp"
+#include "reductions.hpp"
+#include "vectorExpr.hpp"
+#include <Eigen/Dense>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+/*
+  BLAS-1 kernels with ET::Vector, with hand-written loops and with Eigen:
+
+  - y = a*x + b*y + z
+  - y += a*x (and the same written as y = y + a*x)
+  - dot(x, z)
+  - y -= a*x followed by dot(y,y), fused by updateAndSquaredNorm()
+
+  for vectors of 10^3, 10^5 and 10^7 elements. We report the time per element
+  in ns. Compile with -fopenmp to use threads for the long vectors.
+ */
+namespace
+{
+//! Time in ns per element of f, repeated to process about 2*10^8 elements
+template <class F>
+double
+timePerElement(std::size_t n, F &&f)
+{
+  std::size_t const repetitions = std::max<std::size_t>(1u, 200000000u / n);
+  Timings::Chrono   clock;
+  clock.start();
+  for(std::size_t r = 0u; r < repetitions; ++r)
+    f();
+  clock.stop();
+  return clock.wallTime() * 1.e3 / (static_cast<double>(repetitions) * n);
+}
+
+void
+print(std::string const &kernel, double loop, double et, double eigen,
+      std::string const &note = "")
+{
+  std::cout << std::left << std::setw(24) << kernel << std::right
+            << std::fixed << std::setprecision(3) << std::setw(10) << loop
+            << std::setw(10) << et << std::setw(10) << eigen << "  " << note
+            << std::defaultfloat << '\n';
+}
+
+void
+benchmark(std::size_t n)
+{
+  double const        a = 0.5;
+  double const        b = 0.25;
+  std::vector<double> xs(n), ys(n), zs(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      xs[i] = 1. + 1.e-3 * (i % 1000u);
+      ys[i] = 2. - 1.e-3 * (i % 777u);
+      zs[i] = 0.5 + 1.e-3 * (i % 555u);
+    }
+  // hand-written loops
+  std::vector<double> x(xs), y(ys), z(zs);
+  double             *px = x.data(), *py = y.data(), *pz = z.data();
+  // ET
+  ET::Vector ex(xs), ey(ys), ez(zs);
+  // Eigen
+  using EV = Eigen::VectorXd;
+  EV vx = Eigen::Map<EV>(xs.data(), n), vy = Eigen::Map<EV>(ys.data(), n),
+     vz = Eigen::Map<EV>(zs.data(), n);
+  double sink = 0.;
+
+  std::cout << "\nn=" << n << ", ns per element\n"
+            << std::left << std::setw(24) << "kernel" << std::right
+            << std::setw(10) << "loop" << std::setw(10) << "ET"
+            << std::setw(10) << "Eigen" << '\n';
+  double tl = timePerElement(n, [&] {
+    for(std::size_t i = 0u; i < n; ++i)
+      py[i] = a * px[i] + b * py[i] + pz[i];
+  });
+  double te = timePerElement(n, [&] { ey = a * ex + b * ey + ez; });
+  double tv = timePerElement(n, [&] { vy = a * vx + b * vy + vz; });
+  print("y=a*x+b*y+z", tl, te, tv);
+
+  tl = timePerElement(n, [&] {
+    for(std::size_t i = 0u; i < n; ++i)
+      py[i] += a * px[i];
+  });
+  te = timePerElement(n, [&] { ey += a * ex; });
+  tv = timePerElement(n, [&] { vy += a * vx; });
+  print("y+=a*x", tl, te, tv);
+  {
+    // on a copy, to keep the three y equal
+    ET::Vector ew(ey);
+    te = timePerElement(n, [&] { ew = ew + a * ex; });
+    print("y=y+a*x", tl, te, tv, "(ET written without +=)");
+  }
+
+  double dl = 0., de = 0., dv = 0.;
+  tl = timePerElement(n, [&] {
+    double s = 0.;
+    for(std::size_t i = 0u; i < n; ++i)
+      s += px[i] * pz[i];
+    dl += s;
+  });
+  te = timePerElement(n, [&] { de += dot(ex, ez); });
+  tv = timePerElement(n, [&] { dv += vx.dot(vz); });
+  print("dot(x,z)", tl, te, tv);
+  sink += dl + de + dv;
+
+  tl = timePerElement(n, [&] {
+    double s = 0.;
+    for(std::size_t i = 0u; i < n; ++i)
+      {
+        py[i] -= a * px[i];
+        s += py[i] * py[i];
+      }
+    dl += s;
+  });
+  te = timePerElement(n, [&] {
+    de += ey.updateAndSquaredNorm(a * ex, ET::SubtractAssign{});
+  });
+  tv = timePerElement(n, [&] {
+    vy -= a * vx;
+    dv += vy.squaredNorm();
+  });
+  print("y-=a*x; dot(y,y)", tl, te, tv, "(Eigen: two passes)");
+  sink += dl + de + dv;
+
+  // The same operations have been done on the three copies
+  double diff = 0.;
+  for(std::size_t i = 0u; i < n; ++i)
+    diff = std::max({diff, std::abs(y[i] - ey[i]), std::abs(y[i] - vy[i])});
+  std::cout << "max difference of y: " << diff << " (sink " << sink << ")\n";
+}
+} // namespace
+
+int
+main()
+{
+  for(std::size_t n : {1000u, 100000u, 10000000u})
+    benchmark(n);
+}
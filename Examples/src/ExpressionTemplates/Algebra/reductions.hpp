@@ -0,0 +1,66 @@
+#ifndef HH_REDUCTIONS_HPP
+#define HH_REDUCTIONS_HPP
+#include "evaluation.hpp"
+#include "expressionWrapper.hpp"
+#include <cassert>
+#include <cmath>
+namespace ET
+{
+//  REDUCTIONS OF EXPRESSIONS
+/*
+  They are lazy: the expressions are evaluated element by element inside the
+  reduction, so dot(a*x+y, z) is computed in a single pass, without
+  temporaries.
+ */
+//! The sum of the elements of an expression
+template <class E>
+double
+sum(Expr<E> const &e)
+{
+  const E &et(e); // casting!
+  return internals::reduceChunks(
+    et.size(), [&et](std::size_t begin, std::size_t end) {
+      return internals::sumRange(begin, end,
+                                 [&et](std::size_t i) { return et[i]; });
+    });
+}
+
+//! The scalar product of two expressions
+template <class L, class R>
+double
+dot(Expr<L> const &l, Expr<R> const &r)
+{
+  const L &lt(l);
+  const R &rt(r);
+  assert(lt.size() == rt.size());
+  return internals::reduceChunks(
+    lt.size(), [&lt, &rt](std::size_t begin, std::size_t end) {
+      return internals::sumRange(
+        begin, end, [&lt, &rt](std::size_t i) { return lt[i] * rt[i]; });
+    });
+}
+
+//! The squared euclidean norm of an expression
+template <class E>
+double
+squaredNorm(Expr<E> const &e)
+{
+  const E &et(e);
+  return internals::reduceChunks(
+    et.size(), [&et](std::size_t begin, std::size_t end) {
+      return internals::sumRange(begin, end, [&et](std::size_t i) {
+        double const v = et[i];
+        return v * v;
+      });
+    });
+}
+
+//! The euclidean norm of an expression
+template <class E>
+double
+norm(Expr<E> const &e)
+{
+  return std::sqrt(squaredNorm(e));
+}
+} // namespace ET
+#endif
@@ -1,5 +1,6 @@
 #ifndef HH_VECTOREXPR_HPP
 #define HH_VECTOREXPR_HPP
+#include "evaluation.hpp"
 #include "expressionWrapper.hpp"
 #include <utility>
 #include <vector>
@@ -9,6 +10,10 @@ namespace ET
 /*!
   It is build around std::vector<double> and indeed
   std::vector:double> is the only variable member of the class.
+
+  Expressions are evaluated in a single pass, without temporaries, by
+  chunks (see evaluation.hpp): in parallel, if compiled with OpenMP, for
+  long vectors.
  */
 class Vector : public Expr<Vector>
 {
@@ -32,12 +37,9 @@ public:
   //! MOve assign
   Vector &operator=(Vector &&) = default;
   //! I may build a Vector from an expression!
-  template <class T> Vector(const Expr<T> &e) : M_data()
+  template <class T> Vector(const Expr<T> &e) : M_data(e.size())
   {
-    const T &et(e); // casting!
-    M_data.reserve(et.size());
-    for(auto i = 0u; i < et.size(); ++i)
-      M_data.emplace_back(et[i]);
+    update(e, Assign{});
   }
   //! Assigning an expression
   /*!
@@ -47,12 +49,64 @@ public:
   Vector &
   operator=(const Expr<T> &e)
   {
-    const T &et(e); // casting!
-    M_data.resize(et.size());
-    for(auto i = 0u; i < et.size(); ++i)
-      M_data[i] = et[i];
+    M_data.resize(e.size());
+    update(e, Assign{});
+    return *this;
+  }
+  //! Adds an expression, without temporaries
+  template <class T>
+  Vector &
+  operator+=(const Expr<T> &e)
+  {
+    update(e, AddAssign{});
+    return *this;
+  }
+  //! Subtracts an expression, without temporaries
+  template <class T>
+  Vector &
+  operator-=(const Expr<T> &e)
+  {
+    update(e, SubtractAssign{});
     return *this;
   }
+  //! Multiplies by a scalar
+  Vector &
+  operator*=(double a)
+  {
+    double *const out = M_data.data();
+    internals::forChunks(size(), [out, a](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; ++i)
+        out[i] *= a;
+    });
+    return *this;
+  }
+  /*!
+    Updates the vector with an expression, and returns the squared norm of
+    the result, in the same pass
+    @code
+    // r-=alpha*q; rr=dot(r,r);
+    double rr = r.updateAndSquaredNorm(alpha * q, ET::SubtractAssign{});
+    @endcode
+    @param e The expression (of the same size of the vector)
+    @param op How the elements are updated: Assign, AddAssign or
+    SubtractAssign
+   */
+  template <class T, class OP = Assign>
+  double
+  updateAndSquaredNorm(const Expr<T> &e, OP op = OP{})
+  {
+    const T      &et(e); // casting!
+    double *const out = M_data.data();
+    return internals::reduceChunks(
+      size(), [&et, out, op](std::size_t begin, std::size_t end) {
+        // The chunk is still in cache when the norm is computed
+        for(std::size_t i = begin; i < end; ++i)
+          op(out[i], et[i]);
+        return internals::sumRange(begin, end, [out](std::size_t i) {
+          return out[i] * out[i];
+        });
+      });
+  }
   //! Returns i-th element
   double &
   operator[](std::size_t i)
@@ -106,6 +160,25 @@ public:
   {
     return M_data;
   }
+
+private:
+  //! Updates the elements with those of the expression, chunk by chunk
+  /*!
+    The elements are written through a raw pointer, so that the loop is
+    simple enough to be vectorized.
+   */
+  template <class T, class OP>
+  void
+  update(const Expr<T> &e, OP op)
+  {
+    const T      &et(e); // casting!
+    double *const out = M_data.data();
+    internals::forChunks(size(),
+                         [&et, out, op](std::size_t begin, std::size_t end) {
+                           for(std::size_t i = begin; i < end; ++i)
+                             op(out[i], et[i]);
+                         });
+  }
 };
 
 //! I want to use range for loops with Vector objects.
@@ -5,10 +5,12 @@
 #ifndef EXAMPLES_HEAPVIEW_HPP
 #define EXAMPLES_HEAPVIEW_HPP
 #include "heapViewTraits.hpp"
+#include <algorithm>
 #include <concepts>
 #include <functional>
 #include <limits>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
@@ -34,13 +36,22 @@
  * proper comparison operator on DataElementType.
  * @tparam Traits The traits for the heap view.  It should provide the
  * definition of the internal types.
+ * @tparam Arity The number of children of each node of the heap (2 for a
+ * binary heap). With a larger arity the heap is shallower: siftUp, the
+ * operation used when a key decreases, is cheaper, siftDown is more
+ * expensive (it compares all the children of a node), but children are
+ * contiguous in memory. 4 is often the best choice when decrease-key
+ * operations dominate, as in Dijkstra's algorithm.
  */
 namespace apsc
 {
 template <class DataElementType, class CompOp = std::less<DataElementType>,
-          class Traits = heapViewTraits<DataElementType>>
+          class Traits = heapViewTraits<DataElementType>,
+          std::size_t Arity = 2u>
 class HeapView
 {
+  static_assert(Arity >= 2u, "The arity of a heap must be at least 2");
+
 public:
   using Index = Traits::Index;
   using DataVector = Traits::DataVector;
@@ -48,6 +59,8 @@ public:
   using ElementType = Traits::ElementType;
   using HeapIndex = Traits::HeapIndex;
   using HeapIter = Traits::HeapIter;
+  //! The number of children of a node
+  static constexpr std::size_t arity = Arity;
 
   HeapView() = default;
   /*!
@@ -69,11 +82,7 @@ public:
             heapIndex_.push_back(i);
             heapIter_.push_back(i);
           }
-        for(Index i = data_.size() / 2; i > 0; --i)
-          {
-            siftDown(i);
-          }
-        siftDown(0);
+        heapify();
       }
   }
   HeapView(const HeapView &other) = default;
@@ -98,16 +107,7 @@ public:
         heapIndex_.emplace_back(i);
         heapIter_.emplace_back(i);
       }
-    if(data_.size() != 0)
-      {
-        // to avoid problems with subtraction of unsigned I treat index 0
-        // specially
-        for(Index i = data_.size() / 2; i > 0; --i)
-          {
-            siftDown(i);
-          }
-        siftDown(0);
-      }
+    heapify();
   }
   /*!
    * @brief Reserves capacity.
@@ -162,7 +162,12 @@ public:
     this->swap(*where, heapIndex_.size() - 1);
     heapIndex_.pop_back();
     heapIter_[i].reset();
-    return siftDown(siftUp(*where));
+    if(*where == heapIndex_.size())
+      {
+        // it was the last element, nothing to rearrange
+        return *where;
+      }
+    return siftUpOrDown(*where);
   }
   /*!
    * @brief Update an element in the heap view.
@@ -189,7 +194,57 @@ public:
         heapIter_[i] = where;
         return siftUp(*where);
       }
-    return siftDown(siftUp(*where));
+    return siftUpOrDown(*where);
+  }
+  /*!
+   * @brief Updates many elements at once
+   *
+   * Equivalent to calling update(indices[k], values[k]) for all k, but if
+   * the number of changes is large compared to the size of the heap the
+   * heap is rebuilt once, in linear time, instead of sifting each changed
+   * element (which costs a logarithmic time per element). Elements not in
+   * the heap are added to it, as in update().
+   *
+   * @param indices The indexes in the data of the elements to change
+   * @param values The new values
+   * @throw std::invalid_argument if the two spans have different sizes
+   */
+  void
+  updateMany(std::span<DataIndex const> indices,
+             std::span<ElementType const> values)
+  {
+    if(indices.size() != values.size())
+      {
+        throw std::invalid_argument(
+          "HeapView: updateMany needs as many values as indices");
+      }
+    // A rough estimate of the cost of the two alternatives: a sift per
+    // element, of the order of the depth of the heap, or a rebuild, of the
+    // order of the size of the heap
+    std::size_t depth = 1u;
+    for(std::size_t n = heapIndex_.size(); n >= Arity; n /= Arity)
+      {
+        ++depth;
+      }
+    if(indices.size() * depth < heapIndex_.size() + indices.size())
+      {
+        for(std::size_t k = 0; k < indices.size(); ++k)
+          {
+            update(indices[k], values[k]);
+          }
+        return;
+      }
+    for(std::size_t k = 0; k < indices.size(); ++k)
+      {
+        auto const i = indices[k];
+        data_[i] = values[k];
+        if(not heapIter_[i].has_value())
+          {
+            heapIter_[i] = heapIndex_.size();
+            heapIndex_.push_back(i);
+          }
+      }
+    heapify();
   }
   /*!
    * @brief The size of the heap
@@ -297,22 +352,18 @@ public:
   bool
   check() const
   {
-    for(Index i = 0; i < heapIndex_.size(); ++i)
+    for(Index i = 1; i < heapIndex_.size(); ++i)
       {
-        auto const [left, right] = children(i);
-        if(left)
+        if(compHeapView_(heapIndex_[i], heapIndex_[parent(i)]))
           {
-            if(comp_(data_[heapIndex_[*left]], data_[heapIndex_[i]]))
-              {
-                return false;
-              }
+            return false;
           }
-        if(right)
+      }
+    for(Index i = 0; i < heapIndex_.size(); ++i)
+      {
+        if(heapIter_[heapIndex_[i]] != i)
           {
-            if(comp_(data_[heapIndex_[*right]], data_[heapIndex_[i]]))
-              {
-                return false;
-              }
+            return false;
           }
       }
     return true;
@@ -332,37 +383,41 @@ private:
    * @param i the index
    * @return the index of the parent
    */
-  Index
-  parent(Index i) const noexcept
+  static constexpr Index
+  parent(Index i) noexcept
   {
-    return (i == 0u) ? 0u : (i - 1u) / 2u;
+    return (i == 0u) ? 0u : (i - 1u) / Arity;
   };
   /*!
-   * The indexex of the chirldens of a node in the heap
+   * The index of the first child of a node in the heap. The children are
+   * firstChild(i),...,firstChild(i)+Arity-1, those existing are the ones
+   * less than size().
    * @param i The index
-   * @return A pair of optionals.  The first is the left child, the second is
-   * the right child.  If the child does not exist, the optional is empty.
+   * @return The index of the first child
    */
-  std::pair<std::optional<Index>, std::optional<Index>>
-  children(Index i) const noexcept
+  static constexpr Index
+  firstChild(Index i) noexcept
   {
-    if(2 * i + 1u < heapIndex_.size())
+    return Arity * i + 1u;
+  }
+  /*!
+   * Rebuilds the heap (Floyd's algorithm: linear complexity)
+   */
+  void
+  heapify()
+  {
+    auto const n = heapIndex_.size();
+    if(n < 2u)
       {
-        if(2 * i + 2u < heapIndex_.size())
-          {
-            return std::make_pair(std::optional<Index>(2 * i + 1u),
-                                  std::optional<Index>(2 * i + 2u));
-          }
-        else
-          {
-            return std::make_pair(std::optional<Index>(2 * i + 1u),
-                                  std::optional<Index>());
-          }
+        return;
       }
-    else
+    // to avoid problems with subtraction of unsigned I treat index 0
+    // specially
+    for(Index i = parent(n - 1u); i > 0; --i)
       {
-        return std::make_pair(std::optional<Index>(), std::optional<Index>());
+        siftDown(i);
       }
+    siftDown(0);
   }
   /*!
    * Swap two elements in the heap
@@ -379,40 +434,73 @@ private:
     heapIter_[heapIndex_[i]] = i;
     heapIter_[heapIndex_[j]] = j;
   }
-  //! Moves an element up the heap until it is in the correct position
+  /*!
+   * Moves an element to its correct position in the heap, after its value
+   * has changed
+   *
+   * If the element moves up, its new children are the element it replaced
+   * and the children of the latter, which are not before it: no need to
+   * sift it down.
+   */
+  Index
+  siftUpOrDown(Index i)
+  {
+    auto const j = siftUp(i);
+    return j != i ? j : siftDown(j);
+  }
+  /*!
+   * Moves an element up the heap until it is in the correct position
+   *
+   * The element is not swapped at each step: the parents are moved down
+   * and the element is stored only at the end, halving the memory writes.
+   */
   Index
   siftUp(Index i)
   {
-    while(i > 0 && compHeapView_(heapIndex_[i], heapIndex_[parent(i)]))
+    auto const moving = heapIndex_[i];
+    while(i > 0)
       {
-        this->swap(i, parent(i));
-        i = parent(i);
+        auto const p = parent(i);
+        if(not compHeapView_(moving, heapIndex_[p]))
+          {
+            break;
+          }
+        heapIndex_[i] = heapIndex_[p];
+        heapIter_[heapIndex_[i]] = i;
+        i = p;
       }
+    heapIndex_[i] = moving;
+    heapIter_[moving] = i;
     return i;
   }
   //! Moves an element down the heap until it is in the correct position
   Index
   siftDown(Index i)
   {
-    auto [left, right] = children(i);
-    while(left)
+    auto const moving = heapIndex_[i];
+    auto const n = heapIndex_.size();
+    for(Index first = firstChild(i); first < n; first = firstChild(i))
       {
-        Index j = *left;
-        if(right && compHeapView_(heapIndex_[*right], heapIndex_[*left]))
+        // the best among the children
+        auto const last = std::min(first + Arity, n);
+        Index      j = first;
+        for(Index k = first + 1u; k < last; ++k)
           {
-            j = *right;
-          }
-        if(compHeapView_(heapIndex_[j], heapIndex_[i]))
-          {
-            this->swap(i, j);
-            i = j;
-            std::tie(left, right) = children(i);
+            if(compHeapView_(heapIndex_[k], heapIndex_[j]))
+              {
+                j = k;
+              }
           }
-        else
+        if(not compHeapView_(heapIndex_[j], moving))
           {
             break;
           }
+        heapIndex_[i] = heapIndex_[j];
+        heapIter_[heapIndex_[i]] = i;
+        i = j;
       }
+    heapIndex_[i] = moving;
+    heapIter_[moving] = i;
     return i;
   }
 
@@ -433,6 +521,16 @@ private:
   CompOp comp_ = CompOp{};
   // static auto constexpr noData=std::numeric_limits<std::size_t>::max();
 };
+
+/*!
+ * @brief A HeapView with a given arity and the default traits
+ *
+ * For instance DaryHeapView<double, 4> is a 4-ary min heap view of doubles.
+ */
+template <class DataElementType, std::size_t Arity,
+          class CompOp = std::less<DataElementType>>
+using DaryHeapView =
+  HeapView<DataElementType, CompOp, heapViewTraits<DataElementType>, Arity>;
 } // namespace apsc
 
 #endif // EXAMPLES_HEAPVIEW_HPP
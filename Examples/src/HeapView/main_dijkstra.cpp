@@ -0,0 +1,282 @@
+//
+// Benchmark of HeapView in Dijkstra's algorithm and with bulk updates
+//
+#include "chrono.hpp" // in Utilities
+#include "heapView.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+/*
+ * Dijkstra's algorithm is run on two large graphs: a grid with random
+ * weights (a road network like graph, few decrease-key operations per
+ * node) and a random graph with average degree 8 (many decrease-key).
+ *
+ * For each graph:
+ * - the shortest paths are computed with a std::priority_queue with lazy
+ *   deletion (the reference) and with HeapView of arity 2, 4 and 8;
+ * - the sequence of heap operations (pop and update) made by the
+ *   algorithm is recorded and replayed on each heap, to measure the cost
+ *   of the heap operations alone.
+ *
+ * Then update() and updateMany() are compared when an increasing fraction
+ * of the keys of a large heap is changed.
+ *
+ * Usage: main_dijkstra [n] (the number of nodes, 10^6 by default)
+ */
+namespace
+{
+//! A graph in compressed sparse row format
+struct Graph
+{
+  std::vector<std::size_t>   offsets{0u};
+  std::vector<std::uint32_t> targets;
+  std::vector<double>        weights;
+  std::size_t
+  numNodes() const
+  {
+    return offsets.size() - 1u;
+  }
+};
+
+//! A side x side grid with 4 neighbours and random weights in [1,10]
+Graph
+gridGraph(std::size_t side, std::mt19937 &urbg)
+{
+  std::uniform_real_distribution<double> weight(1., 10.);
+  Graph                                  g;
+  for(std::size_t i = 0u; i < side; ++i)
+    for(std::size_t j = 0u; j < side; ++j)
+      {
+        auto link = [&](std::size_t ii, std::size_t jj) {
+          g.targets.push_back(static_cast<std::uint32_t>(ii * side + jj));
+          g.weights.push_back(weight(urbg));
+        };
+        if(i > 0u)
+          link(i - 1u, j);
+        if(i + 1u < side)
+          link(i + 1u, j);
+        if(j > 0u)
+          link(i, j - 1u);
+        if(j + 1u < side)
+          link(i, j + 1u);
+        g.offsets.push_back(g.targets.size());
+      }
+  return g;
+}
+
+//! A random graph with given number of edges per node, weights in [1,10]
+Graph
+randomGraph(std::size_t n, std::size_t degree, std::mt19937 &urbg)
+{
+  std::uniform_real_distribution<double>       weight(1., 10.);
+  std::uniform_int_distribution<std::uint32_t> node(0u, n - 1u);
+  Graph                                        g;
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      for(std::size_t k = 0u; k < degree; ++k)
+        {
+          g.targets.push_back(node(urbg));
+          g.weights.push_back(weight(urbg));
+        }
+      g.offsets.push_back(g.targets.size());
+    }
+  return g;
+}
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+//! The reference: binary heap of the standard library with lazy deletion
+std::vector<double>
+dijkstraReference(Graph const &g, std::size_t source)
+{
+  std::vector<double> dist(g.numNodes(), infinity);
+  using Item = std::pair<double, std::size_t>;
+  std::priority_queue<Item, std::vector<Item>, std::greater<>> queue;
+  dist[source] = 0.;
+  queue.emplace(0., source);
+  while(!queue.empty())
+    {
+      auto const [d, u] = queue.top();
+      queue.pop();
+      if(d > dist[u])
+        continue; // an old copy
+      for(auto e = g.offsets[u]; e < g.offsets[u + 1u]; ++e)
+        {
+          auto const v = g.targets[e];
+          double const nd = d + g.weights[e];
+          if(nd < dist[v])
+            {
+              dist[v] = nd;
+              queue.emplace(nd, v);
+            }
+        }
+    }
+  return dist;
+}
+
+//! An operation on the heap: a pop if index is noIndex, otherwise an update
+struct HeapOp
+{
+  std::uint32_t index;
+  double        value;
+};
+constexpr std::uint32_t noIndex = std::numeric_limits<std::uint32_t>::max();
+
+//! Dijkstra with a HeapView used as a priority queue with decrease-key
+template <class Heap>
+std::vector<double>
+dijkstra(Graph const &g, std::size_t source, std::vector<HeapOp> *trace)
+{
+  std::vector<double> dist(g.numNodes(), infinity);
+  std::vector<bool>   done(g.numNodes(), false);
+  Heap                heap;
+  heap.reserve(g.numNodes());
+  dist[source] = 0.;
+  heap.update(source, 0.);
+  if(trace)
+    trace->push_back({static_cast<std::uint32_t>(source), 0.});
+  while(!heap.empty())
+    {
+      auto const [u, d] = heap.popPair();
+      if(trace)
+        trace->push_back({noIndex, 0.});
+      done[u] = true;
+      for(auto e = g.offsets[u]; e < g.offsets[u + 1u]; ++e)
+        {
+          auto const   v = g.targets[e];
+          double const nd = d + g.weights[e];
+          if(!done[v] && nd < dist[v])
+            {
+              dist[v] = nd;
+              heap.update(v, nd);
+              if(trace)
+                trace->push_back({v, nd});
+            }
+        }
+    }
+  return dist;
+}
+
+//! Replays a trace of heap operations
+template <class Heap>
+double
+replay(std::vector<HeapOp> const &trace, std::size_t n)
+{
+  Heap heap;
+  heap.reserve(n);
+  double sum = 0.;
+  for(auto const &op : trace)
+    {
+      if(op.index == noIndex)
+        sum += heap.pop();
+      else
+        heap.update(op.index, op.value);
+    }
+  return sum;
+}
+
+using Timings::timeIt; // time in milliseconds
+
+template <std::size_t Arity>
+using Heap = apsc::DaryHeapView<double, Arity>;
+
+bool
+benchmarkGraph(std::string const &name, Graph const &g)
+{
+  std::cout << name << ": " << g.numNodes() << " nodes, " << g.targets.size()
+            << " edges\n";
+  std::vector<double> reference;
+  double const tRef = timeIt([&] { reference = dijkstraReference(g, 0u); });
+  std::vector<HeapOp> trace;
+  dijkstra<Heap<2>>(g, 0u, &trace);
+  auto const numPops =
+    std::ranges::count_if(trace, [](auto op) { return op.index == noIndex; });
+  std::cout << "Trace: " << numPops << " pops, " << trace.size() - numPops
+            << " updates (insertions and decrease-key)\n";
+  std::cout << std::left << std::setw(26) << "Queue" << std::right
+            << std::setw(16) << "Dijkstra (ms)" << std::setw(16)
+            << "replay (ms)" << '\n';
+  std::cout << std::left << std::setw(26) << "std::priority_queue (lazy)"
+            << std::right << std::setw(16) << tRef << std::setw(16) << "-"
+            << '\n';
+  bool ok = true;
+  auto run = [&]<std::size_t Arity>() {
+    std::vector<double> dist;
+    double const        t =
+      timeIt([&] { dist = dijkstra<Heap<Arity>>(g, 0u, nullptr); });
+    double       sum = 0.;
+    double const tReplay =
+      timeIt([&] { sum = replay<Heap<Arity>>(trace, g.numNodes()); });
+    std::cout << std::left << std::setw(26)
+              << "HeapView, arity " + std::to_string(Arity) << std::right
+              << std::setw(16) << t << std::setw(16) << tReplay << '\n';
+    ok = ok && dist == reference && sum > 0.;
+  };
+  run.template operator()<2>();
+  run.template operator()<4>();
+  run.template operator()<8>();
+  std::cout << "Distances " << (ok ? "agree" : "DO NOT agree")
+            << " with the reference\n\n";
+  return ok;
+}
+
+//! Changes k keys of a heap with n elements with update() and updateMany()
+template <std::size_t Arity>
+bool
+benchmarkUpdateMany(std::size_t n, std::mt19937 &urbg)
+{
+  std::uniform_real_distribution<double> value(0., 1.);
+  std::vector<double>                    data(n);
+  for(auto &x : data)
+    x = value(urbg);
+  std::cout << "Heap of arity " << Arity << " with " << n << " elements\n";
+  std::cout << std::setw(12) << "changes" << std::setw(16) << "update (ms)"
+            << std::setw(20) << "updateMany (ms)" << '\n';
+  bool ok = true;
+  for(auto fraction : {0.001, 0.01, 0.1, 0.5})
+    {
+      auto const k = static_cast<std::size_t>(fraction * n);
+      std::vector<std::size_t> indices(k);
+      std::vector<double>      values(k);
+      for(std::size_t j = 0u; j < k; ++j)
+        {
+          indices[j] = urbg() % n;
+          values[j] = value(urbg);
+        }
+      Heap<Arity>  one(data);
+      Heap<Arity>  many(data);
+      double const tOne = timeIt([&] {
+        for(std::size_t j = 0u; j < k; ++j)
+          one.update(indices[j], values[j]);
+      });
+      double const tMany = timeIt([&] { many.updateMany(indices, values); });
+      std::cout << std::setw(12) << k << std::setw(16) << tOne
+                << std::setw(20) << tMany << '\n';
+      ok = ok && one.check() && many.check() && one.top() == many.top();
+    }
+  std::cout << "Heaps are " << (ok ? "sane" : "NOT sane") << "\n\n";
+  return ok;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  std::mt19937      urbg{1234};
+  auto const        side =
+    static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+  bool ok = benchmarkGraph("Grid graph", gridGraph(side, urbg));
+  ok = benchmarkGraph("Random graph", randomGraph(n, 8u, urbg)) && ok;
+  ok = benchmarkUpdateMany<2>(n, urbg) && ok;
+  ok = benchmarkUpdateMany<4>(n, urbg) && ok;
+  return ok ? 0 : 1;
+}
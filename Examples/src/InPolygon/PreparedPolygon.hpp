@@ -0,0 +1,246 @@
+//
+// A polygon prepared for many point-in-polygon queries
+//
+
+#ifndef C_PREPAREDPOLYGON_HPP
+#define C_PREPAREDPOLYGON_HPP
+#include "inPolygon.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace apsc
+{
+/*!
+ * A polygon prepared for testing many points, with the crossing number
+ * algorithm of inPolygonFast().
+ *
+ * The bounding box of the polygon is divided into numSlabs horizontal slabs
+ * of equal height, and each slab stores the edges whose y-range intersects
+ * it. The horizontal half-line from a point may cross only the edges of the
+ * slab containing the point, so a query examines only those edges, instead
+ * of all of them. Points outside the bounding box are rejected immediately.
+ *
+ * The edges of the slabs are stored in structure-of-arrays form, each edge
+ * oriented upwards, and the test on an edge has no branches and no
+ * divisions, so the compiler can vectorize the loop on the edges of a slab.
+ *
+ * An edge with lower vertex (x0,y0) and upper vertex (x1,y1) is crossed by
+ * the half-line from (x,y) if \f$y0< y\le y1\f$ and
+ * \f$(y-y0)x1+(y1-y)x0 \ge x(y1-y0)\f$, the same test of inPolygonFast()
+ * with the division removed. The result may differ from that of
+ * inPolygonFast() only for points on the boundary, because of rounding.
+ *
+ * The memory is that of the edges, times the average number of slabs
+ * crossed by an edge.
+ */
+class PreparedPolygon
+{
+public:
+  using Point = std::array<double, 2>;
+  /*!
+   * @param poly The polygon (vertices in order, clockwise or anticlockwise)
+   * @param numSlabs The number of slabs. If 0, it is equal to the number of
+   * edges
+   */
+  template <BarePolygon Poly>
+  explicit PreparedPolygon(Poly const &poly, std::size_t numSlabs = 0u);
+
+  //! Whether the point is inside the polygon
+  bool
+  contains(Point const &point) const
+  {
+    return contains(point[0], point[1]);
+  }
+  //! Whether the point (x,y) is inside the polygon
+  bool contains(double x, double y) const;
+
+  /*!
+   * Classifies a batch of points given by their coordinates: inside[i] is
+   * set to 1 if (x[i],y[i]) is inside, to 0 otherwise. If compiled with
+   * OpenMP the points are shared among the threads.
+   *
+   * @return The number of points inside
+   */
+  std::size_t classify(std::span<double const> x, std::span<double const> y,
+                       std::span<std::uint8_t> inside) const;
+  //! The same for points stored as arrays
+  std::size_t classify(std::span<Point const>  points,
+                       std::span<std::uint8_t> inside) const;
+
+  //! The number of edges of the polygon
+  std::size_t
+  numEdges() const
+  {
+    return M_numEdges;
+  }
+  //! The number of slabs
+  std::size_t
+  numSlabs() const
+  {
+    return M_slabStart.size() - 1u;
+  }
+  //! The number of edges stored in the slabs (with repetitions)
+  std::size_t
+  storedEdges() const
+  {
+    return M_x0.size();
+  }
+
+private:
+  //! The slab containing the y coordinate (clamped)
+  std::size_t
+  slab(double y) const
+  {
+    auto const s = static_cast<std::ptrdiff_t>((y - M_ymin) * M_inverseHeight);
+    auto const last = static_cast<std::ptrdiff_t>(numSlabs()) - 1;
+    return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(s, 0, last));
+  }
+  std::size_t M_numEdges = 0u;
+  //! Bounding box
+  double M_xmin, M_xmax, M_ymin, M_ymax;
+  //! The inverse of the height of a slab
+  double M_inverseHeight;
+  //! The edges of slab s are in [M_slabStart[s], M_slabStart[s+1])
+  std::vector<std::size_t> M_slabStart;
+  //! The lower and the upper vertices of the edges
+  std::vector<double> M_x0, M_y0, M_x1, M_y1;
+};
+
+// IMPLEMENTATIONS---------------------------------------------------------
+
+template <BarePolygon Poly>
+PreparedPolygon::PreparedPolygon(Poly const &poly, std::size_t numSlabs)
+  : M_numEdges{static_cast<std::size_t>(poly.size())}
+{
+  if(M_numEdges < 3u)
+    throw std::invalid_argument(
+      "PreparedPolygon: a polygon needs at least 3 vertices");
+  if(numSlabs == 0u)
+    numSlabs = M_numEdges;
+  M_xmin = M_xmax = poly[0][0];
+  M_ymin = M_ymax = poly[0][1];
+  for(std::size_t i = 1u; i < M_numEdges; ++i)
+    {
+      M_xmin = std::min<double>(M_xmin, poly[i][0]);
+      M_xmax = std::max<double>(M_xmax, poly[i][0]);
+      M_ymin = std::min<double>(M_ymin, poly[i][1]);
+      M_ymax = std::max<double>(M_ymax, poly[i][1]);
+    }
+  M_inverseHeight =
+    M_ymax > M_ymin ? static_cast<double>(numSlabs) / (M_ymax - M_ymin) : 0.;
+  M_slabStart.assign(numSlabs + 1u, 0u);
+  // The lower and upper vertex of edge i
+  auto const edge = [&poly, this](std::size_t i) {
+    Point a{poly[i][0], poly[i][1]};
+    Point b{poly[(i + 1u) % M_numEdges][0], poly[(i + 1u) % M_numEdges][1]};
+    if(b[1] < a[1])
+      std::swap(a, b);
+    return std::array<Point, 2>{a, b};
+  };
+  // Two passes: count the edges of each slab, then fill them. Horizontal
+  // edges are never crossed and are skipped. The slabs of an edge are
+  // computed with slab(), which is monotone, so that a point with y in the
+  // y-range of the edge always finds it in its slab
+  for(std::size_t i = 0u; i < M_numEdges; ++i)
+    {
+      auto const [a, b] = edge(i);
+      if(a[1] == b[1])
+        continue;
+      for(auto s = slab(a[1]); s <= slab(b[1]); ++s)
+        ++M_slabStart[s + 1u];
+    }
+  for(std::size_t s = 0u; s < numSlabs; ++s)
+    M_slabStart[s + 1u] += M_slabStart[s];
+  auto const total = M_slabStart.back();
+  M_x0.resize(total);
+  M_y0.resize(total);
+  M_x1.resize(total);
+  M_y1.resize(total);
+  std::vector<std::size_t> next(M_slabStart.begin(), M_slabStart.end() - 1);
+  for(std::size_t i = 0u; i < M_numEdges; ++i)
+    {
+      auto const [a, b] = edge(i);
+      if(a[1] == b[1])
+        continue;
+      for(auto s = slab(a[1]); s <= slab(b[1]); ++s)
+        {
+          auto const k = next[s]++;
+          M_x0[k] = a[0];
+          M_y0[k] = a[1];
+          M_x1[k] = b[0];
+          M_y1[k] = b[1];
+        }
+    }
+}
+
+inline bool
+PreparedPolygon::contains(double x, double y) const
+{
+  // written so that NaNs are outside
+  if(!(x >= M_xmin && x <= M_xmax && y >= M_ymin && y <= M_ymax))
+    return false;
+  auto const    s = slab(y);
+  auto const    first = M_slabStart[s];
+  auto const    last = M_slabStart[s + 1u];
+  double const *x0 = M_x0.data();
+  double const *y0 = M_y0.data();
+  double const *x1 = M_x1.data();
+  double const *y1 = M_y1.data();
+  unsigned int  count = 0u;
+  for(auto k = first; k < last; ++k)
+    {
+      bool const spans = (y0[k] < y) & (y <= y1[k]);
+      bool const right =
+        (y - y0[k]) * x1[k] + (y1[k] - y) * x0[k] >= x * (y1[k] - y0[k]);
+      count += spans & right;
+    }
+  return count % 2u == 1u;
+}
+
+inline std::size_t
+PreparedPolygon::classify(std::span<double const> x,
+                          std::span<double const> y,
+                          std::span<std::uint8_t> inside) const
+{
+  if(x.size() != y.size() || inside.size() < x.size())
+    throw std::invalid_argument(
+      "PreparedPolygon::classify: sizes of the spans do not match");
+  auto const  n = static_cast<std::ptrdiff_t>(x.size());
+  std::size_t numInside = 0u;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1024) reduction(+ : numInside)
+#endif
+  for(std::ptrdiff_t i = 0; i < n; ++i)
+    {
+      inside[i] = contains(x[i], y[i]);
+      numInside += inside[i];
+    }
+  return numInside;
+}
+
+inline std::size_t
+PreparedPolygon::classify(std::span<Point const>  points,
+                          std::span<std::uint8_t> inside) const
+{
+  if(inside.size() < points.size())
+    throw std::invalid_argument(
+      "PreparedPolygon::classify: sizes of the spans do not match");
+  auto const  n = static_cast<std::ptrdiff_t>(points.size());
+  std::size_t numInside = 0u;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1024) reduction(+ : numInside)
+#endif
+  for(std::ptrdiff_t i = 0; i < n; ++i)
+    {
+      inside[i] = contains(points[i][0], points[i][1]);
+      numInside += inside[i];
+    }
+  return numInside;
+}
+} // namespace apsc
+#endif // C_PREPAREDPOLYGON_HPP
@@ -0,0 +1,132 @@
+//
+// Benchmark of the point-in-polygon tests: inPolygon(), inPolygonFast() and
+// PreparedPolygon, point by point and in batch.
+//
+#include "PreparedPolygon.hpp"
+#include "chrono.hpp"
+#include "inPolygon.hpp"
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+namespace
+{
+using Point = std::array<double, 2>;
+/*!
+ * A polygon with n vertices on the curve r=1+amplitude*sin(7 theta). It is
+ * convex for amplitude=0 (a regular polygon), star shaped otherwise.
+ */
+std::vector<Point>
+makePolygon(std::size_t n, double amplitude)
+{
+  std::vector<Point> poly(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      double const theta = 2. * std::numbers::pi * i / n;
+      double const r = 1. + amplitude * std::sin(7. * theta);
+      poly[i] = {r * std::cos(theta), r * std::sin(theta)};
+    }
+  return poly;
+}
+
+//! Time in ns per point of test(i), i=0,...,numPoints-1
+template <class Test>
+double
+nsPerPoint(std::size_t numPoints, Test &&test)
+{
+  Timings::Chrono clock;
+  clock.start();
+  test();
+  clock.stop();
+  return clock.wallTime() * 1.e3 / numPoints;
+}
+
+void
+benchmark(std::size_t numVertices, std::size_t numPoints, bool convex)
+{
+  auto const poly = makePolygon(numVertices, convex ? 0. : 0.3);
+  // The points in the box [-1.4,1.4]^2
+  std::mt19937                           engine(12345u);
+  std::uniform_real_distribution<double> coordinate(-1.4, 1.4);
+  std::vector<Point>                     points(numPoints);
+  std::vector<double>                    x(numPoints), y(numPoints);
+  for(std::size_t i = 0u; i < numPoints; ++i)
+    {
+      x[i] = coordinate(engine);
+      y[i] = coordinate(engine);
+      points[i] = {x[i], y[i]};
+    }
+  // The original functions cost numVertices per point: they are timed on a
+  // subset of the points
+  std::size_t const numOld =
+    std::min(numPoints, std::max<std::size_t>(1000u, 200000000u / numVertices));
+  std::vector<std::uint8_t> fast(numOld), standard(numOld), one(numPoints),
+    batch(numPoints);
+
+  double const tStandard = nsPerPoint(numOld, [&] {
+    for(std::size_t i = 0u; i < numOld; ++i)
+      standard[i] = apsc::inPolygon(poly, points[i]);
+  });
+  double const tFast = nsPerPoint(numOld, [&] {
+    for(std::size_t i = 0u; i < numOld; ++i)
+      fast[i] = apsc::inPolygonFast(poly, points[i]);
+  });
+  Timings::Chrono clock;
+  clock.start();
+  apsc::PreparedPolygon const prepared(poly);
+  clock.stop();
+  double const tPrepare = clock.wallTime() * 1.e-3;
+  double const tOne = nsPerPoint(numPoints, [&] {
+    for(std::size_t i = 0u; i < numPoints; ++i)
+      one[i] = prepared.contains(points[i]);
+  });
+  std::size_t numInside = 0u;
+  double const tBatch = nsPerPoint(
+    numPoints, [&] { numInside = prepared.classify(x, y, batch); });
+
+  // Differences with respect to inPolygonFast()
+  std::size_t differences = 0u, differencesStandard = 0u;
+  for(std::size_t i = 0u; i < numOld; ++i)
+    {
+      differences += (fast[i] != one[i]) + (fast[i] != batch[i]);
+      differencesStandard += fast[i] != standard[i];
+    }
+  std::cout << std::setw(8) << numVertices << std::setw(10) << numPoints
+            << std::setw(8) << (convex ? "convex" : "star") << std::fixed
+            << std::setprecision(1) << std::setw(12);
+  if(convex)
+    std::cout << tStandard;
+  else
+    std::cout << "-";
+  std::cout << std::setw(12) << tFast << std::setw(10) << tOne << std::setw(10)
+            << tBatch << std::setw(12) << tPrepare << std::setw(9)
+            << std::setprecision(2) << static_cast<double>(numInside) / numPoints
+            << std::setw(7) << differences << std::defaultfloat << '\n';
+  if(convex && differencesStandard > 0u)
+    std::cout << "  inPolygon and inPolygonFast differ on "
+              << differencesStandard << " points\n";
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const maxPoints = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  std::cout << "Times in ns per point (prepare: ms). inPolygon() works only "
+               "for convex polygons.\n"
+            << "diff: points classified differently from inPolygonFast()\n"
+            << std::setw(8) << "vertices" << std::setw(10) << "points"
+            << std::setw(8) << "shape" << std::setw(12) << "inPolygon"
+            << std::setw(12) << "inPolyFast" << std::setw(10) << "prepared"
+            << std::setw(10) << "batch" << std::setw(12) << "prepare(ms)"
+            << std::setw(9) << "inside" << std::setw(7) << "diff" << '\n';
+  for(std::size_t numVertices : {16u, 256u, 4096u, 65536u})
+    for(std::size_t numPoints = 10000u; numPoints <= maxPoints;
+        numPoints *= 10u)
+      for(bool convex : {true, false})
+        benchmark(numVertices, numPoints, convex);
+}
@@ -16,6 +16,28 @@
 #include <type_traits>
 namespace apsc
 {
+namespace internals
+{
+  /*!
+   * Linear interpolation between (keyLeft, valueLeft) and
+   * (keyRight, valueRight)
+   *
+   * All interpolators use it, so they give exactly the same result.
+   */
+  template <typename Key, typename Value>
+  auto
+  linearInterpolation(Key const &keyLeft, Key const &keyRight,
+                      Value const &valueLeft, Value const &valueRight,
+                      Key const &keyVal)
+  {
+    const auto len = keyRight - keyLeft;
+    // I assume no nodes are repeated
+    const auto coeffRight = (keyVal - keyLeft) / len;
+    const auto coeffLeft = 1.0 - coeffRight;
+    return valueLeft * coeffLeft + valueRight * coeffRight;
+  }
+} // namespace internals
+
 /*! A general piecewise-linear interpolator
  *
  * This function is the building block for rather general piecewise-liner
@@ -103,15 +125,122 @@ interp1D(RAIterator const &begin, RAIterator const &end, Key const &keyVal,
       b = a;
       std::advance(a, -1); // here I need bi-directionality!
     }
-  const auto valueLeft = extractValue(*a);
-  const Key  keyLeft = extractKey(*a);
-  const auto valueRight = extractValue(*b);
-  const Key  keyRight = extractKey(*b);
-  const auto len = keyRight - keyLeft;
-  // I assume no nodes are repeated
-  const auto coeffRight = (keyVal - keyLeft) / len;
-  const auto coeffLeft = 1.0 - coeffRight;
-  return valueLeft * coeffLeft + valueRight * coeffRight;
+  return internals::linearInterpolation(Key(extractKey(*a)),
+                                        Key(extractKey(*b)), extractValue(*a),
+                                        extractValue(*b), keyVal);
+}
+
+/*! Piecewise-linear interpolation at many keys
+ *
+ * The same as the previous function, but it interpolates at all the keys in
+ * [first, last[ and writes the results in the range starting at out.
+ *
+ * The interval found for a key is the starting point of the search for the
+ * next one: the search gallops from there (with steps 1, 2, 4...) and then
+ * bisects. If the keys are sorted the whole procedure is a merge of two
+ * sorted sequences, with complexity N + M log2(N/M) for M keys, instead of
+ * M log2 N. It is correct for keys in any order, and still efficient if
+ * they are almost sorted.
+ *
+ * Results are identical to those of the previous function.
+ *
+ * @tparam RAIterator A bi-directional iterator (random access for the
+ * complexity above)
+ * @tparam KeyIterator An input iterator over the keys where to interpolate
+ * @tparam OutputIterator An output iterator
+ * @param begin Start of the range of interpolation nodes
+ * @param end   End of the range of interpolation nodes
+ * @param first Start of the range of keys to interpolate
+ * @param last End of the range of keys to interpolate
+ * @param out Where to write the interpolated values
+ * @param extractKey The actual functor for extraction of key
+ * @param extractValue The actual functor for extraction of values
+ * @param comp The comparison operator for keys
+ * @return The output iterator past the last value written
+ * @throw a runtime standard exception if I do not have at least 2
+ * interpolation nodes
+ */
+template <typename RAIterator, typename KeyIterator, typename OutputIterator,
+          typename ExtractKey, typename ExtractValue,
+          typename CompareKey =
+            std::less<typename std::iterator_traits<KeyIterator>::value_type>>
+OutputIterator
+interp1D(RAIterator const &begin, RAIterator const &end, KeyIterator first,
+         KeyIterator const &last, OutputIterator out,
+         ExtractKey const &extractKey, ExtractValue const &extractValue,
+         CompareKey const &comp = CompareKey())
+{
+  using category = typename std::iterator_traits<RAIterator>::iterator_category;
+  static_assert(std::is_same_v<category, std::bidirectional_iterator_tag> ||
+                  std::is_same_v<category, std::random_access_iterator_tag>,
+                "Iterators must be (at least) bidirectional");
+  using Key = typename std::iterator_traits<KeyIterator>::value_type;
+  if(std::distance(begin, end) < 2)
+    throw std::runtime_error(
+      "Interp1D: I need at least 2 points to interpolate!");
+  // keyVal on the left of the node
+  auto const onTheLeft = [&extractKey, &comp](Key const &keyVal,
+                                              auto const &node) {
+    return comp(keyVal, extractKey(node));
+  };
+  // The last interval starts here
+  RAIterator const lastInterval = std::prev(end, 2);
+  // The current interval [a, a+1]
+  RAIterator a{begin};
+  for(; first != last; ++first, ++out)
+    {
+      Key const keyVal = *first;
+      if(onTheLeft(keyVal, *a))
+        {
+          // gallop to the left: keyVal is on the left of hi
+          RAIterator hi{a};
+          for(typename std::iterator_traits<RAIterator>::difference_type
+                step = 1;
+              ; step *= 2)
+            {
+              auto const dis = std::distance(begin, hi);
+              if(dis == 0)
+                {
+                  a = begin; // extrapolation on the left
+                  break;
+                }
+              RAIterator lo = std::prev(hi, std::min(step, dis));
+              if(!onTheLeft(keyVal, *lo))
+                {
+                  a = std::prev(std::upper_bound(std::next(lo), hi, keyVal,
+                                                 onTheLeft));
+                  break;
+                }
+              hi = lo;
+            }
+        }
+      else
+        {
+          // gallop to the right: keyVal is on the right of lo (or on it)
+          RAIterator lo{a};
+          for(typename std::iterator_traits<RAIterator>::difference_type
+                step = 1;
+              lo != lastInterval; step *= 2)
+            {
+              RAIterator hi =
+                std::next(lo, std::min(step, std::distance(lo, lastInterval)));
+              if(onTheLeft(keyVal, *hi))
+                {
+                  lo = std::prev(std::upper_bound(std::next(lo), hi, keyVal,
+                                                  onTheLeft));
+                  break;
+                }
+              lo = hi;
+            }
+          a = lo; // if lo==lastInterval: extrapolation on the right
+        }
+      RAIterator const b = std::next(a);
+      *out = internals::linearInterpolation(Key(extractKey(*a)),
+                                            Key(extractKey(*b)),
+                                            extractValue(*a),
+                                            extractValue(*b), keyVal);
+    }
+  return out;
 }
 
 } // namespace apsc
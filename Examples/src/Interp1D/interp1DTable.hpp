@@ -0,0 +1,269 @@
+/*
+ * interp1DTable.hpp
+ *
+ *  A table for fast piecewise linear interpolation at many points
+ */
+
+#ifndef EXAMPLES_SRC_INTERP1D_INTERP1DTABLE_HPP_
+#define EXAMPLES_SRC_INTERP1D_INTERP1DTABLE_HPP_
+#include "interp1D.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+namespace apsc
+{
+//! What is known about the order of the keys where we interpolate
+enum class QueryOrder
+{
+  Unknown, //!< It is checked
+  Sorted,  //!< Increasing, or almost
+  Unsorted //!< Any order
+};
+
+/*! A table of interpolation nodes and values for fast interpolation
+ *
+ * It gives the same results as apsc::interp1D() with nodes sorted with
+ * std::less<double>, but is meant for interpolation at many points. Besides
+ * the nodes and the values it stores a bucket index: the interval
+ * [k_0, k_{n-1}] is divided into buckets of equal length and for each bucket
+ * we store the interval of nodes that contains its left end. The interval
+ * containing a key is found by computing its bucket, O(1), and then
+ * searching among the few nodes in the bucket (a bisection if they are
+ * many, which happens only if the nodes are very unevenly spaced).
+ *
+ * Many keys can be interpolated at once with evaluate(). If they are
+ * sorted, the intervals are found with a linear sweep, as in a merge, since
+ * the interval of a key is close to that of the previous one. Otherwise the
+ * bucket index is used. An overload takes an execution policy and
+ * interpolates blocks of keys in parallel.
+ *
+ * @tparam T The type of values. It must support the usual operations of a
+ * vector space
+ */
+template <class T = double> class Interp1DTable
+{
+public:
+  using size_type = std::size_t;
+  //! Number of keys interpolated by a task in parallel evaluations
+  static constexpr size_type blockSize = 4096u;
+  /*!
+   * Constructor
+   * @param keys The interpolation nodes, strictly increasing
+   * @param values The interpolation values
+   * @param bucketsPerNode Number of buckets per interval of the index
+   * @throw std::runtime_error if there are less than two nodes
+   * @throw std::invalid_argument if keys and values have different size, or
+   * keys are not strictly increasing
+   */
+  Interp1DTable(std::vector<double> keys, std::vector<T> values,
+                double bucketsPerNode = 1.0)
+    : M_keys{std::move(keys)}, M_values{std::move(values)}
+  {
+    if(M_keys.size() < 2u)
+      throw std::runtime_error(
+        "Interp1DTable: I need at least 2 points to interpolate!");
+    if(M_keys.size() != M_values.size())
+      throw std::invalid_argument(
+        "Interp1DTable: keys and values must have the same size");
+    if(std::adjacent_find(M_keys.begin(), M_keys.end(),
+                          std::greater_equal<double>{}) != M_keys.end())
+      throw std::invalid_argument(
+        "Interp1DTable: keys must be strictly increasing");
+    buildIndex(bucketsPerNode);
+  }
+  //! The number of interpolation nodes
+  size_type
+  size() const noexcept
+  {
+    return M_keys.size();
+  }
+  //! The number of buckets of the index
+  size_type
+  numBuckets() const noexcept
+  {
+    return M_bucketStart.size() - 1u;
+  }
+  /*!
+   * The interval containing the key
+   * @param keyVal The key
+   * @return i such that keyVal is in [k_i, k_{i+1}[ (0 or n-2 if keyVal is
+   * outside the nodes)
+   */
+  size_type
+  interval(double keyVal) const noexcept
+  {
+    double const position = (keyVal - M_keys.front()) * M_inverseWidth;
+    size_type    bucket = 0u; // also if position is NaN
+    if(position > 0.)
+      bucket = position < static_cast<double>(numBuckets() - 1u)
+                 ? static_cast<size_type>(position)
+                 : numBuckets() - 1u;
+    size_type const lo = M_bucketStart[bucket];
+    size_type const hi = M_bucketStart[bucket + 1u];
+    size_type       i = lo;
+    if(hi - lo > maxLinearSearch)
+      i = std::upper_bound(M_keys.begin() + lo + 1, M_keys.begin() + hi + 1,
+                           keyVal) -
+          M_keys.begin() - 1;
+    // linear search, or correction of the rounding near a bucket boundary
+    return walk(i, keyVal);
+  }
+  //! Interpolation at a key
+  T
+  operator()(double keyVal) const
+  {
+    return interpolate(interval(keyVal), keyVal);
+  }
+  /*!
+   * Interpolation at many keys
+   *
+   * @param first Start of the range of keys
+   * @param last End of the range of keys
+   * @param out Where the values are written
+   * @param order The order of the keys. If Unknown, it is checked.
+   * @return The output iterator past the last value written
+   */
+  template <class InputIterator, class OutputIterator>
+  OutputIterator
+  evaluate(InputIterator first, InputIterator last, OutputIterator out,
+           QueryOrder order = QueryOrder::Unknown) const
+  {
+    if(order == QueryOrder::Unknown)
+      {
+        if constexpr(std::is_base_of_v<
+                       std::forward_iterator_tag,
+                       typename std::iterator_traits<
+                         InputIterator>::iterator_category>)
+          order = std::is_sorted(first, last) ? QueryOrder::Sorted
+                                              : QueryOrder::Unsorted;
+        else
+          order = QueryOrder::Sorted; // a single pass is possible
+      }
+    if(order == QueryOrder::Sorted)
+      {
+        // sweep: start from the interval of the previous key
+        size_type i = 0u;
+        for(; first != last; ++first, ++out)
+          {
+            double const keyVal = *first;
+            i = sweep(i, keyVal);
+            *out = interpolate(i, keyVal);
+          }
+      }
+    else
+      for(; first != last; ++first, ++out)
+        *out = (*this)(*first);
+    return out;
+  }
+  /*!
+   * Parallel interpolation at many keys
+   *
+   * Keys are divided into blocks of blockSize keys, interpolated in parallel
+   * with the given policy by the sequential version of evaluate().
+   *
+   * @param policy An execution policy, like std::execution::par
+   * @param first Start of the range of keys (random access)
+   * @param last End of the range of keys
+   * @param out Where the values are written (random access)
+   * @param order The order of the keys. If Unknown, it is checked on each
+   * block.
+   */
+  template <class ExecutionPolicy, class RAInputIterator,
+            class RAOutputIterator>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+  void
+  evaluate(ExecutionPolicy &&policy, RAInputIterator first,
+           RAInputIterator last, RAOutputIterator out,
+           QueryOrder order = QueryOrder::Unknown) const
+  {
+    auto const             numKeys = static_cast<size_type>(last - first);
+    std::vector<size_type> blocks((numKeys + blockSize - 1u) / blockSize);
+    std::iota(blocks.begin(), blocks.end(), size_type{0u});
+    std::for_each(std::forward<ExecutionPolicy>(policy), blocks.begin(),
+                  blocks.end(), [&](size_type block) {
+                    auto const begin = block * blockSize;
+                    auto const end = std::min(begin + blockSize, numKeys);
+                    evaluate(first + begin, first + end, out + begin, order);
+                  });
+  }
+  //! Interpolation at many keys (vector version)
+  std::vector<T>
+  evaluate(std::vector<double> const &keyVals,
+           QueryOrder                 order = QueryOrder::Unknown) const
+  {
+    std::vector<T> result(keyVals.size());
+    evaluate(keyVals.begin(), keyVals.end(), result.begin(), order);
+    return result;
+  }
+
+private:
+  //! Above this number of nodes in a bucket we use bisection
+  static constexpr size_type maxLinearSearch = 8u;
+  //! Above this number of steps the sweep uses the index
+  static constexpr size_type maxSweepSteps = 4u;
+  //! Interpolation in interval i
+  T
+  interpolate(size_type i, double keyVal) const
+  {
+    return internals::linearInterpolation(M_keys[i], M_keys[i + 1u],
+                                          M_values[i], M_values[i + 1u],
+                                          keyVal);
+  }
+  //! Moves from interval i to the one containing keyVal
+  size_type
+  walk(size_type i, double keyVal) const noexcept
+  {
+    size_type const lastInterval = M_keys.size() - 2u;
+    while(i < lastInterval && !(keyVal < M_keys[i + 1u]))
+      ++i;
+    while(i > 0u && keyVal < M_keys[i])
+      --i;
+    return i;
+  }
+  //! The interval of keyVal, close to interval i if the keys are sorted
+  size_type
+  sweep(size_type i, double keyVal) const noexcept
+  {
+    size_type const lastInterval = M_keys.size() - 2u;
+    if(keyVal < M_keys[i] && i > 0u)
+      return interval(keyVal); // not sorted after all
+    for(size_type step = 0u; step < maxSweepSteps; ++step)
+      {
+        if(i == lastInterval || keyVal < M_keys[i + 1u])
+          return i;
+        ++i;
+      }
+    return interval(keyVal); // a jump: better use the index
+  }
+  //! Builds the bucket index with a merge of nodes and bucket boundaries
+  void
+  buildIndex(double bucketsPerNode)
+  {
+    auto const numBuckets = std::max<size_type>(
+      1u, static_cast<size_type>(std::ceil(bucketsPerNode *
+                                           (M_keys.size() - 1u))));
+    double const width = (M_keys.back() - M_keys.front()) / numBuckets;
+    M_inverseWidth = 1. / width;
+    M_bucketStart.resize(numBuckets + 1u);
+    size_type i = 0u;
+    for(size_type b = 0u; b < numBuckets; ++b)
+      {
+        i = walk(i, M_keys.front() + b * width);
+        M_bucketStart[b] = i;
+      }
+    M_bucketStart[numBuckets] = M_keys.size() - 2u;
+  }
+  std::vector<double>    M_keys;
+  std::vector<T>         M_values;
+  double                 M_inverseWidth = 0.;
+  std::vector<size_type> M_bucketStart;
+};
+} // namespace apsc
+
+#endif /* EXAMPLES_SRC_INTERP1D_INTERP1DTABLE_HPP_ */
@@ -0,0 +1,139 @@
+/*
+ * main_benchmark.cpp
+ *
+ *  Interpolation at many points: repeated calls of interp1D against the
+ *  batch versions
+ */
+#include "chrono.hpp" // in Utilities
+#include "interp1D.hpp"
+#include "interp1D_util.hpp"
+#include "interp1DTable.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <execution>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+/*
+ * For n = 10^3 ... 10^7 nodes, graded towards 0 (k_i = (i/(n-1))^2, so
+ * that a few buckets of the index contain many nodes), we interpolate at m
+ * random points in [-0.05, 1.05], in random order, sorted, and almost
+ * sorted (sorted, then 10% of the points swapped with the next one). We
+ * compare
+ * - repeated calls of apsc::interp1D (bisection);
+ * - the batch version of apsc::interp1D (galloping sweep);
+ * - Interp1DTable::evaluate, sequential and with std::execution::par.
+ * All results must be identical to those of the repeated calls.
+ *
+ * Usage: main_benchmark [m] (number of points, 10^6 by default)
+ */
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+constexpr int width = 12;
+
+bool
+runCase(std::size_t n, std::vector<double> const &random,
+        std::vector<double> const &sorted,
+        std::vector<double> const &almostSorted)
+{
+  std::vector<std::array<double, 2>> nodes(n);
+  std::vector<double>                keys(n);
+  std::vector<double>                values(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      double const t = static_cast<double>(i) / (n - 1u);
+      keys[i] = t * t;
+      values[i] = std::sin(10. * keys[i]);
+      nodes[i] = {keys[i], values[i]};
+    }
+  apsc::Interp1DTable<double> table(keys, values);
+  auto const                  getKey = [](auto const &x) { return x[0]; };
+  auto const                  getValue = [](auto const &x) { return x[1]; };
+
+  auto const          m = random.size();
+  std::vector<double> expected(m);
+  std::vector<double> result(m);
+  bool                ok = true;
+  auto const          check = [&] {
+    ok = ok && result == expected;
+    std::ranges::fill(result, 0.);
+  };
+  std::cout << std::setw(10) << n;
+  for(auto const *queries : {&random, &sorted, &almostSorted})
+    {
+      auto const &q = *queries;
+      double const tScalar = timeIt([&] {
+        for(std::size_t j = 0u; j < m; ++j)
+          expected[j] = apsc::interp1D(nodes, q[j]);
+      });
+      double const tSweep = timeIt([&] {
+        apsc::interp1D(nodes.cbegin(), nodes.cend(), q.cbegin(), q.cend(),
+                       result.begin(), getKey, getValue);
+      });
+      check();
+      auto const order = queries == &random ? apsc::QueryOrder::Unsorted
+                                            : apsc::QueryOrder::Sorted;
+      double const tTable = timeIt([&] {
+        table.evaluate(q.cbegin(), q.cend(), result.begin(), order);
+      });
+      check();
+      double const tParallel = timeIt([&] {
+        table.evaluate(std::execution::par, q.cbegin(), q.cend(),
+                       result.begin(), order);
+      });
+      check();
+      std::cout << std::setw(width) << tScalar << std::setw(width) << tSweep
+                << std::setw(width) << tTable << std::setw(width)
+                << tParallel;
+    }
+  std::cout << '\n';
+  return ok;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const m = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  std::mt19937      urbg{4321};
+  std::uniform_real_distribution<double> uniform(-0.05, 1.05);
+  std::vector<double>                    random(m);
+  for(auto &x : random)
+    x = uniform(urbg);
+  std::vector<double> sorted(random);
+  std::ranges::sort(sorted);
+  std::vector<double> almostSorted(sorted);
+  std::bernoulli_distribution swap(0.1);
+  for(std::size_t j = 0u; j + 1u < m; ++j)
+    if(swap(urbg))
+      std::swap(almostSorted[j], almostSorted[j + 1u]);
+
+  std::cout << "Time (ms) for interpolating at " << m << " points\n"
+            << "scalar: repeated interp1D, sweep: batch interp1D, "
+            << "table: Interp1DTable, par: Interp1DTable in parallel\n";
+  std::cout << std::setw(10) << "";
+  for(std::string const what : {"random", "sorted", "almost sorted"})
+    std::cout << std::setw(4 * width) << what;
+  std::cout << '\n' << std::setw(10) << "nodes";
+  for(int k = 0; k < 3; ++k)
+    for(std::string const what : {"scalar", "sweep", "table", "par"})
+      std::cout << std::setw(width) << what;
+  std::cout << '\n';
+  {
+    // the first parallel call starts the threads: not to be timed
+    apsc::Interp1DTable<double> table({0., 1.}, {0., 1.});
+    std::vector<double>         scratch(m);
+    table.evaluate(std::execution::par, random.cbegin(), random.cend(),
+                   scratch.begin());
+  }
+  bool ok = true;
+  for(std::size_t n = 1000u; n <= 10000000u; n *= 10u)
+    ok = runCase(n, random, sorted, almostSorted) && ok;
+  std::cout << "Results " << (ok ? "are identical" : "DIFFER") << '\n';
+  return ok ? 0 : 1;
+}
@@ -66,6 +66,8 @@ struct TestParameters
   SolverSwitch            solverSwitch;
   FVCode3D::PrecondSwitch precondSwitch;
   std::string             logFile;
+  //! Whether to time a second set-up of the preconditioner (a new time step)
+  bool                    refreshSetup = false;
   long int                EIGncv = 20L;
   long int                EIGmaxit = 1500L;
   double                  EIGtol = 1.e-8;
@@ -161,6 +163,8 @@ read_parameters(GetPot const &ifl)
   r.HSSalpha = ifl("HSS/alpha", 1.e-2);
   r.HSStol = ifl("HSS/tol", 1.e-2);
   r.logFile = ifl("logfile", "NONE");
+  test = ifl("refresh_setup", 0);
+  r.refreshSetup = (test != 0);
   // data for eigenvalues
   r.EIGncv = ifl("EIG/ncv", 20L);
   r.EIGmaxit = ifl("EIG/maxit", 1500L);
@@ -189,6 +193,58 @@ loadPreconditioner(FVCode3D::preconditioner &      p,
   p.set_MaxIt(param.HSSMaxIter);
   p.set_tol(param.HSStol);
 }
+//! A wrapper of a preconditioner that measures the time spent in solve().
+/*!
+ * It may be passed to the IML solvers in place of the preconditioner, to
+ * separate the cost of applying the preconditioner from the rest of the
+ * iterations.
+ */
+class TimedPreconditioner
+{
+public:
+  explicit TimedPreconditioner(FVCode3D::preconditioner const &p)
+    : precond{p}
+  {}
+  //! Applies the preconditioner and accumulates the time
+  FVCode3D::Vector
+  solve(FVCode3D::Vector const &r) const
+  {
+    timer.start();
+    FVCode3D::Vector z = precond.solve(r);
+    timer.stop();
+    totalTime += timer.wallTime() * 1.e-3;
+    ++calls;
+    return z;
+  }
+  //! Total time in solve() (ms)
+  double
+  time() const
+  {
+    return totalTime;
+  }
+  //! Number of calls to solve()
+  unsigned int
+  numCalls() const
+  {
+    return calls;
+  }
+
+private:
+  FVCode3D::preconditioner const &precond;
+  mutable Timings::Chrono         timer;
+  mutable double                  totalTime = 0.;
+  mutable unsigned int            calls = 0u;
+};
+
+//! Prints the time spent by phase in the set-up of a preconditioner.
+inline std::ostream &
+operator<<(std::ostream &out, FVCode3D::SetupTimings const &t)
+{
+  out << "total " << t.total() << " ms (assembly " << t.assembly
+      << ", symbolic " << t.symbolic << ", numeric " << t.numeric << ")";
+  return out;
+}
+
 //! Pretty-print the effective runtime configuration.
 /*!
  * This is used both on screen and on the optional log stream so each run keeps
@@ -233,6 +289,7 @@ operator<<(std::ostream &out, TestParameters const &p)
   out << "B matrix file name= " << p.BMatrixFileName << std::endl;
   out << "Symmetric indefinite form:" << std::boolalpha << p.isSymUndef
       << " Lumping:" << p.lumped << std::endl;
+  out << "Preconditioner set-up refresh:" << p.refreshSetup << std::endl;
   return out;
 }
 } // namespace SaddlePointUtilities
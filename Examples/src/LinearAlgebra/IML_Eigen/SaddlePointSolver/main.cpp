@@ -138,6 +138,18 @@ main(int argc, char *argv[])
     saddlePointMat.convertToDoubleSaddlePoint();
 
   loadPreconditioner(precond, saddlePointMat, testParameters);
+  std::clog << "Preconditioner set-up:           " << precond.setupTimings()
+            << std::endl;
+  // Set it again, as at a new time step where only the values of the blocks
+  // change: the symbolic analyses are reused
+  if(testParameters.refreshSetup)
+    {
+      precond.set(saddlePointMat);
+      std::clog << "Preconditioner set-up (refresh): "
+                << precond.setupTimings() << std::endl;
+    }
+  // Measures the time spent in applying the preconditioner
+  TimedPreconditioner timedPrecond(precond);
 
   // Status flag returned by the selected solver.
   int result{0};
@@ -188,8 +200,9 @@ main(int argc, char *argv[])
         auto m = testParameters.gmres_levels;
         std::clog << "Starting computations\n";
         timer.start();
+        // Solve system
         result =
-          GMRES(saddlePointMat, x, b, precond, m, maxit, tol); // Solve system
+          GMRES(saddlePointMat, x, b, timedPrecond, m, maxit, tol);
         timer.stop();
         std::clog << timer;
         std::clog << "End computations\n";
@@ -200,8 +213,9 @@ main(int argc, char *argv[])
         auto m = testParameters.gmres_levels;
         std::clog << "Starting computations\n";
         timer.start();
+        // Solve system
         result =
-          GMRESR(saddlePointMat, x, b, precond, m, maxit, tol); // Solve system
+          GMRESR(saddlePointMat, x, b, timedPrecond, m, maxit, tol);
         timer.stop();
         std::clog << timer;
         std::clog << "End computations\n";
@@ -212,7 +226,7 @@ main(int argc, char *argv[])
         std::clog << "Starting computations\n";
         timer.start();
         auto m = testParameters.gmres_levels;
-        result = FGMRES(saddlePointMat, x, b, precond, m, maxit, tol);
+        result = FGMRES(saddlePointMat, x, b, timedPrecond, m, maxit, tol);
         ; // Solve system
         timer.stop();
         std::clog << timer;
@@ -224,8 +238,8 @@ main(int argc, char *argv[])
         {
           std::clog << "Starting computations\n";
           timer.start();
-          result =
-            MINRES(saddlePointMat, x, b, precond, maxit, tol); // Solve system
+          // Solve system
+          result = MINRES(saddlePointMat, x, b, timedPrecond, maxit, tol);
           timer.stop();
           std::clog << timer;
           std::clog << "End computations\n";
@@ -238,7 +252,7 @@ main(int argc, char *argv[])
     case tminres:
       std::clog << "Starting computations\n";
       timer.start();
-      result = TMINRES(saddlePointMat, x, b, precond, maxit, tol,
+      result = TMINRES(saddlePointMat, x, b, timedPrecond, maxit, tol,
                        true); // Solve system
       timer.stop();
       std::clog << timer;
@@ -256,5 +270,10 @@ main(int argc, char *argv[])
   std::clog << "Relative Error:        " << solError << std::endl;
   std::clog << "Relative Residual Error:" << resFinal << std::endl;
   std::clog << "Cond. Estimate         :" << solError / resFinal << std::endl;
+  if(timedPrecond.numCalls() > 0u)
+    std::clog << "Preconditioner applied " << timedPrecond.numCalls()
+              << " times in " << timedPrecond.time() << " ms ("
+              << timedPrecond.time() / timedPrecond.numCalls()
+              << " ms each)" << std::endl;
   return result;
 }
@@ -14,9 +14,11 @@
 #include "preconditioner.hpp"
 #include <Eigen/LU>
 #include <unsupported/Eigen/SparseExtra>
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iostream>
+#include <numeric>
 namespace FVCode3D
 {
 DiagMat
@@ -79,6 +81,242 @@ BamCt(const SaddlePointMat &Mat, const DiagMat &D)
   return matrix.getBlock({1, 0}) * D * matrix.getBlock({2, 0}).transpose();
 }
 
+SetupTimings
+SchurComplementLDLT::compute(const SpMat &B, const DiagMat &D, const SpMat *T,
+                             Real sign)
+{
+  // The kernels below work on the arrays of compressed matrices
+  SpMat        compressedB, compressedT;
+  const SpMat *Bc = &B;
+  const SpMat *Tc = T;
+  if(!B.isCompressed())
+    {
+      compressedB = B;
+      compressedB.makeCompressed();
+      Bc = &compressedB;
+    }
+  if(T && !T->isCompressed())
+    {
+      compressedT = *T;
+      compressedT.makeCompressed();
+      Tc = &compressedT;
+    }
+  SetupTimings    timings;
+  Timings::Chrono timer;
+  if(!samePattern(*Bc, Tc))
+    {
+      timer.start();
+      analyze(*Bc, Tc);
+      timer.stop();
+      timings.symbolic = timer.wallTime() * 1.e-3;
+    }
+  timer.start();
+  fill(*Bc, D, Tc, sign);
+  timer.stop();
+  timings.assembly = timer.wallTime() * 1.e-3;
+  timer.start();
+  ldlt.factorize(S);
+  timer.stop();
+  timings.numeric = timer.wallTime() * 1.e-3;
+  return timings;
+}
+
+namespace
+{
+  //! Copies the outer and inner indices of a compressed matrix
+  std::vector<SpMat::StorageIndex>
+  copyPattern(const SpMat &A)
+  {
+    std::vector<SpMat::StorageIndex> pattern(
+      A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+    pattern.insert(pattern.end(), A.innerIndexPtr(),
+                   A.innerIndexPtr() + A.nonZeros());
+    return pattern;
+  }
+  //! True if the compressed matrix A has the given pattern
+  bool
+  hasPattern(const SpMat &A, const std::vector<SpMat::StorageIndex> &pattern)
+  {
+    auto const outer = A.outerSize() + 1;
+    return pattern.size() == std::size_t(outer + A.nonZeros()) &&
+           std::equal(A.outerIndexPtr(), A.outerIndexPtr() + outer,
+                      pattern.begin()) &&
+           std::equal(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(),
+                      pattern.begin() + outer);
+  }
+} // namespace
+
+bool
+SchurComplementLDLT::samePattern(const SpMat &B, const SpMat *T) const
+{
+  if(analyses == 0 || B.rows() != Brows || !hasPattern(B, patternB))
+    return false;
+  return T ? hasPattern(*T, patternT) : patternT.empty();
+}
+
+void
+SchurComplementLDLT::analyze(const SpMat &B, const SpMat *T)
+{
+  auto const  m = B.rows();
+  auto const *Bstart = B.outerIndexPtr();
+  auto const *Brow = B.innerIndexPtr();
+  // The rows of B, by counting sort
+  rowStart.assign(m + 1, 0);
+  for(Eigen::Index p = 0; p < B.nonZeros(); ++p)
+    ++rowStart[Brow[p] + 1];
+  std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+  rowColumn.resize(B.nonZeros());
+  rowPosition.resize(B.nonZeros());
+  {
+    std::vector<Eigen::Index> next(rowStart.begin(), rowStart.end() - 1);
+    for(Eigen::Index k = 0; k < B.cols(); ++k)
+      for(auto p = Bstart[k]; p < Bstart[k + 1]; ++p)
+        {
+          auto const q = next[Brow[p]]++;
+          rowColumn[q] = k;
+          rowPosition[q] = p;
+        }
+  }
+  // The pattern of the upper triangle of S, column by column. Column j of
+  // B D B^T is a combination of the columns k of B such that B(j,k)!=0.
+  std::vector<StorageIndex> outer(m + 1, 0);
+  std::vector<StorageIndex> inner;
+  std::vector<Eigen::Index> mark(m, -1);
+  for(Eigen::Index j = 0; j < m; ++j)
+    {
+      auto const first = inner.size();
+      auto const add = [&](Eigen::Index i) {
+        if(i <= j && mark[i] != j)
+          {
+            mark[i] = j;
+            inner.push_back(static_cast<StorageIndex>(i));
+          }
+      };
+      add(j); // the diagonal is always present
+      for(auto q = rowStart[j]; q < rowStart[j + 1]; ++q)
+        {
+          auto const k = rowColumn[q];
+          for(auto p = Bstart[k]; p < Bstart[k + 1]; ++p)
+            add(Brow[p]);
+        }
+      if(T)
+        for(auto p = T->outerIndexPtr()[j]; p < T->outerIndexPtr()[j + 1]; ++p)
+          add(T->innerIndexPtr()[p]);
+      std::sort(inner.begin() + first, inner.end());
+      outer[j + 1] = static_cast<StorageIndex>(inner.size());
+    }
+  S.resize(m, m);
+  S.resizeNonZeros(inner.size());
+  std::copy(outer.begin(), outer.end(), S.outerIndexPtr());
+  std::copy(inner.begin(), inner.end(), S.innerIndexPtr());
+  std::fill(S.valuePtr(), S.valuePtr() + inner.size(), 0.);
+  slot.resize(m);
+  ldlt.analyzePattern(S);
+  // Store the patterns used
+  Brows = m;
+  patternB = copyPattern(B);
+  patternT = T ? copyPattern(*T) : std::vector<StorageIndex>{};
+  ++analyses;
+}
+
+void
+SchurComplementLDLT::fill(const SpMat &B, const DiagMat &D, const SpMat *T,
+                          Real sign)
+{
+  auto const  m = B.rows();
+  auto const *Bstart = B.outerIndexPtr();
+  auto const *Brow = B.innerIndexPtr();
+  auto const *Bvalue = B.valuePtr();
+  auto const &d = D.diagonal();
+  auto const *Sstart = S.outerIndexPtr();
+  auto const *Srow = S.innerIndexPtr();
+  auto       *Svalue = S.valuePtr();
+  for(Eigen::Index j = 0; j < m; ++j)
+    {
+      for(auto p = Sstart[j]; p < Sstart[j + 1]; ++p)
+        {
+          slot[Srow[p]] = p;
+          Svalue[p] = 0.;
+        }
+      // the inner indices are sorted, so we can stop at the diagonal
+      for(auto q = rowStart[j]; q < rowStart[j + 1]; ++q)
+        {
+          auto const k = rowColumn[q];
+          Real const coeff = sign * d[k] * Bvalue[rowPosition[q]];
+          for(auto p = Bstart[k]; p < Bstart[k + 1] && Brow[p] <= j; ++p)
+            Svalue[slot[Brow[p]]] += coeff * Bvalue[p];
+        }
+      if(T)
+        {
+          auto const *Tstart = T->outerIndexPtr();
+          auto const *Trow = T->innerIndexPtr();
+          auto const *Tvalue = T->valuePtr();
+          for(auto p = Tstart[j]; p < Tstart[j + 1] && Trow[p] <= j; ++p)
+            Svalue[slot[Trow[p]]] -= sign * Tvalue[p];
+        }
+    }
+}
+
+void
+BlockDiagonal_preconditioner::set(const SaddlePointMat &SP)
+{
+  Timings::Chrono timer;
+  timer.start();
+  Bptr = &SP.getB();
+  Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
+  timer.stop();
+  timings = SetupTimings{timer.wallTime() * 1.e-3};
+  // factorize -S = B D B^T - T
+  timings += chol.compute(SP.getB(), Md_inv, &SP.getT(), 1.);
+}
+
+void
+BlockTriangular_preconditioner::set(const SaddlePointMat &SP)
+{
+  Timings::Chrono timer;
+  timer.start();
+  Bptr = &SP.getB();
+  Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
+  timer.stop();
+  timings = SetupTimings{timer.wallTime() * 1.e-3};
+  // factorize -S = B D B^T - T
+  timings += chol.compute(SP.getB(), Md_inv, &SP.getT(), 1.);
+}
+
+void
+ILU_preconditioner::set(const SaddlePointMat &SP)
+{
+  Timings::Chrono timer;
+  timer.start();
+  Bptr = &SP.getB();
+  Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
+  timer.stop();
+  timings = SetupTimings{timer.wallTime() * 1.e-3};
+  // factorize -S = B D B^T - T
+  timings += chol.compute(SP.getB(), Md_inv, &SP.getT(), 1.);
+}
+
+void
+DoubleSaddlePoint_preconditioner::set(const SaddlePointMat &SP)
+{
+  Timings::Chrono timer;
+  timer.start();
+  auto const &matrix = SP.sparseBlockMatrix();
+  nCell = matrix.rows({1, 0});
+  nVel = matrix.rows({0, 0});
+  nFrac = matrix.rows({2, 0});
+  Bptr = &matrix.getBlock({1, 0});
+  Cptr = &matrix.getBlock({2, 0});
+  Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
+  BAmC = BamCt(SP, Md_inv);
+  timer.stop();
+  timings = SetupTimings{timer.wallTime() * 1.e-3};
+  // T22 - C D C^T
+  timings += Schur_chol.compute(*Cptr, Md_inv, &matrix.getBlock({2, 2}), -1.);
+  // -B D B^T
+  timings += BAB_chol.compute(*Bptr, Md_inv, nullptr, -1.);
+}
+
 Vector
 diagonal_preconditioner::solve(const Vector &r) const
 {
@@ -159,6 +397,8 @@ Real constexpr HSS_preconditioner::alpha_default;
 void
 HSS_preconditioner::set(const SaddlePointMat &SP)
 {
+  Timings::Chrono timer;
+  timer.start();
   auto &M = SP.getM();
   auto &B = SP.getB();
   auto &T = SP.getT();
@@ -209,12 +449,34 @@ HSS_preconditioner::set(const SaddlePointMat &SP)
   SpMat BBtalpha = B * B.transpose();
   for(int i = 0; i < BBtalpha.rows(); i++)
     BBtalpha.coeffRef(i, i) += alpha * alpha;
+  // The patterns are compared with those of the last symbolic analyses
+  Talpha.makeCompressed();
+  BBtalpha.makeCompressed();
+
+  timer.stop();
+  timings = SetupTimings{timer.wallTime() * 1.e-3};
 
   // cg.setMaxIterations(MaxIt);
   // cg.setTolerance(tol);
   // cg.compute(Halpha);
-  cholT.compute(Talpha);
-  cholBBt.compute(BBtalpha);
+  timer.start();
+  if(!hasPattern(Talpha, patternT))
+    {
+      cholT.analyzePattern(Talpha);
+      patternT = copyPattern(Talpha);
+    }
+  if(!hasPattern(BBtalpha, patternBBt))
+    {
+      cholBBt.analyzePattern(BBtalpha);
+      patternBBt = copyPattern(BBtalpha);
+    }
+  timer.stop();
+  timings.symbolic = timer.wallTime() * 1.e-3;
+  timer.start();
+  cholT.factorize(Talpha);
+  cholBBt.factorize(BBtalpha);
+  timer.stop();
+  timings.numeric = timer.wallTime() * 1.e-3;
 }
 
 Vector
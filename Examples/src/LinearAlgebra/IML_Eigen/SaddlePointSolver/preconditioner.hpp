@@ -21,6 +21,7 @@
 #include <Eigen/SparseCholesky>
 #include <unsupported/Eigen/SparseExtra>
 #include <memory>
+#include <vector>
 
 namespace FVCode3D
 {
@@ -99,6 +100,105 @@ ComputeApproximateSchur(const SaddlePointMat &Mat, bool lumping = false)
   return ComputeApproximateSchur(
     Mat, ComputeApproximateInverseInnerProd(Mat, lumping));
 }
+//! Time (in ms) spent in the set-up of a preconditioner, by phase.
+struct SetupTimings
+{
+  //! Building the approximations of the blocks (M^{-1}, Schur complement)
+  Real assembly = 0.;
+  //! Symbolic analysis of the factorizations (zero if it has been reused)
+  Real symbolic = 0.;
+  //! Numeric factorizations
+  Real numeric = 0.;
+
+  SetupTimings &
+  operator+=(SetupTimings const &other)
+  {
+    assembly += other.assembly;
+    symbolic += other.symbolic;
+    numeric += other.numeric;
+    return *this;
+  }
+  //! Total time
+  Real
+  total() const
+  {
+    return assembly + symbolic + numeric;
+  }
+};
+
+//! LDLT factorization of an approximate Schur complement.
+/*!
+ * @class SchurComplementLDLT
+ * Factorizes S = sign (B D B^T - T), where D is diagonal and T is optional.
+ *
+ * The sparsity pattern of S and the symbolic analysis of the factorization
+ * are computed at the first call of compute() and reused as long as the
+ * patterns of B and T do not change, as in a time dependent problem where
+ * only the coefficients change between time steps. Then compute() only
+ * refills the values of S, without allocating memory, and redoes the numeric
+ * factorization. Only the upper triangle of S is formed, since it is the
+ * only part read by the factorization.
+ */
+class SchurComplementLDLT
+{
+public:
+  using LDLT = Eigen::SimplicialLDLT<SpMat, Eigen::Upper>;
+  //! Computes and factorizes S
+  /*!
+   * @param B The B matrix
+   * @param D The diagonal matrix
+   * @param T The T matrix, square as B D B^T (nullptr if not present)
+   * @param sign +1 or -1
+   * @return The time spent in the different phases
+   */
+  SetupTimings compute(const SpMat &B, const DiagMat &D, const SpMat *T,
+                       Real sign);
+  //! Solves S x = r
+  Vector
+  solve(const Vector &r) const
+  {
+    return ldlt.solve(r);
+  }
+  //! The (upper triangle of the) matrix S last factorized
+  const SpMat &
+  matrix() const
+  {
+    return S;
+  }
+  //! The number of symbolic analyses performed up to now
+  UInt
+  numAnalyses() const
+  {
+    return analyses;
+  }
+
+private:
+  using StorageIndex = SpMat::StorageIndex;
+  //! True if B and T have the pattern used for the symbolic analysis
+  bool samePattern(const SpMat &B, const SpMat *T) const;
+  //! Computes the pattern of S and performs the symbolic analysis
+  void analyze(const SpMat &B, const SpMat *T);
+  //! Fills the values of S
+  void fill(const SpMat &B, const DiagMat &D, const SpMat *T, Real sign);
+  //! The factorization
+  LDLT ldlt;
+  //! The upper triangle of S
+  SpMat S;
+  //! The rows of B in CSR format: column index and position in B of the
+  //! entries of each row
+  std::vector<Eigen::Index> rowStart;
+  std::vector<Eigen::Index> rowColumn;
+  std::vector<Eigen::Index> rowPosition;
+  //! For each row, the position in the current column of S
+  std::vector<Eigen::Index> slot;
+  //! Copy of the patterns of B and T (outer and inner indices)
+  std::vector<StorageIndex> patternB;
+  std::vector<StorageIndex> patternT;
+  Eigen::Index              Brows = -1;
+  //! Number of symbolic analyses
+  UInt analyses = 0;
+};
+
 //! Abstract interface for all saddle-point preconditioners used in this folder.
 /*!
  * @class preconditioner
@@ -168,10 +268,18 @@ public:
   set_tol(const Real)
   {}
   //@}
+  //! The time spent by phase in the last call to set()
+  const SetupTimings &
+  setupTimings() const
+  {
+    return timings;
+  }
   virtual ~preconditioner() = default;
 
 protected:
   bool lumped = false;
+  //! Filled by set()
+  SetupTimings timings;
   //@}
 };
 
@@ -272,11 +380,7 @@ class BlockDiagonal_preconditioner : public preconditioner
 public:
   //! @name Constructor & Destructor
   //@{
-  BlockDiagonal_preconditioner(const SaddlePointMat &SP) : Bptr{&SP.getB()}
-  {
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    chol.compute(-ComputeApproximateSchur(SP, Md_inv));
-  }
+  BlockDiagonal_preconditioner(const SaddlePointMat &SP) { this->set(SP); }
   //! Empty-Constructor
   BlockDiagonal_preconditioner() = default;
   //@}
@@ -288,14 +392,7 @@ public:
    * @param Mat The saddle point mat
    *
    */
-  void
-  set(const SaddlePointMat &SP) override
-  {
-    Bptr = &SP.getB();
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    // store Chowleski factor of -S
-    chol.compute(-ComputeApproximateSchur(SP, Md_inv));
-  }
+  void set(const SaddlePointMat &SP) override;
   //@}
 
   //! @name Solve Methods
@@ -312,8 +409,8 @@ private:
   const SpMat *Bptr = nullptr;
   //! The inverse of the diagonal of M
   DiagMat Md_inv;
-  //! Cholesky factorization
-  Eigen::SimplicialLDLT<SpMat, Eigen::Upper> chol;
+  //! Cholesky factorization of -S
+  SchurComplementLDLT chol;
 };
 
 //! Block-triangular preconditioner for the 2x2 saddle-point matrix.
@@ -326,12 +423,7 @@ class BlockTriangular_preconditioner : public preconditioner
 public:
   //! @name Constructor & Destructor
   //@{
-  BlockTriangular_preconditioner(const SaddlePointMat &SP) : Bptr{&SP.getB()}
-  {
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    // B D^{-1}B^T -T (-Shur complement)
-    chol.compute(-ComputeApproximateSchur(SP, Md_inv));
-  }
+  BlockTriangular_preconditioner(const SaddlePointMat &SP) { this->set(SP); }
   BlockTriangular_preconditioner() = default;
   //@}
   //! @name Assemble Methods
@@ -341,15 +433,7 @@ public:
    * @param Mat The saddle point mat
    *
    */
-  void
-  set(const SaddlePointMat &SP) override
-  {
-    Bptr = &SP.getB();
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    // -B D^{-1}B^T + T (-Schur complement)
-    chol.compute(
-      -ComputeApproximateSchur(SP, Md_inv)); // store chowleski factor
-  }
+  void set(const SaddlePointMat &SP) override;
   //@}
 
   //! @name Solve Methods
@@ -366,8 +450,8 @@ private:
   const SpMat *Bptr = nullptr;
   //! The inverse of the diagonal of M
   DiagMat Md_inv;
-  //! Cholesky factorization
-  Eigen::SimplicialLDLT<SpMat, Eigen::Upper> chol;
+  //! Cholesky factorization of -S
+  SchurComplementLDLT chol;
 };
 
 //! Incomplete block LU preconditioner for the 2x2 saddle-point matrix.
@@ -381,12 +465,7 @@ class ILU_preconditioner : public preconditioner
 public:
   //! @name Constructor & Destructor
   //@{
-  ILU_preconditioner(const SaddlePointMat &SP) : Bptr{&SP.getB()}
-  {
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    // store Chowleski factor of -S
-    chol.compute(-ComputeApproximateSchur(SP, Md_inv));
-  }
+  ILU_preconditioner(const SaddlePointMat &SP) { this->set(SP); }
   //@}
   //! Empty-Constructor
   ILU_preconditioner() = default;
@@ -397,14 +476,7 @@ public:
   /*!
    * @param Mat The saddle point mat
    */
-  void
-  set(const SaddlePointMat &SP) override
-  {
-    Bptr = &SP.getB();
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    // store Chowleski factor of -S
-    chol.compute(-ComputeApproximateSchur(SP, Md_inv));
-  }
+  void set(const SaddlePointMat &SP) override;
   //@}
 
   //! @name Solve Methods
@@ -421,14 +493,16 @@ private:
   const SpMat *Bptr = nullptr;
   //! The inverse of the diagonal of M
   DiagMat Md_inv;
-  //! Cholesky factorization
-  Eigen::SimplicialLDLT<SpMat, Eigen::Upper> chol;
+  //! Cholesky factorization of -S
+  SchurComplementLDLT chol;
 };
 
 //! Hermitian/skew-Hermitian splitting preconditioner.
 /*!
  * This variant builds the auxiliary matrices described in the reference paper
  * and applies them through a combination of CG and sparse LDLT solves.
+ * As in SchurComplementLDLT, the symbolic analyses of the LDLT factorizations
+ * are redone only when the patterns of the matrices change.
  */
 class HSS_preconditioner : public preconditioner
 {
@@ -512,6 +586,9 @@ private:
   Eigen::SimplicialLDLT<SpMat, Eigen::Upper> cholT;
   //! Cholesky factorization for BBtalpha
   Eigen::SimplicialLDLT<SpMat, Eigen::Upper> cholBBt;
+  //! Patterns (outer and inner indices) used for the symbolic analyses
+  std::vector<SpMat::StorageIndex> patternT;
+  std::vector<SpMat::StorageIndex> patternBBt;
   //! Vector to scale M
   Vector scaledM;
   //! The alpha coeff of the scheme (default value)
@@ -528,17 +605,8 @@ public:
   //! @name Constructor & Destructor
   //@{
   DoubleSaddlePoint_preconditioner(const SaddlePointMat &SP)
-    : Bptr{&SP.sparseBlockMatrix().getBlock({1, 0})},
-      Cptr{&SP.sparseBlockMatrix().getBlock({2, 0})},
-      nVel{SP.sparseBlockMatrix().rows({0, 0})},
-      nCell{SP.sparseBlockMatrix().rows({1, 0})}, nFrac{
-                                                    SP.sparseBlockMatrix().rows(
-                                                      {2, 0})}
   {
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    Schur_chol.compute(ComputeApproximateSchurDSP(SP, Md_inv));
-    BAB_chol.compute(BamBt(SP, Md_inv));
-    BAmC = BamCt(SP, Md_inv);
+    this->set(SP);
   }
   //! Empty-Constructor
   DoubleSaddlePoint_preconditioner() = default;
@@ -551,19 +619,7 @@ public:
    * @param Mat The saddle point mat
    *
    */
-  void
-  set(const SaddlePointMat &SP) override
-  {
-    nCell = SP.sparseBlockMatrix().rows({1, 0});
-    nVel = SP.sparseBlockMatrix().rows({0, 0});
-    nFrac = SP.sparseBlockMatrix().rows({2, 0});
-    Bptr = &SP.sparseBlockMatrix().getBlock({1, 0});
-    Cptr = &SP.sparseBlockMatrix().getBlock({2, 0});
-    Md_inv = ComputeApproximateInverseInnerProd(SP, this->lumped);
-    Schur_chol.compute(ComputeApproximateSchurDSP(SP, Md_inv));
-    BAB_chol.compute(BamBt(SP, Md_inv));
-    BAmC = BamCt(SP, Md_inv);
-  }
+  void set(const SaddlePointMat &SP) override;
   //@}
 
   //! @name Solve Methods
@@ -582,9 +638,10 @@ protected:
   Eigen::Index nFrac;
   //! The inverse of the diagonal of M
   DiagMat Md_inv;
-  //! Cholesky factorization
-  Eigen::SimplicialLDLT<SpMat, Eigen::Upper> Schur_chol;
-  Eigen::SimplicialLDLT<SpMat, Eigen::Upper> BAB_chol;
+  //! Factorization of the fracture Schur complement
+  SchurComplementLDLT Schur_chol;
+  //! Factorization of -B D B^T
+  SchurComplementLDLT BAB_chol;
 };
 
 class DoubleSaddlePointSym_preconditioner
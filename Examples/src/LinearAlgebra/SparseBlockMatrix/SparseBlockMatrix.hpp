@@ -9,6 +9,7 @@
 #define EXAMPLES_SRC_LINEARALGEBRA_SPARSEBLOCKMATRIX_SPARSEBLOCKMATRIX_HPP_
 #include "Eigen/Dense"
 #include "Eigen/Sparse"
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <exception>
@@ -47,6 +48,8 @@ public:
   //! The type of a row vector
   //! @todo this part should go in a trait!
   using RowVector = Eigen::Matrix<T, 1, Eigen::Dynamic>;
+  //! The type of the merged matrix returned by csrSnapshot()
+  using CsrMatrix = Eigen::SparseMatrix<T, Eigen::RowMajor>;
   //! The type used to index Eigen matrices.
   //! @todo it may be changed by adding a further template argument to SpMat
   //! definition or in the trait.
@@ -245,6 +248,33 @@ public:
    */
   SpMat fullMatrix() const;
 
+  /*!
+   * Computes res = A*x without allocating a new vector (res is resized only
+   * if it has the wrong size).
+   *
+   * The block rows write disjoint parts of res, so if compiled with OpenMP
+   * they are computed in parallel. The blocks stored as transposes are
+   * multiplied with a dedicated kernel that reads the stored matrix in its
+   * own storage order, without forming the transpose.
+   *
+   * @param res The result
+   * @param x The vector (of size cols())
+   */
+  void multiplyInto(ColVector &res, ColVector const &x) const;
+
+  /*!
+   * Merges all blocks in a single matrix in row-major (CSR) format. The
+   * product of a row-major Eigen matrix by a vector is parallelized by Eigen
+   * on the rows if compiled with OpenMP, so it is convenient when many
+   * products with the same matrix are needed (Krylov solvers). It is a copy:
+   * later changes of the blocks are not reflected in it.
+   *
+   * It is cheaper than fullMatrix(): the rows are filled directly, without
+   * sorting triplets.
+   * @return The full matrix in row-major format.
+   */
+  CsrMatrix csrSnapshot() const;
+
   //! Squared Frobenius norm
   double
   squaredNorm() const
@@ -309,29 +339,8 @@ auto
 operator*(SparseBlockMatrix<T, M, N, storageOrder> const &                    A,
           typename SparseBlockMatrix<T, M, N, storageOrder>::ColVector const &x)
 {
-  using ColVector =
-    typename SparseBlockMatrix<T, M, N, storageOrder>::ColVector;
-  ColVector res = ColVector::Zero(A.rows());
-
-  for(unsigned int i = 0; i < M; ++i)
-    {
-      for(unsigned int j = 0; j < N; ++j)
-        {
-          auto ncols = A.cols({i, j});
-          auto nrows = A.rows({i, j});
-          if(A.isTranspose({i, j}))
-            {
-              res.segment(A.rowOffset(i), nrows) +=
-                A.getBlock({i, j}).transpose() *
-                x.segment(A.colOffset(j), ncols);
-            }
-          else
-            {
-              res.segment(A.rowOffset(i), nrows) +=
-                A.getBlock({i, j}) * x.segment(A.colOffset(j), ncols);
-            }
-        }
-    }
+  typename SparseBlockMatrix<T, M, N, storageOrder>::ColVector res;
+  A.multiplyInto(res, x);
   return res;
 }
 
@@ -375,6 +384,114 @@ operator*(typename SparseBlockMatrix<T, M, N, storageOrder>::RowVector const &x,
 //      **********************     IMPLEMENTATIONS
 //      *******************************************
 
+namespace internals
+{
+  /*!
+   * Adds to y the product of a sparse matrix, or of its transpose, by x.
+   *
+   * If the rows of the logical matrix are the outer vectors of the stored
+   * one (a transposed column-major matrix, or a row-major one), each entry
+   * of y is a dot product computed in a register. Otherwise the columns of
+   * the logical matrix are scattered on y.
+   */
+  template <class SpMat>
+  void
+  addSparseProduct(SpMat const &A, bool transposed,
+                   typename SpMat::Scalar const *x,
+                   typename SpMat::Scalar *__restrict y)
+  {
+    using Scalar = typename SpMat::Scalar;
+    bool const gather = transposed == !SpMat::IsRowMajor;
+    for(Eigen::Index k = 0; k < A.outerSize(); ++k)
+      {
+        if(gather)
+          {
+            Scalar sum{0};
+            for(typename SpMat::InnerIterator it(A, k); it; ++it)
+              sum += it.value() * x[it.index()];
+            y[k] += sum;
+          }
+        else
+          {
+            Scalar const xk = x[k];
+            for(typename SpMat::InnerIterator it(A, k); it; ++it)
+              y[it.index()] += it.value() * xk;
+          }
+      }
+  }
+} // namespace internals
+
+template <typename T, unsigned int M, unsigned int N, int storageOrder>
+void
+SparseBlockMatrix<T, M, N, storageOrder>::multiplyInto(ColVector       &res,
+                                                       ColVector const &x) const
+{
+  if(x.size() != totalCols)
+    throw std::runtime_error(
+      "In multiplyInto: the vector does not have the expected size");
+  if(res.size() != totalRows)
+    res.resize(totalRows);
+  // res and x must not alias: work on a copy of x if they do
+  ColVector        copy;
+  ColVector const *in = &x;
+  if(&res == &x)
+    {
+      copy = x;
+      in = &copy;
+    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if(M > 1)
+#endif
+  for(unsigned int i = 0; i < M; ++i)
+    {
+      T *y = res.data() + theRowOffset[i];
+      std::fill(y, y + theRowSizes[i], T{0});
+      for(unsigned int j = 0; j < N; ++j)
+        if(theMatrices[i][j]->nonZeros() > 0)
+          internals::addSparseProduct(*theMatrices[i][j], transpose[i][j],
+                                      in->data() + theColOffset[j], y);
+    }
+}
+
+template <typename T, unsigned int M, unsigned int N, int storageOrder>
+typename SparseBlockMatrix<T, M, N, storageOrder>::CsrMatrix
+SparseBlockMatrix<T, M, N, storageOrder>::csrSnapshot() const
+{
+  using StorageIndex = typename CsrMatrix::StorageIndex;
+  CsrMatrix result(totalRows, totalCols);
+  // Applies f(row, col, value) to the entries of block row i, in global
+  // indices. For each row the columns come in increasing order, since the
+  // inner indices of the blocks are sorted.
+  auto const forEntries = [this](unsigned int i, auto &&f) {
+    for(unsigned int j = 0; j < N; ++j)
+      {
+        SpMat const &block = *theMatrices[i][j];
+        for(Index k = 0; k < block.outerSize(); ++k)
+          for(typename SpMat::InnerIterator it(block, k); it; ++it)
+            {
+              auto const row = transpose[i][j] ? it.col() : it.row();
+              auto const col = transpose[i][j] ? it.row() : it.col();
+              f(row + theRowOffset[i], col + theColOffset[j], it.value());
+            }
+      }
+  };
+  // counting sort on the rows
+  std::vector<Index> next(totalRows + 1, 0);
+  for(unsigned int i = 0; i < M; ++i)
+    forEntries(i, [&next](Index row, Index, T) { ++next[row + 1]; });
+  std::partial_sum(next.begin(), next.end(), next.begin());
+  result.resizeNonZeros(next.back());
+  for(Index r = 0; r <= totalRows; ++r)
+    result.outerIndexPtr()[r] = static_cast<StorageIndex>(next[r]);
+  for(unsigned int i = 0; i < M; ++i)
+    forEntries(i, [&next, &result](Index row, Index col, T value) {
+      auto const pos = next[row]++;
+      result.innerIndexPtr()[pos] = static_cast<StorageIndex>(col);
+      result.valuePtr()[pos] = value;
+    });
+  return result;
+}
+
 template <typename T, unsigned int M, unsigned int N, int storageOrder>
 inline typename SparseBlockMatrix<T, M, N, storageOrder>::SpMat
 SparseBlockMatrix<T, M, N, storageOrder>::fullMatrix() const
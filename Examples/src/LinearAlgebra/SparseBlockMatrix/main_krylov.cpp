@@ -0,0 +1,228 @@
+/*
+ * Benchmark of the product of a SparseBlockMatrix by a vector inside a
+ * Krylov loop.
+ *
+ * Usage:
+ *   main_krylov [T.mat] [iterations]
+ *   main_krylov M.mat B.mat T.mat [iterations]
+ *
+ * The matrix is the saddle point matrix
+ *   [M B^T]
+ *   [B  T ]
+ * with B^T stored as the transpose of B, as in SaddlePointMat. With a single
+ * file (by default ../MatrixData/blockMatrix/T.mat) T is read from the file
+ * and M and B are those of a mixed finite element discretization of the
+ * Darcy problem on a (periodic) lattice of cells with the size of T. Two
+ * larger lattices are then also tested.
+ *
+ * The loop is the Lanczos process, the kernel of MINRES, and we compare
+ *  - the product block by block as it was done before (a new vector for
+ *    each product, and transpose()*x for B^T)
+ *  - multiplyInto()
+ *  - the product with csrSnapshot()
+ *  - the product with fullMatrix() (column major)
+ */
+#include "SparseBlockMatrix.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unsupported/Eigen/SparseExtra>
+#include <vector>
+namespace
+{
+using BlockMatrix = apsc::SparseBlockMatrix<double, 2, 2>;
+using SpMat = BlockMatrix::SpMat;
+using Vector = BlockMatrix::ColVector;
+using Index = Eigen::Index;
+using Tri = Eigen::Triplet<double, Index>;
+
+//! The product as implemented before multiplyInto()
+Vector
+blockByBlock(BlockMatrix const &A, Vector const &x)
+{
+  Vector res = Vector::Zero(A.rows());
+  for(unsigned int i = 0; i < 2; ++i)
+    for(unsigned int j = 0; j < 2; ++j)
+      {
+        auto ncols = A.cols({i, j});
+        auto nrows = A.rows({i, j});
+        if(A.isTranspose({i, j}))
+          res.segment(A.rowOffset(i), nrows) +=
+            A.getBlock({i, j}).transpose() * x.segment(A.colOffset(j), ncols);
+        else
+          res.segment(A.rowOffset(i), nrows) +=
+            A.getBlock({i, j}) * x.segment(A.colOffset(j), ncols);
+      }
+  return res;
+}
+
+/*!
+ * The M and B blocks of the lowest order Raviart-Thomas discretization on a
+ * periodic lattice of n cells with w cells per row. Face 2c is the east face
+ * of cell c, face 2c+1 the north one.
+ */
+void
+darcyBlocks(Index n, SpMat &Mmat, SpMat &Bmat)
+{
+  auto const w = static_cast<Index>(std::ceil(std::sqrt(n)));
+  auto const wrap = [n](Index c) { return (c % n + n) % n; };
+  std::vector<Tri> m, b;
+  for(Index c = 0; c < n; ++c)
+    {
+      Index const east = 2 * c, north = 2 * c + 1;
+      Index const west = 2 * wrap(c - 1), south = 2 * wrap(c - w) + 1;
+      b.insert(b.end(), {{c, east, 1.}, {c, north, 1.}, {c, west, -1.},
+                         {c, south, -1.}});
+      m.insert(m.end(),
+               {{east, east, 2. / 3.}, {north, north, 2. / 3.},
+                {east, west, 1. / 6.}, {west, east, 1. / 6.},
+                {north, south, 1. / 6.}, {south, north, 1. / 6.}});
+    }
+  Mmat.resize(2 * n, 2 * n);
+  Mmat.setFromTriplets(m.begin(), m.end());
+  Bmat.resize(n, 2 * n);
+  Bmat.setFromTriplets(b.begin(), b.end());
+}
+
+BlockMatrix
+saddlePoint(SpMat Mmat, SpMat Bmat, SpMat Tmat)
+{
+  BlockMatrix A({Mmat.rows(), Bmat.rows()}, {Mmat.cols(), Bmat.rows()});
+  A.setBlock({0, 0}, std::move(Mmat));
+  A.setBlock({1, 0}, std::move(Bmat));
+  A.setBlock({1, 1}, std::move(Tmat));
+  A.addTranspose({0, 1}, {1, 0});
+  A.makeCompressed();
+  return A;
+}
+
+/*!
+ * Runs the Lanczos process for the given number of iterations, with
+ * apply(y,x) computing y=A*x.
+ * @return the time in ms
+ */
+template <class Apply>
+double
+lanczos(Index n, int iterations, Apply &&apply)
+{
+  Vector          v = Vector::Ones(n) / std::sqrt(double(n));
+  Vector          vOld = Vector::Zero(n);
+  Vector          w(n);
+  double          beta = 0.;
+  Timings::Chrono clock;
+  clock.start();
+  for(int k = 0; k < iterations; ++k)
+    {
+      apply(w, v);
+      w -= beta * vOld;
+      double const alpha = w.dot(v);
+      w -= alpha * v;
+      beta = w.norm();
+      vOld.swap(v);
+      v = w / beta;
+    }
+  clock.stop();
+  return clock.wallTime() * 1.e-3;
+}
+
+void
+benchmark(std::string const &name, BlockMatrix const &A, int iterations)
+{
+  Timings::Chrono clock;
+  clock.start();
+  auto const csr = A.csrSnapshot();
+  clock.stop();
+  double const tSnapshot = clock.wallTime() * 1.e-3;
+  clock.start();
+  SpMat const full = A.fullMatrix();
+  clock.stop();
+  double const tFull = clock.wallTime() * 1.e-3;
+
+  auto const n = A.rows();
+  double const tOld = lanczos(n, iterations, [&A](Vector &y, Vector const &x) {
+    y = blockByBlock(A, x);
+  });
+  double const tInto = lanczos(n, iterations,
+                               [&A](Vector &y, Vector const &x) {
+                                 A.multiplyInto(y, x);
+                               });
+  double const tCsr = lanczos(n, iterations,
+                              [&csr](Vector &y, Vector const &x) {
+                                y.noalias() = csr * x;
+                              });
+  double const tColMajor = lanczos(n, iterations,
+                                   [&full](Vector &y, Vector const &x) {
+                                     y.noalias() = full * x;
+                                   });
+
+  // The difference of a single product with respect to the old one
+  Vector const x = Vector::LinSpaced(n, -1., 1.);
+  Vector const reference = blockByBlock(A, x);
+  Vector       y;
+  A.multiplyInto(y, x);
+  double const diffInto = (y - reference).norm() / reference.norm();
+  y.noalias() = csr * x;
+  double const diffCsr = (y - reference).norm() / reference.norm();
+
+  std::cout << std::setw(10) << name << std::setw(9) << n << std::setw(10)
+            << A.nonZeros() << std::fixed << std::setprecision(3)
+            << std::setw(10) << tOld / iterations << std::setw(10)
+            << tInto / iterations << std::setw(10) << tCsr / iterations
+            << std::setw(10) << tColMajor / iterations << std::setw(10)
+            << std::setprecision(1) << tSnapshot << std::setw(10) << tFull
+            << std::scientific << std::setw(10) << std::max(diffInto, diffCsr)
+            << std::defaultfloat << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  int                      iterations = 200;
+  if(args.size() == 2u || args.size() == 4u)
+    {
+      iterations = std::stoi(args.back());
+      args.pop_back();
+    }
+  std::cout << "Time in ms per Lanczos iteration (" << iterations
+            << " iterations) and to build the merged matrices\n"
+            << "diff: relative difference of a product w.r.t. the old one\n"
+            << std::setw(10) << "matrix" << std::setw(9) << "rows"
+            << std::setw(10) << "nonzeros" << std::setw(10) << "old"
+            << std::setw(10) << "into" << std::setw(10) << "csr"
+            << std::setw(10) << "colmajor" << std::setw(10) << "snapshot"
+            << std::setw(10) << "full" << std::setw(10) << "diff" << '\n';
+  SpMat Mmat, Bmat, Tmat;
+  if(args.size() == 3u)
+    {
+      if(!Eigen::loadMarket(Mmat, args[0]) ||
+         !Eigen::loadMarket(Bmat, args[1]) ||
+         !Eigen::loadMarket(Tmat, args[2]))
+        {
+          std::cerr << "Cannot read the matrices\n";
+          return 1;
+        }
+      benchmark("files", saddlePoint(Mmat, Bmat, Tmat), iterations);
+      return 0;
+    }
+  std::string const fileT =
+    args.empty() ? "../MatrixData/blockMatrix/T.mat" : args[0];
+  if(!Eigen::loadMarket(Tmat, fileT))
+    {
+      std::cerr << "Cannot read " << fileT << '\n';
+      return 1;
+    }
+  darcyBlocks(Tmat.rows(), Mmat, Bmat);
+  benchmark("T.mat", saddlePoint(Mmat, Bmat, Tmat), iterations);
+  for(Index n : {Index(100000), Index(1000000)})
+    {
+      darcyBlocks(n, Mmat, Bmat);
+      Tmat.resize(n, n);
+      Tmat.setIdentity();
+      Tmat *= -1.e-3;
+      benchmark("lattice", saddlePoint(Mmat, Bmat, Tmat), iterations);
+    }
+}
@@ -0,0 +1,450 @@
+/*
+ * CompactMesh.cpp
+ *
+ *  A triangular mesh stored in flat arrays
+ */
+#include "CompactMesh.hpp"
+#include "MeshTria.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+namespace Fem
+{
+CompactMesh::CompactMesh(std::vector<double> x, std::vector<double> y,
+                         std::vector<Id> triangles)
+  : M_x(std::move(x)), M_y(std::move(y)), M_triangles(std::move(triangles))
+{
+  if(M_x.size() != M_y.size() || M_triangles.size() % 3u != 0u)
+    throw std::invalid_argument("CompactMesh: inconsistent sizes");
+  for(auto v : M_triangles)
+    if(v >= M_x.size())
+      throw std::invalid_argument("CompactMesh: vertex out of range");
+  M_pointBc.resize(num_points());
+  std::iota(M_pointBc.begin(), M_pointBc.end(), BcId{0});
+  M_elementBc.resize(num_elements());
+  std::iota(M_elementBc.begin(), M_elementBc.end(), BcId{0});
+  M_setOrientation();
+}
+
+CompactMesh::CompactMesh(MeshTria const &mesh)
+{
+  auto const np = mesh.num_points();
+  M_x.resize(np);
+  M_y.resize(np);
+  M_pointBc.resize(np);
+  for(size_type i = 0; i < np; ++i)
+    {
+      Point const &p = mesh.point(i);
+      M_x[i] = p[0];
+      M_y[i] = p[1];
+      M_pointBc[i] = p.bcId();
+    }
+  // Entities of a MeshTria refer to points in its list: the index of a point
+  // is its distance from the first one (more robust than relying on ids)
+  Point const *first = np > 0 ? &mesh.point(0) : nullptr;
+  auto index = [first](Point const &p) { return static_cast<Id>(&p - first); };
+  M_triangles.resize(3u * mesh.num_elements());
+  M_elementBc.resize(mesh.num_elements());
+  for(size_type e = 0; e < mesh.num_elements(); ++e)
+    {
+      Triangle const &t = mesh.element(e);
+      for(int k = 0; k < 3; ++k)
+        M_triangles[3u * e + k] = index(t[k]);
+      M_elementBc[e] = t.bcId();
+    }
+  auto copyEdges = [&index](size_type n, auto const &getEdge,
+                            std::vector<Id> &conn, std::vector<BcId> &bc) {
+    conn.resize(2u * n);
+    bc.resize(n);
+    for(size_type e = 0; e < n; ++e)
+      {
+        Edge const &ed = getEdge(e);
+        conn[2u * e] = index(ed[0]);
+        conn[2u * e + 1u] = index(ed[1]);
+        bc[e] = ed.bcId();
+      }
+  };
+  copyEdges(
+    mesh.num_edges(), [&mesh](size_type i) -> Edge const & { return mesh.edge(i); },
+    M_edges, M_edgeBc);
+  copyEdges(
+    mesh.num_bEdges(),
+    [&mesh](size_type i) -> Edge const & { return mesh.bEdge(i); }, M_bEdges,
+    M_bEdgeBc);
+}
+
+MeshTria
+CompactMesh::toMeshTria() const
+{
+  MeshTria    mesh;
+  MeshHandler handler(mesh);
+  auto       &points = handler.pointList;
+  // reserve is essential: entities store pointers to points
+  points.reserve(num_points());
+  for(size_type i = 0; i < num_points(); ++i)
+    {
+      points.emplace_back(M_x[i], M_y[i]);
+      points.back().id() = static_cast<Id>(i);
+      points.back().bcId() = M_pointBc[i];
+    }
+  handler.elementList.reserve(num_elements());
+  for(size_type e = 0; e < num_elements(); ++e)
+    {
+      handler.elementList.emplace_back(
+        points[M_triangles[3u * e]], points[M_triangles[3u * e + 1u]],
+        points[M_triangles[3u * e + 2u]], static_cast<Id>(e));
+      handler.elementList.back().bcId() = M_elementBc[e];
+    }
+  auto makeEdges = [&points](std::vector<Id> const   &conn,
+                             std::vector<BcId> const &bc,
+                             std::vector<Edge>       &list) {
+    list.reserve(bc.size());
+    for(size_type e = 0; e < bc.size(); ++e)
+      {
+        list.emplace_back(points[conn[2u * e]], points[conn[2u * e + 1u]]);
+        list.back().id() = static_cast<Id>(e);
+        list.back().bcId() = bc[e];
+      }
+  };
+  makeEdges(M_edges, M_edgeBc, handler.edgeList);
+  makeEdges(M_bEdges, M_bEdgeBc, handler.bEdgeList);
+  return mesh;
+}
+
+void
+CompactMesh::setEdges(std::vector<Id> edges)
+{
+  if(edges.size() % 2u != 0u)
+    throw std::invalid_argument("CompactMesh: odd size of edge array");
+  M_edges = std::move(edges);
+  M_edgeBc.resize(num_edges());
+  std::iota(M_edgeBc.begin(), M_edgeBc.end(), BcId{0});
+}
+
+void
+CompactMesh::setBoundaryEdges(std::vector<Id> bEdges)
+{
+  if(bEdges.size() % 2u != 0u)
+    throw std::invalid_argument("CompactMesh: odd size of edge array");
+  M_bEdges = std::move(bEdges);
+  M_bEdgeBc.resize(num_bEdges());
+  std::iota(M_bEdgeBc.begin(), M_bEdgeBc.end(), BcId{0});
+}
+
+void
+CompactMesh::buildEdges()
+{
+  // All sides as (min,max) pairs, sorted: a shared side appears twice
+  std::vector<std::pair<Id, Id>> sides;
+  sides.reserve(M_triangles.size());
+  for(size_type e = 0; e < num_elements(); ++e)
+    for(int k = 0; k < 3; ++k)
+      {
+        Id const a = vertex(e, k);
+        Id const b = vertex(e, (k + 1) % 3);
+        sides.emplace_back(std::min(a, b), std::max(a, b));
+      }
+  std::sort(sides.begin(), sides.end());
+  std::vector<Id> edges;
+  std::vector<Id> bEdges;
+  edges.reserve(sides.size());
+  for(size_type i = 0; i < sides.size();)
+    {
+      size_type j = i + 1;
+      while(j < sides.size() && sides[j] == sides[i])
+        ++j;
+      edges.insert(edges.end(), {sides[i].first, sides[i].second});
+      if(j - i == 1)
+        bEdges.insert(bEdges.end(), {sides[i].first, sides[i].second});
+      i = j;
+    }
+  setEdges(std::move(edges));
+  setBoundaryEdges(std::move(bEdges));
+}
+
+CompactMesh
+unitSquareMesh(std::size_t n)
+{
+  std::vector<double> x((n + 1) * (n + 1));
+  std::vector<double> y((n + 1) * (n + 1));
+  std::vector<Id>     t;
+  t.reserve(6 * n * n);
+  double const h = 1.0 / n;
+  for(std::size_t j = 0; j <= n; ++j)
+    for(std::size_t i = 0; i <= n; ++i)
+      {
+        x[j * (n + 1) + i] = i * h;
+        y[j * (n + 1) + i] = j * h;
+      }
+  for(std::size_t j = 0; j < n; ++j)
+    for(std::size_t i = 0; i < n; ++i)
+      {
+        Id const a = j * (n + 1) + i;
+        Id const b = a + 1;
+        Id const c = a + n + 1;
+        Id const d = c + 1;
+        t.insert(t.end(), {a, b, d, a, d, c});
+      }
+  return CompactMesh(std::move(x), std::move(y), std::move(t));
+}
+
+void
+CompactMesh::M_setOrientation()
+{
+  std::vector<double> areas(num_elements());
+  computeAreas(areas);
+  for(size_type e = 0; e < num_elements(); ++e)
+    if(areas[e] < 0.0)
+      std::swap(M_triangles[3u * e + 1u], M_triangles[3u * e + 2u]);
+}
+
+// The kernels below are written as simple loops over the elements, with
+// the arrays accessed through local pointers, so that the compiler can
+// vectorize them (coordinates are gathered through the connectivity).
+
+void
+CompactMesh::computeAreas(std::span<double> areas) const
+{
+  double const *x = M_x.data();
+  double const *y = M_y.data();
+  Id const     *t = M_triangles.data();
+  double       *a = areas.data();
+  auto const    n = num_elements();
+#pragma GCC ivdep
+  for(size_type e = 0; e < n; ++e)
+    {
+      Id const     i0 = t[3u * e];
+      Id const     i1 = t[3u * e + 1u];
+      Id const     i2 = t[3u * e + 2u];
+      double const x0 = x[i0];
+      double const y0 = y[i0];
+      a[e] = 0.5 * ((x[i1] - x0) * (y[i2] - y0) - (x[i2] - x0) * (y[i1] - y0));
+    }
+}
+
+void
+CompactMesh::computeJacobians(JacobianArrays &jac) const
+{
+  auto const n = num_elements();
+  jac.resize(n);
+  double const *x = M_x.data();
+  double const *y = M_y.data();
+  Id const     *t = M_triangles.data();
+  double       *j00 = jac.J00.data();
+  double       *j10 = jac.J10.data();
+  double       *j01 = jac.J01.data();
+  double       *j11 = jac.J11.data();
+  double       *det = jac.detJ.data();
+#pragma GCC ivdep
+  for(size_type e = 0; e < n; ++e)
+    {
+      Id const     i0 = t[3u * e];
+      Id const     i1 = t[3u * e + 1u];
+      Id const     i2 = t[3u * e + 2u];
+      double const a00 = x[i1] - x[i0];
+      double const a10 = y[i1] - y[i0];
+      double const a01 = x[i2] - x[i0];
+      double const a11 = y[i2] - y[i0];
+      j00[e] = a00;
+      j10[e] = a10;
+      j01[e] = a01;
+      j11[e] = a11;
+      det[e] = a00 * a11 - a10 * a01;
+    }
+}
+
+void
+CompactMesh::computeBarycenters(std::span<double> bx,
+                                std::span<double> by) const
+{
+  double const *x = M_x.data();
+  double const *y = M_y.data();
+  Id const     *t = M_triangles.data();
+  double       *cx = bx.data();
+  double       *cy = by.data();
+  auto const    n = num_elements();
+  double const  third = 1.0 / 3.0;
+#pragma GCC ivdep
+  for(size_type e = 0; e < n; ++e)
+    {
+      Id const i0 = t[3u * e];
+      Id const i1 = t[3u * e + 1u];
+      Id const i2 = t[3u * e + 2u];
+      cx[e] = third * (x[i0] + x[i1] + x[i2]);
+      cy[e] = third * (y[i0] + y[i1] + y[i2]);
+    }
+}
+
+void
+CompactMesh::computeEdgeLengths(std::span<double> lengths) const
+{
+  double const *x = M_x.data();
+  double const *y = M_y.data();
+  Id const     *t = M_edges.data();
+  double       *l = lengths.data();
+  auto const    n = num_edges();
+#pragma GCC ivdep
+  for(size_type e = 0; e < n; ++e)
+    {
+      double const dx = x[t[2u * e + 1u]] - x[t[2u * e]];
+      double const dy = y[t[2u * e + 1u]] - y[t[2u * e]];
+      l[e] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+double
+CompactMesh::measure() const
+{
+  // Twice the area is accumulated directly, without storing the areas
+  double const *x = M_x.data();
+  double const *y = M_y.data();
+  Id const     *t = M_triangles.data();
+  auto const    n = num_elements();
+  double        mes2 = 0.0;
+  for(size_type e = 0; e < n; ++e)
+    {
+      Id const     i0 = t[3u * e];
+      Id const     i1 = t[3u * e + 1u];
+      Id const     i2 = t[3u * e + 2u];
+      double const x0 = x[i0];
+      double const y0 = y[i0];
+      mes2 += (x[i1] - x0) * (y[i2] - y0) - (x[i2] - x0) * (y[i1] - y0);
+    }
+  return 0.5 * mes2;
+}
+
+Point
+TriangleView::operator[](int i) const
+{
+  Id const k = M_mesh->vertex(M_e, i);
+  Point    p(M_mesh->x()[k], M_mesh->y()[k]);
+  p.id() = k;
+  p.bcId() = M_mesh->pointMarkers()[k];
+  return p;
+}
+
+GeoPoint
+TriangleView::map(GeoPoint const &u) const
+{
+  auto const J = jacobian();
+  auto const p0 = M_coor(0);
+  return GeoPoint(p0[0] + J(0, 0) * u[0] + J(0, 1) * u[1],
+                  p0[1] + J(1, 0) * u[0] + J(1, 1) * u[1]);
+}
+
+GeoPoint
+TriangleView::invMap(GeoPoint const &x) const
+{
+  auto const iJ = invJac();
+  auto const p0 = M_coor(0);
+  GeoPoint   d(x[0] - p0[0], x[1] - p0[1]);
+  return GeoPoint(iJ(0, 0) * d[0] + iJ(0, 1) * d[1],
+                  iJ(1, 0) * d[0] + iJ(1, 1) * d[1]);
+}
+
+double
+TriangleView::measure() const
+{
+  auto const J = jacobian();
+  return 0.5 * (J(0, 0) * J(1, 1) - J(1, 0) * J(0, 1));
+}
+
+Eigen::Matrix<double, TriangleView::myDim, ndim>
+TriangleView::jacobian(double, double) const
+{
+  auto const p0 = M_coor(0);
+  auto const p1 = M_coor(1);
+  auto const p2 = M_coor(2);
+  Eigen::Matrix<double, myDim, ndim> J;
+  J << p1[0] - p0[0], p2[0] - p0[0], p1[1] - p0[1], p2[1] - p0[1];
+  return J;
+}
+
+Eigen::Matrix<double, TriangleView::myDim, ndim>
+TriangleView::invJac(double, double) const
+{
+  auto const   J = jacobian();
+  double const idet = 1. / (J(0, 0) * J(1, 1) - J(1, 0) * J(0, 1));
+  Eigen::Matrix<double, myDim, ndim> iJ;
+  iJ << idet * J(1, 1), -idet * J(0, 1), -idet * J(1, 0), idet * J(0, 0);
+  return iJ;
+}
+
+Eigen::Matrix<double, 3, 3>
+TriangleView::localMassMatrix() const
+{
+  double const area = this->measure();
+  double const diag(area / 6.0);
+  double const off(area / 12.0);
+  Eigen::Matrix<double, 3, 3> a;
+  a << diag, off, off, off, diag, off, off, off, diag;
+  return a;
+}
+
+Eigen::Matrix<double, 3, 3>
+TriangleView::localStiffMatrix() const
+{
+  // Same as Triangle::localStiffMatrix()
+  Eigen::Matrix<double, 3, 2> n;
+  std::array<std::array<double, 2>, 3> const p{M_coor(0), M_coor(1),
+                                               M_coor(2)};
+  double                      meas2 = 1 / (2.0 * this->measure());
+  for(int i = 0; i < 3; ++i)
+    {
+      int j = (i + 1) % 3;
+      int k = (j + 1) % 3;
+      n.row(i) << (-p[k][1] + p[j][1]), (p[k][0] - p[j][0]);
+    }
+  n *= meas2;
+  double                      off01 = n.row(0).dot(n.row(1));
+  double                      off02 = n.row(0).dot(n.row(2));
+  double                      off12 = n.row(1).dot(n.row(2));
+  Eigen::Matrix<double, 3, 3> s;
+  s << -(off01 + off02), off01, off02, off01, -(off01 + off12), off12, off02,
+    off12, -(off02 + off12);
+  return s;
+}
+
+Point
+EdgeView::operator[](int i) const
+{
+  Id const k = M_conn[2u * M_e + i];
+  Point    p(M_mesh->x()[k], M_mesh->y()[k]);
+  p.id() = k;
+  p.bcId() = M_mesh->pointMarkers()[k];
+  return p;
+}
+
+double
+EdgeView::measure() const
+{
+  GeoPoint d((*this)[1] - (*this)[0]);
+  return std::sqrt(d[0] * d[0] + d[1] * d[1]);
+}
+
+GeoPoint
+EdgeView::map(double const &t) const
+{
+  GeoPoint a = (*this)[0];
+  GeoPoint b = (*this)[1];
+  return GeoPoint(a * (1 - t) + b * t);
+}
+
+Eigen::Matrix<double, ndim, 1>
+EdgeView::jacobian(double const &) const
+{
+  GeoPoint d((*this)[1] - (*this)[0]);
+  return Eigen::Matrix<double, ndim, 1>(d[0], d[1]);
+}
+
+Point
+MeshTriaView::point(size_type i) const
+{
+  Point p(M_mesh->x()[i], M_mesh->y()[i]);
+  p.id() = static_cast<Id>(i);
+  p.bcId() = M_mesh->pointMarkers()[i];
+  return p;
+}
+} // namespace Fem
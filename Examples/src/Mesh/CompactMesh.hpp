@@ -0,0 +1,439 @@
+/*
+ * CompactMesh.hpp
+ *
+ *  A triangular mesh stored in flat arrays
+ */
+
+#ifndef COMPACTMESH_HPP_
+#define COMPACTMESH_HPP_
+#include "femMesh.hpp"
+#include <array>
+#include <span>
+#include <vector>
+namespace Fem
+{
+class MeshTria;
+
+//! The jacobians of the affine maps of all elements, by components
+/*!
+ * \f$J_{ij}=dx_i/du_j\f$ of element e is Jij[e]. Stored as separate arrays,
+ * so that loops over the elements access contiguous memory.
+ */
+struct JacobianArrays
+{
+  std::vector<double> J00;
+  std::vector<double> J10;
+  std::vector<double> J01;
+  std::vector<double> J11;
+  std::vector<double> detJ;
+  void
+  resize(std::size_t n)
+  {
+    for(auto *v : {&J00, &J10, &J01, &J11, &detJ})
+      v->resize(n);
+  }
+};
+
+//! A triangular mesh stored in a structure of arrays
+/*!
+ * Differently from MeshTria, where triangles and edges store pointers to
+ * points, here coordinates are kept in two flat arrays and the connectivity
+ * is given by integer indices (three consecutive ones for each triangle, two
+ * for each edge).
+ *
+ * Advantages:
+ * \li the mesh is a regular value: it can be copied, moved or written to a
+ * file as it is, with no pointer to fix;
+ * \li a loop over the elements reads 12 bytes of connectivity and the
+ * needed coordinates, instead of a large object and three pointers to
+ * chase, so bulk computations (areas, jacobians, barycenters) are much more
+ * cache friendly and may be vectorized by the compiler.
+ *
+ * The price is that a triangle is no more an object. The interface of
+ * MeshTria is recovered with MeshTriaView, and a MeshTria may be created
+ * with toMeshTria() when needed.
+ *
+ * As in MeshTria, triangles are positively oriented: the constructor swaps
+ * the last two vertices of triangles with negative area.
+ */
+class CompactMesh
+{
+public:
+  using size_type = std::size_t;
+  CompactMesh() = default;
+  /*!
+   * Builds the mesh from coordinates and connectivity.
+   *
+   * Markers are set to the identifier of the entity, as in MeshTria.
+   *
+   * @param x The x coordinates of the points
+   * @param y The y coordinates of the points
+   * @param triangles The vertices of each triangle (three per triangle)
+   * @throws std::invalid_argument if sizes are inconsistent
+   */
+  CompactMesh(std::vector<double> x, std::vector<double> y,
+              std::vector<Id> triangles);
+  //! Converts a MeshTria
+  explicit CompactMesh(MeshTria const &mesh);
+  //! Creates a MeshTria with the same entities and markers
+  MeshTria toMeshTria() const;
+  /*!
+   * Sets the edges
+   * @param edges The end points of each edge (two per edge)
+   */
+  void setEdges(std::vector<Id> edges);
+  /*!
+   * Sets the boundary edges
+   * @param bEdges The end points of each boundary edge (two per edge)
+   */
+  void setBoundaryEdges(std::vector<Id> bEdges);
+  /*!
+   * Builds the list of edges from the triangles. Edges shared by one
+   * triangle only are also stored as boundary edges.
+   */
+  void buildEdges();
+
+  /*!\defgroup Sizes Number of entities
+    @{
+  */
+  size_type
+  num_points() const
+  {
+    return M_x.size();
+  }
+  size_type
+  num_elements() const
+  {
+    return M_triangles.size() / 3u;
+  }
+  size_type
+  num_edges() const
+  {
+    return M_edges.size() / 2u;
+  }
+  size_type
+  num_bEdges() const
+  {
+    return M_bEdges.size() / 2u;
+  }
+  /*!@}*/
+
+  /*!\defgroup RawData Access to the arrays
+    @{
+  */
+  std::span<double const>
+  x() const
+  {
+    return M_x;
+  }
+  std::span<double const>
+  y() const
+  {
+    return M_y;
+  }
+  //! The vertices of the triangles (three per triangle)
+  std::span<Id const>
+  triangles() const
+  {
+    return M_triangles;
+  }
+  //! The end points of the edges (two per edge)
+  std::span<Id const>
+  edges() const
+  {
+    return M_edges;
+  }
+  //! The end points of the boundary edges (two per edge)
+  std::span<Id const>
+  bEdges() const
+  {
+    return M_bEdges;
+  }
+  std::vector<BcId> &
+  pointMarkers()
+  {
+    return M_pointBc;
+  }
+  std::vector<BcId> const &
+  pointMarkers() const
+  {
+    return M_pointBc;
+  }
+  std::vector<BcId> &
+  elementMarkers()
+  {
+    return M_elementBc;
+  }
+  std::vector<BcId> const &
+  elementMarkers() const
+  {
+    return M_elementBc;
+  }
+  std::vector<BcId> &
+  edgeMarkers()
+  {
+    return M_edgeBc;
+  }
+  std::vector<BcId> const &
+  edgeMarkers() const
+  {
+    return M_edgeBc;
+  }
+  std::vector<BcId> &
+  bEdgeMarkers()
+  {
+    return M_bEdgeBc;
+  }
+  std::vector<BcId> const &
+  bEdgeMarkers() const
+  {
+    return M_bEdgeBc;
+  }
+  //! The k-th vertex of triangle e
+  Id
+  vertex(size_type e, int k) const
+  {
+    return M_triangles[3u * e + k];
+  }
+  /*!@}*/
+
+  /*!\defgroup Kernels Geometric quantities of all entities
+    The output spans must have the size of the number of entities.
+    @{
+  */
+  //! Areas of the triangles
+  void computeAreas(std::span<double> areas) const;
+  //! Jacobians of the maps from the reference triangle
+  void computeJacobians(JacobianArrays &jac) const;
+  //! Barycenters of the triangles
+  void computeBarycenters(std::span<double> bx, std::span<double> by) const;
+  //! Lengths of the edges
+  void computeEdgeLengths(std::span<double> lengths) const;
+  //! Measure of the domain
+  double measure() const;
+  /*!@}*/
+
+private:
+  //! Makes all triangles positively oriented
+  void M_setOrientation();
+  std::vector<double> M_x;
+  std::vector<double> M_y;
+  std::vector<Id>     M_triangles;
+  std::vector<Id>     M_edges;
+  std::vector<Id>     M_bEdges;
+  std::vector<BcId>   M_pointBc;
+  std::vector<BcId>   M_elementBc;
+  std::vector<BcId>   M_edgeBc;
+  std::vector<BcId>   M_bEdgeBc;
+};
+
+/*!
+ * A structured mesh of the unit square: n x n squares, each split in two
+ * triangles. Useful for tests and benchmarks.
+ */
+CompactMesh unitSquareMesh(std::size_t n);
+
+//! A triangle of a CompactMesh, with (part of) the interface of Triangle
+class TriangleView
+{
+public:
+  static const int numVertices = 3;
+  static const int numSides = 3;
+  static const int myDim = 2;
+  TriangleView(CompactMesh const &mesh, std::size_t e) : M_mesh(&mesh), M_e(e)
+  {}
+  //! The i-th vertex
+  Point operator[](int i) const;
+  Id
+  id() const
+  {
+    return static_cast<Id>(M_e);
+  }
+  BcId
+  bcId() const
+  {
+    return M_mesh->elementMarkers()[M_e];
+  }
+  //! The point on an edge
+  Point
+  edgePoint(int edgenum, int endnum) const
+  {
+    return (*this)[Geometry::Triangle<Point>::edge(edgenum, endnum)];
+  }
+  //! Return x=T(u,v)
+  GeoPoint map(GeoPoint const &u) const;
+  //! Return \f$(u,v) = T^{-1}(x)$
+  GeoPoint invMap(GeoPoint const &x) const;
+  //! The area
+  double measure() const;
+  //! \f$J=dx/d(u,v)\f$
+  Eigen::Matrix<double, myDim, ndim> jacobian(double u = 0,
+                                              double v = 0) const;
+  //! \f$(d(xy)/d(uv))^{-1}\f$
+  Eigen::Matrix<double, myDim, ndim> invJac(double u = 0, double v = 0) const;
+  bool
+  empty() const
+  {
+    return false;
+  }
+  //! Triangles in a CompactMesh are positively oriented
+  bool
+  orientation() const
+  {
+    return true;
+  }
+  //! Mass Matrix (unitary density)
+  Eigen::Matrix<double, 3, 3> localMassMatrix() const;
+  //! Stiffness matrix (unitary diffusivity)
+  Eigen::Matrix<double, 3, 3> localStiffMatrix() const;
+
+private:
+  //! Coordinates of the i-th vertex, without building a Point
+  std::array<double, 2>
+  M_coor(int i) const
+  {
+    Id const k = M_mesh->vertex(M_e, i);
+    return {M_mesh->x()[k], M_mesh->y()[k]};
+  }
+  CompactMesh const *M_mesh;
+  std::size_t        M_e;
+};
+
+//! An edge of a CompactMesh, with the interface of Edge
+class EdgeView
+{
+public:
+  static const int numVertices = 2;
+  static const int numSides = 1;
+  static const int myDim = 1;
+  /*!
+   * @param mesh The mesh
+   * @param connectivity The array of end points (edges or boundary edges)
+   * @param markers The markers of the edges
+   * @param e The edge number
+   */
+  EdgeView(CompactMesh const &mesh, std::span<Id const> connectivity,
+           std::vector<BcId> const &markers, std::size_t e)
+    : M_mesh(&mesh), M_conn(connectivity), M_markers(&markers), M_e(e)
+  {}
+  //! The i-th end point
+  Point operator[](int i) const;
+  Id
+  id() const
+  {
+    return static_cast<Id>(M_e);
+  }
+  BcId
+  bcId() const
+  {
+    return (*M_markers)[M_e];
+  }
+  //! Edge Length
+  double measure() const;
+  //! Returns x=x(t)
+  GeoPoint map(double const &t) const;
+  //! dx/dt
+  Eigen::Matrix<double, ndim, 1> jacobian(double const &) const;
+  bool
+  empty() const
+  {
+    return false;
+  }
+
+private:
+  CompactMesh const       *M_mesh;
+  std::span<Id const>      M_conn;
+  std::vector<BcId> const *M_markers;
+  std::size_t              M_e;
+};
+
+//! The interface of MeshTria over a CompactMesh
+/*!
+ * Points, elements and edges are returned by value, as light objects
+ * computing what is asked on the fly from the arrays of the CompactMesh.
+ * Code written for MeshTria that only uses its (const) public interface
+ * may work unchanged with a view, for instance if it is a template on the
+ * mesh type.
+ *
+ * The view does not own the mesh, which must outlive it.
+ */
+class MeshTriaView
+{
+public:
+  using size_type = std::size_t;
+  explicit MeshTriaView(CompactMesh const &mesh) : M_mesh(&mesh) {}
+  size_type
+  num_points() const
+  {
+    return M_mesh->num_points();
+  }
+  //! ith point
+  Point point(size_type i) const;
+  size_type
+  num_elements() const
+  {
+    return M_mesh->num_elements();
+  }
+  //! ith element
+  TriangleView
+  element(size_type i) const
+  {
+    return TriangleView(*M_mesh, i);
+  }
+  //! ith element with specific name
+  TriangleView
+  triangle(size_type i) const
+  {
+    return TriangleView(*M_mesh, i);
+  }
+  size_type
+  num_edges() const
+  {
+    return M_mesh->num_edges();
+  }
+  //! ith Edge
+  EdgeView
+  edge(size_type i) const
+  {
+    return EdgeView(*M_mesh, M_mesh->edges(), M_mesh->edgeMarkers(), i);
+  }
+  bool
+  has_Edges() const
+  {
+    return M_mesh->num_edges() > 0u;
+  }
+  size_type
+  num_bEdges() const
+  {
+    return M_mesh->num_bEdges();
+  }
+  //! ith boundary edge
+  EdgeView
+  bEdge(size_type i) const
+  {
+    return EdgeView(*M_mesh, M_mesh->bEdges(), M_mesh->bEdgeMarkers(), i);
+  }
+  bool
+  has_bEdges() const
+  {
+    return M_mesh->num_bEdges() > 0u;
+  }
+  //! measure of the domain
+  double
+  measure() const
+  {
+    return M_mesh->measure();
+  }
+  //! The underlying mesh
+  CompactMesh const &
+  mesh() const
+  {
+    return *M_mesh;
+  }
+
+private:
+  CompactMesh const *M_mesh;
+};
+} // namespace Fem
+
+#endif /* COMPACTMESH_HPP_ */
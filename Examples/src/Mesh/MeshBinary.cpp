@@ -0,0 +1,269 @@
+/*
+ * MeshBinary.cpp
+ *
+ *  A binary format for triangular meshes that can be memory mapped
+ */
+#include "MeshBinary.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+namespace Fem
+{
+static_assert(sizeof(Id) == sizeof(std::uint32_t) &&
+                sizeof(BcId) == sizeof(std::uint32_t),
+              "The binary mesh format stores identifiers as 32 bit integers");
+namespace
+{
+  //! Alignment of the arrays in the file
+  constexpr std::uint64_t sectionAlignment = 64u;
+  constexpr std::uint64_t
+  alignUp(std::uint64_t n)
+  {
+    return (n + sectionAlignment - 1u) / sectionAlignment * sectionAlignment;
+  }
+} // namespace
+
+void
+writeBinaryMesh(CompactMesh const &mesh, std::string const &fileName)
+{
+  using H = BinaryMeshHeader;
+  H header;
+  header.numPoints = mesh.num_points();
+  header.numElements = mesh.num_elements();
+  header.numEdges = mesh.num_edges();
+  header.numBEdges = mesh.num_bEdges();
+  // The data of each section and its size
+  std::array<std::pair<void const *, std::uint64_t>, H::NumSections> data;
+  auto set = [&data](H::Section s, auto const &range) {
+    data[s] = {range.data(), range.size() * sizeof(*range.data())};
+  };
+  set(H::X, mesh.x());
+  set(H::Y, mesh.y());
+  set(H::PointBc, mesh.pointMarkers());
+  set(H::Triangles, mesh.triangles());
+  set(H::ElementBc, mesh.elementMarkers());
+  set(H::Edges, mesh.edges());
+  set(H::EdgeBc, mesh.edgeMarkers());
+  set(H::BEdges, mesh.bEdges());
+  set(H::BEdgeBc, mesh.bEdgeMarkers());
+  std::uint64_t position = alignUp(sizeof(H));
+  for(unsigned s = 0; s < H::NumSections; ++s)
+    {
+      header.offset[s] = position;
+      header.bytes[s] = data[s].second;
+      position = alignUp(position + data[s].second);
+    }
+
+  std::ofstream file(fileName, std::ios::binary);
+  if(!file)
+    throw std::runtime_error("Cannot open binary mesh file " + fileName);
+  char const padding[sectionAlignment] = {};
+  file.write(reinterpret_cast<char const *>(&header), sizeof(H));
+  position = sizeof(H);
+  for(unsigned s = 0; s < H::NumSections; ++s)
+    {
+      file.write(padding, header.offset[s] - position);
+      file.write(static_cast<char const *>(data[s].first), data[s].second);
+      position = header.offset[s] + data[s].second;
+    }
+  if(!file)
+    throw std::runtime_error("Error while writing binary mesh file " +
+                             fileName);
+}
+
+void
+writeBinaryMesh(MeshTria const &mesh, std::string const &fileName)
+{
+  writeBinaryMesh(CompactMesh(mesh), fileName);
+}
+
+MappedMesh::MappedMesh(std::string const &fileName)
+{
+  int const fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error("Cannot open binary mesh file " + fileName);
+  struct stat st;
+  if(::fstat(fd, &st) != 0 ||
+     static_cast<std::size_t>(st.st_size) < sizeof(BinaryMeshHeader))
+    {
+      ::close(fd);
+      throw std::runtime_error("Not a binary mesh file: " + fileName);
+    }
+  M_length = st.st_size;
+  M_address = ::mmap(nullptr, M_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after closing the file
+  ::close(fd);
+  if(M_address == MAP_FAILED)
+    {
+      M_address = nullptr;
+      throw std::runtime_error("Cannot map binary mesh file " + fileName);
+    }
+  auto const &h = header();
+  std::string error;
+  if(h.magic != BinaryMeshHeader::magicString)
+    error = "Not a binary mesh file: ";
+  else if(h.byteOrder != BinaryMeshHeader::byteOrderMark)
+    error = "Binary mesh written with a different byte order: ";
+  else if(h.version != BinaryMeshHeader::currentVersion)
+    error = "Unsupported version of binary mesh file: ";
+  else
+    {
+      // Written so that no sum or product can overflow, whatever the header
+      // contains
+      for(unsigned s = 0; s < BinaryMeshHeader::NumSections; ++s)
+        if(h.offset[s] > M_length || h.bytes[s] > M_length - h.offset[s] ||
+           h.offset[s] % sizeof(double) != 0u)
+          error = "Truncated binary mesh file: ";
+      // The size of each section must match the counts of the header
+      auto matches = [&h](BinaryMeshHeader::Section s, std::uint64_t count,
+                          std::uint64_t entrySize) {
+        return h.bytes[s] % entrySize == 0u && h.bytes[s] / entrySize == count;
+      };
+      using H = BinaryMeshHeader;
+      if(error.empty() &&
+         !(matches(H::X, h.numPoints, sizeof(double)) &&
+           matches(H::Y, h.numPoints, sizeof(double)) &&
+           matches(H::PointBc, h.numPoints, sizeof(BcId)) &&
+           matches(H::Triangles, h.numElements, 3u * sizeof(Id)) &&
+           matches(H::ElementBc, h.numElements, sizeof(BcId)) &&
+           matches(H::Edges, h.numEdges, 2u * sizeof(Id)) &&
+           matches(H::EdgeBc, h.numEdges, sizeof(BcId)) &&
+           matches(H::BEdges, h.numBEdges, 2u * sizeof(Id)) &&
+           matches(H::BEdgeBc, h.numBEdges, sizeof(BcId))))
+        error = "Inconsistent binary mesh file: ";
+    }
+  if(!error.empty())
+    {
+      ::munmap(M_address, M_length);
+      M_address = nullptr;
+      throw std::runtime_error(error + fileName);
+    }
+  // We will read the whole file sequentially
+  ::madvise(M_address, M_length, MADV_SEQUENTIAL);
+}
+
+MappedMesh::MappedMesh(MappedMesh &&other) noexcept
+  : M_address(std::exchange(other.M_address, nullptr)),
+    M_length(std::exchange(other.M_length, 0u))
+{}
+
+MappedMesh &
+MappedMesh::operator=(MappedMesh &&other) noexcept
+{
+  if(this != &other)
+    {
+      if(M_address)
+        ::munmap(M_address, M_length);
+      M_address = std::exchange(other.M_address, nullptr);
+      M_length = std::exchange(other.M_length, 0u);
+    }
+  return *this;
+}
+
+MappedMesh::~MappedMesh()
+{
+  if(M_address)
+    ::munmap(M_address, M_length);
+}
+
+CompactMesh
+MappedMesh::toCompactMesh() const
+{
+  auto toVector = [](auto const &s) {
+    return std::vector<std::remove_const_t<
+      typename std::remove_reference_t<decltype(s)>::element_type>>(s.begin(),
+                                                                    s.end());
+  };
+  CompactMesh mesh(toVector(x()), toVector(y()), toVector(triangles()));
+  mesh.setEdges(toVector(edges()));
+  mesh.setBoundaryEdges(toVector(bEdges()));
+  mesh.pointMarkers() = toVector(pointMarkers());
+  mesh.elementMarkers() = toVector(elementMarkers());
+  mesh.edgeMarkers() = toVector(edgeMarkers());
+  mesh.bEdgeMarkers() = toVector(bEdgeMarkers());
+  return mesh;
+}
+
+int
+MeshReadBinary::read(MeshTria &m, std::string const &filename)
+{
+  MappedMesh mapped;
+  try
+    {
+      mapped = MappedMesh(filename);
+    }
+  catch(std::runtime_error &e)
+    {
+      // the file is missing, or its header is not valid
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  if(M_verbose)
+    std::clog << "Num points " << mapped.num_points() << " Num elements "
+              << mapped.num_elements() << std::endl;
+  // The sizes are checked by MappedMesh, the content of the connectivity
+  // arrays is checked here, before it is used as index
+  auto const numPoints = mapped.num_points();
+  auto validIds = [numPoints](std::span<Id const> conn) {
+    return std::all_of(conn.begin(), conn.end(),
+                       [numPoints](Id i) { return i < numPoints; });
+  };
+  if(!validIds(mapped.triangles()))
+    {
+      std::cerr << "FILE ERROR! Element with a wrong point in " << filename
+                << std::endl;
+      return 5;
+    }
+  if(!validIds(mapped.edges()) || !validIds(mapped.bEdges()))
+    {
+      std::cerr << "FILE ERROR! Edge with a wrong point in " << filename
+                << std::endl;
+      return 6;
+    }
+  MeshHandler mesh(m);
+  auto       &pl = mesh.pointList;
+  auto const  x = mapped.x();
+  auto const  y = mapped.y();
+  auto const  pBc = mapped.pointMarkers();
+  pl.clear();
+  pl.reserve(numPoints);
+  for(std::size_t i = 0; i < numPoints; ++i)
+    {
+      pl.emplace_back(x[i], y[i]);
+      pl.back().id() = static_cast<Id>(i);
+      pl.back().bcId() = pBc[i];
+    }
+  auto const t = mapped.triangles();
+  auto const eBc = mapped.elementMarkers();
+  mesh.elementList.clear();
+  mesh.elementList.reserve(mapped.num_elements());
+  for(std::size_t e = 0; e < mapped.num_elements(); ++e)
+    {
+      mesh.elementList.emplace_back(pl[t[3u * e]], pl[t[3u * e + 1u]],
+                                    pl[t[3u * e + 2u]], static_cast<Id>(e));
+      mesh.elementList.back().bcId() = eBc[e];
+    }
+  auto readEdges = [&pl](std::span<Id const> conn, std::span<BcId const> bc,
+                         std::vector<Edge> &list) {
+    list.clear();
+    list.reserve(bc.size());
+    for(std::size_t e = 0; e < bc.size(); ++e)
+      {
+        list.emplace_back(pl[conn[2u * e]], pl[conn[2u * e + 1u]]);
+        list.back().id() = static_cast<Id>(e);
+        list.back().bcId() = bc[e];
+      }
+  };
+  readEdges(mapped.edges(), mapped.edgeMarkers(), mesh.edgeList);
+  readEdges(mapped.bEdges(), mapped.bEdgeMarkers(), mesh.bEdgeList);
+  return 0;
+}
+} // namespace Fem
@@ -0,0 +1,220 @@
+/*
+ * MeshBinary.hpp
+ *
+ *  A binary format for triangular meshes that can be memory mapped
+ */
+
+#ifndef MESHBINARY_HPP_
+#define MESHBINARY_HPP_
+#include "CompactMesh.hpp"
+#include "MeshTria.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+namespace Fem
+{
+/*!
+ * \defgroup BinaryMesh A binary mesh format
+ *
+ * The file is made of a header followed by the arrays of a CompactMesh,
+ * each one starting at an offset multiple of 64 bytes:
+ *
+ * | array       | type          | size            |
+ * |-------------|---------------|-----------------|
+ * | x, y        | double        | num_points      |
+ * | point bc    | std::uint32_t | num_points      |
+ * | triangles   | std::uint32_t | 3*num_elements  |
+ * | element bc  | std::uint32_t | num_elements    |
+ * | edges       | std::uint32_t | 2*num_edges     |
+ * | edge bc     | std::uint32_t | num_edges       |
+ * | bEdges      | std::uint32_t | 2*num_bEdges    |
+ * | bEdge bc    | std::uint32_t | num_bEdges      |
+ *
+ * Data is stored in the native byte order; the header contains a marker to
+ * detect files written on a machine with a different one. Since the layout
+ * of the file is the layout of the arrays in memory, a mesh can be used
+ * directly from the memory mapped file (see MappedMesh), with no parsing.
+ * @{
+ */
+//! The header of a binary mesh file
+struct BinaryMeshHeader
+{
+  //! Identifies the file type
+  static constexpr std::array<char, 8> magicString{'P', 'A', 'C', 'S',
+                                                   'M', 'E', 'S', 'H'};
+  //! Current version of the format
+  static constexpr std::uint32_t currentVersion = 1u;
+  //! To detect a different byte order
+  static constexpr std::uint32_t byteOrderMark = 0x01020304u;
+  //! The arrays stored in the file, in the order given by this enum
+  enum Section : unsigned
+  {
+    X = 0,
+    Y,
+    PointBc,
+    Triangles,
+    ElementBc,
+    Edges,
+    EdgeBc,
+    BEdges,
+    BEdgeBc,
+    NumSections
+  };
+  std::array<char, 8> magic = magicString;
+  std::uint32_t       version = currentVersion;
+  std::uint32_t       byteOrder = byteOrderMark;
+  std::uint64_t       numPoints = 0u;
+  std::uint64_t       numElements = 0u;
+  std::uint64_t       numEdges = 0u;
+  std::uint64_t       numBEdges = 0u;
+  //! Offset in bytes of each array from the beginning of the file
+  std::array<std::uint64_t, NumSections> offset{};
+  //! Size in bytes of each array
+  std::array<std::uint64_t, NumSections> bytes{};
+};
+
+/*!
+ * Writes a mesh in binary format
+ * @param mesh The mesh
+ * @param fileName The file name
+ * @throws std::runtime_error if the file cannot be written
+ */
+void writeBinaryMesh(CompactMesh const &mesh, std::string const &fileName);
+//! Writes a MeshTria in binary format
+void writeBinaryMesh(MeshTria const &mesh, std::string const &fileName);
+
+//! A binary mesh file mapped in memory
+/*!
+ * The file is mapped read-only with mmap. Coordinates, connectivity and
+ * markers are accessed in place, as spans pointing into the mapped memory:
+ * opening a mesh costs (almost) nothing, pages are loaded from disk by the
+ * operating system when first accessed.
+ *
+ * The interface mirrors the raw data access of CompactMesh. The object is
+ * movable but not copyable, the mapping is released by the destructor.
+ */
+class MappedMesh
+{
+public:
+  using size_type = std::size_t;
+  MappedMesh() = default;
+  /*!
+   * Maps a file
+   * @param fileName The file name
+   * @throws std::runtime_error if the file cannot be mapped or it is not a
+   * valid binary mesh
+   */
+  explicit MappedMesh(std::string const &fileName);
+  MappedMesh(MappedMesh const &) = delete;
+  MappedMesh &operator=(MappedMesh const &) = delete;
+  MappedMesh(MappedMesh &&other) noexcept;
+  MappedMesh &operator=(MappedMesh &&other) noexcept;
+  ~MappedMesh();
+  //! The file header
+  BinaryMeshHeader const &
+  header() const
+  {
+    return *static_cast<BinaryMeshHeader const *>(M_address);
+  }
+  size_type
+  num_points() const
+  {
+    return header().numPoints;
+  }
+  size_type
+  num_elements() const
+  {
+    return header().numElements;
+  }
+  size_type
+  num_edges() const
+  {
+    return header().numEdges;
+  }
+  size_type
+  num_bEdges() const
+  {
+    return header().numBEdges;
+  }
+  std::span<double const>
+  x() const
+  {
+    return section<double>(BinaryMeshHeader::X);
+  }
+  std::span<double const>
+  y() const
+  {
+    return section<double>(BinaryMeshHeader::Y);
+  }
+  std::span<Id const>
+  triangles() const
+  {
+    return section<Id>(BinaryMeshHeader::Triangles);
+  }
+  std::span<Id const>
+  edges() const
+  {
+    return section<Id>(BinaryMeshHeader::Edges);
+  }
+  std::span<Id const>
+  bEdges() const
+  {
+    return section<Id>(BinaryMeshHeader::BEdges);
+  }
+  std::span<BcId const>
+  pointMarkers() const
+  {
+    return section<BcId>(BinaryMeshHeader::PointBc);
+  }
+  std::span<BcId const>
+  elementMarkers() const
+  {
+    return section<BcId>(BinaryMeshHeader::ElementBc);
+  }
+  std::span<BcId const>
+  edgeMarkers() const
+  {
+    return section<BcId>(BinaryMeshHeader::EdgeBc);
+  }
+  std::span<BcId const>
+  bEdgeMarkers() const
+  {
+    return section<BcId>(BinaryMeshHeader::BEdgeBc);
+  }
+  //! Copies the data into a CompactMesh
+  CompactMesh toCompactMesh() const;
+
+private:
+  template <class T>
+  std::span<T const>
+  section(BinaryMeshHeader::Section s) const
+  {
+    auto const &h = header();
+    return {reinterpret_cast<T const *>(static_cast<char const *>(M_address) +
+                                        h.offset[s]),
+            h.bytes[s] / sizeof(T)};
+  }
+  void       *M_address = nullptr;
+  std::size_t M_length = 0u;
+};
+
+//! Reads a binary mesh into a MeshTria
+class MeshReadBinary : public Fem::MeshReader
+{
+public:
+  MeshReadBinary(bool verbose = false) : MeshReader(verbose){};
+  /*!
+   * Errors are reported on std::cerr and by the returned value, with the
+   * codes of the other readers:
+   * - 0 success
+   * - 1 the file is missing or it is not a valid binary mesh
+   * - 5 an element refers to a non existing point
+   * - 6 an edge refers to a non existing point
+   */
+  int read(MeshTria &m, std::string const &filename) override;
+};
+/*!@}*/
+} // namespace Fem
+
+#endif /* MESHBINARY_HPP_ */
@@ -1,6 +1,7 @@
 #ifndef __HH_MESHREADERFACTORY_HH
 #define __HH_MESHREADERFACTORY_HH
 #include "Factory.hpp"
+#include "MeshBinary.hpp"
 #include "MeshReaders.hpp"
 #include <string>
 namespace Fem
@@ -8,20 +9,26 @@ namespace Fem
 using MeshReaderFactory = GenericFactory::Factory<MeshReader, std::string>;
 //! Get the factory of mesh readers
 /*
-  To be called only once in the program.
+  The readers are registered at the first call.
  */
-MeshReaderFactory const &
+inline MeshReaderFactory const &
 getMeshReaderFactory()
 {
-  MeshReaderFactory &mRF(MeshReaderFactory::instance());
-  mRF.add(
-    "Simple",
-    auto []() { return std::unique_ptr<MeshReader>(new MeshReadSimple); });
-  mRF.add(
-    "Triangle",
-    auto []() { return std::unique_ptr<MeshReader>(new MeshReadTriangle); });
-  mRF.add(
-    "Dummy", auto []() { return std::unique_ptr<MeshReader>(new DummyMesh); });
+  static MeshReaderFactory &mRF = []() -> MeshReaderFactory & {
+    MeshReaderFactory &f(MeshReaderFactory::Instance());
+    f.add("Simple",
+          []() { return std::unique_ptr<MeshReader>(new MeshReadSimple); });
+    f.add("Triangle",
+          []() { return std::unique_ptr<MeshReader>(new MeshReadTriangle); });
+    f.add("TriangleParallel", []() {
+      return std::unique_ptr<MeshReader>(new MeshReadTriangleParallel);
+    });
+    f.add("Binary",
+          []() { return std::unique_ptr<MeshReader>(new MeshReadBinary); });
+    f.add("Dummy",
+          []() { return std::unique_ptr<MeshReader>(new DummyMesh); });
+    return f;
+  }();
   return mRF;
 }
 } // namespace Fem
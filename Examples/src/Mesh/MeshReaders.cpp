@@ -5,9 +5,16 @@
  *      Author: forma
  */
 #include "MeshReaders.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 namespace
 {
 //! An helper function
@@ -21,6 +28,176 @@ skipInput(std::istream &f, std::string s)
     }
   while((currLine.find(s) == std::string::npos) && !f.eof());
 }
+
+//! Reads a whole file in a string. Returns false if the file does not exist
+bool
+loadFile(std::string const &fileName, std::string &buffer)
+{
+  std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+  if(!f)
+    return false;
+  buffer.resize(f.tellg());
+  f.seekg(0);
+  f.read(buffer.data(), buffer.size());
+  return !f.fail();
+}
+
+//! Extracts numbers from a line of text
+class LineParser
+{
+public:
+  LineParser(char const *begin, char const *end) : M_pos(begin), M_end(end)
+  {}
+  //! Reads the next number, returns false if not possible
+  template <class T>
+  bool
+  next(T &value)
+  {
+    while(M_pos != M_end && (*M_pos == ' ' || *M_pos == '\t' || *M_pos == '\r'))
+      ++M_pos;
+    auto [ptr, ec] = std::from_chars(M_pos, M_end, value);
+    M_pos = ptr;
+    return ec == std::errc();
+  }
+  //! True if the line is empty or a comment
+  bool
+  blank() const
+  {
+    auto p = M_pos;
+    while(p != M_end && (*p == ' ' || *p == '\t' || *p == '\r'))
+      ++p;
+    return p == M_end || *p == '#';
+  }
+
+private:
+  char const *M_pos;
+  char const *M_end;
+};
+
+//! The header line of a Triangle file and the position of the data
+struct TriangleFile
+{
+  std::string         buffer;
+  std::array<int, 4>  header{0, 0, 0, 0};
+  char const         *data = nullptr;
+  int                 base = 1; // numbering of the first entity
+};
+
+//! The outcome of openTriangleFile()
+enum class OpenStatus
+{
+  ok,
+  missing,  //!< The file cannot be read
+  corrupted //!< The header, or the first data line, is not valid
+};
+
+/*!
+ * Loads a Triangle file, reads the header (nh numbers) and the numbering of
+ * the first entity.
+ */
+OpenStatus
+openTriangleFile(std::string const &fileName, int nh, TriangleFile &file)
+{
+  if(!loadFile(fileName, file.buffer))
+    return OpenStatus::missing;
+  char const *p = file.buffer.data();
+  char const *end = p + file.buffer.size();
+  bool        headerRead = false;
+  while(p < end)
+    {
+      char const *eol = std::find(p, end, '\n');
+      LineParser  line(p, eol);
+      p = eol == end ? end : eol + 1;
+      if(line.blank())
+        continue;
+      if(!headerRead)
+        {
+          for(int i = 0; i < nh; ++i)
+            if(!line.next(file.header[i]) || file.header[i] < 0)
+              return OpenStatus::corrupted;
+          headerRead = true;
+          file.data = p;
+        }
+      else
+        {
+          if(!line.next(file.base))
+            return OpenStatus::corrupted;
+          return OpenStatus::ok;
+        }
+    }
+  if(!headerRead)
+    return OpenStatus::corrupted;
+  file.data = end;
+  return OpenStatus::ok;
+}
+
+//! Records which entities have been read, to detect repeated numbers
+class IdRegistry
+{
+public:
+  explicit IdRegistry(std::size_t n) : M_seen(n) {}
+  //! Returns false if id is out of range or has already been claimed
+  bool
+  claim(int id)
+  {
+    return id >= 0 && static_cast<std::size_t>(id) < M_seen.size() &&
+           !M_seen[id].exchange(true, std::memory_order_relaxed);
+  }
+
+private:
+  std::vector<std::atomic<bool>> M_seen;
+};
+
+/*!
+ * Splits the data lines of a file among threads and calls
+ * parse(LineParser &) on each non blank line. parse returns false on error.
+ * @return The number of lines parsed, nothing if parse fails on some line
+ */
+template <class Parse>
+std::optional<std::size_t>
+parseLines(TriangleFile const &file, unsigned numThreads, Parse const &parse)
+{
+  char const *begin = file.data;
+  char const *end = file.buffer.data() + file.buffer.size();
+  numThreads = std::max(numThreads, 1u);
+  // Chunk boundaries, moved to the beginning of a line
+  std::vector<char const *> bounds(numThreads + 1, end);
+  bounds[0] = begin;
+  for(unsigned t = 1; t < numThreads; ++t)
+    {
+      char const *p = begin + (end - begin) * t / numThreads;
+      p = std::max(p, bounds[t - 1]);
+      p = std::find(p, end, '\n');
+      bounds[t] = p == end ? end : p + 1;
+    }
+  std::atomic<std::size_t> count{0};
+  std::atomic<bool>        ok{true};
+  auto                     work = [&](unsigned t) {
+    std::size_t localCount = 0;
+    char const *p = bounds[t];
+    while(p < bounds[t + 1] && ok.load(std::memory_order_relaxed))
+      {
+        char const *eol = std::find(p, bounds[t + 1], '\n');
+        LineParser  line(p, eol);
+        p = eol + 1;
+        if(line.blank())
+          continue;
+        if(!parse(line))
+          ok = false;
+        ++localCount;
+      }
+    count += localCount;
+  };
+  std::vector<std::thread> threads;
+  for(unsigned t = 1; t < numThreads; ++t)
+    threads.emplace_back(work, t);
+  work(0);
+  for(auto &th : threads)
+    th.join();
+  if(!ok)
+    return std::nullopt;
+  return count.load();
+}
 } // namespace
 namespace Fem
 {
@@ -314,4 +491,170 @@ remainder of the file is assumed to contain boundary markers.
   return 0;
 }
 
+int
+MeshReadTriangleParallel::read(MeshTria &m, std::string const &filename)
+{
+  MeshHandler            mesh(m);
+  std::vector<Point>    &pl(mesh.pointList);
+  std::vector<Triangle> &el(mesh.elementList);
+  unsigned const         numThreads = M_numThreads > 0u
+                                        ? M_numThreads
+                                        : std::thread::hardware_concurrency();
+  // Nodes: <point #> <x> <y> [attributes] [boundary marker]
+  std::string const nodeFileName = filename + ".node";
+  TriangleFile      nodes;
+  if(openTriangleFile(nodeFileName, 4, nodes) != OpenStatus::ok)
+    {
+      std::cerr << "Triangle node file does not exist or is corrupted: "
+                << nodeFileName << std::endl;
+      return 1;
+    }
+  auto const [numPoints, dimension, numAttributes, numBMarkers] = nodes.header;
+  if(dimension != 2)
+    {
+      std::cerr << "Only 2D meshes are supported" << std::endl;
+      return 1;
+    }
+  if(M_verbose)
+    std::clog << "Num points " << numPoints << std::endl;
+  pl.clear();
+  pl.resize(numPoints);
+  int const base = nodes.base;
+  // Every number must appear once, otherwise some entities stay undefined
+  IdRegistry pointIds(numPoints);
+  auto       nRead = parseLines(nodes, numThreads, [&](LineParser &line) {
+    int    nId;
+    double x, y, attr;
+    int    bMarker = 0;
+    if(!(line.next(nId) && line.next(x) && line.next(y)))
+      return false;
+    for(int j = 0; j < numAttributes; ++j)
+      if(!line.next(attr))
+        return false;
+    if(numBMarkers == 1 && !line.next(bMarker))
+      return false;
+    nId -= base;
+    if(!pointIds.claim(nId))
+      return false;
+    pl[nId][0] = x;
+    pl[nId][1] = y;
+    pl[nId].id() = nId;
+    pl[nId].bcId() = bMarker;
+    return true;
+  });
+  if(nRead != static_cast<std::size_t>(numPoints))
+    {
+      std::cerr << "FILE ERROR! Cannot read all points in " << nodeFileName
+                << std::endl;
+      return 3;
+    }
+
+  // Elements: <triangle #> <point> <point> <point> ... [attributes]
+  std::string const eleFileName = filename + ".ele";
+  TriangleFile      elements;
+  switch(openTriangleFile(eleFileName, 3, elements))
+    {
+    case OpenStatus::missing:
+      std::cerr << "Cannot open triangle ele file " << eleFileName
+                << std::endl;
+      return 2;
+    case OpenStatus::corrupted:
+      std::cerr << "FILE ERROR! Wrong header in " << eleFileName << std::endl;
+      return 5;
+    case OpenStatus::ok:
+      break;
+    }
+  auto const [numEle, numPTria, numEleAttributes, unused] = elements.header;
+  if(M_verbose)
+    std::clog << "Num Elements  " << numEle << std::endl;
+  el.clear();
+  el.resize(numEle);
+  IdRegistry elementIds(numEle);
+  nRead = parseLines(elements, numThreads, [&](LineParser &line) {
+    int    nId, inext;
+    int    i[3];
+    double attr;
+    if(!(line.next(nId) && line.next(i[0]) && line.next(i[1]) &&
+         line.next(i[2])))
+      return false;
+    // I neglect extra points for quadratic tria
+    for(int j = 3; j < numPTria; ++j)
+      if(!line.next(inext))
+        return false;
+    for(int j = 0; j < numEleAttributes; ++j)
+      if(!line.next(attr))
+        return false;
+    for(int k = 0; k < 3; ++k)
+      {
+        i[k] -= base;
+        if(i[k] < 0 || i[k] >= numPoints)
+          return false;
+      }
+    nId -= base;
+    if(!elementIds.claim(nId))
+      return false;
+    el[nId].changePoint(0, pl[i[0]]);
+    el[nId].changePoint(1, pl[i[1]]);
+    el[nId].changePoint(2, pl[i[2]]);
+    el[nId].id() = nId;
+    el[nId].bcId() = 0;
+    return true;
+  });
+  if(nRead != static_cast<std::size_t>(numEle))
+    {
+      std::cerr << "FILE ERROR! Cannot read all elements in " << eleFileName
+                << std::endl;
+      return 5;
+    }
+
+  // Edges: <edge #> <endpoint> <endpoint> [boundary marker]
+  std::string const  edgeFileName = filename + ".edge";
+  TriangleFile       edges;
+  std::vector<Edge> &edl(mesh.edgeList);
+  edl.clear();
+  switch(openTriangleFile(edgeFileName, 2, edges))
+    {
+    case OpenStatus::missing:
+      if(M_verbose)
+        std::clog << "triangle Edge file not present" << std::endl;
+      return 0;
+    case OpenStatus::corrupted:
+      std::cerr << "FILE ERROR! Wrong header in " << edgeFileName
+                << std::endl;
+      return 6;
+    case OpenStatus::ok:
+      break;
+    }
+  auto const [numEdges, numEdgeBMarkers, unused1, unused2] = edges.header;
+  edl.resize(numEdges);
+  IdRegistry edgeIds(numEdges);
+  nRead = parseLines(edges, numThreads, [&](LineParser &line) {
+    int nId, i1, i2;
+    int bMarker = 0;
+    if(!(line.next(nId) && line.next(i1) && line.next(i2)))
+      return false;
+    if(numEdgeBMarkers == 1 && !line.next(bMarker))
+      return false;
+    i1 -= base;
+    i2 -= base;
+    if(i1 < 0 || i1 >= numPoints || i2 < 0 || i2 >= numPoints)
+      return false;
+    nId -= base;
+    if(!edgeIds.claim(nId))
+      return false;
+    edl[nId].changePoint(0, pl[i1]);
+    edl[nId].changePoint(1, pl[i2]);
+    edl[nId].bcId() = bMarker;
+    edl[nId].id() = nId;
+    return true;
+  });
+  if(nRead != static_cast<std::size_t>(numEdges))
+    {
+      std::cerr << "FILE ERROR! Cannot read all edges in " << edgeFileName
+                << std::endl;
+      return 6;
+    }
+  return 0;
+}
+
 } // namespace Fem
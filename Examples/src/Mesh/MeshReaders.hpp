@@ -24,6 +24,42 @@ public:
   int read(MeshTria &, std::string const &filename) override;
 };
 
+//! A multithreaded reader of the files produced by Triangle
+/*!
+ * It reads the same .node, .ele and (optional) .edge files of
+ * MeshReadTriangle. Each file is loaded in memory with a single read and
+ * its lines are split among threads, which parse numbers with
+ * std::from_chars. Since every line starts with the number of the entity,
+ * each thread stores what it reads directly in the final position.
+ *
+ * Numbering may start from 0 or 1 (Triangle option -z), comments
+ * (starting with #) are skipped.
+ */
+class MeshReadTriangleParallel : public Fem::MeshReader
+{
+public:
+  /*!
+   * @param verbose Verbosity
+   * @param numThreads Number of threads (0 means all hardware threads)
+   */
+  MeshReadTriangleParallel(bool verbose = false, unsigned numThreads = 0u)
+    : MeshReader(verbose), M_numThreads(numThreads){};
+  /*!
+   * Errors are reported on std::cerr and by the returned value, with the
+   * codes of the other readers:
+   * - 0 success (the .edge file is optional)
+   * - 1 the .node file is missing or has a wrong header
+   * - 2 the .ele file is missing
+   * - 3 wrong, missing or repeated points
+   * - 5 wrong, missing or repeated elements (or points out of range)
+   * - 6 wrong, missing or repeated edges
+   */
+  int read(MeshTria &, std::string const &filename) override;
+
+private:
+  unsigned M_numThreads;
+};
+
 class DummyMesh : public Fem::MeshReader
 {
 public:
@@ -28,8 +28,7 @@ MeshTria::MeshTria(const MeshTria &m)
   this->M_bEdgeList.reserve(m.M_bEdgeList.size());
   this->M_edgeList.reserve(m.M_edgeList.size());
   this->M_elementList.reserve(m.M_elementList.size());
-  std::vector<Point *> old2new;
-  old2new.reserve(m.num_points());
+  std::vector<Point *> old2new(m.num_points());
 
   // I create new points and I store the pointers for later use
   unsigned int count(0);
@@ -96,8 +95,7 @@ MeshTria::operator=(MeshTria const &m)
             std::back_inserter(pointList));
 
   // Fix pointers
-  std::vector<Point *> old2new;
-  old2new.reserve(m.num_points());
+  std::vector<Point *> old2new(m.num_points());
   for(size_type i = 0; i < m.num_points(); ++i)
     {
       Point *pnew = &(pointList[i]);
@@ -0,0 +1,135 @@
+#include "CompactMesh.hpp"
+#include "MeshTria.hpp"
+#include "chrono.hpp" // in Utilities
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+/*
+ * Compares MeshTria and CompactMesh on a structured mesh of the unit square
+ * with 2*n*n triangles (n=1000 by default, i.e. two million triangles).
+ *
+ * Usage: main_benchmarkMesh [n]
+ */
+namespace
+{
+//! Runs f nRep times and returns the average time in milliseconds
+template <class F>
+double
+timeIt(F &&f, int nRep = 5)
+{
+  Timings::Chrono clock;
+  clock.start();
+  for(int r = 0; r < nRep; ++r)
+    f();
+  clock.stop();
+  return clock.wallTime() * 1.e-3 / nRep;
+}
+
+void
+report(std::string const &what, double tMeshTria, double tCompact)
+{
+  std::cout << std::left << std::setw(24) << what << std::right
+            << std::setw(14) << tMeshTria << std::setw(14) << tCompact
+            << std::setw(10) << tMeshTria / tCompact << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace Fem;
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 1000u;
+  CompactMesh       compact;
+  double const      tBuild = timeIt([&] { compact = unitSquareMesh(n); }, 1);
+  MeshTria          mesh;
+  double const tConvert = timeIt([&] { mesh = compact.toMeshTria(); }, 1);
+  auto const   ne = compact.num_elements();
+  std::cout << "Mesh with " << ne << " triangles and " << compact.num_points()
+            << " points\n";
+  std::cout << "Building CompactMesh " << tBuild
+            << " ms, converting to MeshTria " << tConvert << " ms\n";
+  std::cout << "Memory: MeshTria "
+            << (mesh.num_points() * sizeof(Point) + ne * sizeof(Triangle)) /
+                 1048576.
+            << " MB, CompactMesh "
+            << (compact.num_points() * (2 * sizeof(double) + sizeof(BcId)) +
+                ne * (3 * sizeof(Id) + sizeof(BcId))) /
+                 1048576.
+            << " MB\n\n";
+  std::cout << std::left << std::setw(24) << "Times (ms)" << std::right
+            << std::setw(14) << "MeshTria" << std::setw(14) << "CompactMesh"
+            << std::setw(10) << "speedup" << '\n';
+
+  report(
+    "copy", timeIt([&] { MeshTria copy(mesh); }),
+    timeIt([&] { CompactMesh copy(compact); }));
+
+  double              m1 = 0.0;
+  double              m2 = 0.0;
+  std::vector<double> a1(ne);
+  std::vector<double> a2(ne);
+  report(
+    "measure()", timeIt([&] { m1 = mesh.measure(); }),
+    timeIt([&] { m2 = compact.measure(); }));
+
+  report(
+    "areas", timeIt([&] {
+      for(std::size_t e = 0; e < ne; ++e)
+        a1[e] = mesh.element(e).measure();
+    }),
+    timeIt([&] { compact.computeAreas(a2); }));
+
+  JacobianArrays jac;
+  jac.resize(ne);
+  report(
+    "jacobians", timeIt([&] {
+      for(std::size_t e = 0; e < ne; ++e)
+        {
+          auto const J = mesh.element(e).jacobian();
+          jac.J00[e] = J(0, 0);
+          jac.J10[e] = J(1, 0);
+          jac.J01[e] = J(0, 1);
+          jac.J11[e] = J(1, 1);
+          jac.detJ[e] = J(0, 0) * J(1, 1) - J(1, 0) * J(0, 1);
+        }
+    }),
+    timeIt([&] { compact.computeJacobians(jac); }));
+
+  std::vector<double> bx(ne);
+  std::vector<double> by(ne);
+  report(
+    "barycenters", timeIt([&] {
+      for(std::size_t e = 0; e < ne; ++e)
+        {
+          Triangle const &t = mesh.element(e);
+          bx[e] = (t[0][0] + t[1][0] + t[2][0]) / 3.0;
+          by[e] = (t[0][1] + t[1][1] + t[2][1]) / 3.0;
+        }
+    }),
+    timeIt([&] { compact.computeBarycenters(bx, by); }));
+
+  // The view provides the interface of MeshTria: here the same loop used
+  // for MeshTria, element by element
+  MeshTriaView view(compact);
+  double       m3 = 0.0;
+  report(
+    "element loop (view)", timeIt([&] {
+      m1 = 0.0;
+      for(std::size_t e = 0; e < ne; ++e)
+        m1 += mesh.element(e).measure();
+    }),
+    timeIt([&] {
+      m3 = 0.0;
+      for(std::size_t e = 0; e < view.num_elements(); ++e)
+        m3 += view.element(e).measure();
+    }));
+
+  double maxDiff = 0.0;
+  for(std::size_t e = 0; e < ne; ++e)
+    maxDiff = std::max(maxDiff, std::abs(a1[e] - a2[e]));
+  std::cout << "\nArea of the domain: MeshTria " << m1 << ", CompactMesh "
+            << m2 << ", view " << m3 << "\nMax difference of element areas "
+            << maxDiff << '\n';
+}
@@ -0,0 +1,125 @@
+#include "CompactMesh.hpp"
+#include "MeshBinary.hpp"
+#include "MeshReaderFactory.hpp"
+#include "MeshTria.hpp"
+#include "chrono.hpp" // in Utilities
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+/*
+ * Compares the time needed to load a mesh with the different readers: the
+ * text reader of Triangle files, its multithreaded version, the binary
+ * reader, and the memory mapped binary mesh.
+ *
+ * Usage: main_benchmarkReaders [n] [numThreads]
+ *
+ * The mesh is a structured mesh of the unit square with 2*n*n triangles
+ * (n=1000 by default). Files are written in the current directory and
+ * removed at the end.
+ */
+namespace
+{
+//! Writes a mesh in the Triangle format (numbering from 1)
+void
+writeTriangleFiles(Fem::CompactMesh const &mesh, std::string const &name)
+{
+  std::ofstream node(name + ".node");
+  node << mesh.num_points() << " 2 0 1\n";
+  node << std::setprecision(17);
+  for(std::size_t i = 0; i < mesh.num_points(); ++i)
+    node << i + 1 << " " << mesh.x()[i] << " " << mesh.y()[i] << " "
+         << mesh.pointMarkers()[i] << '\n';
+  std::ofstream ele(name + ".ele");
+  ele << mesh.num_elements() << " 3 0\n";
+  for(std::size_t e = 0; e < mesh.num_elements(); ++e)
+    ele << e + 1 << " " << mesh.vertex(e, 0) + 1 << " "
+        << mesh.vertex(e, 1) + 1 << " " << mesh.vertex(e, 2) + 1 << '\n';
+  std::ofstream edge(name + ".edge");
+  edge << mesh.num_edges() << " 1\n";
+  for(std::size_t e = 0; e < mesh.num_edges(); ++e)
+    edge << e + 1 << " " << mesh.edges()[2 * e] + 1 << " "
+         << mesh.edges()[2 * e + 1] + 1 << " " << mesh.edgeMarkers()[e]
+         << '\n';
+}
+
+using Timings::timeIt; // time in milliseconds
+
+void
+report(std::string const &what, double time, double reference, double area)
+{
+  std::cout << std::left << std::setw(34) << what << std::right
+            << std::setw(12) << time << std::setw(10) << reference / time
+            << std::setw(12) << area << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace Fem;
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 1000u;
+  unsigned const    numThreads = argc > 2 ? std::stoul(argv[2]) : 0u;
+  std::string const name = "benchmarkReaders";
+  {
+    CompactMesh mesh = unitSquareMesh(n);
+    mesh.buildEdges();
+    std::cout << "Writing a mesh with " << mesh.num_points() << " points, "
+              << mesh.num_elements() << " triangles and " << mesh.num_edges()
+              << " edges\n";
+    std::cout << "Triangle files: "
+              << timeIt([&] { writeTriangleFiles(mesh, name); }) << " ms, ";
+    std::cout << "binary file: "
+              << timeIt([&] { writeBinaryMesh(mesh, name + ".msh.bin"); })
+              << " ms\n\n";
+  }
+  std::cout << std::left << std::setw(34) << "Load times (ms)" << std::right
+            << std::setw(12) << "time" << std::setw(10) << "speedup"
+            << std::setw(12) << "area" << '\n';
+
+  auto const &factory = getMeshReaderFactory();
+  MeshTria    mesh;
+  auto        reader = factory.create("Triangle");
+  double const tText = timeIt([&] { reader->read(mesh, name); });
+  report("Triangle text (MeshReadTriangle)", tText, tText, mesh.measure());
+
+  MeshReadTriangleParallel parallelReader(false, 1u);
+  double t = timeIt([&] { parallelReader.read(mesh, name); });
+  report("Triangle text, from_chars 1 thread", t, tText, mesh.measure());
+
+  reader = factory.create("TriangleParallel");
+  if(numThreads > 0)
+    reader = std::make_unique<MeshReadTriangleParallel>(false, numThreads);
+  t = timeIt([&] { reader->read(mesh, name); });
+  report("Triangle text, multithreaded", t, tText, mesh.measure());
+
+  reader = factory.create("Binary");
+  t = timeIt([&] { reader->read(mesh, name + ".msh.bin"); });
+  report("Binary into MeshTria", t, tText, mesh.measure());
+
+  CompactMesh compact;
+  t = timeIt([&] { compact = MappedMesh(name + ".msh.bin").toCompactMesh(); });
+  report("Binary into CompactMesh", t, tText, compact.measure());
+
+  // Data used in place: the area is computed directly from the mapped file
+  double area = 0.0;
+  t = timeIt([&] {
+    MappedMesh mapped(name + ".msh.bin");
+    auto const x = mapped.x();
+    auto const y = mapped.y();
+    auto const tri = mapped.triangles();
+    for(std::size_t e = 0; e < mapped.num_elements(); ++e)
+      {
+        auto const i0 = tri[3 * e];
+        auto const i1 = tri[3 * e + 1];
+        auto const i2 = tri[3 * e + 2];
+        area += 0.5 * ((x[i1] - x[i0]) * (y[i2] - y[i0]) -
+                       (x[i2] - x[i0]) * (y[i1] - y[i0]));
+      }
+  });
+  report("Mapped in place (incl. one sweep)", t, tText, area);
+
+  for(auto ext : {".node", ".ele", ".edge", ".msh.bin"})
+    std::remove((name + ext).c_str());
+}
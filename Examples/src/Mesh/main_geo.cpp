@@ -1,6 +1,9 @@
+#include "CompactMesh.hpp"
+#include "MeshBinary.hpp"
 #include "MeshReaders.hpp"
 #include "MeshTria.hpp"
 #include "femMesh.hpp"
+#include <cstdio>
 #include <iostream>
 #include <vector>
 /*
@@ -29,5 +32,26 @@ main()
   MeshTria meshA("Test/A.1", readTriangle);
   meshA.checkmesh();
 
+  // The same mesh in compact form, and back
+  CompactMesh  compactA(meshA);
+  MeshTriaView viewA(compactA);
+  cout << "Compact mesh: area " << compactA.measure() << ", view area "
+       << viewA.measure() << ", stiffness matrix of first triangle\n"
+       << viewA.triangle(0).localStiffMatrix() << std::endl;
+  MeshTria meshA2 = compactA.toMeshTria();
+  meshA2.checkmesh();
+
+  // Multithreaded reader and binary format
+  MeshReadTriangleParallel readParallel(true);
+  MeshTria                 meshA3("Test/A.1", readParallel);
+  writeBinaryMesh(meshA3, "A.msh.bin");
+  MeshReadBinary readBinary;
+  MeshTria       meshA4("A.msh.bin", readBinary);
+  MappedMesh     mappedA("A.msh.bin");
+  cout << "Area: parallel reader " << meshA3.measure() << ", binary reader "
+       << meshA4.measure() << ", mapped file "
+       << mappedA.toCompactMesh().measure() << ", " << meshA4.num_edges()
+       << " edges" << std::endl;
+  std::remove("A.msh.bin");
 
 }
@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
@@ -41,13 +43,17 @@ using size_type = std::size_t;
 
 //! A simple dense matrix class.
 /*!
- * The matrix stores its entries in a flat `std::vector<T>`. The storage order
- * is selected at compile time through the `storagePolicy` template parameter.
+ * The matrix stores its entries in a flat `std::vector<T, Allocator>`. The
+ * storage order is selected at compile time through the `storagePolicy`
+ * template parameter, the way memory is obtained through the `Allocator`
+ * parameter (see for instance `PoolAllocator` in `MyMat0_allocator.hpp`).
  *
  * @tparam T Scalar type stored in the matrix.
  * @tparam storagePolicy Storage layout used internally.
+ * @tparam Allocator A standard-conforming allocator for T.
  */
-template <class T = double, StoragePolicySwitch storagePolicy = ROWMAJOR>
+template <class T = double, StoragePolicySwitch storagePolicy = ROWMAJOR,
+          class Allocator = std::allocator<T>>
 class MyMat0
 {
 public:
@@ -64,6 +70,8 @@ public:
   using size_type = std::size_t;
   //! I expose the type of the elements
   using value_type = T;
+  //! The allocator used for the data storage
+  using allocator_type = Allocator;
 
 private:
   size_type nr, nc;
@@ -75,7 +83,7 @@ private:
    * In alternative I might have used a smart pointer, in particular
    * std::unique_ptr<T>.
    */
-  std::vector<T> data;
+  std::vector<T, Allocator> data;
   //! The other storage system
   static constexpr StoragePolicySwitch otherPolicy =
     storagePolicy == ROWMAJOR ? COLUMNMAJOR : ROWMAJOR;
@@ -157,7 +165,7 @@ public:
   /*!
     @param m Source matrix stored with the other policy.
    */
-  MyMat0(MyMat0<T, otherPolicy> const &m);
+  MyMat0(MyMat0<T, otherPolicy, Allocator> const &m);
   //! Default move constructor is ok
   MyMat0(MyMat0 &&) = default;
   //! Default copy assign is ok
@@ -169,7 +177,7 @@ public:
     @param m Source matrix stored with the other policy.
     @return `*this`
    */
-  MyMat0 &operator=(MyMat0<T, otherPolicy> const &);
+  MyMat0 &operator=(MyMat0<T, otherPolicy, Allocator> const &);
   //! Default move assign is ok
   MyMat0 &operator=(MyMat0 &&) = default;
   //! Resizing the matrix
@@ -359,6 +367,17 @@ public:
     @throws std::invalid_argument if `v.size()!=ncol()`.
    */
   void vecMultiply(const std::vector<T> &v, std::vector<T> &res) const;
+  /*! Multiplies the matrix by a vector, storing the result in given memory.
+    Nothing is allocated: the result is written in the storage provided by the
+    caller, which may be a std::vector with any allocator, a std::array, a
+    column of another matrix, etc. In the row-major case the inner products
+    use four partial sums, so the result may differ from that of vecMultiply()
+    by rounding.
+    @param v Vector to be multiplied (`ncol()` entries).
+    @param res Where the result is stored (`nrow()` entries).
+    @throws std::invalid_argument if the sizes are not compatible.
+   */
+  void vecMultiplyInto(std::span<T const> v, std::span<T> res) const;
   //! Iterator to the begin of the internal structure
   /*!
     To be used for fast operation on the data
@@ -414,14 +433,15 @@ public:
  * @return The product `m*v`.
  * @throws std::invalid_argument if `v.size()!=m.ncol()`.
  */
-template <class T, StoragePolicySwitch storagePolicy>
-std::vector<T> operator*(MyMat0<T, storagePolicy> const &m,
-                         std::vector<T> const           &v);
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
+std::vector<T> operator*(MyMat0<T, storagePolicy, Allocator> const &m,
+                         std::vector<T> const                      &v);
 
 //                 DEFINITIONS
 
-template <class T, StoragePolicySwitch storagePolicy>
-MyMat0<T, storagePolicy>::MyMat0(MyMat0<T, otherPolicy> const &m)
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
+MyMat0<T, storagePolicy, Allocator>::MyMat0(
+  MyMat0<T, otherPolicy, Allocator> const &m)
   : nr(m.nrow()), nc(m.ncol()), data(nr * nc)
 {
   for(size_type i = 0; i < nr; ++i)
@@ -429,11 +449,12 @@ MyMat0<T, storagePolicy>::MyMat0(MyMat0<T, otherPolicy> const &m)
       data[getIndex(i, j)] = m(i, j);
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
-MyMat0<T, storagePolicy> &
-MyMat0<T, storagePolicy>::operator=(MyMat0<T, otherPolicy> const &m)
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
+MyMat0<T, storagePolicy, Allocator> &
+MyMat0<T, storagePolicy, Allocator>::operator=(
+  MyMat0<T, otherPolicy, Allocator> const &m)
 {
-  this->resize(m.nr, m.nc);
+  this->resize(m.nrow(), m.ncol());
   for(size_type i = 0; i < nr; ++i)
     for(size_type j = 0; j < nc; ++j)
       data[getIndex(i, j)] = m(i, j);
@@ -468,9 +489,10 @@ const & j) const
   return i + j*nr;
 }
 */
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::resize(size_type const n, size_type const m)
+MyMat0<T, storagePolicy, Allocator>::resize(size_type const n,
+                                            size_type const m)
 {
   if(n * m != nc * nr)
     {
@@ -481,9 +503,9 @@ MyMat0<T, storagePolicy>::resize(size_type const n, size_type const m)
   nc = m;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 double
-MyMat0<T, storagePolicy>::normInf() const
+MyMat0<T, storagePolicy, Allocator>::normInf() const
 {
   if(nr * nc == 0)
     return 0;
@@ -499,9 +521,9 @@ MyMat0<T, storagePolicy>::normInf() const
   return vmax;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 double
-MyMat0<T, storagePolicy>::norm1() const
+MyMat0<T, storagePolicy, Allocator>::norm1() const
 {
   if(nr * nc == 0)
     return 0;
@@ -516,9 +538,9 @@ MyMat0<T, storagePolicy>::norm1() const
   return vmax;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 double
-MyMat0<T, storagePolicy>::normF() const
+MyMat0<T, storagePolicy, Allocator>::normF() const
 {
   if(nr * nc == 0)
     return 0.0;
@@ -531,10 +553,10 @@ MyMat0<T, storagePolicy>::normF() const
   return std::sqrt(vsum);
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::vecMultiply(const std::vector<T> &v,
-                                      std::vector<T>       &res) const
+MyMat0<T, storagePolicy, Allocator>::vecMultiply(const std::vector<T> &v,
+                                                 std::vector<T> &res) const
 {
   if(v.size() != nc)
     throw std::invalid_argument("Vector size must match the number of columns");
@@ -555,9 +577,51 @@ MyMat0<T, storagePolicy>::vecMultiply(const std::vector<T> &v,
     }
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
+void
+MyMat0<T, storagePolicy, Allocator>::vecMultiplyInto(std::span<T const> v,
+                                                     std::span<T> res) const
+{
+  if(v.size() != nc)
+    throw std::invalid_argument("Vector size must match the number of columns");
+  if(res.size() != nr)
+    throw std::invalid_argument("Result size must match the number of rows");
+  // for efficiency I use two different algorithms
+  if constexpr(storagePolicy == ROWMAJOR)
+    {
+      // Classic A*v row by row: inner product with contiguous rows.
+      // Four partial sums break the dependency chain of the accumulation,
+      // which the compiler cannot do by itself without -ffast-math.
+      for(size_type i = 0; i < nr; ++i)
+        {
+          T const  *row = data.data() + i * nc;
+          T         sum[4]{};
+          size_type j = 0;
+          for(; j + 4 <= nc; j += 4)
+            for(size_type l = 0; l < 4; ++l)
+              sum[l] += row[j + l] * v[j + l];
+          for(; j < nc; ++j)
+            sum[0] += row[j] * v[j];
+          res[i] = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+        }
+    }
+  else
+    {
+      // result is a linear combination of the contiguous columns of A
+      std::fill(res.begin(), res.end(), T{});
+      for(size_type j = 0; j < nc; ++j)
+        {
+          T const *col = data.data() + j * nr;
+          T const  vj = v[j];
+          for(size_type i = 0; i < nr; ++i)
+            res[i] += col[i] * vj;
+        }
+    }
+}
+
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::fillRandom(unsigned int seed)
+MyMat0<T, storagePolicy, Allocator>::fillRandom(unsigned int seed)
 {
   auto generator =
     seed == 0 ? std::mt19937{std::random_device{}()} : std::mt19937{seed};
@@ -566,9 +630,9 @@ MyMat0<T, storagePolicy>::fillRandom(unsigned int seed)
     x = static_cast<T>(distribution(generator));
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::showMe(std::ostream &out) const
+MyMat0<T, storagePolicy, Allocator>::showMe(std::ostream &out) const
 {
   if(nr == 0 || nc == 0)
     {
@@ -588,18 +652,20 @@ MyMat0<T, storagePolicy>::showMe(std::ostream &out) const
     }
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 std::vector<T>
-operator*(MyMat0<T, storagePolicy> const &m, std::vector<T> const &v)
+operator*(MyMat0<T, storagePolicy, Allocator> const &m,
+          std::vector<T> const                      &v)
 {
   std::vector<T> tmp;
   m.vecMultiply(v, tmp);
   return tmp;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 std::vector<T>
-MyMat0<T, storagePolicy>::col(size_type j, StorageType<ROWMAJOR>) const
+MyMat0<T, storagePolicy, Allocator>::col(
+  size_type j, StorageType<ROWMAJOR>) const
 {
   // Extracting a column from a matrix stored in row major ordering is not
   // efficient
@@ -610,27 +676,30 @@ MyMat0<T, storagePolicy>::col(size_type j, StorageType<ROWMAJOR>) const
   return res;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 std::vector<T>
-MyMat0<T, storagePolicy>::col(size_type j, StorageType<COLUMNMAJOR>) const
+MyMat0<T, storagePolicy, Allocator>::col(
+  size_type j, StorageType<COLUMNMAJOR>) const
 {
   auto const first = data.cbegin() + getIndex(0, j);
   auto const last = first + static_cast<std::ptrdiff_t>(nr);
   return std::vector<T>(first, last);
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 std::vector<T>
-MyMat0<T, storagePolicy>::row(size_type i, StorageType<ROWMAJOR>) const
+MyMat0<T, storagePolicy, Allocator>::row(
+  size_type i, StorageType<ROWMAJOR>) const
 {
   auto const first = data.cbegin() + getIndex(i, 0);
   auto const last = first + static_cast<std::ptrdiff_t>(nc);
   return std::vector<T>(first, last);
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 std::vector<T>
-MyMat0<T, storagePolicy>::row(size_type i, StorageType<COLUMNMAJOR>) const
+MyMat0<T, storagePolicy, Allocator>::row(
+  size_type i, StorageType<COLUMNMAJOR>) const
 {
   // Extracting a row from a matrix stored in column major ordering is not
   // efficient
@@ -641,10 +710,11 @@ MyMat0<T, storagePolicy>::row(size_type i, StorageType<COLUMNMAJOR>) const
   return res;
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::replaceCol(size_type j, std::vector<T> const &c,
-                                     StorageType<ROWMAJOR>)
+MyMat0<T, storagePolicy, Allocator>::replaceCol(size_type j,
+                                                std::vector<T> const &c,
+                                                StorageType<ROWMAJOR>)
 {
   if(c.size() != nr)
     throw std::invalid_argument("Column size mismatch");
@@ -652,10 +722,11 @@ MyMat0<T, storagePolicy>::replaceCol(size_type j, std::vector<T> const &c,
     data[getIndex(i, j)] = c[i];
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::replaceCol(size_type j, std::vector<T> const &c,
-                                     StorageType<COLUMNMAJOR>)
+MyMat0<T, storagePolicy, Allocator>::replaceCol(size_type j,
+                                                std::vector<T> const &c,
+                                                StorageType<COLUMNMAJOR>)
 {
   if(c.size() != nr)
     throw std::invalid_argument("Column size mismatch");
@@ -666,10 +737,11 @@ MyMat0<T, storagePolicy>::replaceCol(size_type j, std::vector<T> const &c,
     *(start++) = c[i];
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::replaceRow(size_type i, std::vector<T> const &c,
-                                     StorageType<ROWMAJOR>)
+MyMat0<T, storagePolicy, Allocator>::replaceRow(size_type i,
+                                                std::vector<T> const &c,
+                                                StorageType<ROWMAJOR>)
 {
   if(c.size() != nc)
     throw std::invalid_argument("Row size mismatch");
@@ -680,10 +752,11 @@ MyMat0<T, storagePolicy>::replaceRow(size_type i, std::vector<T> const &c,
     *(start++) = c[j];
 }
 
-template <class T, StoragePolicySwitch storagePolicy>
+template <class T, StoragePolicySwitch storagePolicy, class Allocator>
 void
-MyMat0<T, storagePolicy>::replaceRow(size_type i, std::vector<T> const &c,
-                                     StorageType<COLUMNMAJOR>)
+MyMat0<T, storagePolicy, Allocator>::replaceRow(size_type i,
+                                                std::vector<T> const &c,
+                                                StorageType<COLUMNMAJOR>)
 {
   if(c.size() != nc)
     throw std::invalid_argument("Row size mismatch");
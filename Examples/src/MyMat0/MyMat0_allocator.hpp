@@ -0,0 +1,226 @@
+#ifndef HH_MYMAT0_ALLOCATOR__HH
+#define HH_MYMAT0_ALLOCATOR__HH
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+/*!
+  @file MyMat0_allocator.hpp
+  @brief Aligned and pooled allocators for the storage of MyMat0.
+
+  A dense matrix library spends a surprising amount of time in `new` and
+  `delete` when results of products are created and destroyed in a loop.
+  Here we provide two standard-conforming allocators that may be passed as
+  third template argument of `MyMat0` (or to any standard container):
+
+  - `AlignedAllocator`: memory aligned to a cache line (64 bytes), which is
+    also the alignment required by the widest SIMD loads;
+  - `PoolAllocator`: aligned memory taken from a global pool. Released blocks
+    are not returned to the system but kept for later requests of the same
+    size class, so repeated creation of temporaries of the same size costs
+    (almost) nothing.
+ */
+namespace LinearAlgebra
+{
+//! Alignment (in bytes) of the memory provided by the allocators.
+inline constexpr std::size_t cacheLineSize = 64u;
+
+//! A pool of 64-byte aligned memory blocks.
+/*!
+  Requests are rounded up to the next power of two (the size class) and
+  served from a free list of blocks of that class. Only if the free list is
+  empty the memory is taken from the system. Released blocks go back to the
+  free list.
+
+  The pool is a singleton (see `instance()`), and it is thread safe: the free
+  lists are protected by a mutex, which is much cheaper than a call to the
+  system allocator.
+
+  The singleton is deliberately never destroyed: objects with static storage
+  duration using a PoolAllocator may be destroyed after any function-local
+  static, and they must still find a valid pool. The cached memory is
+  reclaimed by the operating system at exit (or earlier with release()).
+ */
+class AlignedPool
+{
+public:
+  //! Usage statistics
+  struct Statistics
+  {
+    //! Number of allocate() calls
+    std::size_t requests = 0u;
+    //! Number of allocations actually obtained from the system
+    std::size_t systemAllocations = 0u;
+    //! Bytes currently kept in the free lists
+    std::size_t cachedBytes = 0u;
+  };
+  //! The global pool
+  /*!
+    Created at the first use and leaked on purpose, so it can be used also
+    during the destruction of static objects.
+   */
+  static AlignedPool &
+  instance()
+  {
+    static AlignedPool *const pool = new AlignedPool;
+    return *pool;
+  }
+  AlignedPool(AlignedPool const &) = delete;
+  AlignedPool &operator=(AlignedPool const &) = delete;
+  //! Returns a block of at least `bytes` bytes, aligned to cacheLineSize
+  void *
+  allocate(std::size_t bytes)
+  {
+    auto const       c = sizeClass(bytes);
+    std::scoped_lock lock(M_mutex);
+    ++M_stat.requests;
+    if(!M_free[c].empty())
+      {
+        void *p = M_free[c].back();
+        M_free[c].pop_back();
+        M_stat.cachedBytes -= classBytes(c);
+        return p;
+      }
+    ++M_stat.systemAllocations;
+    return ::operator new(classBytes(c), std::align_val_t{cacheLineSize});
+  }
+  //! Puts a block back in the pool
+  /*!
+    @param p The block, returned by allocate()
+    @param bytes The size passed to allocate()
+
+    It is noexcept, as deallocate() of an allocator must be, although it
+    locks a mutex. std::mutex::lock() throws only if the mutex is already
+    owned by the calling thread or the system cannot lock it: the lock is
+    held only inside the member functions of the pool, which do not call
+    each other, so the first case cannot happen, and in the second one
+    terminating is the only sensible choice. The push_back into the free
+    list may throw bad_alloc, and it is handled.
+   */
+  void
+  deallocate(void *p, std::size_t bytes) noexcept
+  {
+    if(p == nullptr)
+      return;
+    auto const       c = sizeClass(bytes);
+    std::scoped_lock lock(M_mutex);
+    try
+      {
+        M_free[c].push_back(p);
+        M_stat.cachedBytes += classBytes(c);
+      }
+    catch(std::bad_alloc &)
+      {
+        // no room in the free list: give the block back to the system
+        ::operator delete(p, std::align_val_t{cacheLineSize});
+      }
+  }
+  //! Gives all cached blocks back to the system
+  void
+  release()
+  {
+    std::scoped_lock lock(M_mutex);
+    for(std::size_t c = 0; c < M_free.size(); ++c)
+      {
+        for(auto p : M_free[c])
+          ::operator delete(p, std::align_val_t{cacheLineSize});
+        M_free[c].clear();
+      }
+    M_stat.cachedBytes = 0u;
+  }
+  //! Returns the usage statistics
+  Statistics
+  statistics() const
+  {
+    std::scoped_lock lock(M_mutex);
+    return M_stat;
+  }
+  //! Resets the counters (the cached memory is kept)
+  void
+  resetStatistics()
+  {
+    std::scoped_lock lock(M_mutex);
+    M_stat.requests = 0u;
+    M_stat.systemAllocations = 0u;
+  }
+
+private:
+  AlignedPool() = default;
+  //! Index of the size class: blocks of 2^c bytes, at least a cache line
+  static std::size_t
+  sizeClass(std::size_t bytes)
+  {
+    return std::bit_width(std::bit_ceil(std::max(bytes, cacheLineSize)) - 1u);
+  }
+  static constexpr std::size_t
+  classBytes(std::size_t c)
+  {
+    return std::size_t{1u} << c;
+  }
+  mutable std::mutex                                       M_mutex;
+  std::array<std::vector<void *>, 8 * sizeof(std::size_t)> M_free;
+  Statistics                                               M_stat;
+};
+
+//! An allocator providing memory aligned to a cache line
+/*!
+  @tparam T The type of the allocated objects
+ */
+template <class T> struct AlignedAllocator
+{
+  using value_type = T;
+  AlignedAllocator() noexcept = default;
+  template <class U> AlignedAllocator(AlignedAllocator<U> const &) noexcept {}
+  T *
+  allocate(std::size_t n)
+  {
+    return static_cast<T *>(
+      ::operator new(n * sizeof(T), std::align_val_t{cacheLineSize}));
+  }
+  void
+  deallocate(T *p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t{cacheLineSize});
+  }
+  //! All aligned allocators are interchangeable
+  template <class U>
+  bool
+  operator==(AlignedAllocator<U> const &) const noexcept
+  {
+    return true;
+  }
+};
+
+//! An allocator taking aligned memory from the global AlignedPool
+/*!
+  @tparam T The type of the allocated objects
+ */
+template <class T> struct PoolAllocator
+{
+  using value_type = T;
+  PoolAllocator() noexcept = default;
+  template <class U> PoolAllocator(PoolAllocator<U> const &) noexcept {}
+  T *
+  allocate(std::size_t n)
+  {
+    return static_cast<T *>(AlignedPool::instance().allocate(n * sizeof(T)));
+  }
+  void
+  deallocate(T *p, std::size_t n) noexcept
+  {
+    AlignedPool::instance().deallocate(p, n * sizeof(T));
+  }
+  //! The pool is global, so all pool allocators are interchangeable
+  template <class U>
+  bool
+  operator==(PoolAllocator<U> const &) const noexcept
+  {
+    return true;
+  }
+};
+} // namespace LinearAlgebra
+
+#endif
@@ -0,0 +1,408 @@
+#ifndef HH_MYMAT0_BLOCKED__HH
+#define HH_MYMAT0_BLOCKED__HH
+#include "MyMat0.hpp"
+#include "MyMat0_allocator.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+/*!
+  @file MyMat0_blocked.hpp
+  @brief Cache-blocked matrix-matrix multiplication for MyMat0.
+
+  The algorithm follows the classic scheme of high-performance GEMM
+  implementations (Goto, van de Geijn): the operands are cut into
+  macro-tiles that fit in the cache hierarchy, the tiles are copied
+  ("packed") into contiguous aligned buffers with the layout expected by a
+  small register-tiled micro-kernel, and the micro-kernel computes an
+  \f$MR\times NR\f$ block of the result keeping all accumulators in
+  registers.
+
+  Packing makes the micro-kernel independent of the storage policy of the
+  operands: only the packing routines look at `ROWMAJOR`/`COLUMNMAJOR`.
+ */
+namespace LinearAlgebra
+{
+//! Implementation details of matMulBlocked
+namespace GemmDetail
+{
+  //! A minimal owning buffer with 64-byte aligned storage.
+  /*!
+    It is used only for the packed panels, which are overwritten at each
+    macro step, so entries are not initialised. Memory is taken from the
+    AlignedPool, so repeated products do not call the system allocator.
+    @tparam T Type of the stored values (trivially constructible).
+   */
+  template <class T> class AlignedBuffer
+  {
+  public:
+    explicit AlignedBuffer(size_type n)
+      : M_size(n), M_data(M_alloc.allocate(n))
+    {}
+    AlignedBuffer(AlignedBuffer const &) = delete;
+    AlignedBuffer &operator=(AlignedBuffer const &) = delete;
+    ~AlignedBuffer() { M_alloc.deallocate(M_data, M_size); }
+    T *
+    data()
+    {
+      return M_data;
+    }
+
+  private:
+    PoolAllocator<T> M_alloc;
+    size_type        M_size;
+    T               *M_data;
+  };
+
+  //! Blocking parameters and micro-kernel, portable version.
+  /*!
+    The micro-kernel computes \f$C += A_p B_p\f$, where \f$A_p\f$ is a packed
+    panel of MR rows, \f$B_p\f$ a packed panel of NR columns and \f$C\f$ is
+    an \f$MR\times NR\f$ row-major block with leading dimension `ldc`. The
+    fixed-size loops are written so that the compiler can vectorize them.
+
+    - MC, KC: the packed block of the first operand (MC x KC) should stay in
+      the L2 cache;
+    - KC, NC: the packed block of the second operand (KC x NC) should stay in
+      the L3 cache;
+    - a KC x NR panel of the second operand should stay in L1.
+    @tparam T The scalar type
+   */
+  template <class T> struct KernelTraits
+  {
+    static constexpr size_type MR = 4;
+    static constexpr size_type NR = 8;
+    static constexpr size_type MC = 128;
+    static constexpr size_type KC = 256;
+    static constexpr size_type NC = 2048;
+
+    static void
+    microKernel(size_type kc, T const *a, T const *b, T *c, size_type ldc)
+    {
+      T acc[MR][NR]{};
+      for(size_type p = 0; p < kc; ++p, a += MR, b += NR)
+        for(size_type r = 0; r < MR; ++r)
+          {
+            T const ar = a[r];
+            for(size_type j = 0; j < NR; ++j)
+              acc[r][j] += ar * b[j];
+          }
+      for(size_type r = 0; r < MR; ++r)
+        for(size_type j = 0; j < NR; ++j)
+          c[r * ldc + j] += acc[r][j];
+    }
+  };
+
+#if defined(__AVX512F__)
+  //! AVX-512 micro-kernel for doubles: 8x16 block, 16 zmm accumulators.
+  template <> struct KernelTraits<double>
+  {
+    static constexpr size_type MR = 8;
+    static constexpr size_type NR = 16;
+    static constexpr size_type MC = 128;
+    static constexpr size_type KC = 256;
+    static constexpr size_type NC = 2048;
+
+    static void
+    microKernel(size_type kc, double const *a, double const *b, double *c,
+                size_type ldc)
+    {
+      __m512d acc[MR][2];
+      for(size_type r = 0; r < MR; ++r)
+        acc[r][0] = acc[r][1] = _mm512_setzero_pd();
+      for(size_type p = 0; p < kc; ++p, a += MR, b += NR)
+        {
+          __m512d const b0 = _mm512_load_pd(b);
+          __m512d const b1 = _mm512_load_pd(b + 8);
+          for(size_type r = 0; r < MR; ++r)
+            {
+              __m512d const ar = _mm512_set1_pd(a[r]);
+              acc[r][0] = _mm512_fmadd_pd(ar, b0, acc[r][0]);
+              acc[r][1] = _mm512_fmadd_pd(ar, b1, acc[r][1]);
+            }
+        }
+      for(size_type r = 0; r < MR; ++r)
+        {
+          double *cr = c + r * ldc;
+          _mm512_storeu_pd(cr, _mm512_add_pd(_mm512_loadu_pd(cr), acc[r][0]));
+          _mm512_storeu_pd(cr + 8,
+                           _mm512_add_pd(_mm512_loadu_pd(cr + 8), acc[r][1]));
+        }
+    }
+  };
+#elif defined(__AVX2__) && defined(__FMA__)
+  //! AVX2 micro-kernel for doubles: 6x8 block, 12 ymm accumulators.
+  template <> struct KernelTraits<double>
+  {
+    static constexpr size_type MR = 6;
+    static constexpr size_type NR = 8;
+    static constexpr size_type MC = 120;
+    static constexpr size_type KC = 256;
+    static constexpr size_type NC = 2048;
+
+    static void
+    microKernel(size_type kc, double const *a, double const *b, double *c,
+                size_type ldc)
+    {
+      __m256d acc[MR][2];
+      for(size_type r = 0; r < MR; ++r)
+        acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+      for(size_type p = 0; p < kc; ++p, a += MR, b += NR)
+        {
+          __m256d const b0 = _mm256_load_pd(b);
+          __m256d const b1 = _mm256_load_pd(b + 4);
+          for(size_type r = 0; r < MR; ++r)
+            {
+              __m256d const ar = _mm256_broadcast_sd(a + r);
+              acc[r][0] = _mm256_fmadd_pd(ar, b0, acc[r][0]);
+              acc[r][1] = _mm256_fmadd_pd(ar, b1, acc[r][1]);
+            }
+        }
+      for(size_type r = 0; r < MR; ++r)
+        {
+          double *cr = c + r * ldc;
+          _mm256_storeu_pd(cr, _mm256_add_pd(_mm256_loadu_pd(cr), acc[r][0]));
+          _mm256_storeu_pd(cr + 4,
+                           _mm256_add_pd(_mm256_loadu_pd(cr + 4), acc[r][1]));
+        }
+    }
+  };
+#endif
+
+  //! Packs the block m(ic:ic+mc, pc:pc+kc) in panels of MR rows.
+  /*!
+    Inside a panel the entries are stored column after column (MR values for
+    each k). Rows beyond `mc` are padded with zeros so that the micro-kernel
+    never needs to test the bounds.
+   */
+  template <size_type MR, class T, StoragePolicySwitch P, class A>
+  void
+  packA(MyMat0<T, P, A> const &m, size_type ic, size_type mc, size_type pc,
+        size_type kc, T *buf)
+  {
+    for(size_type ir = 0; ir < mc; ir += MR, buf += MR * kc)
+      {
+        size_type const mr = std::min(MR, mc - ir);
+        if constexpr(P == ROWMAJOR)
+          {
+            // rows are contiguous: read along them
+            for(size_type r = 0; r < mr; ++r)
+              {
+                T const *src = &m[m.getIndex(ic + ir + r, pc)];
+                for(size_type p = 0; p < kc; ++p)
+                  buf[p * MR + r] = src[p];
+              }
+          }
+        else
+          {
+            // columns are contiguous: read along them
+            for(size_type p = 0; p < kc; ++p)
+              {
+                T const *src = &m[m.getIndex(ic + ir, pc + p)];
+                for(size_type r = 0; r < mr; ++r)
+                  buf[p * MR + r] = src[r];
+              }
+          }
+        for(size_type r = mr; r < MR; ++r)
+          for(size_type p = 0; p < kc; ++p)
+            buf[p * MR + r] = T{};
+      }
+  }
+
+  //! Packs the block m(pc:pc+kc, jc:jc+nc) in panels of NR columns.
+  /*!
+    Inside a panel the entries are stored row after row (NR values for each
+    k). Columns beyond `nc` are padded with zeros.
+   */
+  template <size_type NR, class T, StoragePolicySwitch P, class A>
+  void
+  packB(MyMat0<T, P, A> const &m, size_type pc, size_type kc, size_type jc,
+        size_type nc, T *buf)
+  {
+    for(size_type jr = 0; jr < nc; jr += NR, buf += NR * kc)
+      {
+        size_type const nr = std::min(NR, nc - jr);
+        if constexpr(P == ROWMAJOR)
+          {
+            for(size_type p = 0; p < kc; ++p)
+              {
+                T const *src = &m[m.getIndex(pc + p, jc + jr)];
+                for(size_type j = 0; j < nr; ++j)
+                  buf[p * NR + j] = src[j];
+              }
+          }
+        else
+          {
+            for(size_type j = 0; j < nr; ++j)
+              {
+                T const *src = &m[m.getIndex(pc, jc + jr + j)];
+                for(size_type p = 0; p < kc; ++p)
+                  buf[p * NR + j] = src[p];
+              }
+          }
+        for(size_type j = nr; j < NR; ++j)
+          for(size_type p = 0; p < kc; ++p)
+            buf[p * NR + j] = T{};
+      }
+  }
+
+  //! Multiplies two packed blocks and accumulates into the row-major C.
+  /*!
+    Full MR x NR tiles are updated directly in C, border tiles go through a
+    small local buffer.
+   */
+  template <class T>
+  void
+  macroKernel(size_type mc, size_type nc, size_type kc, T const *aPacked,
+              T const *bPacked, T *c, size_type ldc)
+  {
+    using K = KernelTraits<T>;
+    for(size_type jr = 0; jr < nc; jr += K::NR)
+      {
+        size_type const nr = std::min(K::NR, nc - jr);
+        for(size_type ir = 0; ir < mc; ir += K::MR)
+          {
+            size_type const mr = std::min(K::MR, mc - ir);
+            T const        *a = aPacked + ir * kc;
+            T const        *b = bPacked + jr * kc;
+            T              *cij = c + ir * ldc + jr;
+            if(mr == K::MR && nr == K::NR)
+              K::microKernel(kc, a, b, cij, ldc);
+            else
+              {
+                T tile[K::MR * K::NR]{};
+                K::microKernel(kc, a, b, tile, K::NR);
+                for(size_type r = 0; r < mr; ++r)
+                  for(size_type j = 0; j < nr; ++j)
+                    cij[r * ldc + j] += tile[r * K::NR + j];
+              }
+          }
+      }
+  }
+} // namespace GemmDetail
+
+//! Cache-blocked, register-tiled and multithreaded matrix multiplication.
+/*!
+  The result is computed in the storage of `res`, which is resized only if
+  needed: calling it repeatedly with matrices of the same size performs no
+  allocation of the result, and the packing buffers come from the
+  AlignedPool.
+
+  The result is split in macro-tiles of size MC x NC (see
+  `GemmDetail::KernelTraits`), which are distributed dynamically among the
+  OpenMP threads (compile with `-fopenmp`, e.g. `make openmp`). Each thread
+  owns its packing buffers and writes to disjoint parts of the result, so no
+  synchronization is needed. Without OpenMP the product is sequential.
+
+  The SIMD micro-kernels are selected at compile time: compile with
+  `-march=native` (`make NATIVE=yes`) to activate the AVX2 or AVX-512
+  versions for `double`. Otherwise a portable kernel is used.
+
+  @param res Row-major matrix where the product `m1*m2` is stored. It must
+  not be one of the operands.
+  @param m1 Left-hand-side matrix (any storage policy).
+  @param m2 Right-hand-side matrix (any storage policy).
+  @param nThreads Number of threads. If 0, `omp_get_max_threads()` is used
+  (i.e. OMP_NUM_THREADS). Ignored without OpenMP.
+  @throws std::invalid_argument if the matrix sizes are incompatible or if
+  `res` is one of the operands.
+ */
+template <typename T, StoragePolicySwitch storagePolicy1,
+          StoragePolicySwitch storagePolicy2, class Alloc, class Alloc1,
+          class Alloc2>
+void
+matMulInto(MyMat0<T, ROWMAJOR, Alloc>            &res,
+           MyMat0<T, storagePolicy1, Alloc1> const &m1,
+           MyMat0<T, storagePolicy2, Alloc2> const &m2,
+           unsigned int                             nThreads = 0u)
+{
+  using K = GemmDetail::KernelTraits<T>;
+  if(m1.ncol() != m2.nrow())
+    throw std::invalid_argument("Incompatible matrix sizes in matMulInto");
+  // res is zeroed before the operands are read
+  void const *const resAddress = &res;
+  if(resAddress == &m1 || resAddress == &m2)
+    throw std::invalid_argument("matMulInto: the result cannot be an operand");
+  size_type const m = m1.nrow();
+  size_type const n = m2.ncol();
+  size_type const k = m1.ncol();
+  res.resize(m, n);
+  std::fill(res.begin(), res.end(), T{});
+  if(m == 0 || n == 0 || k == 0)
+    return;
+
+  size_type const nTilesRow = (m + K::MC - 1) / K::MC;
+  size_type const nTilesCol = (n + K::NC - 1) / K::NC;
+  size_type const nTiles = nTilesRow * nTilesCol;
+  T              *c = &res[0];
+#ifdef _OPENMP
+  int const numThreads = static_cast<int>(std::min<size_type>(
+    nThreads > 0u ? nThreads : omp_get_max_threads(), nTiles));
+#pragma omp parallel num_threads(numThreads)
+#else
+  static_cast<void>(nThreads);
+#endif
+  {
+    // Each thread owns its packing buffers
+    size_type const kcMax = std::min(K::KC, k);
+    // Round up to a multiple of the register tile because of zero padding
+    size_type const mcMax = std::min(K::MC, (m + K::MR - 1) / K::MR * K::MR);
+    size_type const ncMax = std::min(K::NC, (n + K::NR - 1) / K::NR * K::NR);
+    GemmDetail::AlignedBuffer<T> aPacked(mcMax * kcMax);
+    GemmDetail::AlignedBuffer<T> bPacked(kcMax * ncMax);
+    // A macro-tile of C is computed completely by one thread, looping over
+    // the common dimension.
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for(size_type tile = 0; tile < nTiles; ++tile)
+      {
+        size_type const ic = (tile % nTilesRow) * K::MC;
+        size_type const jc = (tile / nTilesRow) * K::NC;
+        size_type const mc = std::min(K::MC, m - ic);
+        size_type const nc = std::min(K::NC, n - jc);
+        for(size_type pc = 0; pc < k; pc += K::KC)
+          {
+            size_type const kc = std::min(K::KC, k - pc);
+            GemmDetail::packB<K::NR>(m2, pc, kc, jc, nc, bPacked.data());
+            GemmDetail::packA<K::MR>(m1, ic, mc, pc, kc, aPacked.data());
+            GemmDetail::macroKernel(mc, nc, kc, aPacked.data(),
+                                    bPacked.data(), c + ic * n + jc, n);
+          }
+      }
+  }
+}
+
+//! Cache-blocked, register-tiled and multithreaded matrix multiplication.
+/*!
+  It returns a new matrix, see matMulInto() for the details and for a version
+  that reuses the storage of an existing matrix.
+
+  @param m1 Left-hand-side matrix (any storage policy).
+  @param m2 Right-hand-side matrix (any storage policy).
+  @param nThreads Number of threads. If 0, `omp_get_max_threads()` is used
+  (i.e. OMP_NUM_THREADS). Ignored without OpenMP.
+  @return A row-major matrix containing the product `m1*m2`, with the same
+  allocator as `m1`.
+  @throws std::invalid_argument if the matrix sizes are incompatible.
+ */
+template <typename T, StoragePolicySwitch storagePolicy1,
+          StoragePolicySwitch storagePolicy2, class Alloc1, class Alloc2>
+MyMat0<T, ROWMAJOR, Alloc1>
+matMulBlocked(MyMat0<T, storagePolicy1, Alloc1> const &m1,
+              MyMat0<T, storagePolicy2, Alloc2> const &m2,
+              unsigned int                             nThreads = 0u)
+{
+  MyMat0<T, ROWMAJOR, Alloc1> res;
+  matMulInto(res, m1, m2, nThreads);
+  return res;
+}
+
+} // namespace LinearAlgebra
+
+#endif
@@ -10,17 +10,19 @@ namespace LinearAlgebra
 
   @param m1 Left-hand-side matrix.
   @param m2 Right-hand-side matrix.
-  @return A row-major matrix containing the product `m1*m2`.
+  @return A row-major matrix containing the product `m1*m2`, with the same
+  allocator as `m1`.
   @throws std::invalid_argument if the matrix sizes are incompatible.
  */
 template <typename T, StoragePolicySwitch storagePolicy1,
-          StoragePolicySwitch storagePolicy2>
-MyMat0<T, ROWMAJOR>
-matMul(MyMat0<T, storagePolicy1> const &m1, MyMat0<T, storagePolicy2> const &m2)
+          StoragePolicySwitch storagePolicy2, class Alloc1, class Alloc2>
+MyMat0<T, ROWMAJOR, Alloc1>
+matMul(MyMat0<T, storagePolicy1, Alloc1> const &m1,
+       MyMat0<T, storagePolicy2, Alloc2> const &m2)
 {
   if(m1.ncol() != m2.nrow())
     throw std::invalid_argument("Incompatible matrix sizes in matMul");
-  MyMat0<T, ROWMAJOR> res(m1.nrow(), m2.ncol(), T{});
+  MyMat0<T, ROWMAJOR, Alloc1> res(m1.nrow(), m2.ncol(), T{});
   for(size_type i = 0; i < m1.nrow(); ++i)
     for(size_type j = 0; j < m2.ncol(); ++j)
       for(size_type k = 0; k < m2.nrow(); ++k)
@@ -1,13 +1,81 @@
 #include "MyMat0.hpp"
+#include "MyMat0_allocator.hpp"
+#include "MyMat0_blocked.hpp"
 #include "MyMat0_util.hpp"
 
 #include <benchmark/benchmark.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Counter of the calls of the global operator new, replaced below, so that
+// also the allocations that do not go through the AlignedPool (those of
+// std::vector, for instance) can be reported. The array and nothrow
+// versions forward to these by default.
+namespace
+{
+std::atomic<std::size_t> heapAllocations{0};
+}
+
+void *
+operator new(std::size_t bytes)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  if(void *p = std::malloc(bytes == 0 ? 1 : bytes))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *
+operator new(std::size_t bytes, std::align_val_t al)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  auto const alignment = static_cast<std::size_t>(al);
+  // aligned_alloc wants a size multiple of the alignment
+  auto const size = (bytes + alignment - 1) / alignment * alignment;
+  if(void *p = std::aligned_alloc(alignment, size == 0 ? alignment : size))
+    return p;
+  throw std::bad_alloc();
+}
+
+// free() is the right match for the operator new above, but gcc, seeing
+// both inlined, warns
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void
+operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void *p, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+#pragma GCC diagnostic pop
+
 namespace
 {
 using LinearAlgebra::COLUMNMAJOR;
 using LinearAlgebra::MyMat0;
+using LinearAlgebra::PoolAllocator;
 using LinearAlgebra::ROWMAJOR;
+using PooledMatrix = MyMat0<double, ROWMAJOR, PoolAllocator<double>>;
 
 // Utility used by all benchmarks: build a matrix of the requested size and
 // fill it with deterministic pseudo-random values so that runs are
@@ -84,6 +152,13 @@ runMatMulBenchmark(benchmark::State &state, Multiply multiply)
     }
 
   state.SetComplexityN(state.range(0));
+  // A product of two n x n matrices costs 2n^3 floating point operations.
+  // Reporting the rate makes the variants comparable with the peak of the
+  // machine, not only with each other.
+  auto const flops = 2.0 * static_cast<double>(n) * static_cast<double>(n) *
+                     static_cast<double>(n);
+  state.counters["GFLOP"] =
+    benchmark::Counter(flops * 1.e-9, benchmark::Counter::kIsIterationInvariantRate);
 }
 
 // Baseline triple-loop implementation.  The other benchmarks can be read as
@@ -129,6 +204,155 @@ BM_MatMulOpt_ColumnRow(benchmark::State &state)
     state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulOpt(a, b); });
 }
 
+// Cache-blocked multiplication with packed operands and SIMD micro-kernels,
+// single threaded so that it can be compared with the variants above.
+static void
+BM_MatMulBlocked_RowRow(benchmark::State &state)
+{
+  runMatMulBenchmark<MyMat0<double, ROWMAJOR>, MyMat0<double, ROWMAJOR>>(
+    state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulBlocked(a, b, 1u); });
+}
+
+// Packing hides the storage layout, so all combinations should perform
+// almost the same.
+static void
+BM_MatMulBlocked_RowColumn(benchmark::State &state)
+{
+  runMatMulBenchmark<MyMat0<double, ROWMAJOR>, MyMat0<double, COLUMNMAJOR>>(
+    state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulBlocked(a, b, 1u); });
+}
+
+static void
+BM_MatMulBlocked_ColumnColumn(benchmark::State &state)
+{
+  runMatMulBenchmark<MyMat0<double, COLUMNMAJOR>, MyMat0<double, COLUMNMAJOR>>(
+    state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulBlocked(a, b, 1u); });
+}
+
+static void
+BM_MatMulBlocked_ColumnRow(benchmark::State &state)
+{
+  runMatMulBenchmark<MyMat0<double, COLUMNMAJOR>, MyMat0<double, ROWMAJOR>>(
+    state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulBlocked(a, b, 1u); });
+}
+
+// Blocked multiplication on large matrices using all the available cores.
+// Wall-clock time is used (see UseRealTime below) since the work is spread
+// over several threads.
+static void
+BM_MatMulBlockedThreads_RowRow(benchmark::State &state)
+{
+  runMatMulBenchmark<MyMat0<double, ROWMAJOR>, MyMat0<double, ROWMAJOR>>(
+    state, [](auto const &a, auto const &b) { return LinearAlgebra::matMulBlocked(a, b); });
+#ifdef _OPENMP
+  state.counters["threads"] = omp_get_max_threads();
+#else
+  state.counters["threads"] = 1;
+#endif
+}
+
+// Resets the allocation counters, before the loop so that set-up is not
+// included.
+void
+resetAllocations()
+{
+  LinearAlgebra::AlignedPool::instance().resetStatistics();
+  heapAllocations = 0;
+}
+
+// Reports the allocations per iteration made through the AlignedPool: the
+// requests made to the pool and those the pool had to forward to the system.
+// heap/call counts all the calls of operator new, those of the pool included.
+void
+reportAllocations(benchmark::State &state)
+{
+  auto const heap = static_cast<double>(heapAllocations.load());
+  auto const stat = LinearAlgebra::AlignedPool::instance().statistics();
+  state.counters["pool/call"] =
+    benchmark::Counter(static_cast<double>(stat.requests),
+                       benchmark::Counter::kAvgIterations);
+  state.counters["system/call"] =
+    benchmark::Counter(static_cast<double>(stat.systemAllocations),
+                       benchmark::Counter::kAvgIterations);
+  state.counters["heap/call"] =
+    benchmark::Counter(heap, benchmark::Counter::kAvgIterations);
+}
+
+// Product returning a new matrix: every call asks for the storage of the
+// result and for the packing buffers.
+static void
+BM_MatMulReturn(benchmark::State &state)
+{
+  auto const   n = static_cast<std::size_t>(state.range(0));
+  PooledMatrix left(n, n);
+  PooledMatrix right(n, n);
+  left.fillRandom(1234U);
+  right.fillRandom(5678U);
+  resetAllocations();
+  for(auto _ : state)
+    {
+      auto result = LinearAlgebra::matMulBlocked(left, right, 1u);
+      benchmark::DoNotOptimize(result);
+      benchmark::ClobberMemory();
+    }
+  reportAllocations(state);
+}
+
+// In-place product on pooled matrices: after the first call only the
+// packing buffers are requested, and the pool recycles them.
+static void
+BM_MatMulInto(benchmark::State &state)
+{
+  auto const   n = static_cast<std::size_t>(state.range(0));
+  PooledMatrix left(n, n);
+  PooledMatrix right(n, n);
+  PooledMatrix result;
+  left.fillRandom(1234U);
+  right.fillRandom(5678U);
+  resetAllocations();
+  for(auto _ : state)
+    {
+      LinearAlgebra::matMulInto(result, left, right, 1u);
+      benchmark::DoNotOptimize(result);
+      benchmark::ClobberMemory();
+    }
+  reportAllocations(state);
+}
+
+// Matrix-vector product through operator*, which returns a new vector. The
+// vector uses the standard allocator, so its allocation shows in heap/call.
+static void
+BM_VecMultiplyReturn(benchmark::State &state)
+{
+  auto const n = static_cast<std::size_t>(state.range(0));
+  auto matrix = makeMatrix<ROWMAJOR>(n, n, 1234U);
+  std::vector<double> vec(n, 1.0);
+  resetAllocations();
+  for(auto _ : state)
+    {
+      auto result = matrix * vec;
+      benchmark::DoNotOptimize(result);
+    }
+  reportAllocations(state);
+}
+
+// Matrix-vector product writing in storage owned by the caller.
+static void
+BM_VecMultiplyInto(benchmark::State &state)
+{
+  auto const n = static_cast<std::size_t>(state.range(0));
+  auto matrix = makeMatrix<ROWMAJOR>(n, n, 1234U);
+  std::vector<double> vec(n, 1.0);
+  std::vector<double> result(n);
+  resetAllocations();
+  for(auto _ : state)
+    {
+      matrix.vecMultiplyInto(vec, result);
+      benchmark::DoNotOptimize(result);
+    }
+  reportAllocations(state);
+}
+
 #ifndef NOBLAS
 // BLAS-based benchmark with row-major storage for both operands.
 static void
@@ -186,6 +410,32 @@ BENCHMARK(BM_MatMulOpt_ColumnColumn)
   ->Range(64, 256)
   ->Complexity();
 BENCHMARK(BM_MatMulOpt_ColumnRow)->RangeMultiplier(2)->Range(64, 256)->Complexity();
+BENCHMARK(BM_MatMulBlocked_RowRow)->RangeMultiplier(2)->Range(64, 256)->Complexity();
+BENCHMARK(BM_MatMulBlocked_RowColumn)
+  ->RangeMultiplier(2)
+  ->Range(64, 256)
+  ->Complexity();
+BENCHMARK(BM_MatMulBlocked_ColumnColumn)
+  ->RangeMultiplier(2)
+  ->Range(64, 256)
+  ->Complexity();
+BENCHMARK(BM_MatMulBlocked_ColumnRow)
+  ->RangeMultiplier(2)
+  ->Range(64, 256)
+  ->Complexity();
+// The naive variants would take too long on these sizes.
+BENCHMARK(BM_MatMulBlockedThreads_RowRow)
+  ->Arg(1000)
+  ->Arg(2000)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+// Allocation-free versus allocating interfaces.  Small sizes are included
+// since there the cost of the allocation is relatively larger.
+BENCHMARK(BM_MatMulReturn)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK(BM_MatMulInto)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK(BM_VecMultiplyReturn)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK(BM_VecMultiplyInto)->RangeMultiplier(4)->Range(16, 1024);
 
 #ifndef NOBLAS
 BENCHMARK(BM_MatMulBlas_RowRow)->RangeMultiplier(2)->Range(64, 256)->Complexity();
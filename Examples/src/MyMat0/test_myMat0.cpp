@@ -1,8 +1,12 @@
 #include "MyMat0.hpp"
 #include "MyMat0_TypeTraitAndView/MyMat0_views.hpp"
+#include "MyMat0_allocator.hpp"
+#include "MyMat0_blocked.hpp"
 #include "MyMat0_util.hpp"
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 namespace
@@ -173,6 +177,79 @@ TEST(MyMat0Test, MatrixMultiplicationMatchesReferenceForAllLayouts)
   expectSameEntries(reference, LinearAlgebra::matMulOpt(crLeft, rcRight));
 }
 
+TEST(MyMat0Test, BlockedMultiplicationMatchesReferenceForAllLayouts)
+{
+  // Sizes are chosen so that no dimension is a multiple of the register or
+  // cache tiles: the border tiles are the delicate part of the algorithm.
+  auto left = MyMat0<double, ROWMAJOR>(131, 277);
+  auto right = MyMat0<double, ROWMAJOR>(277, 45);
+  left.fillRandom(1234U);
+  right.fillRandom(5678U);
+  auto const leftC = MyMat0<double, COLUMNMAJOR>(left);
+  auto const rightC = MyMat0<double, COLUMNMAJOR>(right);
+  auto const reference = LinearAlgebra::matMul(left, right);
+
+  auto expectClose = [&reference](auto const &result)
+  {
+    ASSERT_EQ(result.nrow(), reference.nrow());
+    ASSERT_EQ(result.ncol(), reference.ncol());
+    for(std::size_t i = 0; i < reference.nrow(); ++i)
+      for(std::size_t j = 0; j < reference.ncol(); ++j)
+        EXPECT_NEAR(result(i, j), reference(i, j), 1.e-12 * 277);
+  };
+  // Both the serial and the multithreaded driver are exercised
+  for(unsigned int nThreads : {1u, 3u})
+    {
+      expectClose(LinearAlgebra::matMulBlocked(left, right, nThreads));
+      expectClose(LinearAlgebra::matMulBlocked(left, rightC, nThreads));
+      expectClose(LinearAlgebra::matMulBlocked(leftC, right, nThreads));
+      expectClose(LinearAlgebra::matMulBlocked(leftC, rightC, nThreads));
+    }
+}
+
+TEST(MyMat0Test, VectorMultiplicationIntoCallerStorage)
+{
+  // The result is written in the memory given by the caller, whose size must
+  // be correct.
+  auto const m = makeReferenceMatrix<COLUMNMAJOR>();
+  std::vector<double> const v{1.0, 2.0, 3.0};
+  std::array<double, 2>     result{};
+  m.vecMultiplyInto(v, result);
+  EXPECT_DOUBLE_EQ(result[0], 6.0);
+  EXPECT_DOUBLE_EQ(result[1], -4.0);
+  std::vector<double> wrong(3);
+  EXPECT_THROW(m.vecMultiplyInto(v, wrong), std::invalid_argument);
+}
+
+TEST(MyMat0Test, PooledMatrixProductReusesMemory)
+{
+  // Matrices using the pool allocator behave like the standard ones, and
+  // repeating an in-place product does not ask the system for memory.
+  using Pooled = MyMat0<double, ROWMAJOR, LinearAlgebra::PoolAllocator<double>>;
+  Pooled left(70, 40);
+  Pooled right(40, 30);
+  left.fillRandom(1U);
+  right.fillRandom(2U);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&left[0]) % 64u, 0u);
+
+  Pooled result;
+  LinearAlgebra::matMulInto(result, left, right, 1u);
+  auto const reference = LinearAlgebra::matMul(left, right);
+  for(std::size_t i = 0; i < reference.nrow(); ++i)
+    for(std::size_t j = 0; j < reference.ncol(); ++j)
+      EXPECT_NEAR(result(i, j), reference(i, j), 1.e-12 * 40);
+
+  auto &pool = LinearAlgebra::AlignedPool::instance();
+  { auto temporary = LinearAlgebra::matMulBlocked(left, right, 1u); }
+  auto const before = pool.statistics().systemAllocations;
+  // The storage of the result and of the packing buffers is reused...
+  LinearAlgebra::matMulInto(result, left, right, 1u);
+  EXPECT_EQ(pool.statistics().systemAllocations, before);
+  // ...and the memory of a destroyed temporary is recycled
+  { auto temporary = LinearAlgebra::matMulBlocked(left, right, 1u); }
+  EXPECT_EQ(pool.statistics().systemAllocations, before);
+}
+
 TEST(MyMat0Test, MatrixMultiplicationThrowsOnWrongSize)
 {
   // Multiplication with incompatible dimensions must fail deterministically.
@@ -181,6 +258,11 @@ TEST(MyMat0Test, MatrixMultiplicationThrowsOnWrongSize)
   EXPECT_THROW(static_cast<void>(LinearAlgebra::matMul(a, b)), std::invalid_argument);
   EXPECT_THROW(static_cast<void>(LinearAlgebra::matMulOpt(a, b)),
                std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(LinearAlgebra::matMulBlocked(a, b)),
+               std::invalid_argument);
+  // The in-place product cannot overwrite one of its operands
+  MyMat0<double, ROWMAJOR> c(3, 3, 1.0);
+  EXPECT_THROW(LinearAlgebra::matMulInto(c, c, c), std::invalid_argument);
 }
 
 TEST(MyMat0Test, ResizePreservesWhenElementCountMatches)
@@ -8,6 +8,9 @@
 #include <cmath>
 #include <limits>
 #include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 apsc::DiscreteJacobian::ArgumentType
 apsc::DiscreteJacobian::solve(const ArgumentType &x,
@@ -43,6 +46,109 @@ apsc::DiscreteJacobian::solve(const ArgumentType &x,
   return J.fullPivLu().solve(b);
 }
 
+void
+apsc::SparseDiscreteJacobian::setPattern(SparseMatrixType const &pattern)
+{
+  if(pattern.rows() != pattern.cols())
+    throw std::invalid_argument("ERROR: The Jacobian pattern must be square");
+  Eigen::Index const n = pattern.cols();
+  // The pattern, with the diagonal, in compressed column-major form. Only
+  // the structure of the given matrix is used, not its values
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(pattern.nonZeros() + n);
+  for(Eigen::Index j = 0; j < n; ++j)
+    {
+      entries.emplace_back(j, j, 0.);
+      for(SparseMatrixType::InnerIterator it(pattern, j); it; ++it)
+        entries.emplace_back(it.row(), j, 0.);
+    }
+  M_J.resize(n, n);
+  M_J.setFromTriplets(entries.begin(), entries.end());
+  M_J.makeCompressed();
+  // The pattern row by row, to find the columns sharing a row
+  using RowMajorMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  RowMajorMatrix const rows = M_J;
+  // Greedy coloring, in the natural order of the columns: a column takes
+  // the first color not used by the columns sharing a row with it
+  std::vector<Eigen::Index> color(n, -1);
+  // forbidden[c]==j if color c is used by a neighbour of column j
+  std::vector<Eigen::Index> forbidden;
+  M_colors.clear();
+  for(Eigen::Index j = 0; j < n; ++j)
+    {
+      for(SparseMatrixType::InnerIterator col(M_J, j); col; ++col)
+        for(RowMajorMatrix::InnerIterator row(rows, col.row()); row; ++row)
+          if(color[row.col()] >= 0)
+            forbidden[color[row.col()]] = j;
+      Eigen::Index c = 0;
+      while(c < static_cast<Eigen::Index>(forbidden.size()) &&
+            forbidden[c] == j)
+        ++c;
+      if(c == static_cast<Eigen::Index>(forbidden.size()))
+        {
+          forbidden.push_back(-1);
+          M_colors.emplace_back();
+        }
+      color[j] = c;
+      M_colors[c].push_back(j);
+    }
+  M_analyzed = false;
+}
+
+apsc::SparseDiscreteJacobian::ArgumentType
+apsc::SparseDiscreteJacobian::solve(const ArgumentType &x,
+                                    const ArgumentType &b) const
+{
+  if(!M_sys)
+    throw std::runtime_error("ERROR: Non linear system not set in Jacobian");
+  if(M_J.cols() != x.size())
+    throw std::runtime_error(
+      "ERROR: Sparsity pattern not set, or of the wrong size, in Jacobian");
+  double const two_tol = 2 * tol;
+  auto const   numColors = static_cast<long>(M_colors.size());
+  // Each entry belongs to a single column, so to a single color: the
+  // colors write different entries of M_J
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(long c = 0; c < numColors; ++c)
+    {
+      ArgumentType x1(x);
+      ArgumentType x2(x);
+      for(auto j : M_colors[c])
+        {
+          x1[j] -= tol;
+          x2[j] += tol;
+        }
+      ArgumentType r2 = (*M_sys)(x2);
+      r2 -= (*M_sys)(x1);
+      r2 /= two_tol; // Finite difference
+      for(auto j : M_colors[c])
+        for(SparseMatrixType::InnerIterator it(M_J, j); it; ++it)
+          it.valueRef() = r2[it.row()] + (it.row() == j ? lambda : 0.);
+    }
+  if(M_linearSolver == LinearSolver::BiCGSTAB)
+    {
+      M_bicgstab.compute(M_J);
+      ArgumentType result = M_bicgstab.solve(b);
+      if(M_bicgstab.info() != Eigen::Success)
+        throw std::runtime_error("ERROR: BiCGSTAB did not converge in Jacobian");
+      return result;
+    }
+  // The pattern does not change: the symbolic analysis is done once
+  if(!M_analyzed)
+    {
+      M_lu.analyzePattern(M_J);
+      M_analyzed = true;
+    }
+  M_lu.factorize(M_J);
+  if(M_lu.info() != Eigen::Success)
+    throw std::runtime_error("ERROR: Sparse LU factorization failed in "
+                             "Jacobian: "
+                             + M_lu.lastErrorMessage());
+  return M_lu.solve(b);
+}
+
 apsc::FullJacobian::ArgumentType
 apsc::FullJacobian::solve(const ArgumentType &x, ArgumentType const &b) const
 {
@@ -8,6 +8,8 @@
 #ifndef NONLINSYSSOLVER_JACOBIAN_HPP_
 #define NONLINSYSSOLVER_JACOBIAN_HPP_
 #include "NewtonTraits.hpp"
+#include <Eigen/Sparse>
+#include <vector>
 namespace apsc
 {
 //! @brief The base class for the Jacobian.
@@ -104,6 +106,157 @@ private:
   static double constexpr defaultLambda = 0.0;
 };
 
+//! @brief Computes a sparse Jacobian by colored finite differences.
+/*!
+  @details Final class that approximates the Jacobian, as DiscreteJacobian,
+  by centered finite differences, for systems whose Jacobian has a known
+  sparsity pattern (as those coming from the discretization of PDEs).
+
+  The columns are grouped by a greedy coloring: two columns have the same
+  color if they have no nonzero in the same row. Then the columns of a group
+  can be computed together, by perturbing all their variables at once: the
+  difference of the residuals in row i gives the entry of the only column
+  of the group with a nonzero in row i (Curtis, Powell and Reid). The
+  residual is evaluated twice per color, instead of twice per variable:
+  for a banded Jacobian the number of colors is the bandwidth.
+
+  The entries are stored in an Eigen sparse matrix, with the given pattern,
+  and the system is solved by a sparse LU factorization (whose symbolic
+  analysis is computed only once, since the pattern does not change), or by
+  BiCGSTAB preconditioned with an incomplete LU.
+
+  If compiled with OpenMP the color groups are processed in parallel, so the
+  non linear system must be callable concurrently.
+
+  @note The diagonal is always added to the pattern.
+ */
+class SparseDiscreteJacobian final : public JacobianBase
+{
+public:
+  //! The type of the sparse Jacobian
+  using SparseMatrixType = Eigen::SparseMatrix<double>;
+  //! The linear solvers
+  enum class LinearSolver
+  {
+    SparseLU, //!< Sparse LU factorization
+    BiCGSTAB  //!< BiCGSTAB with incomplete LU preconditioner
+  };
+  //! Constructor optionally takes the pointer to a non linear system.
+  /*!
+   * @param sys The non linear system
+   * @param spacing The spacing |h| for the computation of the approximate
+   * derivative
+   * @param lambda The regularization parameter
+   */
+  SparseDiscreteJacobian(NonLinearSystemType const *sys = nullptr,
+                         double spacing = defaultTol,
+                         double lambda = defaultLambda)
+    : JacobianBase{sys}, tol{spacing}, lambda{lambda}
+  {}
+  //! Constructor taking the sparsity pattern (see setPattern())
+  /*!
+   * @param pattern The sparsity pattern of the Jacobian
+   * @param sys The non linear system
+   * @param spacing The spacing |h| for the computation of the approximate
+   * derivative
+   * @param lambda The regularization parameter
+   */
+  explicit SparseDiscreteJacobian(SparseMatrixType const  &pattern,
+                                  NonLinearSystemType const *sys = nullptr,
+                                  double spacing = defaultTol,
+                                  double lambda = defaultLambda)
+    : SparseDiscreteJacobian{sys, spacing, lambda}
+  {
+    setPattern(pattern);
+  }
+  //! Copies the pattern and the options (the factorization is recomputed)
+  SparseDiscreteJacobian(SparseDiscreteJacobian const &other)
+    : JacobianBase{other}, tol{other.tol}, lambda{other.lambda},
+      M_J{other.M_J}, M_colors{other.M_colors},
+      M_linearSolver{other.M_linearSolver}
+  {}
+  //! Copies the pattern and the options (the factorization is recomputed)
+  SparseDiscreteJacobian &
+  operator=(SparseDiscreteJacobian const &other)
+  {
+    if(this != &other)
+      {
+        JacobianBase::operator=(other);
+        tol = other.tol;
+        lambda = other.lambda;
+        M_J = other.M_J;
+        M_colors = other.M_colors;
+        M_linearSolver = other.M_linearSolver;
+        M_analyzed = false;
+      }
+    return *this;
+  }
+  /*!
+   * @brief Sets the sparsity pattern and computes the coloring
+   * @param pattern A square matrix whose (structural) nonzero entries are
+   * those of the Jacobian. The values are not used.
+   */
+  void setPattern(SparseMatrixType const &pattern);
+  //! Sets the linear solver
+  void
+  setLinearSolver(LinearSolver s)
+  {
+    M_linearSolver = s;
+  }
+  //! The number of colors, i.e. of pairs of evaluations of the residual
+  std::size_t
+  numColors() const
+  {
+    return M_colors.size();
+  }
+  //! The last computed Jacobian
+  SparseMatrixType const &
+  jacobian() const
+  {
+    return M_J;
+  }
+  //! Solves the system
+  /*!
+   * @param x the point where to evaluate the Jacobian
+   * @param b the right hand side of the system J(x) y=b
+   * @return The result
+   */
+  ArgumentType solve(ArgumentType const &x,
+                     ArgumentType const &b) const override;
+  /*!
+    @brief Set the parameters for the computation of the Jacobian
+    @param tol The spacing |h| for the computation of the approximate derivative
+    @param lambda The regularization parameter
+  */
+  void
+  setParameters(double tol = defaultTol, double lambda = defaultLambda)
+  {
+    this->tol = tol;
+    this->lambda = lambda;
+  }
+  //! The current spacing |h|
+  double tol = defaultTol;
+  //! Regularization (if needed)
+  double lambda = defaultLambda;
+
+private:
+  //! Default tolerance.
+  static double constexpr defaultTol = 1e-4;
+  static double constexpr defaultLambda = 0.0;
+  //! The Jacobian, with the pattern. Mutable because filled by solve()
+  mutable SparseMatrixType M_J;
+  //! The columns of each color
+  std::vector<std::vector<Eigen::Index>> M_colors;
+  LinearSolver                           M_linearSolver = LinearSolver::SparseLU;
+  //! The sparse LU solver (it keeps the symbolic analysis)
+  mutable Eigen::SparseLU<SparseMatrixType> M_lu;
+  //! The iterative solver
+  mutable Eigen::BiCGSTAB<SparseMatrixType, Eigen::IncompleteLUT<double>>
+    M_bicgstab;
+  //! True if the symbolic analysis of the LU has been done
+  mutable bool M_analyzed = false;
+};
+
 /*!
  * The identityJacobian just scales the residual by a factor defaulted to 1
  * by default \f$\lambda\f$ is one.
@@ -12,6 +12,7 @@
 #include "Jacobian.hpp"
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 namespace apsc
 {
 //! Enumerator for different Jacobians
@@ -28,15 +29,47 @@ enum class JacobianKind : int
   FullJacobian = 2,
   BroydenB = 3,
   BroydenG = 4,
-  EirolaNevanlinna = 5
+  EirolaNevanlinna = 5,
+  SparseDiscreteJacobian = 6
 };
 
+namespace internals
+{
+  //! True if the first of the arguments is a sparsity pattern
+  template <typename... Args> struct firstIsPattern : std::false_type
+  {};
+  template <typename First, typename... Args>
+  struct firstIsPattern<First, Args...>
+    : std::is_convertible<First,
+                          SparseDiscreteJacobian::SparseMatrixType const &>
+  {};
+  //! Creates a T from the arguments, throws if it is not possible
+  template <class T, typename... Args>
+  std::unique_ptr<apsc::JacobianBase>
+  make_if_constructible(Args &&...args)
+  {
+    if constexpr(std::is_constructible_v<T, Args &&...>)
+      return std::make_unique<T>(std::forward<Args>(args)...);
+    else
+      throw std::invalid_argument(
+        "Error in make_Jacobian: invalid arguments for this JacobianKind");
+  }
+} // namespace internals
+
 //! A simple factory that returns a JacobianBase polymorphic object wrapped in a
 //! unique_ptr
 //!
 //! \param kind The kind of Jacobian type class you want
 //! \param args Optional arguments to be forwarded to the constructor
 //!
+//! A SparseDiscreteJacobian needs the sparsity pattern as first argument,
+//! for instance
+//! \code
+//!  auto J = make_Jacobian(JacobianKind::SparseDiscreteJacobian, pattern);
+//! \endcode
+//! \throw std::invalid_argument if the Jacobian of the given kind cannot be
+//! built from the arguments
+//!
 template <typename... Args>
 [[nodiscard]] std::unique_ptr<apsc::JacobianBase>
 make_Jacobian(JacobianKind kind, Args &&...args)
@@ -44,20 +77,32 @@ make_Jacobian(JacobianKind kind, Args &&...args)
   switch(kind)
     {
     case JacobianKind::DiscreteJacobian:
-      return std::make_unique<apsc::DiscreteJacobian>(
+      return internals::make_if_constructible<apsc::DiscreteJacobian>(
         std::forward<Args>(args)...);
     case JacobianKind::IdentityJacobian:
-      return std::make_unique<apsc::IdentityJacobian>(
+      return internals::make_if_constructible<apsc::IdentityJacobian>(
         std::forward<Args>(args)...);
     case JacobianKind::FullJacobian:
-      return std::make_unique<apsc::FullJacobian>(std::forward<Args>(args)...);
+      return internals::make_if_constructible<apsc::FullJacobian>(
+        std::forward<Args>(args)...);
     case JacobianKind::BroydenB:
-      return std::make_unique<apsc::BroydenB>(std::forward<Args>(args)...);
+      return internals::make_if_constructible<apsc::BroydenB>(
+        std::forward<Args>(args)...);
     case JacobianKind::BroydenG:
-      return std::make_unique<apsc::BroydenG>(std::forward<Args>(args)...);
+      return internals::make_if_constructible<apsc::BroydenG>(
+        std::forward<Args>(args)...);
     case JacobianKind::EirolaNevanlinna:
-      return std::make_unique<apsc::Eirola_Nevanlinna>(
+      return internals::make_if_constructible<apsc::Eirola_Nevanlinna>(
         std::forward<Args>(args)...);
+    case JacobianKind::SparseDiscreteJacobian:
+      // Without the pattern solve() would fail
+      if constexpr(internals::firstIsPattern<Args...>::value)
+        return internals::make_if_constructible<apsc::SparseDiscreteJacobian>(
+          std::forward<Args>(args)...);
+      else
+        throw std::invalid_argument(
+          "Error in make_Jacobian: SparseDiscreteJacobian needs the sparsity "
+          "pattern as first argument");
     default:
       throw std::runtime_error(
         "Error in JacobianKind: You must specify a valid type");
@@ -0,0 +1,201 @@
+/*
+ * JacobianFreeNewtonKrylov.hpp
+ *
+ *  Jacobian-free Newton-Krylov correction for the Newton solver
+ */
+
+#ifndef NONLINSYSSOLVER_JACOBIANFREENEWTONKRYLOV_HPP_
+#define NONLINSYSSOLVER_JACOBIANFREENEWTONKRYLOV_HPP_
+#include "Jacobian.hpp"
+#include "gmres.hpp" // from LinearAlgebra/IML_Eigen/include
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+namespace apsc
+{
+//! @brief Jacobian-free Newton-Krylov (JFNK).
+/*!
+  @details The Newton correction \f$J(x)d=b\f$ is computed by GMRES (the
+  IML++ version in LinearAlgebra/IML_Eigen), which needs only the product of
+  the Jacobian with a vector. It is approximated by a finite difference in
+  the direction of the vector
+
+  \f[
+      J(x)v \simeq \frac{F(x+\epsilon v)-F(x)}{\epsilon},\quad
+      \epsilon=\frac{\sqrt{\epsilon_M}(1+|x|)}{|v|},
+  \f]
+
+  so the Jacobian is never formed, nor stored: the memory is that of the
+  Krylov basis, restart+1 vectors, and each GMRES iteration costs an
+  evaluation of F.
+
+  The linear system is solved inexactly, with relative tolerance given by
+  the forcing term of Eisenstat and Walker (choice 2):
+  \f$\eta_k=\gamma(|F(x_k)|/|F(x_{k-1})|)^\alpha\f$, with the safeguard
+  \f$\eta_k\ge\gamma\eta_{k-1}^\alpha\f$ if the latter is greater than 0.1,
+  and \f$\eta_k\le\eta_{max}\f$. So the linear solves are cheap far from the
+  solution and accurate only when Newton converges quadratically.
+
+  An optional (left) preconditioner may be given, as a function returning
+  the approximation of \f$J^{-1}v\f$. It is essential for problems coming
+  from the discretization of PDEs.
+
+  @note The right hand side b must be the residual F(x), as in Newton: it is
+  used for the finite differences. If GMRES does not reach the tolerance
+  the last iterate is returned anyway (inexact Newton), and the failure is
+  counted.
+ */
+class JacobianFreeNewtonKrylov final : public JacobianBase
+{
+public:
+  //! The preconditioner: returns the approximation of J^{-1}v
+  using PreconditionerType = std::function<ArgumentType(ArgumentType const &)>;
+  //! The parameters of GMRES and of the forcing terms
+  struct Options
+  {
+    //! Restart of GMRES (the number of stored vectors)
+    int restart = 30;
+    //! Max number of GMRES iterations for a Newton step
+    int maxIter = 300;
+    //! The forcing term of the first step
+    double etaInit = 0.5;
+    //! Max forcing term
+    double etaMax = 0.9;
+    //! The parameters of choice 2 of Eisenstat and Walker
+    double gamma = 0.9;
+    double alpha = 2.;
+  };
+  //! Statistics, cumulated since the non linear system has been set
+  struct Statistics
+  {
+    //! Number of solve() calls (Newton steps)
+    unsigned int steps{0u};
+    //! Total GMRES iterations
+    long linearIterations{0};
+    //! Evaluations of the non linear system in the Jacobian-vector products
+    long evaluations{0};
+    //! Number of GMRES not converged
+    unsigned int failures{0u};
+    //! The last forcing term
+    double eta{0.};
+  };
+
+  using JacobianBase::JacobianBase;
+  //! Constructor taking the options
+  explicit JacobianFreeNewtonKrylov(Options const &options,
+                                    NonLinearSystemType const *nls = nullptr)
+    : JacobianBase{nls}, M_options{options}
+  {}
+  //! Sets the options
+  void
+  setOptions(Options const &options)
+  {
+    M_options = options;
+  }
+  //! Sets the preconditioner (an empty function means no preconditioner)
+  void
+  setPreconditioner(PreconditionerType const &p)
+  {
+    M_preconditioner = p;
+  }
+  //! Sets the non linear system, and restarts the forcing terms
+  void
+  setNonLinSys(NonLinearSystemType const *s) override
+  {
+    JacobianBase::setNonLinSys(s);
+    M_statistics = Statistics{};
+    M_previousResidualNorm = 0.;
+  }
+  //! The statistics
+  Statistics const &
+  statistics() const
+  {
+    return M_statistics;
+  }
+  //! Solves \f$J(x) d = b\f$ with b=F(x)
+  //! \param x The point to compute residual
+  //! \param b The right hand side, the residual at x
+  //! \return The Newton correction
+  ArgumentType solve(ArgumentType const &x,
+                     ArgumentType const &b) const override;
+
+private:
+  //! The product of the Jacobian with a vector, by finite differences
+  struct JacobianTimes
+  {
+    NonLinearSystemType const &F;
+    ArgumentType const        &x;
+    ArgumentType const        &Fx;
+    long                      &evaluations;
+    ArgumentType
+    operator*(ArgumentType const &v) const
+    {
+      double const normV = v.norm();
+      if(normV == 0.)
+        return ArgumentType::Zero(v.size());
+      double const epsilon =
+        std::sqrt(std::numeric_limits<double>::epsilon()) * (1. + x.norm()) /
+        normV;
+      ++evaluations;
+      return (F(x + epsilon * v) - Fx) / epsilon;
+    }
+  };
+  //! Adapts the preconditioner to the interface of the IML solvers
+  struct Preconditioner
+  {
+    PreconditionerType const &P;
+    ArgumentType
+    solve(ArgumentType const &v) const
+    {
+      return P ? P(v) : v;
+    }
+  };
+  Options            M_options;
+  PreconditionerType M_preconditioner;
+  //! Mutable because changed by solve()
+  mutable Statistics M_statistics;
+  //! The residual norm at the previous step (0 at the first step)
+  mutable double M_previousResidualNorm = 0.;
+};
+
+inline JacobianFreeNewtonKrylov::ArgumentType
+JacobianFreeNewtonKrylov::solve(ArgumentType const &x,
+                                ArgumentType const &b) const
+{
+  if(!M_sys)
+    throw std::runtime_error("ERROR: Non linear system not set in Jacobian");
+  auto const &[restart, maxIter, etaInit, etaMax, gamma, alpha] = M_options;
+  double const residualNorm = b.norm();
+  // The forcing term (Eisenstat-Walker, choice 2)
+  double eta = etaInit;
+  if(M_previousResidualNorm > 0.)
+    {
+      eta = gamma * std::pow(residualNorm / M_previousResidualNorm, alpha);
+      double const safeguard = gamma * std::pow(M_statistics.eta, alpha);
+      if(safeguard > 0.1)
+        eta = std::max(eta, safeguard);
+    }
+  eta = std::min(eta, etaMax);
+  M_previousResidualNorm = residualNorm;
+  M_statistics.eta = eta;
+  ++M_statistics.steps;
+
+  ArgumentType   delta = ArgumentType::Zero(x.size());
+  JacobianTimes  J{*M_sys, x, b, M_statistics.evaluations};
+  Preconditioner P{M_preconditioner};
+  int            m = restart;
+  int            iterations = maxIter;
+  double         tol = eta;
+  int const      status =
+    LinearAlgebra::GMRES(J, delta, b, P, m, iterations, tol);
+  M_statistics.linearIterations += iterations;
+  if(status != 0)
+    ++M_statistics.failures;
+  return delta;
+}
+
+} // namespace apsc
+
+#endif /* NONLINSYSSOLVER_JACOBIANFREENEWTONKRYLOV_HPP_ */
@@ -0,0 +1,141 @@
+/*
+ * main_jfnk.cpp
+ *
+ *  Newton with the Jacobian-free Newton-Krylov correction, compared with
+ *  the finite difference Jacobian and with Broyden (bad), on the Bratu
+ *  problem -u''=lambda exp(u) in (0,1), u(0)=u(1)=0, discretized by finite
+ *  differences with n unknowns, n from 10^3 to 10^6.
+ *
+ *  The dense methods store an n x n matrix: they are run only for small n.
+ *  JFNK is run with the (tridiagonal) discrete Laplacian as preconditioner,
+ *  and, only for n=1000, without preconditioner: the condition number grows
+ *  like n^2, and so do the GMRES iterations.
+ *
+ *  The memory is that of the data of the Jacobian approximation: the matrix
+ *  (and its LU factorization) for the dense methods, the Krylov basis and
+ *  the preconditioner for JFNK.
+ *
+ *  Usage: main_jfnk [maxN] (10^6 by default)
+ */
+#include "JacobianFactory.hpp"
+#include "JacobianFreeNewtonKrylov.hpp"
+#include "Newton.hpp"
+#include "chrono.hpp"
+#include "tridiagonalSystem.hpp"
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+namespace
+{
+using ArgumentType = apsc::NewtonTraits::ArgumentType;
+constexpr double lambda = 1.;
+//! The counter of the evaluations of the residual
+long evaluations = 0;
+
+//! The residual of the problem with n unknowns
+struct Bratu
+{
+  Eigen::Index n;
+  ArgumentType
+  operator()(ArgumentType const &u) const
+  {
+    ++evaluations;
+    double const h2 = 1. / ((n + 1.) * (n + 1.));
+    ArgumentType r(n);
+    for(Eigen::Index i = 0; i < n; ++i)
+      r[i] = (2. * u[i] - (i > 0 ? u[i - 1] : 0.) -
+              (i + 1 < n ? u[i + 1] : 0.)) /
+               h2 -
+             lambda * std::exp(u[i]);
+    return r;
+  }
+};
+
+//! The discrete Laplacian as preconditioner
+struct Laplacian
+{
+  explicit Laplacian(Eigen::Index n)
+    : a(n, 2. * (n + 1.) * (n + 1.)), b(n, -(n + 1.) * (n + 1.)), c(b)
+  {}
+  ArgumentType
+  operator()(ArgumentType const &v) const
+  {
+    std::vector<double> const f(v.begin(), v.end());
+    auto const x = apsc::LinearAlgebra::thomasSolve(a, b, c, f);
+    return Eigen::Map<ArgumentType const>(x.data(), v.size());
+  }
+  std::vector<double> a, b, c;
+};
+
+void
+run(std::string const &name, Eigen::Index n,
+    std::unique_ptr<apsc::JacobianBase> jacobian, double memory)
+{
+  apsc::NewtonOptions options;
+  // The norms grow like sqrt(n). Moreover, the residual cannot be computed
+  // with an error less than about eps/h^2
+  double const rms =
+    std::max(1.e-8, 10. * std::numeric_limits<double>::epsilon() * (n + 1.) *
+                      (n + 1.));
+  options.tolerance = rms * std::sqrt(n);
+  options.minRes = rms * std::sqrt(n);
+  options.maxIter = 100;
+  auto const     *jfnk =
+    dynamic_cast<apsc::JacobianFreeNewtonKrylov const *>(jacobian.get());
+  apsc::Newton    newton(Bratu{n}, std::move(jacobian), options);
+  Timings::Chrono clock;
+  evaluations = 0;
+  clock.start();
+  auto result = newton.solve(ArgumentType::Zero(n));
+  clock.stop();
+  std::cout << std::setw(9) << n << "  " << std::left << std::setw(18) << name
+            << std::right << std::setw(11) << std::setprecision(4)
+            << memory / (1024. * 1024.) << std::setw(11)
+            << clock.wallTime() * 1.e-3 << std::setw(6) << result.iterations
+            << std::setw(10) << evaluations << std::setw(8)
+            << (jfnk ? jfnk->statistics().linearIterations : 0)
+            << std::setw(11) << std::scientific << std::setprecision(2)
+            << result.residualNorm / std::sqrt(n) << std::defaultfloat
+            << std::setw(6) << result.converged << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  Eigen::Index const maxN = argc > 1 ? std::stol(argv[1]) : 1000000;
+  // Beyond this size the dense methods take too much time and memory
+  Eigen::Index constexpr maxDense = 2000;
+  // and JFNK without preconditioner too many iterations
+  Eigen::Index constexpr maxUnpreconditioned = 1000;
+  apsc::JacobianFreeNewtonKrylov::Options const jfnkOptions;
+  std::cout << std::boolalpha << std::setw(9) << "n"
+            << "  " << std::left << std::setw(18) << "Jacobian" << std::right
+            << std::setw(11) << "memory(MB)" << std::setw(11) << "time (ms)"
+            << std::setw(6) << "iter" << std::setw(10) << "F evals"
+            << std::setw(8) << "GMRES" << std::setw(11) << "rms(F)"
+            << std::setw(6) << "conv" << '\n';
+  for(Eigen::Index n = 1000; n <= maxN; n *= 10)
+    {
+      double const dense = 8. * n * n;
+      double const krylov = 8. * n * (jfnkOptions.restart + 1);
+      if(n <= maxDense)
+        {
+          run("DiscreteJacobian", n,
+              apsc::make_Jacobian(apsc::JacobianKind::DiscreteJacobian),
+              2. * dense);
+          run("BroydenB", n, apsc::make_Jacobian(apsc::JacobianKind::BroydenB),
+              dense);
+        }
+      if(n <= maxUnpreconditioned)
+        run("JFNK", n,
+            std::make_unique<apsc::JacobianFreeNewtonKrylov>(jfnkOptions),
+            krylov);
+      auto jfnk = std::make_unique<apsc::JacobianFreeNewtonKrylov>(jfnkOptions);
+      jfnk->setPreconditioner(Laplacian(n));
+      run("JFNK, Laplacian", n, std::move(jfnk), krylov + 8. * 3 * n);
+    }
+}
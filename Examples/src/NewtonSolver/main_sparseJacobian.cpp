@@ -0,0 +1,152 @@
+/*
+ * main_sparseJacobian.cpp
+ *
+ *  Newton with the dense and the sparse (colored) finite difference
+ *  Jacobians on the Bratu problem -Laplacian(u) = lambda exp(u), u=0 on the
+ *  boundary, discretized by finite differences on (0,1) and on (0,1)^2
+ *  (5-point stencil).
+ *
+ *  Usage: main_sparseJacobian [n2D] (the large 2D grid is n2D x n2D, 200 by
+ *  default)
+ */
+#include "Jacobian.hpp"
+#include "JacobianFactory.hpp"
+#include "Newton.hpp"
+#include "chrono.hpp"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace
+{
+using ArgumentType = apsc::NewtonTraits::ArgumentType;
+using SparseMatrix = apsc::SparseDiscreteJacobian::SparseMatrixType;
+constexpr double lambda = 1.;
+
+//! The counter of the evaluations of the residual (it may be concurrent)
+std::atomic<long> evaluations{0};
+
+//! The problem on a grid of n (or n x n) internal points
+struct Bratu
+{
+  Eigen::Index n;
+  bool         twoD;
+  Eigen::Index
+  size() const
+  {
+    return twoD ? n * n : n;
+  }
+  //! The residual
+  ArgumentType
+  operator()(ArgumentType const &u) const
+  {
+    ++evaluations;
+    double const h2 = 1. / ((n + 1.) * (n + 1.));
+    ArgumentType r(size());
+    auto         at = [&u](Eigen::Index k, bool inside) {
+      return inside ? u[k] : 0.;
+    };
+    if(!twoD)
+      for(Eigen::Index i = 0; i < n; ++i)
+        r[i] = (2. * u[i] - at(i - 1, i > 0) - at(i + 1, i + 1 < n)) / h2 -
+               lambda * std::exp(u[i]);
+    else
+      for(Eigen::Index j = 0; j < n; ++j)
+        for(Eigen::Index i = 0; i < n; ++i)
+          {
+            Eigen::Index const k = i + j * n;
+            r[k] = (4. * u[k] - at(k - 1, i > 0) - at(k + 1, i + 1 < n) -
+                    at(k - n, j > 0) - at(k + n, j + 1 < n)) /
+                     h2 -
+                   lambda * std::exp(u[k]);
+          }
+    return r;
+  }
+  //! The sparsity pattern of the Jacobian
+  SparseMatrix
+  pattern() const
+  {
+    std::vector<Eigen::Triplet<double>> entries;
+    Eigen::Index const                  stride = twoD ? n : size();
+    for(Eigen::Index k = 0; k < size(); ++k)
+      {
+        Eigen::Index const i = k % stride;
+        entries.emplace_back(k, k, 1.);
+        if(i > 0)
+          entries.emplace_back(k, k - 1, 1.);
+        if(i + 1 < stride)
+          entries.emplace_back(k, k + 1, 1.);
+        if(twoD && k >= n)
+          entries.emplace_back(k, k - n, 1.);
+        if(twoD && k + n < size())
+          entries.emplace_back(k, k + n, 1.);
+      }
+    SparseMatrix p(size(), size());
+    p.setFromTriplets(entries.begin(), entries.end());
+    return p;
+  }
+};
+
+//! Solves with a Jacobian and prints a line of the table
+template <class Jacobian>
+ArgumentType
+run(std::string const &name, Bratu const &problem, Jacobian const &jacobian)
+{
+  apsc::NewtonOptions options;
+  options.tolerance = 1.e-8;
+  options.minRes = 1.e-8;
+  apsc::Newton    newton(problem, jacobian, options);
+  Timings::Chrono clock;
+  evaluations = 0;
+  clock.start();
+  auto result = newton.solve(ArgumentType::Zero(problem.size()));
+  clock.stop();
+  std::cout << std::left << std::setw(22) << name << std::right
+            << std::setw(12) << std::setprecision(4)
+            << clock.wallTime() * 1.e-3 << std::setw(8) << result.iterations
+            << std::setw(12) << evaluations << std::setw(12)
+            << std::scientific << std::setprecision(2) << result.residualNorm
+            << std::defaultfloat << std::setw(6) << result.converged << '\n';
+  return result.solution;
+}
+
+void
+compare(Bratu const &problem, bool dense)
+{
+  std::cout << "\nBratu " << (problem.twoD ? "2D, " : "1D, ") << problem.size()
+            << " unknowns\n"
+            << std::left << std::setw(22) << "Jacobian" << std::right
+            << std::setw(12) << "time (ms)" << std::setw(8) << "iter"
+            << std::setw(12) << "residuals" << std::setw(12) << "residual"
+            << std::setw(6) << "conv" << '\n';
+  ArgumentType denseSolution;
+  if(dense)
+    denseSolution = run("dense", problem, apsc::DiscreteJacobian{});
+  // The factory needs the sparsity pattern for the sparse Jacobian
+  auto const sparsePtr = apsc::make_Jacobian(
+    apsc::JacobianKind::SparseDiscreteJacobian, problem.pattern());
+  auto &sparse = dynamic_cast<apsc::SparseDiscreteJacobian &>(*sparsePtr);
+  auto const lu = run("sparse, LU", problem, sparse);
+  sparse.setLinearSolver(
+    apsc::SparseDiscreteJacobian::LinearSolver::BiCGSTAB);
+  auto const bicgstab = run("sparse, BiCGSTAB", problem, sparse);
+  std::cout << "Colors: " << sparse.numColors()
+            << ", max difference LU-BiCGSTAB: "
+            << (lu - bicgstab).lpNorm<Eigen::Infinity>();
+  if(dense)
+    std::cout << ", dense-LU: "
+              << (denseSolution - lu).lpNorm<Eigen::Infinity>();
+  std::cout << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  Eigen::Index const n2D = argc > 1 ? std::stol(argv[1]) : 200;
+  std::cout << std::boolalpha;
+  compare(Bratu{500, false}, true);
+  compare(Bratu{30, true}, true);
+  compare(Bratu{n2D, true}, false);
+}
@@ -15,10 +15,93 @@
 #include "partitioner.hpp" // in Parallel/Utilities
 #include <mpi.h>
 #pragma GCC diagnostic pop
+#include <algorithm>
 #include <array>
+#include <utility>
 #include <vector>
 namespace apsc
 {
+/*!
+ * A handle to a matrix-vector product whose communication is still in
+ * progress, similar to a std::future.
+ *
+ * It is returned by PMatrix::productAsync(). The result vector must not be
+ * accessed until wait() has been called (or test() has returned true). The
+ * destructor waits for the completion of pending communications.
+ */
+class PendingProduct
+{
+public:
+  PendingProduct() = default;
+  /*!
+   * @param reqs The requests of the non-blocking collectives
+   * @param args Arrays (counts, displacements) used by the collectives,
+   * which MPI requires to stay valid until completion
+   */
+  explicit PendingProduct(std::vector<MPI_Request> &&reqs,
+                          std::vector<int>         &&args = {})
+    : requests{std::move(reqs)}, arguments{std::move(args)}
+  {}
+  PendingProduct(PendingProduct const &) = delete;
+  PendingProduct &operator=(PendingProduct const &) = delete;
+  PendingProduct(PendingProduct &&other) noexcept
+    : requests{std::exchange(other.requests, {})},
+      arguments{std::exchange(other.arguments, {})}
+  {}
+  PendingProduct &
+  operator=(PendingProduct &&other) noexcept
+  {
+    if(this != &other)
+      {
+        wait();
+        requests = std::exchange(other.requests, {});
+        arguments = std::exchange(other.arguments, {});
+      }
+    return *this;
+  }
+  ~PendingProduct() { wait(); }
+  /*!
+   * Blocks until the result is available.
+   */
+  void
+  wait()
+  {
+    if(requests.empty())
+      return;
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                MPI_STATUSES_IGNORE);
+    requests.clear();
+  }
+  /*!
+   * Checks if the result is available, without blocking. It also lets the
+   * MPI library progress the communication, so it is worth calling it from
+   * time to time while doing other work.
+   * @return true if the result is available
+   */
+  bool
+  test()
+  {
+    if(requests.empty())
+      return true;
+    int flag;
+    MPI_Testall(static_cast<int>(requests.size()), requests.data(), &flag,
+                MPI_STATUSES_IGNORE);
+    if(flag)
+      requests.clear();
+    return flag;
+  }
+  //! true if there are no pending communications
+  bool
+  ready() const
+  {
+    return requests.empty();
+  }
+
+private:
+  std::vector<MPI_Request> requests;
+  std::vector<int>         arguments;
+};
+
 /*!
  * A class for parallel matrix product
  * @tparam Matrix A matrix compliant with that in Matrix.hpp
@@ -66,6 +149,30 @@ public:
    * @return the global solution of the matrix product, in v.
    */
   void AllCollectGlobal(std::vector<Scalar> &v) const;
+  /*!
+   * Computes the product and collects the global result on all processes,
+   * overlapping computation and communication. It is equivalent to product()
+   * followed by AllCollectGlobal().
+   *
+   * The local rows are processed in chunks: as soon as a chunk is
+   * computed, a non-blocking collective (MPI_Iallgatherv for the row
+   * partition, MPI_Iallreduce for the column partition) is started on it,
+   * while the next chunk is being multiplied. The communication of the last
+   * chunks may still be in progress at return: the caller may do other
+   * work and then wait on the returned handle.
+   *
+   * As product(), it stores the local product, so collectGlobal() and
+   * AllCollectGlobal() may be used afterwards.
+   *
+   * @param x A global vector. It may be destroyed or changed on return.
+   * @param v The global result, distinct from x. It must not be accessed,
+   * or resized, until the returned handle has completed.
+   * @param nChunks The number of chunks (the same on all processes).
+   * @return A handle to the pending communication
+   */
+  [[nodiscard]] PendingProduct
+  productAsync(std::vector<Scalar> const &x, std::vector<Scalar> &v,
+               unsigned int nChunks = defaultChunks);
   /*!
    * Returns the local matrix assigned to the processor
    * @return The local matrix
@@ -76,8 +183,16 @@ public:
     return localMatrix;
   }
   static constexpr int manager = 0;
+  //! Default number of chunks in productAsync()
+  static constexpr unsigned int defaultChunks = 4u;
 
 protected:
+  /*!
+   * Computes the rows [first, last) of the local product and stores them in
+   * res[0], res[1], ...
+   */
+  void localRowsProduct(Scalar const *x, std::size_t first, std::size_t last,
+                        Scalar *res) const;
   MPI_Comm         mpi_comm;
   int              mpi_rank;      // my rank
   int              mpi_size;      // the number of processes
@@ -254,4 +369,131 @@ apsc::PMatrix<Matrix>::AllCollectGlobal(std::vector<Scalar> &v) const
     }
 }
 
+template <class Matrix>
+void
+apsc::PMatrix<Matrix>::localRowsProduct(Scalar const *x, std::size_t first,
+                                        std::size_t last, Scalar *res) const
+{
+  using namespace apsc::LinearAlgebra;
+  Scalar const *a = localMatrix.data();
+  if constexpr(Matrix::ordering == ORDERING::ROWMAJOR)
+    {
+      for(std::size_t i = first; i < last; ++i)
+        {
+          Scalar        r{0};
+          Scalar const *row = a + i * local_nCols;
+          for(std::size_t j = 0; j < local_nCols; ++j)
+            r += row[j] * x[j];
+          res[i - first] = r;
+        }
+    }
+  else
+    {
+      // Four columns at a time, to reduce the traffic on res, which is
+      // read and written for each group of columns
+      std::fill(res, res + (last - first), Scalar{0});
+      std::size_t j = 0;
+      for(; j + 4 <= local_nCols; j += 4)
+        {
+          Scalar const *c0 = a + j * local_nRows;
+          Scalar const *c1 = c0 + local_nRows;
+          Scalar const *c2 = c1 + local_nRows;
+          Scalar const *c3 = c2 + local_nRows;
+          for(std::size_t i = first; i < last; ++i)
+            res[i - first] += c0[i] * x[j] + c1[i] * x[j + 1] +
+                              c2[i] * x[j + 2] + c3[i] * x[j + 3];
+        }
+      for(; j < local_nCols; ++j)
+        {
+          Scalar const *col = a + j * local_nRows;
+          for(std::size_t i = first; i < last; ++i)
+            res[i - first] += col[i] * x[j];
+        }
+    }
+}
+
+template <class Matrix>
+apsc::PendingProduct
+apsc::PMatrix<Matrix>::productAsync(std::vector<Scalar> const &x,
+                                    std::vector<Scalar> &v,
+                                    unsigned int nChunks)
+{
+  using namespace apsc::LinearAlgebra;
+  v.resize(global_nRows);
+  nChunks = std::max(nChunks, 1u);
+  std::vector<MPI_Request> requests(nChunks, MPI_REQUEST_NULL);
+  // The chunk c of the rows [0,n) is [c*n/nChunks, (c+1)*n/nChunks). All
+  // processes must agree on the number of collectives, so even empty chunks
+  // take part in the communication.
+  auto chunkBegin = [nChunks](std::size_t n, unsigned int c) {
+    return (c * n) / nChunks;
+  };
+  if constexpr(Matrix::ordering == ORDERING::ROWMAJOR)
+    {
+      // Each process computes its rows in localProduct and copies them in
+      // the global vector, where the collectives work in place.
+      std::vector<int> rows(mpi_size);
+      std::vector<int> firstRow(mpi_size);
+      for(int p = 0; p < mpi_size; ++p)
+        {
+          rows[p] = counts[p] / global_nCols;
+          firstRow[p] = displacements[p] / global_nCols;
+        }
+      // counts (first half) and displacements (second half) of each chunk.
+      // They must stay valid until the collectives complete, so they are
+      // moved into the returned handle.
+      auto const       nArgs = mpi_size * nChunks;
+      std::vector<int> chunkArgs(2 * nArgs);
+      int             *chunkCounts = chunkArgs.data();
+      int             *chunkDispl = chunkArgs.data() + nArgs;
+      for(unsigned int c = 0; c < nChunks; ++c)
+        for(int p = 0; p < mpi_size; ++p)
+          {
+            auto const b = chunkBegin(rows[p], c);
+            auto const e = chunkBegin(rows[p], c + 1);
+            chunkCounts[c * mpi_size + p] = static_cast<int>(e - b);
+            chunkDispl[c * mpi_size + p] = firstRow[p] + static_cast<int>(b);
+          }
+      localProduct.resize(local_nRows);
+      for(unsigned int c = 0; c < nChunks; ++c)
+        {
+          auto const b = chunkBegin(local_nRows, c);
+          auto const e = chunkBegin(local_nRows, c + 1);
+          localRowsProduct(x.data(), b, e, localProduct.data() + b);
+          std::copy(localProduct.begin() + b, localProduct.begin() + e,
+                    v.begin() + firstRow[mpi_rank] + b);
+          MPI_Iallgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, v.data(),
+                          chunkCounts + c * mpi_size,
+                          chunkDispl + c * mpi_size, MPI_Scalar_Type,
+                          mpi_comm, &requests[c]);
+          // give the library a chance to progress the previous collectives
+          int flag;
+          MPI_Testall(static_cast<int>(c + 1), requests.data(), &flag,
+                      MPI_STATUSES_IGNORE);
+        }
+      return PendingProduct{std::move(requests), std::move(chunkArgs)};
+    }
+  else
+    {
+      // Every process has all rows but only some columns: the partial
+      // results, kept in localProduct, are summed chunk by chunk in v
+      auto const startcol = displacements[mpi_rank] / global_nRows;
+      localProduct.resize(global_nRows);
+      for(unsigned int c = 0; c < nChunks; ++c)
+        {
+          auto const b = chunkBegin(global_nRows, c);
+          auto const e = chunkBegin(global_nRows, c + 1);
+          localRowsProduct(x.data() + startcol, b, e, localProduct.data() + b);
+          std::copy(localProduct.begin() + b, localProduct.begin() + e,
+                    v.begin() + b);
+          MPI_Iallreduce(MPI_IN_PLACE, v.data() + b, static_cast<int>(e - b),
+                         MPI_Scalar_Type, MPI_SUM, mpi_comm, &requests[c]);
+          int flag;
+          MPI_Testall(static_cast<int>(c + 1), requests.data(), &flag,
+                      MPI_STATUSES_IGNORE);
+        }
+      return PendingProduct{std::move(requests)};
+    }
+}
+
 #endif /* AMSC_EXAMPLES_EXAMPLES_SRC_PARALLEL_MPI_PMATRIX_PMATRIX_HPP_ */
@@ -0,0 +1,669 @@
+/*
+ * PMatrix2D.hpp
+ *
+ *  A full matrix distributed on a 2D grid of processes
+ */
+
+#ifndef AMSC_EXAMPLES_EXAMPLES_SRC_PARALLEL_MPI_PMATRIX_PMATRIX2D_HPP_
+#define AMSC_EXAMPLES_EXAMPLES_SRC_PARALLEL_MPI_PMATRIX_PMATRIX2D_HPP_
+#include "Matrix.hpp" // in Matrix/
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+#include "mpi_utils.hpp"   // for MPI_SIZE_T and mpi_typeof()
+#include "partitioner.hpp" // in Parallel/Utilities
+#include <mpi.h>
+#pragma GCC diagnostic pop
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+namespace apsc
+{
+/*!
+ * A full matrix distributed on a 2D grid of processes
+ *
+ * The processes are arranged in a Pr x Pc cartesian grid (chosen by
+ * MPI_Dims_create). Rows are distributed block-cyclically over the rows of
+ * the grid and columns over the columns of the grid (see
+ * GridMatrixPartitioner in partitioner.hpp). With the default block size
+ * each process owns a single block.
+ *
+ * With respect to PMatrix (1D row or column split):
+ * - the matrix may be set up without ever building it on a single process,
+ *   either with a generator or by reading the local blocks from a binary file
+ *   with MPI-IO;
+ * - in the matrix-vector product each process needs only the part of the
+ *   input vector corresponding to its columns, about n/Pc entries, and the
+ *   communication involves only the processes in the same row or column of
+ *   the grid;
+ * - the matrix-matrix product is available, with the SUMMA algorithm.
+ *
+ * Vectors are distributed in two ways: an input vector of the product is
+ * split as the columns of the matrix (and replicated along the columns of the
+ * grid), the result is split as the rows (and replicated along the rows of the
+ * grid). For square matrices, productToInput() converts the second into the
+ * first, so that products may be chained without collecting global vectors.
+ *
+ * @tparam Matrix A matrix compliant with that in Matrix.hpp
+ */
+template <class Matrix> class PMatrix2D
+{
+public:
+  using Scalar = typename Matrix::Scalar;
+  PMatrix2D() = default;
+  //! The class owns MPI communicators, copying makes no sense
+  PMatrix2D(PMatrix2D const &) = delete;
+  PMatrix2D &operator=(PMatrix2D const &) = delete;
+  //! Frees the communicators
+  ~PMatrix2D();
+  /*!
+   * All processes call setup but only the managing process (rank 0) passes a
+   * non-empty global matrix, which is scattered to the other processes.
+   *
+   * @note It is the simplest, but also the least scalable way of building the
+   * matrix, since the manager must hold the global matrix. It is provided for
+   * comparison with PMatrix.
+   * @param gMat The global matrix
+   * @param communic The MPI communicator
+   * @param blockSize The size of the blocks (0 means one block per process)
+   */
+  void setup(Matrix const &gMat, MPI_Comm communic,
+             std::size_t blockSize = 0u);
+  /*!
+   * Each process builds its own local block. The global matrix is never
+   * formed.
+   *
+   * @tparam Generator A callable with signature Scalar (std::size_t i,
+   * std::size_t j), returning the value of the element (i,j) of the global
+   * matrix.
+   * @param nRows Number of rows of the global matrix
+   * @param nCols Number of columns of the global matrix
+   * @param generator The generator of the matrix elements
+   * @param communic The MPI communicator
+   * @param blockSize The size of the blocks (0 means one block per process)
+   */
+  template <class Generator>
+  void setup(std::size_t nRows, std::size_t nCols, Generator &&generator,
+             MPI_Comm communic, std::size_t blockSize = 0u);
+  /*!
+   * Each process reads its own blocks from a binary file with collective
+   * MPI-IO. The global matrix is never formed.
+   *
+   * The file contains the raw buffer of the global matrix, with the same
+   * ordering of Matrix (as written, for instance, by writing gMat.data()).
+   *
+   * @param fileName The file name
+   * @param nRows Number of rows of the global matrix
+   * @param nCols Number of columns of the global matrix
+   * @param communic The MPI communicator
+   * @param blockSize The size of the blocks (0 means one block per process)
+   * @throws std::runtime_error if the file cannot be read
+   */
+  void readFromFile(std::string const &fileName, std::size_t nRows,
+                    std::size_t nCols, MPI_Comm communic,
+                    std::size_t blockSize = 0u);
+  /*!
+   * Sets this matrix equal to A*B with the SUMMA algorithm.
+   *
+   * The common dimension is processed in panels: the owner of a panel of
+   * columns of A broadcasts it along its row of the grid, the owner of the
+   * corresponding panel of rows of B along its column of the grid, and each
+   * process updates its local block. A and B must be distributed on the same
+   * grid, they may have different block sizes. A or B may be this matrix
+   * itself: in that case the product is computed in a temporary.
+   *
+   * @param A Left factor
+   * @param B Right factor
+   * @throws std::invalid_argument if sizes or grids are not compatible
+   */
+  void multiply(PMatrix2D const &A, PMatrix2D const &B);
+  /*!
+   * Extracts from a global vector the part needed by this process for the
+   * product, i.e. the entries corresponding to the local columns.
+   *
+   * @param x A global vector
+   * @return The local part of x
+   */
+  std::vector<Scalar> localInput(std::vector<Scalar> const &x) const;
+  /*!
+   * Performs the matrix times vector product.
+   *
+   * The local partial products are summed along the rows of the grid.
+   * Afterwards, each process holds the entries of the result corresponding
+   * to its local rows (see getLocalProduct())
+   *
+   * @param xLocal The entries of the input vector corresponding to the local
+   * columns (see localInput() and productToInput())
+   */
+  void product(std::vector<Scalar> const &xLocal);
+  /*!
+   * The entries of the last product corresponding to the local rows
+   */
+  auto const &
+  getLocalProduct() const
+  {
+    return localProduct;
+  }
+  /*!
+   * Redistributes the result of the last product as an input vector, for a
+   * square matrix.
+   *
+   * Each process receives only the entries corresponding to its local
+   * columns, from the processes in the same column of the grid.
+   *
+   * @return The local part of the result, distributed as an input vector
+   */
+  std::vector<Scalar> productToInput() const;
+  /*!
+   * Gets the global result of the last product. All processes call it but
+   * only process 0 (manager) gets a non empty vector.
+   *
+   * @param v The global result (only process 0)
+   */
+  void collectGlobal(std::vector<Scalar> &v) const;
+  /*!
+   * Collects the global matrix on the manager. Only for testing, it is
+   * clearly not scalable.
+   * @param gMat The global matrix (only process 0)
+   */
+  void collectGlobalMatrix(Matrix &gMat) const;
+  /*!
+   * Returns the local matrix assigned to the processor
+   * @return The local matrix
+   */
+  auto const &
+  getLocalMatrix() const
+  {
+    return localMatrix;
+  }
+  /*!
+   * The partitioner describing the distribution of the matrix
+   */
+  auto const &
+  getPartitioner() const
+  {
+    return partitioner;
+  }
+  /*!
+   * The number of rows and columns of the process grid
+   */
+  auto const &
+  getGridDims() const
+  {
+    return dims;
+  }
+  static constexpr int manager = 0;
+  //! Maximal width of the panels broadcast in the SUMMA algorithm
+  static constexpr std::size_t summaPanelWidth = 64u;
+
+protected:
+  /*!
+   * Creates the grid, the communicators and the partition, and allocates the
+   * local matrix (set to zero).
+   */
+  void setupLayout(std::size_t nRows, std::size_t nCols, MPI_Comm communic,
+                   std::size_t rowBlockSize, std::size_t colBlockSize);
+  //! Frees the communicators, if any
+  void freeCommunicators();
+  //! Exchanges the content (communicators included) with another matrix
+  void swap(PMatrix2D &other) noexcept;
+  //! The local index in the buffer of the local matrix
+  std::size_t
+  localIndex(std::size_t i, std::size_t j) const
+  {
+    if constexpr(Matrix::ordering == LinearAlgebra::ORDERING::ROWMAJOR)
+      return i * local_nCols + j;
+    else
+      return i + j * local_nRows;
+  }
+  MPI_Comm grid_comm = MPI_COMM_NULL; // Cartesian communicator
+  MPI_Comm row_comm = MPI_COMM_NULL;  // Processes in my row of the grid
+  MPI_Comm col_comm = MPI_COMM_NULL;  // Processes in my column of the grid
+  int      mpi_rank = 0;              // my rank
+  int      mpi_size = 1;              // the number of processes
+  std::array<int, 2>    dims{1, 1};   // The grid
+  std::array<int, 2>    coords{0, 0}; // my position in the grid
+  GridMatrixPartitioner partitioner;  // The distribution of the matrix
+  Matrix                localMatrix;  // The local blocks of the matrix
+  std::vector<Scalar>   localProduct; // The local part of the product
+  // Work areas, kept to avoid allocations in repeated products
+  std::vector<Scalar> partialProduct; // Product with the local columns
+  std::vector<Scalar> aPanel;         // Panel of A in SUMMA
+  std::vector<Scalar> bPanel;         // Panel of B in SUMMA
+  std::size_t           local_nRows = 0u;
+  std::size_t           local_nCols = 0u;
+  std::size_t           global_nRows = 0u;
+  std::size_t           global_nCols = 0u;
+  MPI_Datatype          MPI_Scalar_Type = mpi_typeof(Scalar{});
+};
+} // end namespace apsc
+
+template <class Matrix> apsc::PMatrix2D<Matrix>::~PMatrix2D()
+{
+  freeCommunicators();
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::freeCommunicators()
+{
+  int finalized;
+  MPI_Finalized(&finalized);
+  if(finalized)
+    return;
+  for(auto *comm : {&row_comm, &col_comm, &grid_comm})
+    if(*comm != MPI_COMM_NULL)
+      MPI_Comm_free(comm);
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::swap(PMatrix2D &other) noexcept
+{
+  using std::swap;
+  swap(grid_comm, other.grid_comm);
+  swap(row_comm, other.row_comm);
+  swap(col_comm, other.col_comm);
+  swap(mpi_rank, other.mpi_rank);
+  swap(mpi_size, other.mpi_size);
+  swap(dims, other.dims);
+  swap(coords, other.coords);
+  swap(partitioner, other.partitioner);
+  swap(localMatrix, other.localMatrix);
+  swap(localProduct, other.localProduct);
+  swap(partialProduct, other.partialProduct);
+  swap(aPanel, other.aPanel);
+  swap(bPanel, other.bPanel);
+  swap(local_nRows, other.local_nRows);
+  swap(local_nCols, other.local_nCols);
+  swap(global_nRows, other.global_nRows);
+  swap(global_nCols, other.global_nCols);
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::setupLayout(std::size_t nRows, std::size_t nCols,
+                                     MPI_Comm communic,
+                                     std::size_t rowBlockSize,
+                                     std::size_t colBlockSize)
+{
+  freeCommunicators();
+  int size;
+  MPI_Comm_size(communic, &size);
+  // A grid as square as possible
+  dims = {0, 0};
+  MPI_Dims_create(size, 2, dims.data());
+  std::array<int, 2> periods{0, 0};
+  // No reordering: rank in grid_comm is pr*Pc+pc, as assumed by the
+  // partitioner and by MPI_Type_create_darray
+  MPI_Cart_create(communic, 2, dims.data(), periods.data(), 0, &grid_comm);
+  MPI_Comm_rank(grid_comm, &mpi_rank);
+  MPI_Comm_size(grid_comm, &mpi_size);
+  MPI_Cart_coords(grid_comm, mpi_rank, 2, coords.data());
+  // Communicators for the rows and the columns of the grid. The rank in
+  // row_comm is the column coordinate, that in col_comm the row coordinate.
+  std::array<int, 2> keepCols{0, 1};
+  std::array<int, 2> keepRows{1, 0};
+  MPI_Cart_sub(grid_comm, keepCols.data(), &row_comm);
+  MPI_Cart_sub(grid_comm, keepRows.data(), &col_comm);
+
+  global_nRows = nRows;
+  global_nCols = nCols;
+  partitioner.setPartitioner(nRows, nCols, dims[0], dims[1], rowBlockSize,
+                             colBlockSize);
+  local_nRows = partitioner.rows().local_size(coords[0]);
+  local_nCols = partitioner.cols().local_size(coords[1]);
+  localMatrix.resize(local_nRows, local_nCols);
+  std::fill(localMatrix.data(), localMatrix.data() + localMatrix.bufferSize(),
+            Scalar{0});
+  localProduct.clear();
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::setup(const Matrix &gMat, MPI_Comm communic,
+                               std::size_t blockSize)
+{
+  int rank;
+  MPI_Comm_rank(communic, &rank);
+  std::array<std::size_t, 2> sizes{0u, 0u};
+  if(rank == manager)
+    sizes = {gMat.rows(), gMat.cols()};
+  MPI_Bcast(sizes.data(), 2, MPI_SIZE_T, manager, communic);
+  setupLayout(sizes[0], sizes[1], communic, blockSize, blockSize);
+
+  // The manager packs the blocks of each process, in the order of the local
+  // matrix of the receiving process, and then scatters them
+  auto const [rows, cols] = partitioner.getLocalRowsAndCols();
+  std::vector<int> counts(mpi_size);
+  std::vector<int> displacements(mpi_size, 0);
+  for(int p = 0; p < mpi_size; ++p)
+    counts[p] = static_cast<int>(rows[p] * cols[p]);
+  for(int p = 1; p < mpi_size; ++p)
+    displacements[p] = displacements[p - 1] + counts[p - 1];
+  std::vector<Scalar> sendBuffer;
+  if(mpi_rank == manager)
+    {
+      sendBuffer.resize(gMat.bufferSize());
+      for(int p = 0; p < mpi_size; ++p)
+        {
+          auto const pr = p / dims[1];
+          auto const pc = p % dims[1];
+          auto      *dest = sendBuffer.data() + displacements[p];
+          for(std::size_t li = 0u; li < rows[p]; ++li)
+            for(std::size_t lj = 0u; lj < cols[p]; ++lj)
+              {
+                auto const gi = partitioner.rows().to_global(pr, li);
+                auto const gj = partitioner.cols().to_global(pc, lj);
+                if constexpr(Matrix::ordering ==
+                             LinearAlgebra::ORDERING::ROWMAJOR)
+                  dest[li * cols[p] + lj] = gMat(gi, gj);
+                else
+                  dest[li + lj * rows[p]] = gMat(gi, gj);
+              }
+        }
+    }
+  MPI_Scatterv(sendBuffer.data(), counts.data(), displacements.data(),
+               MPI_Scalar_Type, localMatrix.data(), counts[mpi_rank],
+               MPI_Scalar_Type, manager, grid_comm);
+}
+
+template <class Matrix>
+template <class Generator>
+void
+apsc::PMatrix2D<Matrix>::setup(std::size_t nRows, std::size_t nCols,
+                               Generator &&generator, MPI_Comm communic,
+                               std::size_t blockSize)
+{
+  setupLayout(nRows, nCols, communic, blockSize, blockSize);
+  for(std::size_t li = 0u; li < local_nRows; ++li)
+    for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+      localMatrix(li, lj) =
+        generator(partitioner.rows().to_global(coords[0], li),
+                  partitioner.cols().to_global(coords[1], lj));
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::readFromFile(std::string const &fileName,
+                                      std::size_t nRows, std::size_t nCols,
+                                      MPI_Comm communic, std::size_t blockSize)
+{
+  setupLayout(nRows, nCols, communic, blockSize, blockSize);
+  // MPI has a datatype describing exactly our block-cyclic distribution
+  std::array<int, 2> gsizes{static_cast<int>(nRows), static_cast<int>(nCols)};
+  std::array<int, 2> distribs{MPI_DISTRIBUTE_CYCLIC, MPI_DISTRIBUTE_CYCLIC};
+  std::array<int, 2> dargs{
+    static_cast<int>(partitioner.rows().get_BlockSize()),
+    static_cast<int>(partitioner.cols().get_BlockSize())};
+  int const order = Matrix::ordering == LinearAlgebra::ORDERING::ROWMAJOR
+                      ? MPI_ORDER_C
+                      : MPI_ORDER_FORTRAN;
+  MPI_Datatype fileType;
+  MPI_Type_create_darray(mpi_size, mpi_rank, 2, gsizes.data(), distribs.data(),
+                         dargs.data(), dims.data(), order, MPI_Scalar_Type,
+                         &fileType);
+  MPI_Type_commit(&fileType);
+  MPI_File file;
+  if(MPI_File_open(grid_comm, fileName.c_str(), MPI_MODE_RDONLY,
+                   MPI_INFO_NULL, &file) != MPI_SUCCESS)
+    {
+      MPI_Type_free(&fileType);
+      throw std::runtime_error("PMatrix2D: cannot open file " + fileName);
+    }
+  MPI_File_set_view(file, 0, MPI_Scalar_Type, fileType, "native",
+                    MPI_INFO_NULL);
+  MPI_Status status;
+  int const  error =
+    MPI_File_read_all(file, localMatrix.data(),
+                      static_cast<int>(local_nRows * local_nCols),
+                      MPI_Scalar_Type, &status);
+  MPI_File_close(&file);
+  MPI_Type_free(&fileType);
+  if(error != MPI_SUCCESS)
+    throw std::runtime_error("PMatrix2D: error while reading " + fileName);
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::multiply(PMatrix2D const &A, PMatrix2D const &B)
+{
+  if(A.global_nCols != B.global_nRows)
+    throw std::invalid_argument("PMatrix2D::multiply: incompatible sizes");
+  if(A.dims != B.dims || A.coords != B.coords)
+    throw std::invalid_argument("PMatrix2D::multiply: different grids");
+  if(&A == this || &B == this)
+    {
+      // setupLayout() below would destroy the factor before it is read
+      PMatrix2D result;
+      result.multiply(A, B);
+      swap(result);
+      return;
+    }
+  // The rows of the result are distributed as those of A, the columns as
+  // those of B
+  setupLayout(A.global_nRows, B.global_nCols, A.grid_comm,
+              A.partitioner.rows().get_BlockSize(),
+              B.partitioner.cols().get_BlockSize());
+  auto const &aCols = A.partitioner.cols();
+  auto const &bRows = B.partitioner.rows();
+  auto const  nK = A.global_nCols;
+  auto const  nbA = aCols.get_BlockSize();
+  auto const  nbB = bRows.get_BlockSize();
+  constexpr bool rowMajor =
+    Matrix::ordering == LinearAlgebra::ORDERING::ROWMAJOR;
+  Scalar *c = localMatrix.data();
+  // A panel is a range of the common index owned by a single process column
+  // (for A) and by a single process row (for B). Its width is also limited
+  // so that the panel of B stays in cache during the local update.
+  for(std::size_t k = 0u; k < nK;)
+    {
+      std::size_t const kEnd = std::min({nK, (k / nbA + 1u) * nbA,
+                                         (k / nbB + 1u) * nbB,
+                                         k + summaPanelWidth});
+      std::size_t const w = kEnd - k;
+      int const         aRoot = static_cast<int>(aCols.loc(k));
+      int const         bRoot = static_cast<int>(bRows.loc(k));
+      // Panels are stored with the same ordering as the matrix
+      aPanel.resize(local_nRows * w);
+      if(coords[1] == aRoot)
+        {
+          auto const lk = aCols.to_local(k);
+          for(std::size_t li = 0u; li < local_nRows; ++li)
+            for(std::size_t p = 0u; p < w; ++p)
+              aPanel[rowMajor ? li * w + p : li + p * local_nRows] =
+                A.localMatrix(li, lk + p);
+        }
+      MPI_Bcast(aPanel.data(), static_cast<int>(aPanel.size()),
+                MPI_Scalar_Type, aRoot, row_comm);
+      bPanel.resize(w * local_nCols);
+      if(coords[0] == bRoot)
+        {
+          auto const lk = bRows.to_local(k);
+          for(std::size_t p = 0u; p < w; ++p)
+            for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+              bPanel[rowMajor ? p * local_nCols + lj : p + lj * w] =
+                B.localMatrix(lk + p, lj);
+        }
+      MPI_Bcast(bPanel.data(), static_cast<int>(bPanel.size()),
+                MPI_Scalar_Type, bRoot, col_comm);
+      // Local update C += Apanel*Bpanel, with the innermost loop running on
+      // contiguous memory
+      if constexpr(rowMajor)
+        {
+          for(std::size_t li = 0u; li < local_nRows; ++li)
+            for(std::size_t p = 0u; p < w; ++p)
+              {
+                Scalar const  a = aPanel[li * w + p];
+                Scalar const *b = bPanel.data() + p * local_nCols;
+                Scalar       *ci = c + li * local_nCols;
+                for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+                  ci[lj] += a * b[lj];
+              }
+        }
+      else
+        {
+          for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+            for(std::size_t p = 0u; p < w; ++p)
+              {
+                Scalar const  b = bPanel[p + lj * w];
+                Scalar const *a = aPanel.data() + p * local_nRows;
+                Scalar       *cj = c + lj * local_nRows;
+                for(std::size_t li = 0u; li < local_nRows; ++li)
+                  cj[li] += a[li] * b;
+              }
+        }
+      k = kEnd;
+    }
+}
+
+template <class Matrix>
+std::vector<typename apsc::PMatrix2D<Matrix>::Scalar>
+apsc::PMatrix2D<Matrix>::localInput(std::vector<Scalar> const &x) const
+{
+  std::vector<Scalar> xLocal(local_nCols);
+  for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+    xLocal[lj] = x[partitioner.cols().to_global(coords[1], lj)];
+  return xLocal;
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::product(std::vector<Scalar> const &xLocal)
+{
+  if(xLocal.size() != local_nCols)
+    throw std::invalid_argument("PMatrix2D::product: wrong local size");
+  // partial product with the local columns, in storage kept between calls
+  partialProduct.assign(local_nRows, Scalar{0});
+  Scalar const *a = localMatrix.data();
+  if constexpr(Matrix::ordering == LinearAlgebra::ORDERING::ROWMAJOR)
+    {
+      for(std::size_t li = 0u; li < local_nRows; ++li, a += local_nCols)
+        {
+          Scalar r{0};
+          for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+            r += a[lj] * xLocal[lj];
+          partialProduct[li] = r;
+        }
+    }
+  else
+    {
+      for(std::size_t lj = 0u; lj < local_nCols; ++lj, a += local_nRows)
+        for(std::size_t li = 0u; li < local_nRows; ++li)
+          partialProduct[li] += a[li] * xLocal[lj];
+    }
+  localProduct.resize(local_nRows);
+  // sum of the contributions of the processes in my row of the grid
+  MPI_Allreduce(partialProduct.data(), localProduct.data(),
+                static_cast<int>(local_nRows), MPI_Scalar_Type, MPI_SUM,
+                row_comm);
+}
+
+template <class Matrix>
+std::vector<typename apsc::PMatrix2D<Matrix>::Scalar>
+apsc::PMatrix2D<Matrix>::productToInput() const
+{
+  if(global_nRows != global_nCols)
+    throw std::logic_error("PMatrix2D::productToInput: matrix not square");
+  auto const &rowPart = partitioner.rows();
+  auto const &colPart = partitioner.cols();
+  int const   myRow = coords[0];
+  int const   myCol = coords[1];
+  // I need the entries of my columns. The process in row r of my column of
+  // the grid owns those that are also rows of r. Every process in my column
+  // needs the same entries, so it is an allgather in col_comm.
+  std::vector<int> counts(dims[0], 0);
+  for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+    ++counts[rowPart.loc(colPart.to_global(myCol, lj))];
+  std::vector<int> displacements(dims[0], 0);
+  for(int r = 1; r < dims[0]; ++r)
+    displacements[r] = displacements[r - 1] + counts[r - 1];
+  // What I send: my rows that are also columns of my column of the grid,
+  // in increasing global order
+  std::vector<Scalar> sendBuffer;
+  sendBuffer.reserve(counts[myRow]);
+  for(std::size_t li = 0u; li < local_nRows; ++li)
+    if(colPart.loc(rowPart.to_global(myRow, li)) ==
+       static_cast<unsigned int>(myCol))
+      sendBuffer.push_back(localProduct[li]);
+  std::vector<Scalar> received(local_nCols);
+  MPI_Allgatherv(sendBuffer.data(), static_cast<int>(sendBuffer.size()),
+                 MPI_Scalar_Type, received.data(), counts.data(),
+                 displacements.data(), MPI_Scalar_Type, col_comm);
+  // Reorder: received data is grouped by row of the grid
+  std::vector<Scalar> xLocal(local_nCols);
+  for(std::size_t lj = 0u; lj < local_nCols; ++lj)
+    {
+      auto const r = rowPart.loc(colPart.to_global(myCol, lj));
+      xLocal[lj] = received[displacements[r]++];
+    }
+  return xLocal;
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::collectGlobal(std::vector<Scalar> &v) const
+{
+  // The processes in the first column of the grid have all the rows
+  if(coords[1] != 0)
+    return;
+  std::vector<int> counts(dims[0]);
+  std::vector<int> displacements(dims[0], 0);
+  for(int r = 0; r < dims[0]; ++r)
+    counts[r] = static_cast<int>(partitioner.rows().local_size(r));
+  for(int r = 1; r < dims[0]; ++r)
+    displacements[r] = displacements[r - 1] + counts[r - 1];
+  std::vector<Scalar> received;
+  if(mpi_rank == manager)
+    received.resize(global_nRows);
+  // The manager has coordinates (0,0), so it is rank 0 in its col_comm
+  MPI_Gatherv(localProduct.data(), static_cast<int>(localProduct.size()),
+              MPI_Scalar_Type, received.data(), counts.data(),
+              displacements.data(), MPI_Scalar_Type, manager, col_comm);
+  if(mpi_rank == manager)
+    {
+      v.resize(global_nRows);
+      for(int r = 0; r < dims[0]; ++r)
+        for(int l = 0; l < counts[r]; ++l)
+          v[partitioner.rows().to_global(r, l)] = received[displacements[r] + l];
+    }
+}
+
+template <class Matrix>
+void
+apsc::PMatrix2D<Matrix>::collectGlobalMatrix(Matrix &gMat) const
+{
+  auto const [rows, cols] = partitioner.getLocalRowsAndCols();
+  std::vector<int> counts(mpi_size);
+  std::vector<int> displacements(mpi_size, 0);
+  for(int p = 0; p < mpi_size; ++p)
+    counts[p] = static_cast<int>(rows[p] * cols[p]);
+  for(int p = 1; p < mpi_size; ++p)
+    displacements[p] = displacements[p - 1] + counts[p - 1];
+  std::vector<Scalar> received;
+  if(mpi_rank == manager)
+    received.resize(global_nRows * global_nCols);
+  MPI_Gatherv(localMatrix.data(), counts[mpi_rank], MPI_Scalar_Type,
+              received.data(), counts.data(), displacements.data(),
+              MPI_Scalar_Type, manager, grid_comm);
+  if(mpi_rank != manager)
+    return;
+  gMat.resize(global_nRows, global_nCols);
+  for(int p = 0; p < mpi_size; ++p)
+    {
+      auto const pr = p / dims[1];
+      auto const pc = p % dims[1];
+      auto const src = received.data() + displacements[p];
+      for(std::size_t li = 0u; li < rows[p]; ++li)
+        for(std::size_t lj = 0u; lj < cols[p]; ++lj)
+          gMat(partitioner.rows().to_global(pr, li),
+               partitioner.cols().to_global(pc, lj)) =
+            Matrix::ordering == LinearAlgebra::ORDERING::ROWMAJOR
+              ? src[li * cols[p] + lj]
+              : src[li + lj * rows[p]];
+    }
+}
+
+#endif /* AMSC_EXAMPLES_EXAMPLES_SRC_PARALLEL_MPI_PMATRIX_PMATRIX2D_HPP_ */
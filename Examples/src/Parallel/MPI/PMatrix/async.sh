@@ -0,0 +1,11 @@
+#!/bin/bash
+# Asynchronous matrix-vector product of PMatrix in one and in several chunks.
+# Usage: ./async.sh [max number of processes] [iterations] [chunks]
+# Additional options for mpirun may be given in MPIRUN_FLAGS, for instance
+# MPIRUN_FLAGS="--oversubscribe" ./async.sh
+PMAX=${1:-4}
+NITER=${2:-50}
+NCHUNKS=${3:-4}
+for ((p = 1; p <= PMAX; p *= 2)); do
+    mpirun ${MPIRUN_FLAGS} -np $p ./main_asyncProduct $NITER $NCHUNKS
+done
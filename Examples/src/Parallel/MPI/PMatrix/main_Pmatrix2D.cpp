@@ -0,0 +1,166 @@
+/*
+ * main_Pmatrix2D.cpp
+ *
+ * Tests the matrix distributed on a 2D grid of processes against the serial
+ * products.
+ */
+#include "PMatrix2D.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+#include <mpi.h>
+#pragma GCC diagnostic pop
+namespace
+{
+double
+element(std::size_t i, std::size_t j)
+{
+  return std::sin(0.1 * i + 0.3 * j) + (i == j ? 2.0 : 0.0);
+}
+
+template <class M>
+M
+serialMatrix(std::size_t nRows, std::size_t nCols)
+{
+  M m(nRows, nCols);
+  for(auto i = 0u; i < nRows; ++i)
+    for(auto j = 0u; j < nCols; ++j)
+      m(i, j) = element(i, j);
+  return m;
+}
+
+double
+residual(std::vector<double> const &a, std::vector<double> const &b)
+{
+  double r = 0.0;
+  for(auto i = 0u; i < a.size(); ++i)
+    r += (a[i] - b[i]) * (a[i] - b[i]);
+  return std::sqrt(r);
+}
+
+//! Tests all operations for a given ordering and block size
+template <class M>
+void
+test(std::string const &name, std::size_t blockSize, MPI_Comm comm)
+{
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  constexpr std::size_t n = 37;
+  constexpr std::size_t m = 23;
+  M                     gA = serialMatrix<M>(n, m);
+  M                     gB = serialMatrix<M>(m, n);
+  std::vector<double>   x(m);
+  for(auto j = 0u; j < m; ++j)
+    x[j] = 1.0 + j;
+  if(mpi_rank == 0)
+    std::cout << name << ", block size " << blockSize << '\n';
+
+  // Setup with a generator: no process holds the global matrix
+  apsc::PMatrix2D<M> A;
+  A.setup(n, m, element, comm, blockSize);
+  if(mpi_rank == 0)
+    std::cout << "  Process grid " << A.getGridDims()[0] << " x "
+              << A.getGridDims()[1] << '\n';
+  A.product(A.localInput(x));
+  std::vector<double> y;
+  A.collectGlobal(y);
+  if(mpi_rank == 0)
+    std::cout << "  Matrix-vector product, residual=" << residual(y, gA * x)
+              << '\n';
+
+  // Setup by scattering the global matrix from the manager
+  apsc::PMatrix2D<M> B;
+  B.setup(mpi_rank == 0 ? gB : M{}, comm, blockSize);
+
+  // SUMMA
+  apsc::PMatrix2D<M> C;
+  C.multiply(A, B);
+  M gC;
+  C.collectGlobalMatrix(gC);
+  if(mpi_rank == 0)
+    {
+      double err = 0.0;
+      for(auto i = 0u; i < n; ++i)
+        for(auto j = 0u; j < n; ++j)
+          {
+            double cij = 0.0;
+            for(auto k = 0u; k < m; ++k)
+              cij += gA(i, k) * gB(k, j);
+            err = std::max(err, std::abs(cij - gC(i, j)));
+          }
+      std::cout << "  SUMMA product, max error=" << err << '\n';
+    }
+
+  // Chained products with the square matrix C, without global vectors
+  std::vector<double> z(n, 1.0);
+  C.product(C.localInput(z));
+  C.product(C.productToInput());
+  C.collectGlobal(y);
+  if(mpi_rank == 0)
+    {
+      std::vector<double> gz(n, 1.0);
+      std::cout << "  Two chained products, residual="
+                << residual(y, gC * (gC * gz)) << '\n';
+    }
+
+  // The result may be one of the factors: C=C*C
+  C.multiply(C, C);
+  M gC2;
+  C.collectGlobalMatrix(gC2);
+  if(mpi_rank == 0)
+    {
+      double err = 0.0;
+      for(auto i = 0u; i < n; ++i)
+        for(auto j = 0u; j < n; ++j)
+          {
+            double cij = 0.0;
+            for(auto k = 0u; k < n; ++k)
+              cij += gC(i, k) * gC(k, j);
+            err = std::max(err, std::abs(cij - gC2(i, j)) / (1. + std::abs(cij)));
+          }
+      std::cout << "  SUMMA product C=C*C, max relative error=" << err << '\n';
+    }
+
+  // Reading from file: each process reads its own blocks
+  std::string const fileName = "matrix2D.bin";
+  if(mpi_rank == 0)
+    {
+      std::ofstream file(fileName, std::ios::binary);
+      file.write(reinterpret_cast<char const *>(gA.data()),
+                 gA.bufferSize() * sizeof(double));
+    }
+  MPI_Barrier(comm);
+  apsc::PMatrix2D<M> Af;
+  Af.readFromFile(fileName, n, m, comm, blockSize);
+  double localDiff = 0.0;
+  for(auto i = 0u; i < Af.getLocalMatrix().bufferSize(); ++i)
+    localDiff = std::max(localDiff, std::abs(Af.getLocalMatrix().data()[i] -
+                                             A.getLocalMatrix().data()[i]));
+  double diff;
+  MPI_Reduce(&localDiff, &diff, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  if(mpi_rank == 0)
+    {
+      std::cout << "  Matrix read from file, max difference=" << diff << '\n';
+      std::remove(fileName.c_str());
+    }
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace apsc::LinearAlgebra;
+  MPI_Init(&argc, &argv);
+  using RowMatrix = Matrix<double, ORDERING::ROWMAJOR>;
+  using ColMatrix = Matrix<double, ORDERING::COLUMNMAJOR>;
+  for(std::size_t blockSize : {0u, 1u, 4u})
+    {
+      test<RowMatrix>("Row major", blockSize, MPI_COMM_WORLD);
+      test<ColMatrix>("Column major", blockSize, MPI_COMM_WORLD);
+    }
+  MPI_Finalize();
+}
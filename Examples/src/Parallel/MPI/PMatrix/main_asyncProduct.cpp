@@ -0,0 +1,159 @@
+/*
+ * main_asyncProduct.cpp
+ *
+ * Compares, in a power iteration and for several matrix sizes, the
+ * asynchronous matrix-vector product of PMatrix (productAsync()) in one chunk,
+ * where the collective starts only after the whole local product, with the
+ * one in nChunks chunks, where communication overlaps computation. Both use
+ * the same local kernel, so the speedup measures only the overlap. The result
+ * is checked against the blocking product (product() followed by
+ * AllCollectGlobal()).
+ *
+ * Usage: mpirun -np P main_asyncProduct [iterations] [nChunks]
+ * See async.sh for a script running it with different numbers of processes.
+ */
+#include "PMatrix.hpp"
+#include "chrono.hpp" // my chrono in Utilities
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+#include <mpi.h>
+#pragma GCC diagnostic pop
+namespace
+{
+//! Normalizes a vector
+void
+normalize(std::vector<double> &v)
+{
+  double const norm = std::sqrt(std::inner_product(v.begin(), v.end(),
+                                                   v.begin(), 0.0));
+  for(auto &x : v)
+    x /= norm;
+}
+//! Runs a power iteration and returns the maximal time over the processes
+template <class Iteration>
+double
+powerIteration(Iteration &&iteration, std::vector<double> &x, int nIter,
+               MPI_Comm comm)
+{
+  std::fill(x.begin(), x.end(), 1.0);
+  Timings::Chrono clock;
+  MPI_Barrier(comm);
+  clock.start();
+  for(int k = 0; k < nIter; ++k)
+    {
+      iteration();
+      normalize(x);
+    }
+  clock.stop();
+  double localTime = clock.wallTime() * 1.e-3; // milliseconds
+  double time;
+  MPI_Allreduce(&localTime, &time, 1, MPI_DOUBLE, MPI_MAX, comm);
+  return time / nIter;
+}
+//! Benchmarks a matrix type, returns the max difference between the methods
+template <class M>
+double
+benchmark(std::size_t N, int nIter, unsigned int nChunks, MPI_Comm comm)
+{
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  M gA;
+  if(mpi_rank == 0)
+    {
+      gA.resize(N, N);
+      for(auto i = 0u; i < N; ++i)
+        for(auto j = 0u; j < N; ++j)
+          gA(i, j) = 1.0 / (1.0 + i + j);
+    }
+  apsc::PMatrix<M> A;
+  A.setup(gA, comm);
+  std::vector<double> x(N);
+  std::vector<double> y;
+  std::vector<double> ax;
+
+  // blocking product, used only to check the results
+  std::fill(x.begin(), x.end(), 1.0);
+  for(int k = 0; k < nIter; ++k)
+    {
+      A.product(x);
+      A.AllCollectGlobal(x);
+      normalize(x);
+    }
+  y = x;
+
+  double const tOneChunk = powerIteration(
+    [&] {
+      auto pending = A.productAsync(x, ax, 1u);
+      pending.wait();
+      std::swap(x, ax);
+    },
+    x, nIter, comm);
+  double diff = 0.0;
+  for(auto i = 0u; i < N; ++i)
+    diff = std::max(diff, std::abs(x[i] - y[i]));
+
+  double const tAsync = powerIteration(
+    [&] {
+      auto pending = A.productAsync(x, ax, nChunks);
+      pending.wait();
+      std::swap(x, ax);
+    },
+    x, nIter, comm);
+
+  for(auto i = 0u; i < N; ++i)
+    diff = std::max(diff, std::abs(x[i] - y[i]));
+  // productAsync() stores the local product, as product() does
+  A.productAsync(x, ax, nChunks).wait();
+  A.AllCollectGlobal(y);
+  for(auto i = 0u; i < N; ++i)
+    diff = std::max(diff, std::abs(ax[i] - y[i]));
+  if(mpi_rank == 0)
+    std::cout << std::setw(8) << N << std::setw(14) << tOneChunk
+              << std::setw(14) << tAsync << std::setw(10)
+              << tOneChunk / tAsync << '\n';
+  return diff;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace apsc::LinearAlgebra;
+  MPI_Init(&argc, &argv);
+  int      mpi_rank;
+  int      mpi_size;
+  MPI_Comm mpi_comm = MPI_COMM_WORLD;
+  MPI_Comm_rank(mpi_comm, &mpi_rank);
+  MPI_Comm_size(mpi_comm, &mpi_size);
+  int const          nIter = argc > 1 ? std::stoi(argv[1]) : 50;
+  unsigned int const nChunks = argc > 2 ? std::stoul(argv[2]) : 4u;
+  using RowMatrix = Matrix<double, ORDERING::ROWMAJOR>;
+  using ColMatrix = Matrix<double, ORDERING::COLUMNMAJOR>;
+  double diff = 0.0;
+  for(bool rowMajor : {true, false})
+    {
+      if(mpi_rank == 0)
+        std::cout << (rowMajor ? "Row" : "Column")
+                  << " partition, P=" << mpi_size << ", " << nChunks
+                  << " chunks, time per iteration (ms)\n"
+                  << std::setw(8) << "N" << std::setw(14) << "1 chunk"
+                  << std::setw(14) << "chunked" << std::setw(10) << "speedup"
+                  << '\n';
+      for(std::size_t N : {500u, 1000u, 2000u, 4000u})
+        diff = std::max(diff, rowMajor ? benchmark<RowMatrix>(N, nIter,
+                                                              nChunks, mpi_comm)
+                                       : benchmark<ColMatrix>(N, nIter,
+                                                              nChunks,
+                                                              mpi_comm));
+    }
+  if(mpi_rank == 0)
+    std::cout << "Max difference between blocking and async results: " << diff
+              << '\n';
+  MPI_Finalize();
+}
@@ -0,0 +1,130 @@
+/*
+ * main_scaling2D.cpp
+ *
+ * Strong and weak scaling of the matrix distributed on a 2D grid of
+ * processes, compared with the 1D distribution of PMatrix.
+ *
+ * Usage: mpirun -np P main_scaling2D [N] [blockSize] [weak]
+ *
+ * N is the matrix size (default 1200). If the third argument is "weak", the
+ * size is scaled as N*sqrt(P), so that the memory per process is constant
+ * (for the matrix-matrix product the work per process grows as sqrt(P)).
+ * See scaling.sh for a script running both studies.
+ */
+#include "PMatrix.hpp"
+#include "PMatrix2D.hpp"
+#include "chrono.hpp" // my chrono in Utilities
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsuggest-override"
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+#include <mpi.h>
+#pragma GCC diagnostic pop
+namespace
+{
+double
+element(std::size_t i, std::size_t j)
+{
+  return 1.0 / (1.0 + i + j);
+}
+//! The maximum over the processes of the time taken by f
+template <class F>
+double
+timeIt(F &&f, MPI_Comm comm, int repetitions = 1)
+{
+  Timings::Chrono clock;
+  MPI_Barrier(comm);
+  clock.start();
+  for(int r = 0; r < repetitions; ++r)
+    f();
+  clock.stop();
+  double localTime = clock.wallTime() * 1.e-6 / repetitions; // seconds
+  double time;
+  MPI_Allreduce(&localTime, &time, 1, MPI_DOUBLE, MPI_MAX, comm);
+  return time;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace apsc::LinearAlgebra;
+  MPI_Init(&argc, &argv);
+  int      mpi_rank;
+  int      mpi_size;
+  MPI_Comm mpi_comm = MPI_COMM_WORLD;
+  MPI_Comm_rank(mpi_comm, &mpi_rank);
+  MPI_Comm_size(mpi_comm, &mpi_size);
+  using RowMatrix = Matrix<double, ORDERING::ROWMAJOR>;
+
+  std::size_t N = argc > 1 ? std::stoul(argv[1]) : 1200u;
+  std::size_t blockSize = argc > 2 ? std::stoul(argv[2]) : 0u;
+  bool const  weak = argc > 3 && std::string(argv[3]) == "weak";
+  if(weak)
+    N = static_cast<std::size_t>(N * std::sqrt(mpi_size));
+  constexpr int nProducts = 20;
+
+  // 2D: every process builds its own blocks
+  apsc::PMatrix2D<RowMatrix> A;
+  apsc::PMatrix2D<RowMatrix> B;
+  double const               tSetup2D = timeIt(
+    [&] {
+      A.setup(N, N, element, mpi_comm, blockSize);
+      B.setup(N, N, element, mpi_comm, blockSize);
+    },
+    mpi_comm);
+  apsc::PMatrix2D<RowMatrix> C;
+  double const tSumma = timeIt([&] { C.multiply(A, B); }, mpi_comm);
+  // Repeated matrix-vector products y=A^k x without global vectors
+  std::vector<double> x(N, 1.0);
+  auto                xLocal = A.localInput(x);
+  double const        tMatVec2D = timeIt(
+    [&] {
+      A.product(xLocal);
+      xLocal = A.productToInput();
+    },
+    mpi_comm, nProducts);
+
+  // 1D: the global matrix is built by the manager and scattered; the input
+  // vector is replicated on every process
+  RowMatrix gA;
+  double    tSetup1D = timeIt(
+    [&] {
+      if(mpi_rank == 0)
+        {
+          gA.resize(N, N);
+          for(auto i = 0u; i < N; ++i)
+            for(auto j = 0u; j < N; ++j)
+              gA(i, j) = element(i, j);
+        }
+    },
+    mpi_comm);
+  apsc::PMatrix<RowMatrix> A1D;
+  tSetup1D += timeIt([&] { A1D.setup(gA, mpi_comm); }, mpi_comm);
+  double const tMatVec1D = timeIt(
+    [&] {
+      A1D.product(x);
+      A1D.AllCollectGlobal(x);
+    },
+    mpi_comm, nProducts);
+
+  if(mpi_rank == 0)
+    {
+      auto const   dims = A.getGridDims();
+      double const gflops = 2.0 * N * N * N / tSumma * 1.e-9;
+      std::cout << std::setprecision(4);
+      std::cout << (weak ? "weak" : "strong") << " P=" << mpi_size
+                << " grid=" << dims[0] << "x" << dims[1] << " N=" << N
+                << " nb=" << A.getPartitioner().rows().get_BlockSize() << '\n';
+      std::cout << "  setup 2D (per-rank generator) " << tSetup2D / 2
+                << " s, setup 1D (scatter from rank 0) " << tSetup1D << " s\n";
+      std::cout << "  SUMMA " << tSumma << " s, " << gflops << " GFLOP/s, "
+                << gflops / mpi_size << " GFLOP/s per process\n";
+      std::cout << "  mat-vec 2D " << tMatVec2D * 1.e3 << " ms, mat-vec 1D "
+                << tMatVec1D * 1.e3 << " ms\n";
+    }
+  MPI_Finalize();
+}
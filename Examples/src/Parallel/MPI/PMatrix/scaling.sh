@@ -0,0 +1,16 @@
+#!/bin/bash
+# Strong and weak scaling of the 2D distributed matrix.
+# Usage: ./scaling.sh [N] [max number of processes] [blockSize]
+# Additional options for mpirun may be given in MPIRUN_FLAGS, for instance
+# MPIRUN_FLAGS="--oversubscribe" ./scaling.sh
+N=${1:-1200}
+PMAX=${2:-4}
+NB=${3:-0}
+echo "Strong scaling, N=${N}"
+for ((p = 1; p <= PMAX; p++)); do
+    mpirun ${MPIRUN_FLAGS} -np $p ./main_scaling2D $N $NB
+done
+echo "Weak scaling, N=${N}*sqrt(P)"
+for ((p = 1; p <= PMAX; p++)); do
+    mpirun ${MPIRUN_FLAGS} -np $p ./main_scaling2D $N $NB weak
+done
@@ -0,0 +1,240 @@
+/*
+ * HybridSimpson.hpp
+ *
+ *  Hybrid MPI/OpenMP composite Simpson rule with dynamic load balancing
+ */
+
+#ifndef AMSC_EXAMPLES_SRC_PARALLEL_OPENMP_SIMPSONHYBRID_HYBRIDSIMPSON_HPP_
+#define AMSC_EXAMPLES_SRC_PARALLEL_OPENMP_SIMPSONHYBRID_HYBRIDSIMPSON_HPP_
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <mpi.h>
+#include <stdexcept>
+#include <vector>
+namespace apsc
+{
+//! How the chunks are distributed among the MPI processes
+enum class SimpsonDistribution
+{
+  //! Consecutive blocks of chunks of (almost) the same size, as in
+  //! Parallel/MPI/Simpson
+  Static,
+  //! Rank 0 hands out batches of chunks on request
+  ManagerWorker
+};
+
+//! The parameters of hybridSimpson()
+struct HybridSimpsonOptions
+{
+  //! The number of chunks the intervals are grouped in (the unit of work)
+  unsigned int numChunks = 1024u;
+  //! Threads used by each process
+  unsigned int numThreads = 1u;
+  //! A batch has at least this number of chunks. The default (0) means
+  //! numThreads, so that all threads of a worker have some work
+  unsigned int minBatch = 0u;
+  SimpsonDistribution distribution = SimpsonDistribution::ManagerWorker;
+};
+
+//! The result of hybridSimpson(), meaningful only on rank 0
+struct HybridSimpsonResult
+{
+  double integral = 0.;
+  //! CPU time spent by each process (all its threads) computing the
+  //! integrals of the chunks (in ms). It measures the work done by each
+  //! process also if the processes share the cores
+  std::vector<double> busyTime;
+  //! Number of batches received by each process
+  std::vector<unsigned int> batches;
+};
+
+namespace internals
+{
+  //! Simpson rule on the intervals [first,last) of the global grid
+  inline double
+  simpsonIntervals(std::function<double(double const &)> const &f, double a,
+                   double h, unsigned long first, unsigned long last)
+  {
+    double integral{0.};
+    for(auto i = first; i < last; ++i)
+      integral +=
+        (f(a + i * h) + 4. * f(a + (i + 0.5) * h) + f(a + (i + 1.) * h));
+    return (h / 6.) * integral;
+  }
+
+  //! Computes the chunks [first, first+result.size()) with the threads
+  /*!
+    The chunks are given to the threads dynamically, since their cost may be
+    very different. Each chunk is computed by a single thread, so its value
+    does not depend on the number of threads.
+   */
+  inline void
+  computeChunks(std::function<double(double const &)> const &f, double a,
+                double h, unsigned long n, unsigned int numChunks,
+                unsigned int first, std::vector<double> &result,
+                unsigned int numThreads)
+  {
+    auto const count = static_cast<int>(result.size());
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic, 1)
+    for(int c = 0; c < count; ++c)
+      {
+        unsigned long const chunk = first + c;
+        result[c] = simpsonIntervals(f, a, h, chunk * n / numChunks,
+                                     (chunk + 1ul) * n / numChunks);
+      }
+  }
+
+  //! The tags of the messages of the manager/worker protocol
+  enum SimpsonTag : int
+  {
+    resultTag = 1,
+    batchTag = 2
+  };
+} // namespace internals
+
+/*!
+  Computes the composite Simpson rule between a and b with n intervals, with
+  MPI processes and OpenMP threads.
+
+  The n intervals are grouped in options.numChunks chunks of consecutive
+  intervals, and the integral on each chunk is computed by a single thread.
+  The chunks are distributed among the processes
+
+  - statically, in consecutive blocks, or
+  - by a manager/worker scheme: rank 0 does not compute, it sends to each
+    worker that asks for work a batch of consecutive chunks, and gets back
+    the integrals on the chunks of the previous batch. The size of the batch
+    decreases with the remaining work (guided self scheduling): it is the
+    remaining chunks divided by twice the number of workers, but not less
+    than options.minBatch. So the first batches are large (few messages) and
+    the last ones small (good balance at the end).
+
+  In both cases rank 0 collects the integrals of all chunks and adds them in
+  the order of the chunks: the result is the same (bitwise) for any number
+  of processes and threads, and any distribution.
+
+  Must be called by all processes of the communicator, but MPI is used only
+  outside the OpenMP parallel regions (MPI_THREAD_FUNNELED is sufficient).
+
+  @param f The integrand, which must be thread-safe
+  @return The integral and some statistics, on rank 0
+ */
+inline HybridSimpsonResult
+hybridSimpson(std::function<double(double const &)> const &f, double a,
+              double b, unsigned long n, HybridSimpsonOptions const &options,
+              MPI_Comm comm = MPI_COMM_WORLD)
+{
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  auto const numChunks = options.numChunks;
+  if(numChunks == 0u || numChunks > n)
+    throw std::invalid_argument(
+      "hybridSimpson: the number of chunks must be in [1,n]");
+  auto const numThreads = std::max(1u, options.numThreads);
+  auto const minBatch = options.minBatch > 0u ? options.minBatch : numThreads;
+  double const        h = (b - a) / n;
+  std::vector<double> chunkIntegrals(rank == 0 ? numChunks : 0u);
+  double              busy = 0.;
+  unsigned int        batches = 0u;
+  auto const          cpuTime = [] {
+    return 1000. * std::clock() / CLOCKS_PER_SEC;
+  };
+
+  if(options.distribution == SimpsonDistribution::Static || size == 1)
+    {
+      // rank r computes the chunks [r*numChunks/size, (r+1)*numChunks/size)
+      std::vector<int> counts(size), displacements(size);
+      for(int r = 0; r < size; ++r)
+        {
+          displacements[r] = static_cast<int>(1ul * r * numChunks / size);
+          counts[r] = static_cast<int>(1ul * (r + 1) * numChunks / size) -
+                      displacements[r];
+        }
+      std::vector<double> local(counts[rank]);
+      double const start = cpuTime();
+      internals::computeChunks(f, a, h, n, numChunks, displacements[rank],
+                               local, numThreads);
+      busy = cpuTime() - start;
+      batches = 1u;
+      MPI_Gatherv(local.data(), counts[rank], MPI_DOUBLE,
+                  chunkIntegrals.data(), counts.data(), displacements.data(),
+                  MPI_DOUBLE, 0, comm);
+    }
+  else if(rank == 0)
+    {
+      // The manager. A message from a worker contains the first chunk of the
+      // batch it has computed (-1 for the first request), followed by the
+      // integrals. The answer is the first chunk and the number of chunks of
+      // the new batch, 0 chunks means that the work is over.
+      auto const   workers = static_cast<unsigned int>(size - 1);
+      unsigned int next = 0u;
+      unsigned int stopped = 0u;
+      std::vector<double> message(numChunks + 1u);
+      while(stopped < workers)
+        {
+          MPI_Status status;
+          MPI_Recv(message.data(), static_cast<int>(message.size()),
+                   MPI_DOUBLE, MPI_ANY_SOURCE, internals::resultTag, comm,
+                   &status);
+          int length;
+          MPI_Get_count(&status, MPI_DOUBLE, &length);
+          if(message[0] >= 0.)
+            std::copy_n(message.begin() + 1, length - 1,
+                        chunkIntegrals.begin() +
+                          static_cast<unsigned int>(message[0]));
+          unsigned int const remaining = numChunks - next;
+          unsigned int const guided = remaining / (2u * workers);
+          unsigned int       batch[2] = {
+            next, std::min(remaining, std::max(minBatch, guided))};
+          next += batch[1];
+          if(batch[1] == 0u)
+            ++stopped;
+          MPI_Send(batch, 2, MPI_UNSIGNED, status.MPI_SOURCE,
+                   internals::batchTag, comm);
+        }
+    }
+  else
+    {
+      // A worker
+      std::vector<double> message{-1.};
+      while(true)
+        {
+          MPI_Send(message.data(), static_cast<int>(message.size()),
+                   MPI_DOUBLE, 0, internals::resultTag, comm);
+          unsigned int batch[2];
+          MPI_Recv(batch, 2, MPI_UNSIGNED, 0, internals::batchTag, comm,
+                   MPI_STATUS_IGNORE);
+          if(batch[1] == 0u)
+            break;
+          ++batches;
+          std::vector<double> integrals(batch[1]);
+          double const start = cpuTime();
+          internals::computeChunks(f, a, h, n, numChunks, batch[0], integrals,
+                                   numThreads);
+          busy += cpuTime() - start;
+          message.resize(batch[1] + 1u);
+          message[0] = batch[0];
+          std::copy(integrals.begin(), integrals.end(), message.begin() + 1);
+        }
+    }
+
+  HybridSimpsonResult result;
+  if(rank == 0)
+    {
+      result.busyTime.resize(size);
+      result.batches.resize(size);
+      // in the order of the chunks
+      for(auto v : chunkIntegrals)
+        result.integral += v;
+    }
+  MPI_Gather(&busy, 1, MPI_DOUBLE, result.busyTime.data(), 1, MPI_DOUBLE, 0,
+             comm);
+  MPI_Gather(&batches, 1, MPI_UNSIGNED, result.batches.data(), 1,
+             MPI_UNSIGNED, 0, comm);
+  return result;
+}
+} // namespace apsc
+
+#endif /* AMSC_EXAMPLES_SRC_PARALLEL_OPENMP_SIMPSONHYBRID_HYBRIDSIMPSON_HPP_ */
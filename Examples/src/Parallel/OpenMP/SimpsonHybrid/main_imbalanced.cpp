@@ -0,0 +1,128 @@
+/*
+ * main_imbalanced.cpp
+ *
+ *  Static and dynamic (manager/worker) distribution of the work in the
+ *  hybrid Simpson rule, with integrands whose cost of evaluation is very
+ *  different in different parts of the domain.
+ *
+ *  Usage: mpirun -n 4 ./main_imbalanced [n] [numChunks] [numThreads]
+ *
+ *  The integral must be the same, to the last bit, with any distribution and
+ *  any number of processes and threads.
+ */
+#include "HybridSimpson.hpp"
+#include "chrono.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace
+{
+/*!
+  sin(x) computed as the average of work(x) evaluations of sin(x+k*1.e-12),
+  k=0,...,work(x)-1: the value is almost sin(x), the cost proportional to
+  work(x).
+ */
+double
+costly(double x, unsigned int work)
+{
+  double s = 0.;
+  for(unsigned int k = 0u; k < work; ++k)
+    s += std::sin(x + k * 1.e-12);
+  return s / work;
+}
+
+//! The integrands, on [0,1]
+struct Integrand
+{
+  std::string                           name;
+  std::function<double(double const &)> f;
+};
+
+void
+run(Integrand const &integrand, unsigned long n,
+    apsc::HybridSimpsonOptions options, int rank)
+{
+  for(auto distribution : {apsc::SimpsonDistribution::Static,
+                           apsc::SimpsonDistribution::ManagerWorker})
+    {
+      options.distribution = distribution;
+      MPI_Barrier(MPI_COMM_WORLD);
+      Timings::Chrono clock;
+      clock.start();
+      auto const result =
+        apsc::hybridSimpson(integrand.f, 0., 1., n, options);
+      clock.stop();
+      if(rank != 0)
+        continue;
+      // the manager does not compute
+      auto const first =
+        distribution == apsc::SimpsonDistribution::ManagerWorker &&
+            result.busyTime.size() > 1u
+          ? result.busyTime.begin() + 1
+          : result.busyTime.begin();
+      auto const [minBusy, maxBusy] =
+        std::minmax_element(first, result.busyTime.end());
+      unsigned int batches = 0u;
+      for(auto b : result.batches)
+        batches += b;
+      std::cout << std::left << std::setw(10) << integrand.name
+                << std::setw(15)
+                << (distribution == apsc::SimpsonDistribution::Static
+                      ? "static"
+                      : "manager/worker")
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(11) << clock.wallTime() * 1.e-3 << std::setw(11)
+                << *minBusy << std::setw(11) << *maxBusy << std::setw(9)
+                << batches << "  " << std::hexfloat << result.integral
+                << std::defaultfloat << '\n';
+    }
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  unsigned long const        n = argc > 1 ? std::stoul(argv[1]) : 200000ul;
+  apsc::HybridSimpsonOptions options;
+  options.numChunks = argc > 2 ? std::stoul(argv[2]) : 1024u;
+  options.numThreads = argc > 3 ? std::stoul(argv[3]) : 1u;
+
+  std::vector<Integrand> integrands{
+    {"uniform", [](double const &x) { return costly(x, 20u); }},
+    // the cost grows like x^3
+    {"ramp",
+     [](double const &x) {
+       return costly(x, 1u + static_cast<unsigned int>(80. * x * x * x));
+     }},
+    // almost all the cost in [0.9,0.95]
+    {"peak", [](double const &x) {
+       return costly(x, x >= 0.9 && x < 0.95 ? 200u : 1u);
+     }}};
+  if(rank == 0)
+    {
+      std::cout << "Simpson rule on [0,1] with " << n << " intervals, "
+                << options.numChunks << " chunks, " << size
+                << " processes and " << options.numThreads
+                << " threads per process\n"
+                << "busy: CPU time (ms) spent computing by the (worker) "
+                   "processes\n"
+                << std::left << std::setw(10) << "integrand" << std::setw(15)
+                << "distribution" << std::right << std::setw(11)
+                << "time (ms)" << std::setw(11) << "min busy" << std::setw(11)
+                << "max busy" << std::setw(9) << "batches"
+                << "  integral\n";
+    }
+  for(auto const &integrand : integrands)
+    run(integrand, n, options, rank);
+  MPI_Finalize();
+  return 0;
+}
@@ -443,6 +443,243 @@ private:
   P            Partitioner;
 };
 
+/*!
+ * Partitions num_elements elements into num_tasks chunks with a block-cyclic
+ * strategy
+ *
+ * The elements are grouped in blocks of block_size consecutive elements (the
+ * last block may be shorter) and block b is assigned to task b % num_tasks.
+ * It is the distribution used by ScaLAPACK, and the one described by
+ * MPI_DISTRIBUTE_CYCLIC in MPI_Type_create_darray.
+ *
+ * A task owns in general several non contiguous blocks, so this class does
+ * not satisfy the PartitionerType concept. It provides instead the mapping
+ * between global and local indices. If block_size is
+ * ceil(num_elements/num_tasks) every task owns a single block and we recover a
+ * block partition.
+ */
+class BlockCyclicPartitioner
+{
+public:
+  /*!
+   * Constructor
+   * @param num_tasks The number of tasks
+   * @param num_elements The number of elements
+   * @param block_size The size of the blocks. If 0, a pure block partition is
+   * used (block_size = ceil(num_elements/num_tasks))
+   */
+  BlockCyclicPartitioner(unsigned int num_tasks, std::size_t num_elements,
+                         std::size_t block_size = 0u)
+  {
+    setPartitioner(num_tasks, num_elements, block_size);
+  }
+  BlockCyclicPartitioner() = default;
+  /*!
+   * Sets partitioner data if not given with constructor
+   * @param num_t The number of tasks
+   * @param num_e The number of elements
+   * @param block_s The size of the blocks (0 means pure block partition)
+   */
+  void
+  setPartitioner(unsigned int num_t, std::size_t num_e,
+                 std::size_t block_s = 0u)
+  {
+    num_tasks = num_t;
+    num_elements = num_e;
+    block_size = block_s != 0u ? block_s : (num_e + num_t - 1u) / num_t;
+    block_size = std::max(block_size, std::size_t{1u});
+  }
+  /*!
+   * The task owning element i
+   * @param i The global index
+   * @return The task
+   */
+  auto
+  loc(std::size_t i) const
+  {
+    return static_cast<unsigned int>((i / block_size) % num_tasks);
+  }
+  /*!
+   * The local index of element i in the task owning it
+   * @param i The global index
+   * @return The local index
+   */
+  auto
+  to_local(std::size_t i) const
+  {
+    return (i / (block_size * num_tasks)) * block_size + i % block_size;
+  }
+  /*!
+   * The global index of the l-th element owned by task t
+   * @param t The task
+   * @param l The local index
+   * @return The global index
+   */
+  auto
+  to_global(std::size_t t, std::size_t l) const
+  {
+    return ((l / block_size) * num_tasks + t) * block_size + l % block_size;
+  }
+  /*!
+   * The number of elements owned by task t
+   * @param t The task
+   * @return The number of elements
+   */
+  std::size_t
+  local_size(std::size_t t) const
+  {
+    std::size_t const num_blocks = (num_elements + block_size - 1u) / block_size;
+    if(t >= num_blocks)
+      return 0u;
+    // blocks owned: t, t+num_tasks, ...
+    std::size_t const my_blocks = (num_blocks - 1u - t) / num_tasks + 1u;
+    std::size_t       size = my_blocks * block_size;
+    // the last block may be shorter
+    if((num_blocks - 1u) % num_tasks == t)
+      size -= num_blocks * block_size - num_elements;
+    return size;
+  }
+  /*!
+   * The size of the blocks
+   * @return The size of the blocks
+   */
+  auto
+  get_BlockSize() const
+  {
+    return block_size;
+  }
+  /*!
+   * The number of tasks
+   * @return The number of tasks
+   */
+  auto
+  get_NumTasks() const
+  {
+    return num_tasks;
+  }
+
+private:
+  unsigned int num_tasks = 1u;
+  std::size_t  num_elements = 0u;
+  std::size_t  block_size = 1u;
+};
+
+/*!
+ * Class that provides the tools for partitioning a matrix on a 2D grid of
+ * tasks
+ *
+ * Rows are distributed with a block-cyclic strategy over the rows of the task
+ * grid, and columns over the columns of the task grid. Tasks are numbered
+ * row-wise on the grid: task (pr,pc) has number pr*num_task_cols+pc, as in
+ * MPI_Cart_create and MPI_Type_create_darray.
+ *
+ * It complements MatrixPartitioner, which distributes the matrix in row or
+ * column stripes (a 1 x p or p x 1 grid).
+ */
+class GridMatrixPartitioner
+{
+public:
+  /*!
+   * Constructor taking matrix and grid properties
+   * @param num_rows Number of rows
+   * @param num_cols Number of columns
+   * @param num_task_rows Number of rows of the task grid
+   * @param num_task_cols Number of columns of the task grid
+   * @param block_rows Number of rows of a block (0 means pure block partition)
+   * @param block_cols Number of cols of a block (0 means pure block partition)
+   */
+  GridMatrixPartitioner(std::size_t num_rows, std::size_t num_cols,
+                        unsigned int num_task_rows, unsigned int num_task_cols,
+                        std::size_t block_rows = 0u,
+                        std::size_t block_cols = 0u)
+  {
+    setPartitioner(num_rows, num_cols, num_task_rows, num_task_cols,
+                   block_rows, block_cols);
+  }
+  GridMatrixPartitioner() = default;
+  /*!
+   * Sets the partitioner
+   * @param num_r Number of rows
+   * @param num_c Number of columns
+   * @param num_tr Number of rows of the task grid
+   * @param num_tc Number of columns of the task grid
+   * @param block_r Number of rows of a block (0 means pure block partition)
+   * @param block_c Number of cols of a block (0 means pure block partition)
+   */
+  void
+  setPartitioner(std::size_t num_r, std::size_t num_c, unsigned int num_tr,
+                 unsigned int num_tc, std::size_t block_r = 0u,
+                 std::size_t block_c = 0u)
+  {
+    num_rows = num_r;
+    num_cols = num_c;
+    rowPartitioner.setPartitioner(num_tr, num_r, block_r);
+    colPartitioner.setPartitioner(num_tc, num_c, block_c);
+  }
+  /*!
+   * The partitioner of the rows (over the rows of the task grid)
+   */
+  auto const &
+  rows() const
+  {
+    return rowPartitioner;
+  }
+  /*!
+   * The partitioner of the columns (over the columns of the task grid)
+   */
+  auto const &
+  cols() const
+  {
+    return colPartitioner;
+  }
+  /*!
+   * The task to which a given matrix element has been assigned
+   * @param row The row index
+   * @param col The column index
+   * @return the task number
+   */
+  auto
+  loc(std::size_t row, std::size_t col) const
+  {
+    return rowPartitioner.loc(row) * colPartitioner.get_NumTasks() +
+           colPartitioner.loc(col);
+  }
+  /*!
+   * Returns the number of rows and columns for each task
+   * @return an array with the number of rows and columns stored in two vectors
+   */
+  std::array<std::vector<std::size_t>, 2>
+  getLocalRowsAndCols() const
+  {
+    auto const               ntr = rowPartitioner.get_NumTasks();
+    auto const               ntc = colPartitioner.get_NumTasks();
+    std::vector<std::size_t> rows(ntr * ntc);
+    std::vector<std::size_t> cols(ntr * ntc);
+    for(std::size_t pr = 0u; pr < ntr; ++pr)
+      for(std::size_t pc = 0u; pc < ntc; ++pc)
+        {
+          rows[pr * ntc + pc] = rowPartitioner.local_size(pr);
+          cols[pr * ntc + pc] = colPartitioner.local_size(pc);
+        }
+    return {rows, cols};
+  }
+  /*!
+   * The number of tasks
+   * @return The number of tasks
+   */
+  auto
+  get_NumTasks() const
+  {
+    return rowPartitioner.get_NumTasks() * colPartitioner.get_NumTasks();
+  }
+
+private:
+  std::size_t            num_rows = 0u;
+  std::size_t            num_cols = 0u;
+  BlockCyclicPartitioner rowPartitioner;
+  BlockCyclicPartitioner colPartitioner;
+};
+
 } // namespace apsc
 
 #endif /* AMSC_EXAMPLES_EXAMPLES_SRC_PARALLEL_UTILITIES_PARTITIONER_HPP_ */
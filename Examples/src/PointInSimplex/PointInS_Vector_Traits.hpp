@@ -157,11 +157,12 @@ template <class Simplex, typename... Point>
 void
 make_simplex(Simplex &simplex, const Point &...points)
 {
-  static_assert(Simplex::size() == sizeof...(Point),
+  static_assert(std::tuple_size_v<Simplex> == sizeof...(Point),
                 "The number of points must be equal to the number of vertices "
                 "of the simplex");
   // check if point size is equal to simplex cols
-  static_assert((... && (Point::size() == Simplex::at(0).size())),
+  static_assert((... && (std::tuple_size_v<Point> ==
+                         std::tuple_size_v<typename Simplex::value_type>)),
                 "The size of the points must be equal to the number of columns "
                 "of the simplex");
   int i = 0;
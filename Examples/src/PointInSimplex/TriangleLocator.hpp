@@ -0,0 +1,371 @@
+#ifndef HH_TRIANGLELOCATOR_HH
+#define HH_TRIANGLELOCATOR_HH
+#include "PointInSimplex.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace apsc
+{
+/*!
+ * @brief Locates points in a triangulation
+ *
+ * The triangulation is given by the coordinates of the vertices and the
+ * connectivity (three vertex numbers per triangle), for instance extracted
+ * from a MeshTria with makeTriangleLocator().
+ *
+ * A point is located by a walk: starting from a triangle (typically the one
+ * where the previous point has been found) we compute the barycentric
+ * coordinates of the point with pointInTriangle(). If one is negative the
+ * point is beyond the edge opposite to the corresponding vertex, and we move
+ * to the triangle across that edge (the one with the most negative
+ * coordinate). For a stream of close points (particle tracking, points along
+ * a line) the walk takes very few steps.
+ *
+ * If the walk reaches the boundary (the domain may be non convex), or it
+ * takes too many steps, the point is searched with a uniform grid: each
+ * cell stores the triangles whose bounding box intersects it, and only those
+ * are tested.
+ *
+ * The located point is \f$p=\sum_i\lambda_i v_i\f$, where \f$v_i\f$ are
+ * the vertices of the triangle and \f$\lambda_i\f$ the barycentric
+ * coordinates returned, which can be used to interpolate nodal values.
+ */
+class TriangleLocator
+{
+public:
+  using Point = std::array<double, 2>;
+  using Connectivity = std::array<std::size_t, 3>;
+  //! The value indicating no triangle
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+  //! The result of a search
+  struct Location
+  {
+    //! The triangle containing the point (npos if not found)
+    std::size_t triangle = npos;
+    //! The barycentric coordinates of the point in the triangle
+    std::array<double, 3> lambda{};
+    //! Whether the point has been found
+    bool
+    found() const
+    {
+      return triangle != npos;
+    }
+  };
+  //! Statistics of a batch search
+  struct Statistics
+  {
+    //! Total number of steps of the walks
+    std::size_t walkSteps = 0u;
+    //! Number of searches done with the grid
+    std::size_t gridSearches = 0u;
+    //! Number of points outside the triangulation
+    std::size_t notFound = 0u;
+  };
+
+  /*!
+   * @param vertices The coordinates of the vertices
+   * @param triangles The vertices of each triangle (any orientation)
+   * @param cellsPerTriangle The number of cells of the grid divided by the
+   * number of triangles
+   */
+  TriangleLocator(std::vector<Point> vertices,
+                  std::vector<Connectivity> triangles,
+                  double cellsPerTriangle = 1.);
+
+  //! Locates a point with a walk starting from triangle start. If start is
+  //! npos the grid is used directly
+  Location
+  locate(Point const &p, std::size_t start = npos) const
+  {
+    std::size_t steps = 0u;
+    bool        usedGrid = false;
+    return walk(p, start, steps, usedGrid);
+  }
+  //! Locates a point with the grid only
+  Location locateWithGrid(Point const &p) const;
+
+  /*!
+   * Locates a batch of points. If a point is close to the previous one (less
+   * than two cells of the grid) the walk starts from the triangle of the
+   * previous point, otherwise from a triangle of the cell of the grid
+   * containing the point (jump and walk). So the walk is short both for
+   * coherent and for random streams of points. If compiled with OpenMP the
+   * points are divided among the threads in contiguous blocks, to keep the
+   * coherence.
+   */
+  Statistics locate(std::span<Point const> points,
+                    std::span<Location>    locations) const;
+
+  //! The number of triangles
+  std::size_t
+  numTriangles() const
+  {
+    return M_triangles.size();
+  }
+  //! The neighbours: neighbours()[t][k] is the triangle across the edge
+  //! opposite to vertex k of triangle t (npos on the boundary)
+  std::vector<Connectivity> const &
+  neighbours() const
+  {
+    return M_neighbours;
+  }
+  //! Sets the max number of steps of a walk, before passing to the grid
+  //! (by default 10 plus 4 times the square root of the number of triangles)
+  void
+  setMaxSteps(std::size_t maxSteps)
+  {
+    M_maxSteps = maxSteps;
+  }
+
+private:
+  /*!
+   * The walk from triangle start (the grid if start is npos)
+   * @param steps The number of steps of the walk is added
+   * @param usedGrid Set to true if the grid has been used
+   */
+  Location walk(Point const &p, std::size_t start, std::size_t &steps,
+                bool &usedGrid) const;
+  //! A triangle intersecting the cell containing p (npos if none)
+  std::size_t
+  cellTriangle(Point const &p) const
+  {
+    if(!(p[0] >= M_box[0] && p[0] <= M_box[2] && p[1] >= M_box[1] &&
+         p[1] <= M_box[3]))
+      return npos;
+    auto const c =
+      cell(p[1], M_box[1], M_ny) * M_nx + cell(p[0], M_box[0], M_nx);
+    return M_cellStart[c] < M_cellStart[c + 1u]
+             ? M_cellTriangles[M_cellStart[c]]
+             : npos;
+  }
+  //! The barycentric coordinates of p in triangle t
+  std::tuple<bool, std::array<double, 3>>
+  barycentric(Point const &p, std::size_t t) const
+  {
+    PointInS_Traits::Triangle triangle;
+    PointInS_Traits::Point2D  point;
+    PointInS_Traits::Point2D  v[3];
+    for(int k = 0; k < 3; ++k)
+      {
+        v[k][0] = M_vertices[M_triangles[t][k]][0];
+        v[k][1] = M_vertices[M_triangles[t][k]][1];
+      }
+    point[0] = p[0];
+    point[1] = p[1];
+    make_simplex(triangle, v[0], v[1], v[2]);
+    auto const [in, l] = pointInTriangle(point, triangle);
+    return {in, {l[0], l[1], l[2]}};
+  }
+  //! The cell containing a coordinate (clamped)
+  std::size_t
+  cell(double x, double origin, std::size_t numCells) const
+  {
+    auto const c = static_cast<std::ptrdiff_t>((x - origin) / M_cellSize);
+    auto const last = static_cast<std::ptrdiff_t>(numCells) - 1;
+    return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(c, 0, last));
+  }
+  std::vector<Point>        M_vertices;
+  std::vector<Connectivity> M_triangles;
+  std::vector<Connectivity> M_neighbours;
+  std::size_t               M_maxSteps;
+  //! The grid: bounding box, cells, and the triangles of each cell in CSR
+  //! format
+  std::array<double, 4>    M_box;
+  double                   M_cellSize;
+  std::size_t              M_nx, M_ny;
+  std::vector<std::size_t> M_cellStart;
+  std::vector<std::size_t> M_cellTriangles;
+};
+
+/*!
+ * Builds a locator from a mesh with num_points(), point(i)[j],
+ * num_elements() and element(e)[k].id(), like MeshTria
+ */
+template <class Mesh>
+TriangleLocator
+makeTriangleLocator(Mesh const &mesh, double cellsPerTriangle = 1.)
+{
+  std::vector<TriangleLocator::Point> vertices(mesh.num_points());
+  for(std::size_t i = 0u; i < vertices.size(); ++i)
+    vertices[i] = {mesh.point(i)[0], mesh.point(i)[1]};
+  std::vector<TriangleLocator::Connectivity> triangles(mesh.num_elements());
+  for(std::size_t e = 0u; e < triangles.size(); ++e)
+    for(int k = 0; k < 3; ++k)
+      triangles[e][k] = mesh.element(e)[k].id();
+  return TriangleLocator(std::move(vertices), std::move(triangles),
+                         cellsPerTriangle);
+}
+
+// IMPLEMENTATIONS---------------------------------------------------------
+
+inline TriangleLocator::TriangleLocator(std::vector<Point>        vertices,
+                                        std::vector<Connectivity> triangles,
+                                        double cellsPerTriangle)
+  : M_vertices(std::move(vertices)), M_triangles(std::move(triangles))
+{
+  auto const n = M_triangles.size();
+  if(n == 0u)
+    throw std::invalid_argument("TriangleLocator: no triangles");
+  for(auto const &t : M_triangles)
+    for(auto v : t)
+      if(v >= M_vertices.size())
+        throw std::invalid_argument("TriangleLocator: wrong vertex number");
+  M_maxSteps = 10u + 4u * static_cast<std::size_t>(std::sqrt(n));
+
+  // The neighbours, by sorting the edges: {min vertex, max vertex, 3*t+k}
+  std::vector<std::array<std::size_t, 3>> edges(3u * n);
+  for(std::size_t t = 0u; t < n; ++t)
+    for(std::size_t k = 0u; k < 3u; ++k)
+      {
+        auto const a = M_triangles[t][(k + 1u) % 3u];
+        auto const b = M_triangles[t][(k + 2u) % 3u];
+        edges[3u * t + k] = {std::min(a, b), std::max(a, b), 3u * t + k};
+      }
+  std::sort(edges.begin(), edges.end());
+  M_neighbours.assign(n, {npos, npos, npos});
+  for(std::size_t e = 0u; e + 1u < edges.size(); ++e)
+    if(edges[e][0] == edges[e + 1u][0] && edges[e][1] == edges[e + 1u][1])
+      {
+        auto const first = edges[e][2];
+        auto const second = edges[e + 1u][2];
+        M_neighbours[first / 3u][first % 3u] = second / 3u;
+        M_neighbours[second / 3u][second % 3u] = first / 3u;
+        ++e;
+      }
+
+  // The grid
+  M_box = {M_vertices[M_triangles[0][0]][0], M_vertices[M_triangles[0][0]][1],
+           M_vertices[M_triangles[0][0]][0], M_vertices[M_triangles[0][0]][1]};
+  for(auto const &t : M_triangles)
+    for(auto v : t)
+      {
+        M_box[0] = std::min(M_box[0], M_vertices[v][0]);
+        M_box[1] = std::min(M_box[1], M_vertices[v][1]);
+        M_box[2] = std::max(M_box[2], M_vertices[v][0]);
+        M_box[3] = std::max(M_box[3], M_vertices[v][1]);
+      }
+  double const width = M_box[2] - M_box[0];
+  double const height = M_box[3] - M_box[1];
+  M_cellSize =
+    std::sqrt(width * height / std::max(1., cellsPerTriangle * n));
+  M_cellSize = std::max(M_cellSize, std::max(width, height) / (4. * n));
+  if(!(M_cellSize > 0.))
+    throw std::invalid_argument("TriangleLocator: degenerate triangulation");
+  M_nx = static_cast<std::size_t>(width / M_cellSize) + 1u;
+  M_ny = static_cast<std::size_t>(height / M_cellSize) + 1u;
+  M_cellStart.assign(M_nx * M_ny + 1u, 0u);
+  auto const forCells = [this](Connectivity const &t, auto &&f) {
+    auto const [xmin, xmax] = std::minmax(
+      {M_vertices[t[0]][0], M_vertices[t[1]][0], M_vertices[t[2]][0]});
+    auto const [ymin, ymax] = std::minmax(
+      {M_vertices[t[0]][1], M_vertices[t[1]][1], M_vertices[t[2]][1]});
+    for(auto j = cell(ymin, M_box[1], M_ny); j <= cell(ymax, M_box[1], M_ny);
+        ++j)
+      for(auto i = cell(xmin, M_box[0], M_nx);
+          i <= cell(xmax, M_box[0], M_nx); ++i)
+        f(j * M_nx + i);
+  };
+  for(auto const &t : M_triangles)
+    forCells(t, [this](std::size_t c) { ++M_cellStart[c + 1u]; });
+  for(std::size_t c = 0u; c + 1u < M_cellStart.size(); ++c)
+    M_cellStart[c + 1u] += M_cellStart[c];
+  M_cellTriangles.resize(M_cellStart.back());
+  std::vector<std::size_t> next(M_cellStart.begin(), M_cellStart.end() - 1);
+  for(std::size_t t = 0u; t < n; ++t)
+    forCells(M_triangles[t],
+             [&](std::size_t c) { M_cellTriangles[next[c]++] = t; });
+}
+
+inline TriangleLocator::Location
+TriangleLocator::locateWithGrid(Point const &p) const
+{
+  // written so that NaNs are outside
+  if(!(p[0] >= M_box[0] && p[0] <= M_box[2] && p[1] >= M_box[1] &&
+       p[1] <= M_box[3]))
+    return {};
+  auto const c = cell(p[1], M_box[1], M_ny) * M_nx + cell(p[0], M_box[0], M_nx);
+  for(auto k = M_cellStart[c]; k < M_cellStart[c + 1u]; ++k)
+    {
+      auto const t = M_cellTriangles[k];
+      auto const [in, lambda] = barycentric(p, t);
+      if(in)
+        return {t, lambda};
+    }
+  return {};
+}
+
+inline TriangleLocator::Location
+TriangleLocator::walk(Point const &p, std::size_t start, std::size_t &steps,
+                      bool &usedGrid) const
+{
+  auto t = start;
+  if(t < numTriangles())
+    for(std::size_t step = 0u; step < M_maxSteps; ++step, ++steps)
+      {
+        auto const [in, lambda] = barycentric(p, t);
+        if(in)
+          return {t, lambda};
+        // Degenerate triangle: give up the walk
+        if(std::isnan(lambda[0]))
+          break;
+        auto const k = static_cast<std::size_t>(
+          std::min_element(lambda.begin(), lambda.end()) - lambda.begin());
+        t = M_neighbours[t][k];
+        // We reached the boundary
+        if(t == npos)
+          break;
+      }
+  usedGrid = true;
+  return locateWithGrid(p);
+}
+
+inline TriangleLocator::Statistics
+TriangleLocator::locate(std::span<Point const> points,
+                        std::span<Location>    locations) const
+{
+  if(locations.size() < points.size())
+    throw std::invalid_argument(
+      "TriangleLocator::locate: sizes of the spans do not match");
+  auto const  n = static_cast<std::ptrdiff_t>(points.size());
+  std::size_t walkSteps = 0u, gridSearches = 0u, notFound = 0u;
+#ifdef _OPENMP
+#pragma omp parallel reduction(+ : walkSteps, gridSearches, notFound)
+#endif
+  {
+    // The previous point of this thread, and its triangle
+    Point       last{0., 0.};
+    std::size_t previous = npos;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for(std::ptrdiff_t i = 0; i < n; ++i)
+      {
+        auto const &p = points[i];
+        auto        start = previous;
+        if(previous == npos ||
+           std::abs(p[0] - last[0]) + std::abs(p[1] - last[1]) >
+             2. * M_cellSize)
+          start = cellTriangle(p);
+        last = p;
+        bool usedGrid = false;
+        locations[i] = walk(p, start, walkSteps, usedGrid);
+        gridSearches += usedGrid;
+        if(locations[i].found())
+          previous = locations[i].triangle;
+        else
+          ++notFound;
+      }
+  }
+  return {walkSteps, gridSearches, notFound};
+}
+
+} // namespace apsc
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Benchmark of TriangleLocator
+ *
+ * Usage: main_locator [numPoints] (10^6 by default)
+ *
+ * The triangulation is a perturbed structured mesh of the unit square with
+ * 2n^2 triangles. The points are either along a curve (a coherent stream,
+ * like in particle tracking) or random. We compare
+ *  - the test of all triangles with pointInTriangle() (on a few points)
+ *  - the grid alone
+ *  - the walk from the previous triangle, point by point
+ *  - the batch search, which jumps to the grid for far points
+ *    (multithreaded if compiled with OpenMP)
+ * and we check the barycentric coordinates by interpolating the
+ * coordinates of the vertices.
+ */
+#include "TriangleLocator.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+namespace
+{
+using apsc::TriangleLocator;
+using Point = TriangleLocator::Point;
+
+struct Mesh
+{
+  std::vector<Point>                         vertices;
+  std::vector<TriangleLocator::Connectivity> triangles;
+};
+
+//! n x n squares, each split in two triangles, interior vertices perturbed
+Mesh
+makeMesh(std::size_t n)
+{
+  Mesh                                   mesh;
+  std::mt19937                           engine(4321u);
+  std::uniform_real_distribution<double> noise(-0.25, 0.25);
+  double const                           h = 1. / n;
+  for(std::size_t j = 0u; j <= n; ++j)
+    for(std::size_t i = 0u; i <= n; ++i)
+      {
+        bool const interior = i > 0u && i < n && j > 0u && j < n;
+        mesh.vertices.push_back(
+          {h * (i + (interior ? noise(engine) : 0.)),
+           h * (j + (interior ? noise(engine) : 0.))});
+      }
+  for(std::size_t j = 0u; j < n; ++j)
+    for(std::size_t i = 0u; i < n; ++i)
+      {
+        auto const v = j * (n + 1u) + i;
+        mesh.triangles.push_back({v, v + 1u, v + n + 2u});
+        mesh.triangles.push_back({v, v + n + 2u, v + n + 1u});
+      }
+  return mesh;
+}
+
+//! Points along a closed curve that fills the square
+std::vector<Point>
+curvePoints(std::size_t numPoints)
+{
+  std::vector<Point> points(numPoints);
+  for(std::size_t i = 0u; i < numPoints; ++i)
+    {
+      double const s = 2. * std::numbers::pi * i / numPoints;
+      points[i] = {0.5 + 0.45 * std::sin(3. * s) * std::cos(s),
+                   0.5 + 0.45 * std::sin(5. * s)};
+    }
+  return points;
+}
+
+std::vector<Point>
+randomPoints(std::size_t numPoints)
+{
+  std::mt19937                           engine(1234u);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::vector<Point>                     points(numPoints);
+  for(auto &p : points)
+    p = {uniform(engine), uniform(engine)};
+  return points;
+}
+
+//! Max distance between the points and the interpolated points
+double
+maxError(Mesh const &mesh, std::vector<Point> const &points,
+         std::vector<TriangleLocator::Location> const &locations)
+{
+  double error = 0.;
+  for(std::size_t i = 0u; i < points.size(); ++i)
+    {
+      if(!locations[i].found())
+        return std::numeric_limits<double>::infinity();
+      Point q{0., 0.};
+      for(int k = 0; k < 3; ++k)
+        {
+          auto const &t = mesh.triangles[locations[i].triangle];
+          auto const &v = mesh.vertices[t[k]];
+          q[0] += locations[i].lambda[k] * v[0];
+          q[1] += locations[i].lambda[k] * v[1];
+        }
+      error = std::max(error, std::hypot(q[0] - points[i][0],
+                                         q[1] - points[i][1]));
+    }
+  return error;
+}
+
+//! Time in ns per point
+template <class F>
+double
+nsPerPoint(std::size_t numPoints, F &&f)
+{
+  Timings::Chrono clock;
+  clock.start();
+  f();
+  clock.stop();
+  return clock.wallTime() * 1.e3 / numPoints;
+}
+
+void
+benchmark(Mesh const &mesh, TriangleLocator const &locator,
+          std::string const &name, std::vector<Point> const &points)
+{
+  auto const                             n = points.size();
+  std::vector<TriangleLocator::Location> grid(n), walk(n), batch(n);
+  // brute force on a few points
+  std::size_t const numBrute =
+    std::min<std::size_t>(n, 20000000u / mesh.triangles.size() + 1u);
+  std::size_t found = 0u;
+  double const tBrute = nsPerPoint(numBrute, [&] {
+    for(std::size_t i = 0u; i < numBrute; ++i)
+      for(auto const &t : mesh.triangles)
+        {
+          apsc::PointInS_Traits::Triangle triangle;
+          apsc::PointInS_Traits::Point2D  p, v[3];
+          for(int k = 0; k < 3; ++k)
+            for(int d = 0; d < 2; ++d)
+              v[k][d] = mesh.vertices[t[k]][d];
+          p[0] = points[i][0];
+          p[1] = points[i][1];
+          apsc::make_simplex(triangle, v[0], v[1], v[2]);
+          if(std::get<0>(apsc::pointInTriangle(p, triangle)))
+            {
+              ++found;
+              break;
+            }
+        }
+  });
+  double const tGrid = nsPerPoint(n, [&] {
+    for(std::size_t i = 0u; i < n; ++i)
+      grid[i] = locator.locateWithGrid(points[i]);
+  });
+  double const tWalk = nsPerPoint(n, [&] {
+    std::size_t previous = TriangleLocator::npos;
+    for(std::size_t i = 0u; i < n; ++i)
+      {
+        walk[i] = locator.locate(points[i], previous);
+        previous = walk[i].triangle;
+      }
+  });
+  TriangleLocator::Statistics statistics;
+  double const                tBatch =
+    nsPerPoint(n, [&] { statistics = locator.locate(points, batch); });
+  double const error = std::max(
+    {maxError(mesh, points, grid), maxError(mesh, points, walk),
+     maxError(mesh, points, batch)});
+  std::cout << std::setw(10) << mesh.triangles.size() << std::setw(8) << name
+            << std::fixed << std::setprecision(1) << std::setw(12) << tBrute
+            << std::setw(9) << tGrid << std::setw(9) << tWalk << std::setw(9)
+            << tBatch << std::setw(11) << std::setprecision(2)
+            << static_cast<double>(statistics.walkSteps) / n << std::setw(9)
+            << statistics.gridSearches << std::scientific
+            << std::setprecision(1) << std::setw(10) << error
+            << std::defaultfloat
+            << (found == numBrute ? "" : "  brute force failed")
+            << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const numPoints = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  auto const        curve = curvePoints(numPoints);
+  auto const        random = randomPoints(numPoints);
+  std::cout << "Locating " << numPoints
+            << " points. Times in ns per point (brute force on a few "
+               "points)\n"
+            << std::setw(10) << "triangles" << std::setw(8) << "points"
+            << std::setw(12) << "all tria." << std::setw(9) << "grid"
+            << std::setw(9) << "walk" << std::setw(9) << "batch"
+            << std::setw(11) << "steps/pt" << std::setw(9) << "grid use"
+            << std::setw(10) << "error" << '\n';
+  for(std::size_t n : {100u, 316u, 1000u})
+    {
+      auto const      mesh = makeMesh(n);
+      Timings::Chrono clock;
+      clock.start();
+      TriangleLocator const locator(mesh.vertices, mesh.triangles);
+      clock.stop();
+      benchmark(mesh, locator, "curve", curve);
+      benchmark(mesh, locator, "random", random);
+      std::cout << "  (locator built in " << std::fixed << std::setprecision(1)
+                << clock.wallTime() * 1.e-3 << " ms)\n"
+                << std::defaultfloat;
+    }
+}
@@ -3,6 +3,7 @@
 #include "QuadratureRuleTraits.hpp"
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 
 namespace apsc::NumericalIntegration
@@ -53,6 +54,24 @@ public:
   virtual void
   setMaxIter(unsigned int)
   {}
+  /*!
+   * The nodes in [-1,1] of a standard rule, used to evaluate the integrand
+   * on all the nodes of a mesh at once. Empty for the other rules.
+   */
+  virtual std::span<double const>
+  nodes() const
+  {
+    return {};
+  }
+  /*!
+   * The weights of a standard rule, in the order of nodes(). Empty for the
+   * other rules.
+   */
+  virtual std::span<double const>
+  weights() const
+  {
+    return {};
+  }
   //! a string that identify the general type of quadrature rule
   virtual std::string name() const = 0;
 };
@@ -0,0 +1,332 @@
+#ifndef QUADRATURERULEPARALLELADAPTIVE_HPP
+#define QUADRATURERULEPARALLELADAPTIVE_HPP
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#ifdef PARALLELCPP
+#include <execution>
+#endif
+
+#include "QuadratureRuleBase.hpp"
+
+namespace apsc::NumericalIntegration
+{
+/*!
+  \brief Adaptive quadrature that refines the largest errors first, in
+  batches, without evaluating the integrand twice at the same point.
+
+  Like QuadratureRuleAdaptive it is a decorator of a standard rule: on each
+  subinterval the rule is applied on the whole interval (I_h) and on its two
+  halves (I_{h/2}) and the error is estimated as (I_{h/2}-I_h)*factor. But
+
+  - subintervals are kept in a priority queue ordered by the estimated error.
+    At each round the subintervals with the largest error are bisected (at
+    most batchSize of them, and not more than those whose error is needed to
+    exceed the target), until the sum of the errors is below the target
+    error (a global criterion, not the local one of QuadratureRuleAdaptive);
+
+  - the values of the integrand are cached, and nodes are computed so that
+    coincident nodes are bitwise equal: the rule on the halves of a parent
+    is the rule on the whole of its children, and nodes at the ends of the
+    interval (Simpson, Gauss-Lobatto...) are shared by adjacent intervals.
+    Bisecting a subinterval costs only the evaluations on its quarters;
+
+  - all the new points of a round are evaluated with a single call of the
+    integrand. An integrand of type FunPoints receives them all at once; a
+    scalar FunPoint is evaluated on them in parallel (with OpenMP, or with
+    the parallel algorithms if PARALLELCPP is defined).
+
+  The returned value is the sum of I_{h/2} on the final subintervals, the
+  estimated error is then a conservative one.
+
+  \tparam SQR A standard quadrature rule (derived from StandardQuadratureRule)
+ */
+template <class SQR>
+class QuadratureRuleParallelAdaptive final : public QuadratureRuleBase
+{
+public:
+  //! Information about the last call of apply()
+  struct Statistics
+  {
+    //! Number of evaluations of the integrand
+    std::size_t evaluations = 0u;
+    //! Number of final subintervals
+    std::size_t intervals = 0u;
+    //! Number of rounds of refinement
+    std::size_t rounds = 0u;
+    //! Estimated error
+    double error = 0.0;
+  };
+  //! Constructor.
+  /*!
+    @param targetError The target error
+    @param maxIter Maximal number of bisections
+    @param batchSize Maximal number of subintervals bisected in a round
+  */
+  QuadratureRuleParallelAdaptive(double       targetError = 1.e-6,
+                                 unsigned int maxIter = 100,
+                                 std::size_t  batchSize = 64u);
+
+  //! The clone method.
+  std::unique_ptr<QuadratureRuleBase> clone() const override;
+  //! set Target Error
+  void
+  setTargetError(double const t) override
+  {
+    targetError_ = t;
+  };
+  //! set Max number of bisections
+  void
+  setMaxIter(unsigned int n) override
+  {
+    maxIter_ = n;
+  };
+  //! set the maximal number of subintervals bisected in a round
+  void
+  setBatchSize(std::size_t n)
+  {
+    batchSize_ = std::max(n, std::size_t{1u});
+  }
+  //! The method that applies the rule (on a scalar integrand).
+  double apply(FunPoint const &, double const &a,
+               double const &b) const override;
+  //! The method that applies the rule (on an integrand working on vectors).
+  double apply(FunPoints const &, double const &a, double const &b) const;
+  //! Information about the last call of apply()
+  /*!
+    @note Not meaningful if apply() is called concurrently on the same object.
+   */
+  Statistics const &
+  statistics() const
+  {
+    return statistics_;
+  }
+  //! Returns a string identifying the rule
+  std::string
+  name() const override
+  {
+    return std::string{"Parallel Adaptive "} + therule_.name();
+  }
+
+private:
+  //! A subinterval, with the rule on its halves and the estimated error
+  struct Interval
+  {
+    double a;
+    double b;
+    double fine;
+    double error;
+  };
+  //! Ordering of the priority queue: largest error on top
+  static bool
+  smallerError(Interval const &i, Interval const &j)
+  {
+    return i.error < j.error;
+  }
+  //! The point corresponding to node y of [-1,1] in [a,b]
+  static double
+  point(double a, double b, double y)
+  {
+    // ends are not computed, so they coincide with those of the neighbours
+    if(y == -1.0)
+      return a;
+    if(y == 1.0)
+      return b;
+    return y * (b - a) * 0.5 + (a + b) * 0.5;
+  }
+  using Cache = std::unordered_map<double, double>;
+  //! Adds to x the nodes of the rule on [a,b]
+  static void addNodes(double a, double b, std::vector<double> &x);
+  //! The rule on [a,b], with the values in the cache
+  static double rule(double a, double b, Cache const &cache);
+  //! Builds the subinterval [a,b]
+  Interval interval(double a, double b, Cache const &cache) const;
+
+  inline static SQR  therule_;
+  double             targetError_;
+  unsigned int       maxIter_;
+  std::size_t        batchSize_;
+  double             factor_;
+  mutable Statistics statistics_;
+};
+
+// *** IMPLEMENTATIONS
+template <class SQR>
+QuadratureRuleParallelAdaptive<SQR>::QuadratureRuleParallelAdaptive(
+  double targetError, unsigned int maxIter, std::size_t batchSize)
+  : targetError_(targetError), maxIter_(maxIter),
+    batchSize_(std::max(batchSize, std::size_t{1u})),
+    factor_(1. / (1 - std::pow(2, 1.0 - therule_.order())))
+{}
+
+template <class SQR>
+std::unique_ptr<QuadratureRuleBase>
+QuadratureRuleParallelAdaptive<SQR>::clone() const
+{
+  return std::make_unique<QuadratureRuleParallelAdaptive<SQR>>(*this);
+}
+
+template <class SQR>
+void
+QuadratureRuleParallelAdaptive<SQR>::addNodes(double a, double b,
+                                             std::vector<double> &x)
+{
+  for(unsigned int i = 0u; i < therule_.num_nodes(); ++i)
+    x.push_back(point(a, b, therule_.node(i)));
+}
+
+template <class SQR>
+double
+QuadratureRuleParallelAdaptive<SQR>::rule(double a, double b,
+                                         Cache const &cache)
+{
+  double tmp = 0.0;
+  for(unsigned int i = 0u; i < therule_.num_nodes(); ++i)
+    tmp += cache.at(point(a, b, therule_.node(i))) * therule_.weight(i);
+  return (b - a) * 0.5 * tmp;
+}
+
+template <class SQR>
+typename QuadratureRuleParallelAdaptive<SQR>::Interval
+QuadratureRuleParallelAdaptive<SQR>::interval(double a, double b,
+                                             Cache const &cache) const
+{
+  double const xm = (a + b) / 2;
+  double const coarse = rule(a, b, cache);
+  double const fine = rule(a, xm, cache) + rule(xm, b, cache);
+  return {a, b, fine, std::abs((fine - coarse) * factor_)};
+}
+
+/*!
+  @detail The scalar integrand is evaluated in parallel on all the new points
+  of a round.
+*/
+template <class SQR>
+double
+QuadratureRuleParallelAdaptive<SQR>::apply(FunPoint const &f, double const &a,
+                                           double const &b) const
+{
+  return apply(
+    [&f](std::span<double const> x, std::span<double> fx) {
+#ifdef PARALLELCPP
+      std::transform(std::execution::par, x.begin(), x.end(), fx.begin(),
+                     [&f](double const &y) { return f(y); });
+#else
+#ifdef _OPENMP
+#pragma omp parallel for shared(f, x, fx)
+#endif
+      for(std::size_t i = 0u; i < x.size(); ++i)
+        fx[i] = f(x[i]);
+#endif
+    },
+    a, b);
+}
+
+template <class SQR>
+double
+QuadratureRuleParallelAdaptive<SQR>::apply(FunPoints const &f,
+                                           double const &a,
+                                           double const &b) const
+{
+  statistics_ = Statistics{};
+  Cache               cache;
+  std::vector<double> x;
+  std::vector<double> fx;
+  // Evaluates f on the points in x not yet in the cache
+  auto evaluate = [&]() {
+    std::erase_if(x, [&cache](double y) {
+      return !cache.try_emplace(y, 0.0).second;
+    });
+    fx.resize(x.size());
+    f(x, fx);
+    for(std::size_t i = 0u; i < x.size(); ++i)
+      cache[x[i]] = fx[i];
+    statistics_.evaluations += x.size();
+    x.clear();
+  };
+
+  double const xm = (a + b) / 2;
+  addNodes(a, b, x);
+  addNodes(a, xm, x);
+  addNodes(xm, b, x);
+  evaluate();
+  // The priority queue, and the subintervals that cannot be bisected
+  std::vector<Interval> queue{interval(a, b, cache)};
+  std::vector<Interval> done;
+  std::vector<Interval> parents;
+  double                totalError = queue.front().error;
+  unsigned int          counter(0);
+
+  while(totalError > targetError_ && counter < maxIter_ && !queue.empty())
+    {
+      // the subintervals with the largest errors, but only as many as
+      // needed to bring the error of the others below the target
+      auto const maxParents = std::min<std::size_t>(
+        {batchSize_, queue.size(), std::size_t{maxIter_ - counter}});
+      parents.clear();
+      while(parents.size() < maxParents && totalError > targetError_)
+        {
+          std::pop_heap(queue.begin(), queue.end(), smallerError);
+          parents.push_back(queue.back());
+          queue.pop_back();
+          totalError -= parents.back().error;
+        }
+      counter += parents.size();
+      // Those too small to be bisected are done: set them aside before the
+      // new points are evaluated, so that they cost no evaluation
+      std::erase_if(parents, [&](Interval const &p) {
+        double const m = (p.a + p.b) / 2;
+        if(p.a < (p.a + m) / 2 && (m + p.b) / 2 < p.b)
+          return false;
+        done.push_back(p);
+        totalError += p.error;
+        return true;
+      });
+      // the new points: those on the quarters of the parents
+      for(auto const &p : parents)
+        {
+          double const m = (p.a + p.b) / 2;
+          addNodes(p.a, (p.a + m) / 2, x);
+          addNodes((p.a + m) / 2, m, x);
+          addNodes(m, (m + p.b) / 2, x);
+          addNodes((m + p.b) / 2, p.b, x);
+        }
+      evaluate();
+      for(auto const &p : parents)
+        {
+          double const m = (p.a + p.b) / 2;
+          for(auto const &child : {interval(p.a, m, cache),
+                                   interval(m, p.b, cache)})
+            {
+              queue.push_back(child);
+              std::push_heap(queue.begin(), queue.end(), smallerError);
+              totalError += child.error;
+            }
+        }
+      ++statistics_.rounds;
+    }
+  // Sum from scratch to avoid the accumulation of round-off
+  double result(0);
+  totalError = 0.0;
+  for(auto const *intervals : {&queue, &done})
+    for(auto const &i : *intervals)
+      {
+        result += i.fine;
+        totalError += i.error;
+      }
+  statistics_.intervals = queue.size() + done.size();
+  statistics_.error = totalError;
+  if(counter >= maxIter_ && totalError > targetError_)
+    std::cerr
+      << "Max number iteration exceeded in QuadratureRuleParallelAdaptive: "
+      << counter << std::endl;
+  return result;
+}
+} // namespace apsc::NumericalIntegration
+
+#endif
@@ -10,11 +10,15 @@
 #include "CloningUtilities.hpp"
 #include <functional>
 #include <memory>
+#include <span>
 // This is a simple trait, just in a namespace
 namespace apsc::NumericalIntegration
 {
 //! The type the integrand
 using FunPoint = std::function<double(double const &)>;
+//! The type of an integrand evaluated on many points at once: fx[i]=f(x[i])
+using FunPoints =
+  std::function<void(std::span<double const> x, std::span<double> fx)>;
 } // namespace apsc::NumericalIntegration
 
 #endif /* EXAMPLES_SRC_QUADRATURERULE_BASEVERSION_QUADRATURERULETRAITS_HPP_ */
@@ -2,6 +2,7 @@
 #define QUADRATURE_RULE_HPP
 #include <array>
 #include <ranges>
+#include <span>
 #include <utility>
 
 #include "QuadratureRuleBase.hpp"
@@ -73,6 +74,18 @@ public:
   {
     return my_order;
   }
+  //! all nodes
+  std::span<double const>
+  nodes() const override
+  {
+    return n_;
+  }
+  //! all weights
+  std::span<double const>
+  weights() const override
+  {
+    return w_;
+  }
   //! returns a string that identify the general type of quadrature rule
   std::string
   name() const override
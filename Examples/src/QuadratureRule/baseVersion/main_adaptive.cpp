@@ -0,0 +1,135 @@
+#include "chrono.hpp"
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+
+#include "Adams_rule.hpp"
+#include "Gauss_rule.hpp"
+#include "QuadratureRuleAdaptive.hpp"
+#include "QuadratureRuleParallelAdaptive.hpp"
+/*
+  Compares QuadratureRuleAdaptive with QuadratureRuleParallelAdaptive, with
+  the Simpson and the Gauss-Lobatto 4 points rules, on three integrands on
+  [0,1]:
+  - sqrt(x), whose derivative is singular at 0;
+  - a sharp peak, 1/(1e-4+(x-0.3)^2);
+  - an expensive smooth function, sum_{k=1}^{K} sin(kx)/k^2 with K=200.
+
+  For each case we report the error, the number of evaluations of the
+  integrand, the number of final subintervals and the wall time.
+  QuadratureRuleParallelAdaptive is used with batches of 1 subinterval (a
+  sequential largest error first algorithm), of 64 subintervals, and with an
+  integrand evaluated on vectors of points.
+
+  Usage: main_adaptive [targetError] (1e-8 by default)
+ */
+using namespace apsc::NumericalIntegration;
+namespace
+{
+struct Integrand
+{
+  std::string                   name;
+  std::function<double(double)> f;
+  double                        exact;
+};
+
+//! sum_{k=1}^{K} sin(kx)/k^2
+constexpr unsigned int K = 200u;
+double
+series(double x)
+{
+  double sum = 0.0;
+  for(unsigned int k = 1u; k <= K; ++k)
+    sum += std::sin(k * x) / (k * k);
+  return sum;
+}
+double
+seriesIntegral()
+{
+  double sum = 0.0;
+  for(unsigned int k = 1u; k <= K; ++k)
+    sum += (1.0 - std::cos(static_cast<double>(k))) / (k * k * k);
+  return sum;
+}
+
+using Timings::timeIt; // time in milliseconds
+
+void
+row(std::string const &what, double error, std::size_t evaluations,
+    std::size_t intervals, double time)
+{
+  std::cout << std::left << std::setw(34) << what << std::right
+            << std::setw(12) << std::scientific << std::setprecision(2)
+            << error << std::defaultfloat << std::setw(12) << evaluations
+            << std::setw(11) << intervals << std::setw(11)
+            << std::setprecision(4) << time << '\n';
+}
+
+template <class SQR>
+void
+compare(std::string const &rule, Integrand const &integrand,
+        double targetError)
+{
+  unsigned int const maxIter = 1000000u;
+  std::size_t        counter = 0u;
+  FunPoint const     counted = [&](double const &x) {
+    ++counter;
+    return integrand.f(x);
+  };
+  double value = 0.0;
+
+  QuadratureRuleAdaptive<SQR> fifo(targetError, maxIter);
+  double time = timeIt([&] { value = fifo.apply(counted, 0.0, 1.0); });
+  row(rule + ", FIFO", std::abs(value - integrand.exact), counter, 0u, time);
+
+  QuadratureRuleParallelAdaptive<SQR> priority(targetError, maxIter);
+  for(std::size_t batch : {1u, 64u})
+    {
+      counter = 0u;
+      priority.setBatchSize(batch);
+      time = timeIt([&] { value = priority.apply(counted, 0.0, 1.0); });
+      auto const &s = priority.statistics();
+      row(rule + ", largest first, batch " + std::to_string(batch),
+          std::abs(value - integrand.exact), s.evaluations, s.intervals,
+          time);
+    }
+  // The integrand is called once for each round
+  FunPoints const vectorised = [&](std::span<double const> x,
+                                   std::span<double> fx) {
+    for(std::size_t i = 0u; i < x.size(); ++i)
+      fx[i] = integrand.f(x[i]);
+  };
+  time = timeIt([&] { value = priority.apply(vectorised, 0.0, 1.0); });
+  auto const &s = priority.statistics();
+  row("  the same, on vectors (" + std::to_string(s.rounds) + " calls)",
+      std::abs(value - integrand.exact), s.evaluations, s.intervals, time);
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  double const targetError = argc > 1 ? std::stod(argv[1]) : 1.e-8;
+  Integrand const integrands[] = {
+    {"sqrt(x)", [](double x) { return std::sqrt(x); }, 2. / 3.},
+    {"1/(1e-4+(x-0.3)^2)",
+     [](double x) { return 1. / (1.e-4 + (x - 0.3) * (x - 0.3)); },
+     (std::atan(70.) + std::atan(30.)) / 0.01},
+    {"sum sin(kx)/k^2, K=200", series, seriesIntegral()}};
+  std::cout << "Target error " << targetError
+            << ". FIFO: QuadratureRuleAdaptive (it does not report the "
+               "intervals),\nlargest first: QuadratureRuleParallelAdaptive\n";
+  for(auto const &integrand : integrands)
+    {
+      std::cout << "\nIntegral of " << integrand.name << " on [0,1]\n"
+                << std::left << std::setw(34) << "rule" << std::right
+                << std::setw(12) << "error" << std::setw(12) << "f evals"
+                << std::setw(11) << "intervals" << std::setw(11)
+                << "time (ms)" << '\n';
+      compare<Simpson>("Simpson", integrand, targetError);
+      compare<GaussLobatto4p>("Lobatto4p", integrand, targetError);
+    }
+}
@@ -0,0 +1,85 @@
+#include "chrono.hpp"
+#include <cmath>
+#include <execution>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+
+#include "Adams_rule.hpp"
+#include "Gauss_rule.hpp"
+#include "integrands.hpp"
+#include "numerical_integration.hpp"
+/*
+  Compares CompositeQuadrature::apply() with CompositeQuadrature::applyBatched()
+  on the integrand fsincos (sin(x)cos(x)) of integrands.cpp, on [0, pi] with
+  10^6 intervals (or the number given on the command line).
+
+  applyBatched() is called with
+  - the function fsincos itself: it is in another translation unit, so the
+    gain comes only from avoiding the virtual call of the rule and the
+    std::function;
+  - a lambda computing the same function, that the compiler may inline;
+  - the same lambda, with std::execution::par (only if compiled with
+    -DPARALLELCPP, which needs linking with TBB);
+  - a function working on vectors of points (called once per block).
+
+  Usage: main_batched [number of intervals]
+ */
+using namespace apsc::NumericalIntegration;
+using namespace Geometry;
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+void
+compare(std::string const &rule, CompositeQuadrature const &q, double exact)
+{
+  auto const inlined = [](double const &x) { return std::sin(x) * std::cos(x); };
+  auto const onVectors = [](std::span<double const> x, std::span<double> fx) {
+    for(std::size_t i = 0u; i < x.size(); ++i)
+      fx[i] = 0.5 * std::sin(2. * x[i]);
+  };
+  double     value = 0.0;
+  double     reference = 0.0;
+  auto const row = [&](std::string const &what, double time) {
+    std::cout << std::left << std::setw(42) << rule + ", " + what
+              << std::right << std::setw(12) << std::scientific
+              << std::setprecision(3) << std::abs(value - exact)
+              << std::defaultfloat << std::setw(12) << std::setprecision(4)
+              << time << std::setw(10) << std::setprecision(3)
+              << reference / time << '\n';
+  };
+  reference = timeIt([&] { value = q.apply(fsincos); });
+  row("apply", reference);
+  row("applyBatched(fsincos)",
+      timeIt([&] { value = q.applyBatched(fsincos); }));
+  row("applyBatched(lambda)", timeIt([&] { value = q.applyBatched(inlined); }));
+#ifdef PARALLELCPP
+  row("applyBatched(par, lambda)", timeIt([&] {
+        value = q.applyBatched(std::execution::par, inlined);
+      }));
+#endif
+  row("applyBatched(on vectors)",
+      timeIt([&] { value = q.applyBatched(onVectors); }));
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  unsigned int const nint = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  double const       a = 0.0;
+  double const       b = pi;
+  double const       exactVal = exact(a, b);
+  Mesh1D             mesh{Domain1D{a, b}, nint};
+  std::cout << "Integral of sin(x)cos(x) on [0,pi] with " << nint
+            << " intervals\n"
+            << std::left << std::setw(42) << "rule" << std::right
+            << std::setw(12) << "error" << std::setw(12) << "time (ms)"
+            << std::setw(10) << "speedup" << '\n';
+  compare("Simpson", CompositeQuadrature{Simpson{}, mesh}, exactVal);
+  compare("GaussLegendre3p", CompositeQuadrature{GaussLegendre3p{}, mesh},
+          exactVal);
+  compare("MidPoint", CompositeQuadrature{MidPoint{}, mesh}, exactVal);
+}
@@ -0,0 +1,128 @@
+#include "chrono.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "montecarlo.hpp"
+#include "parallel_montecarlo.hpp"
+/*
+  Scaling of ParallelMonteCarlo with the number of threads, on the integral
+  of 4/(1+x^2) on [0,1] (pi), with 10^8 samples (or the number given on the
+  command line), for the three sampling modes.
+
+  For each number of threads we report the time, the number of samples per
+  second, the speedup with respect to one thread, the estimated and the
+  actual error, and whether the result is bit-identical to the one with one
+  thread (it must be). The serial MonteCarlo rule, with 10^7 samples, is
+  given for comparison.
+
+  Compile with -fopenmp to use more threads: otherwise only one thread is
+  run, and the check of the results is skipped.
+
+  Usage: main_montecarlo [number of samples]
+ */
+using namespace apsc::NumericalIntegration;
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+double
+integrand(double const &x)
+{
+  return 4. / (1. + x * x);
+}
+
+double const pi = 4. * std::atan(1.);
+
+void
+row(std::string const &what, unsigned int threads, double time,
+    std::size_t samples, double speedup, double error, double value,
+    std::string const &identical)
+{
+  std::cout << std::left << std::setw(14) << what << std::right
+            << std::setw(8) << threads << std::setw(11)
+            << std::setprecision(4) << time << std::setw(11)
+            << samples / time * 1.e-3 << std::setw(9) << speedup
+            << std::scientific << std::setprecision(2) << std::setw(11)
+            << error << std::setw(11) << std::abs(value - pi)
+            << std::defaultfloat << std::setw(11) << identical << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  // Antithetic sampling needs an even number of samples
+  std::size_t const samples =
+    (argc > 1 ? std::stoull(argv[1]) : 100000000u) / 2u * 2u;
+  std::vector<unsigned int> threads{1u};
+#ifdef _OPENMP
+  for(unsigned int t = 2u; t <= 2u * std::thread::hardware_concurrency();
+      t *= 2u)
+    threads.push_back(t);
+#else
+  std::cout << "Compiled without OpenMP: only one thread\n";
+#endif
+  std::cout << "Integral of 4/(1+x^2) on [0,1] with " << samples
+            << " samples, " << std::thread::hardware_concurrency()
+            << " hardware threads\n"
+            << std::left << std::setw(14) << "sampling" << std::right
+            << std::setw(8) << "threads" << std::setw(11) << "time (ms)"
+            << std::setw(11) << "Msample/s" << std::setw(9) << "speedup"
+            << std::setw(11) << "est. error" << std::setw(11) << "error"
+            << std::setw(11) << "identical" << '\n';
+  {
+    std::size_t const serialSamples = std::min<std::size_t>(samples, 10000000u);
+    MonteCarlo        serial;
+    serial.setError(0.);
+    serial.setMiter(serialSamples);
+    double       value = 0.;
+    double const time =
+      timeIt([&] { value = serial.apply(integrand, 0., 1.); });
+    row("MonteCarlo", 1u, time, serialSamples, 1., serial.lastError(), value,
+        "");
+  }
+  bool ok = true;
+  for(auto sampling :
+      {MonteCarloSampling::Plain, MonteCarloSampling::Antithetic,
+       MonteCarloSampling::Stratified})
+    {
+      ParallelMonteCarlo mc(samples, sampling, 2024u);
+      std::string const  name =
+        sampling == MonteCarloSampling::Plain        ? "plain"
+        : sampling == MonteCarloSampling::Antithetic ? "antithetic"
+                                                     : "stratified";
+      double reference = 0.;
+      double referenceTime = 0.;
+      for(auto t : threads)
+        {
+          mc.setNumThreads(t);
+          double       value = 0.;
+          double const time =
+            timeIt([&] { value = mc.apply(integrand, 0., 1.); });
+          if(t == 1u)
+            {
+              reference = value;
+              referenceTime = time;
+            }
+          bool const same = std::bit_cast<std::uint64_t>(value) ==
+                            std::bit_cast<std::uint64_t>(reference);
+          ok = ok && same;
+          row(name, t, time, samples, referenceTime / time, mc.lastError(),
+              value, threads.size() == 1u ? "-" : same ? "yes" : "NO");
+        }
+    }
+  if(threads.size() == 1u)
+    {
+      std::cout << "Only one thread: the check of the results with different "
+                   "numbers of threads is skipped\n";
+      return 0;
+    }
+  std::cout << (ok ? "Results are bit-identical\n" : "Results DIFFER\n");
+  return ok ? 0 : 1;
+}
@@ -1,12 +1,42 @@
 #ifndef NUMERICAL_INTEGRATION_HPP
 #define NUMERICAL_INTEGRATION_HPP
 #include "mesh.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
 
 #include "QuadratureRuleBase.hpp"
 namespace apsc::NumericalIntegration
 {
 using namespace Geometry;
 
+namespace internals
+{
+  /*!
+    sum_i a[i]*b[i] with four partial sums
+
+    The four sums are independent, so the compiler can keep them in SIMD
+    registers without reordering the sum (which it would not do without
+    -ffast-math). The result does not depend on the compiler.
+   */
+  inline double
+  dot(double const *a, double const *b, std::size_t n)
+  {
+    double      s[4] = {0., 0., 0., 0.};
+    std::size_t i = 0u;
+    for(; i + 4u <= n; i += 4u)
+      for(std::size_t k = 0u; k < 4u; ++k)
+        s[k] += a[i + k] * b[i + k];
+    for(; i < n; ++i)
+      s[0] += a[i] * b[i];
+    return (s[0] + s[1]) + (s[2] + s[3]);
+  }
+} // namespace internals
+
 /*!
   Class for composite integration.
 
@@ -72,6 +102,41 @@ public:
   CompositeQuadrature &operator=(CompositeQuadrature &&) = default;
   //! Calculates the integal on the passed integrand function.
   double apply(FunPoint const &) const;
+  //! Number of intervals in a block of applyBatched()
+  static constexpr std::size_t blockSize = 512u;
+  /*!
+    Calculates the integral evaluating the integrand on all nodes at once
+
+    The intervals of the mesh are processed in blocks of blockSize. The
+    nodes of the intervals of a block are stored in a contiguous array,
+    ordered by node of the rule (first the first node of all intervals, then
+    the second...), and the integrand is evaluated on it. Then the weighted
+    sum is computed, node by node, as a dot product with the half lengths of
+    the intervals. Blocks are processed according to the policy. The
+    integrand may be
+    - a callable taking (std::span<double const> x, std::span<double> fx)
+      that sets fx[i]=f(x[i]): it is called once per block;
+    - a scalar callable, like a FunPoint, a function or a lambda: it is
+      called on each node in a simple loop. Pass the callable itself, not a
+      FunPoint, to let the compiler inline and vectorize it.
+
+    Only standard rules (those with nodes()) can be used, for the others the
+    integrand is evaluated one interval at a time with apply().
+
+    \param policy An execution policy, used for the loop on the blocks
+    \param f The integrand
+    \return The integral
+   */
+  template <class ExecutionPolicy, class Integrand>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+  double applyBatched(ExecutionPolicy &&policy, Integrand const &f) const;
+  //! The same, sequential
+  template <class Integrand>
+  double
+  applyBatched(Integrand const &f) const
+  {
+    return applyBatched(std::execution::seq, f);
+  }
   QuadratureRuleBase const &
   myRule() const
   {
@@ -88,6 +153,61 @@ protected:
   wfactor dx/dy = h/2
  */
 
+template <class ExecutionPolicy, class Integrand>
+  requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+double
+CompositeQuadrature::applyBatched(ExecutionPolicy &&policy,
+                                  Integrand const &f) const
+{
+  constexpr bool onVectors =
+    std::is_invocable_v<Integrand const &, std::span<double const>,
+                        std::span<double>>;
+  auto const y = rule_->nodes();
+  auto const w = rule_->weights();
+  if(y.empty())
+    {
+      // Not a standard rule
+      if constexpr(onVectors)
+        return apply([&f](double const &x) {
+          double fx;
+          f(std::span<double const>(&x, 1u), std::span<double>(&fx, 1u));
+          return fx;
+        });
+      else
+        return apply(f);
+    }
+  // Intervals are processed in blocks, whose nodes stay in cache
+  std::size_t const        m = mesh_.numNodes() - 1u;
+  std::vector<std::size_t> blocks((m + blockSize - 1u) / blockSize);
+  std::iota(blocks.begin(), blocks.end(), std::size_t{0u});
+  return std::transform_reduce(
+    policy, blocks.begin(), blocks.end(), 0.0, std::plus<double>(),
+    [&](std::size_t const block) {
+      std::size_t const   begin = block * blockSize;
+      std::size_t const   n = std::min(m, begin + blockSize) - begin;
+      std::vector<double> h2(n);
+      std::vector<double> x(n * y.size());
+      std::vector<double> fx(n * y.size());
+      // Nodes ordered by node of the rule, as in StandardQuadratureRule
+      for(std::size_t i = 0u; i < n; ++i)
+        h2[i] = (mesh_[begin + i + 1u] - mesh_[begin + i]) * 0.5;
+      for(std::size_t j = 0u; j < y.size(); ++j)
+        for(std::size_t i = 0u; i < n; ++i)
+          x[j * n + i] =
+            y[j] * h2[i] + (mesh_[begin + i] + mesh_[begin + i + 1u]) * 0.5;
+      if constexpr(onVectors)
+        f(std::span<double const>(x), std::span<double>(fx));
+      else
+        for(std::size_t k = 0u; k < x.size(); ++k)
+          fx[k] = f(x[k]);
+      // Weighted sum, node by node
+      double sum = 0.0;
+      for(std::size_t j = 0u; j < y.size(); ++j)
+        sum += w[j] * internals::dot(h2.data(), fx.data() + j * n, n);
+      return sum;
+    });
+}
+
 } // namespace apsc::NumericalIntegration
 
 #endif
@@ -0,0 +1,215 @@
+#include "parallel_montecarlo.hpp"
+#include "philox.hpp"
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#ifdef PARALLELCPP
+#include <execution>
+#include <numeric>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+namespace apsc::NumericalIntegration
+{
+namespace
+{
+  /*!
+    Fills u with the uniform numbers in [0,1) of the samples first,
+    first+1,... A block of Philox gives the numbers of two samples.
+   */
+  void
+  uniforms(std::uint64_t seed, std::size_t first, std::span<double> u)
+  {
+    apsc::Philox4x32::Key const key{static_cast<std::uint32_t>(seed),
+                                    static_cast<std::uint32_t>(seed >> 32)};
+    std::size_t                 k = 0u;
+    while(k < u.size())
+      {
+        std::uint64_t const i = first + k;
+        auto const          r = apsc::Philox4x32::block(
+          {static_cast<std::uint32_t>(i / 2u),
+           static_cast<std::uint32_t>(i / 2u >> 32), 0u, 0u},
+          key);
+        if(i % 2u == 0u)
+          u[k++] = apsc::Philox4x32::toUnit(r[0], r[1]);
+        if(k < u.size())
+          u[k++] = apsc::Philox4x32::toUnit(r[2], r[3]);
+      }
+  }
+} // namespace
+
+ParallelMonteCarlo::ParallelMonteCarlo(std::size_t        samples,
+                                       MonteCarloSampling sampling,
+                                       std::uint64_t      seed)
+  : sampling_(sampling), seed_(seed)
+{
+  setSamples(samples);
+}
+
+std::unique_ptr<QuadratureRuleBase>
+ParallelMonteCarlo::clone() const
+{
+  return std::make_unique<ParallelMonteCarlo>(*this);
+}
+
+std::string
+ParallelMonteCarlo::name() const
+{
+  switch(sampling_)
+    {
+    case MonteCarloSampling::Antithetic:
+      return "Parallel Montecarlo, antithetic";
+    case MonteCarloSampling::Stratified:
+      return "Parallel Montecarlo, stratified";
+    default:
+      return "Parallel Montecarlo";
+    }
+}
+
+void
+ParallelMonteCarlo::setSamples(std::size_t n)
+{
+  if(n < 4u)
+    throw std::invalid_argument("ParallelMonteCarlo: at least 4 samples");
+  // Otherwise the last evaluation would be lost
+  if(sampling_ == MonteCarloSampling::Antithetic && n % 2u != 0u)
+    throw std::invalid_argument(
+      "ParallelMonteCarlo: antithetic sampling needs an even number of "
+      "samples");
+  samples_ = n;
+}
+
+void
+ParallelMonteCarlo::setSampling(MonteCarloSampling s)
+{
+  if(s == MonteCarloSampling::Antithetic && samples_ % 2u != 0u)
+    throw std::invalid_argument(
+      "ParallelMonteCarlo: antithetic sampling needs an even number of "
+      "samples");
+  sampling_ = s;
+}
+
+void
+ParallelMonteCarlo::setChunkSize(std::size_t n)
+{
+  if(n < 2u)
+    throw std::invalid_argument(
+      "ParallelMonteCarlo: at least 2 samples in a chunk");
+  chunkSize_ = n;
+}
+
+/*!
+  @detail The scalar integrand is evaluated on the points of a chunk in a
+  loop, chunks are processed in parallel.
+*/
+double
+ParallelMonteCarlo::apply(FunPoint const &f, double const &a,
+                          double const &b) const
+{
+  return apply(
+    [&f](std::span<double const> x, std::span<double> fx) {
+      for(std::size_t i = 0u; i < x.size(); ++i)
+        fx[i] = f(x[i]);
+    },
+    a, b);
+}
+
+double
+ParallelMonteCarlo::apply(FunPoints const &f, double const &a,
+                          double const &b) const
+{
+  using Welford = apsc::Statistics::WelfordAlgorithm;
+  bool const antithetic = sampling_ == MonteCarloSampling::Antithetic;
+  // The samples (pairs if antithetic), and their chunks. The last chunk
+  // takes the remainder, so that all have at least chunkSize_ samples
+  std::size_t const units = antithetic ? samples_ / 2u : samples_;
+  std::size_t const numChunks = std::max<std::size_t>(units / chunkSize_, 1u);
+  double const      length = b - a;
+  std::vector<Welford> partial(numChunks);
+
+  auto processChunk = [&](std::size_t c, std::vector<double> &u,
+                          std::vector<double> &x, std::vector<double> &fx) {
+    std::size_t const begin = c * chunkSize_;
+    std::size_t const end = c + 1u == numChunks ? units : begin + chunkSize_;
+    std::size_t const n = end - begin;
+    u.resize(n);
+    uniforms(seed_, begin, u);
+    x.resize(antithetic ? 2u * n : n);
+    switch(sampling_)
+      {
+      case MonteCarloSampling::Plain:
+        for(std::size_t k = 0u; k < n; ++k)
+          x[k] = a + length * u[k];
+        break;
+      case MonteCarloSampling::Antithetic:
+        for(std::size_t k = 0u; k < n; ++k)
+          {
+            x[k] = a + length * u[k];
+            x[n + k] = b - length * u[k];
+          }
+        break;
+      case MonteCarloSampling::Stratified:
+        // the stratum of the chunk is [begin, end)*length/units
+        for(std::size_t k = 0u; k < n; ++k)
+          x[k] = a + length * (begin + n * u[k]) / units;
+        break;
+      }
+    fx.resize(x.size());
+    f(x, fx);
+    if(antithetic)
+      for(std::size_t k = 0u; k < n; ++k)
+        fx[k] = 0.5 * (fx[k] + fx[n + k]);
+    partial[c].update(fx.begin(), fx.begin() + n);
+  };
+
+#ifdef PARALLELCPP
+  std::vector<std::size_t> chunks(numChunks);
+  std::iota(chunks.begin(), chunks.end(), std::size_t{0u});
+  std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+                [&processChunk](std::size_t c) {
+                  std::vector<double> u, x, fx;
+                  processChunk(c, u, x, fx);
+                });
+#else
+#ifdef _OPENMP
+  int const numThreads =
+    numThreads_ > 0u ? static_cast<int>(numThreads_) : omp_get_max_threads();
+#pragma omp parallel num_threads(numThreads) shared(processChunk)
+#endif
+  {
+    // buffers reused by the chunks of a thread
+    std::vector<double> u, x, fx;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for(std::size_t c = 0u; c < numChunks; ++c)
+      processChunk(c, u, x, fx);
+  }
+#endif
+  // Merge in a fixed order: the result does not depend on the threads
+  Welford total;
+  double  stratifiedVariance = 0.;
+  for(auto const &p : partial)
+    {
+      total.merge(p);
+      if(sampling_ == MonteCarloSampling::Stratified)
+        {
+          auto const s = p.finalize();
+          stratifiedVariance +=
+            s.nSamples * static_cast<double>(s.sampleVariance);
+        }
+    }
+  statistics_ = total.finalize();
+  if(sampling_ == MonteCarloSampling::Stratified)
+    lastError_ = std::abs(length) * std::sqrt(stratifiedVariance) / units;
+  else
+    lastError_ = std::abs(length) *
+                 std::sqrt(static_cast<double>(statistics_.sampleVariance) /
+                           units);
+  return length * static_cast<double>(statistics_.mean);
+}
+
+} // namespace apsc::NumericalIntegration
@@ -0,0 +1,129 @@
+#ifndef PARALLEL_MONTECARLO_HPP
+#define PARALLEL_MONTECARLO_HPP
+#include "QuadratureRuleBase.hpp"
+#include "StatisticsComputations.hpp"
+#include <cstddef>
+#include <cstdint>
+namespace apsc::NumericalIntegration
+{
+//! How the samples of ParallelMonteCarlo are drawn
+enum class MonteCarloSampling
+{
+  Plain,      //!< Independent uniform samples
+  Antithetic, //!< Pairs x, a+b-x: the samples are the averages of the pairs
+  Stratified  //!< One stratum for each chunk of samples
+};
+
+//! Implements a parallel, reproducible, montecarlo quadrature
+/*
+  This quadrature rule computes
+  \f$ \int_a^b f \simeq \frac{b-a}{N}\sum_{i=0}^{N-1} f(x_i)\f$
+  with a given number N of samples (not an error target, like MonteCarlo).
+
+  The samples are divided into chunks of a fixed size, processed in parallel
+  (with OpenMP, or with the parallel algorithms if PARALLELCPP is defined).
+  The random numbers of sample i are those of the counter i of a Philox
+  generator with the given seed: they depend only on i, not on the thread
+  that computes them. The statistics of each chunk are computed by a
+  Welford algorithm and merged in the order of the chunks. So the result is
+  bit-identical with any number of threads.
+
+  The points of a chunk are generated together and the integrand is
+  evaluated on all of them: with a single call if it is a FunPoints.
+
+  Variance reduction:
+  - Antithetic: each sample is the average of f at x and at a+b-x, N/2 of
+    them, so N must be even. Effective for monotone integrands;
+  - Stratified: [a,b] is divided into strata, one for each chunk, of length
+    proportional to the number of samples of the chunk. The error estimate
+    combines the variances in the strata. Set the size of the chunks to
+    have the desired number of strata.
+ */
+class ParallelMonteCarlo final : public QuadratureRuleBase
+{
+public:
+  /*!
+    @param samples Number of evaluations of the integrand
+    @param sampling How samples are drawn
+    @param seed The seed of the random numbers
+    @throws std::invalid_argument if samples is not valid (see setSamples())
+   */
+  explicit ParallelMonteCarlo(
+    std::size_t samples = samples_def,
+    MonteCarloSampling sampling = MonteCarloSampling::Plain,
+    std::uint64_t seed = 0u);
+  std::unique_ptr<QuadratureRuleBase> clone() const override;
+  //! The method that applies the rule (on a scalar integrand).
+  double apply(FunPoint const &, double const &a,
+               double const &b) const override;
+  //! The method that applies the rule (on an integrand working on vectors).
+  double apply(FunPoints const &, double const &a, double const &b) const;
+  std::string name() const override;
+  //! Sets the number of evaluations of the integrand
+  /*!
+    @throws std::invalid_argument if n<4, or if n is odd with antithetic
+    sampling
+   */
+  void setSamples(std::size_t n);
+  //! Sets the sampling mode
+  /*!
+    @throws std::invalid_argument if antithetic and the number of samples
+    is odd
+   */
+  void setSampling(MonteCarloSampling s);
+  //! Sets the seed
+  void
+  setSeed(std::uint64_t seed)
+  {
+    seed_ = seed;
+  }
+  //! Sets the number of threads (0: the default of OpenMP)
+  /*!
+    It does not change the result. Ignored if PARALLELCPP is defined.
+   */
+  void
+  setNumThreads(unsigned int n)
+  {
+    numThreads_ = n;
+  }
+  //! Sets the number of samples in a chunk (at least 2)
+  /*!
+    It changes the result: it is the unit of work, and the stratum of
+    stratified sampling.
+   */
+  void setChunkSize(std::size_t n);
+  //! Returns the last computed error estimate
+  double
+  lastError() const
+  {
+    return lastError_;
+  }
+  //! Statistics of a sample
+  using SampleStatistics =
+    apsc::Statistics::WelfordAlgorithm::AggregatedOutput;
+  //! The statistics of the samples of the last call
+  /*!
+    With antithetic sampling the samples are the averages of the pairs.
+    @note Not meaningful if apply() is called concurrently on the same object.
+   */
+  SampleStatistics const &
+  statistics() const
+  {
+    return statistics_;
+  }
+
+private:
+  //! Default number of samples
+  static constexpr std::size_t samples_def = 1000000u;
+  std::size_t                  samples_;
+  MonteCarloSampling           sampling_;
+  std::uint64_t                seed_;
+  unsigned int                 numThreads_ = 0u;
+  std::size_t                  chunkSize_ = 1024u;
+  mutable double               lastError_ = 0.;
+  mutable SampleStatistics     statistics_{};
+};
+
+} // namespace apsc::NumericalIntegration
+
+#endif
@@ -40,6 +40,11 @@ template <unsigned int NSTAGES> struct ButcherArray
     std::transform(A.begin(), A.end(), c.begin(), [](auto const &row) {
       return std::accumulate(row.begin(), row.end(), 0.0);
     });
+    // First Same As Last: the last stage is computed with the weights of the
+    // solution, at the end of the step
+    // (c is computed, so it may differ from 1 by round-off)
+    fsal_ = NSTAGES > 1u && A[NSTAGES - 1u] == b1 && b1[NSTAGES - 1u] == 0. &&
+            c[NSTAGES - 1u] > 1. - 1.e-12 && c[NSTAGES - 1u] < 1. + 1.e-12;
   }
   /* I store the full array even if only the part below the main diagonal is
    * different from zero. For simplicity
@@ -66,6 +71,31 @@ template <unsigned int NSTAGES> struct ButcherArray
     return implicit_;
   }
 
+  /*!
+   * Check if the scheme is FSAL (First Same As Last)
+   *
+   * The last stage is f evaluated at the end of the step on the solution
+   * (the one computed with b1), so it is the first stage of the next step.
+   * @return true if FSAL
+   */
+  constexpr bool
+  fsal() const
+  {
+    return fsal_;
+  }
+  /*!
+   * Check if the first stage is f at the start of the step
+   *
+   * Then it can be taken from the previous step.
+   * @return true if c[0]=0 and the first row of A is zero
+   */
+  constexpr bool
+  explicitFirstStage() const
+  {
+    return std::all_of(A[0].begin(), A[0].end(),
+                       [](double a) { return a == 0.; });
+  }
+
   //! The number of steps.
   /*!
    * As a constexpr function since I need it to be resolved at compile time!
@@ -81,6 +111,7 @@ template <unsigned int NSTAGES> struct ButcherArray
 
 protected:
   bool implicit_ = false;
+  bool fsal_ = false;
   //! Recursively checks if the Butcher array corresponds to an implicit RK
   //! scheme. Returns true if any diagonal element of A is non-zero, indicating
   //! implicitness. Used at construction to set the implicit_ member variable.
@@ -133,6 +164,28 @@ namespace RKFScheme
         }
     {}
   };
+  //! Dormand-Prince 5(4) scheme. It is FSAL: 6 evaluations per step
+  struct DP45_t : public ButcherArray<7>
+  {
+    constexpr DP45_t()
+      : ButcherArray<7>{
+          {{{{0., 0., 0., 0., 0., 0., 0.}},
+            {{1. / 5, 0., 0., 0., 0., 0., 0.}},
+            {{3. / 40, 9. / 40, 0., 0., 0., 0., 0.}},
+            {{44. / 45, -56. / 15, 32. / 9, 0., 0., 0., 0.}},
+            {{19372. / 6561, -25360. / 2187, 64448. / 6561, -212. / 729, 0.,
+              0., 0.}},
+            {{9017. / 3168, -355. / 33, 46732. / 5247, 49. / 176,
+              -5103. / 18656, 0., 0.}},
+            {{35. / 384, 0., 500. / 1113, 125. / 192, -2187. / 6784,
+              11. / 84, 0.}}}},
+          {{35. / 384, 0., 500. / 1113, 125. / 192, -2187. / 6784, 11. / 84,
+            0.}}, // 5th order
+          {{5179. / 57600, 0., 7571. / 16695, 393. / 640, -92097. / 339200,
+            187. / 2100, 1. / 40}}, // 4th order
+          4}
+    {}
+  };
   //! RK23 a lower order scheme
   struct RK23_t : public ButcherArray<4>
   {
@@ -146,6 +199,19 @@ namespace RKFScheme
                         2}
     {}
   };
+  //! Bogacki-Shampine 3(2): RK23 advancing with the 3rd order rule. FSAL
+  struct BS23_t : public ButcherArray<4>
+  {
+    constexpr BS23_t()
+      : ButcherArray<4>{{{{{0., 0., 0., 0.}},
+                          {{1. / 2, 0., 0., 0.}},
+                          {{0., 3. / 4, 0., 0.}},
+                          {{2. / 9, 1. / 3, 4. / 9, 0.}}}},
+                        {{2. / 9, 1. / 3, 4. / 9, 0.}},      // 3rd order
+                        {{7. / 24, 1. / 4, 1. / 3, 1. / 8}}, // 2nd order
+                        2}
+    {}
+  };
   //! Heun-Euler scheme 2nd order
   struct RK12_t : public ButcherArray<2>
   {
@@ -213,6 +279,10 @@ namespace RKFScheme
   // C++17 here!
   inline constexpr RK45_t RK45;
 
+  inline constexpr DP45_t DP45;
+
+  inline constexpr BS23_t BS23;
+
   inline constexpr RK23_t RK23;
 
   inline constexpr RK12_t RK12;
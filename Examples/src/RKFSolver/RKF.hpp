@@ -55,6 +55,8 @@ public:
     int expansions{0};
   //! Number of time-step contractions
     int contractions{0};
+    //! Number of evaluations of the forcing term (outside the Newton solver)
+    int evaluations{0};
     /*
      * Provide a non-templated friend streaming operator for this concrete
      * RKFResult instantiation. Defining it here (inside the nested struct)
@@ -105,6 +107,75 @@ public:
     }
   };
 
+  /*!
+   * An accepted step, as seen by the observers of solve()
+   *
+   * It gives the solution and its derivative at the ends of the step, and a
+   * continuous approximation of the solution in between (dense output): the
+   * cubic Hermite interpolant of those values. It is third order accurate
+   * and continuous, with its derivative, across steps.
+   *
+   * @note The references are valid only during the call of the observer.
+   */
+  struct Step
+  {
+    //! Start of the step
+    double tStart;
+    //! End of the step
+    double tEnd;
+    //! The solution at tStart
+    VariableType const &yStart;
+    //! The solution at tEnd
+    VariableType const &yEnd;
+    //! The derivative at tStart
+    VariableType const &fStart;
+    //! The derivative at tEnd
+    VariableType const &fEnd;
+    /*!
+     * The dense output
+     * @param t A time in [tStart, tEnd]
+     * @param out Where the solution at t is written (no allocation if it
+     * has already the right size)
+     */
+    void
+    interpolate(double t, VariableType &out) const
+    {
+      double const h = tEnd - tStart;
+      double const theta = (t - tStart) / h;
+      out = (1. - theta) * yStart + theta * yEnd +
+            (theta * (theta - 1.)) *
+              ((1. - 2. * theta) * (yEnd - yStart) +
+               ((theta - 1.) * h) * fStart + (theta * h) * fEnd);
+    }
+    //! The dense output at t in [tStart, tEnd]
+    VariableType
+    operator()(double t) const
+    {
+      VariableType out = yStart;
+      interpolate(t, out);
+      return out;
+    }
+  };
+  /*!
+   * Summary of an integration with solve(), which does not store the
+   * solution
+   */
+  struct RKFSummary
+  {
+    //! estimated error
+    double estimatedError{0.0};
+    //! Failure
+    bool failed{false};
+    //! Number of time-step expansions
+    int expansions{0};
+    //! Number of time-step contractions
+    int contractions{0};
+    //! Number of accepted steps
+    int steps{0};
+    //! Number of evaluations of the forcing term (outside the Newton solver)
+    int evaluations{0};
+  };
+
   //! Constructor just taking the function
   template <class F = Function>
     requires std::convertible_to<F, Function>
@@ -147,6 +218,29 @@ public:
                                      VariableType const &y0, double hInit,
                                      double tol = 1e-6,
                                      int    maxStep = 2000) const;
+  /*!
+   * Integration in streaming mode
+   *
+   * Each accepted step is passed to the observer, as a Step, and nothing is
+   * stored: memory does not grow with the number of steps. The observer may
+   * save or process the solution at the end of the step, or sample it at
+   * any time inside the step with the dense output. The time steps are the
+   * same of operator().
+   *
+   * @param observer A callable taking a Step const &
+   * @param T0 initial time
+   * @param T  final time
+   * @param y0 initial condition
+   * @param hInit initial time step
+   * @param tol desired global error max-norm
+   * @param maxStep Safeguard to avoid too many steps (default 2000)
+   * @return A summary of the integration
+   */
+  template <class Observer>
+    requires std::invocable<Observer &, Step const &>
+  RKFSummary solve(Observer &&observer, double T0, double T,
+                   VariableType const &y0, double hInit, double tol = 1e-6,
+                   int maxStep = 2000) const;
   /*!
    * @brief Default options for the quasi-Newton solver.
    * @details Kept public to simplify handling. Mutable because it can be
@@ -172,25 +266,39 @@ public:
 private:
   Function           M_f;
   static constexpr B ButcherTable = B{};
+  /*!
+   * The buffers used by the steps, allocated once per integration
+   */
+  struct Workspace
+  {
+    //! The stages, times h
+    std::array<VariableType, B::Nstages()> K;
+    //! The argument of the forcing term in a stage
+    VariableType value;
+    //! The solution computed with b1 (the one that advances)
+    VariableType yprimal;
+    //! The solution computed with b2, for the error estimate
+    VariableType ytest;
+    //! The derivative at the start of the step
+    VariableType fStart;
+    //! The derivative at the end of the step
+    VariableType fEnd;
+  };
   /*! Function for a single step. It is private since is used only internally.
    *
-   * @note
-   * I have used trailing return type syntax, to be consistent with the
-   * definition given outside this class template definition. But here it is not
-   * necessary. I could have written
-   * @code
-   * std::pair<VariableType,VariableType> RKFstep(const double & tstart, const
-   * VariableType & y0, const double & h)
-   * @endcode
-   * since in this context VariableType is well defined
+   * If the first stage is explicit it is computed from w.fStart, the
+   * derivative at tstart, which is known from the previous step.
    *
    * @param tstart start time
    * @param y0 value at tstart
    * @param h time step
-   * @return values computed with the two rules
+   * @param w The workspace. On output, the values computed with the two
+   * rules are in w.yprimal and w.ytest
+   * @param evaluations Incremented by the number of evaluations of the
+   * forcing term
    */
-  auto RKFstep(const double &tstart, const VariableType &y0,
-               const double &h) const -> std::pair<VariableType, VariableType>;
+  void RKFstep(double tstart, VariableType const &y0, double h, Workspace &w,
+               int &evaluations) const;
 };
 
 //   ***********************************************
@@ -203,25 +311,47 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
                          double hInit, double tol, int maxSteps) const
 {
   RKFResult res;
-  // Useful alias to simplify typing
-  std::vector<double>       &time = res.time;
-  std::vector<VariableType> &y = res.y;
-  auto                      &expansions = res.expansions;
-  auto                      &contractions = res.contractions;
-  auto                      &estimatedError = res.estimatedError;
-  estimatedError = 0.0; // set initial error to zero
-  auto &failed = res.failed;
-  failed = false; // set failed to false
-  // bool expanded =false; // keep track of expansions
   //  reserve some space according to data. It may help reduce memory
   //  reallocations
   int expectedSteps =
     std::min(std::max(1, 1 + static_cast<int>((T - T0) / hInit)), maxSteps);
-  time.reserve(expectedSteps);
-  y.reserve(expectedSteps);
+  res.time.reserve(expectedSteps);
+  res.y.reserve(expectedSteps);
   // push initial step
-  time.push_back(T0);
-  y.push_back(y0);
+  res.time.push_back(T0);
+  res.y.push_back(y0);
+  // The observer stores the solution at the end of each step
+  auto summary = solve(
+    [&res](Step const &step) {
+      res.time.push_back(step.tEnd);
+      res.y.push_back(step.yEnd);
+    },
+    T0, T, y0, hInit, tol, maxSteps);
+  res.estimatedError = summary.estimatedError;
+  res.failed = summary.failed;
+  res.expansions = summary.expansions;
+  res.contractions = summary.contractions;
+  res.evaluations = summary.evaluations;
+  return res;
+}
+
+template <apsc::ButcherArrayConcept B, RKFKind KIND>
+template <class Observer>
+  requires std::invocable<Observer &, typename RKF<B, KIND>::Step const &>
+RKF<B, KIND>::RKFSummary
+RKF<B, KIND>::solve(Observer &&observer, double T0, double T,
+                    const VariableType &y0, double hInit, double tol,
+                    int maxSteps) const
+{
+  RKFSummary res;
+  // Useful alias to simplify typing
+  auto &expansions = res.expansions;
+  auto &contractions = res.contractions;
+  auto &estimatedError = res.estimatedError;
+  estimatedError = 0.0; // set initial error to zero
+  auto &failed = res.failed;
+  failed = false; // set failed to false
+  // bool expanded =false; // keep track of expansions
   // to check if a step has been rejected
   bool rejected(false);
   // safety factor if error greater than tolerance
@@ -254,14 +384,36 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
   double t = T0;
   VariableType ycurr = y0;
   bool         minimalh = false;
+  // The buffers for the steps, allocated here once
+  Workspace w;
+  w.K.fill(y0);
+  w.value = y0;
+  w.yprimal = y0; // The solution that advances
+  w.ytest = y0;   // The other solution
+  w.fStart = M_f(T0, y0);
+  w.fEnd = w.fStart;
+  ++res.evaluations;
+  // Accepts the step from t to tNew: the solution is in w.yprimal
+  auto accept = [&](double tNew) {
+    if constexpr(ButcherTable.fsal())
+      w.fEnd = w.K[B::Nstages() - 1u] / h; // the last stage
+    else
+      {
+        // also the first stage of the next step
+        w.fEnd = M_f(tNew, w.yprimal);
+        ++res.evaluations;
+      }
+    observer(Step{t, tNew, ycurr, w.yprimal, w.fStart, w.fEnd});
+    // no copies
+    std::swap(ycurr, w.yprimal);
+    std::swap(w.fStart, w.fEnd);
+    t = tNew;
+    ++res.steps;
+  };
   // int oscilla=0;
   while(t < T && iter <= maxSteps)
     {
       ++iter;
-      // The low precision solution
-      VariableType yprimal;
-      // The high precision solution
-      VariableType ytest;
       // I compute the amount of error per time step
       // since I want to control the final error
       // But I also have to avoid overdoing, so for low order
@@ -298,8 +450,8 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
       else // perform next step
       */
       {
-        std::tie(yprimal, ytest) = RKFstep(t, ycurr, h); // step
-        double currentError = this->norm(yprimal - ytest);
+        RKFstep(t, ycurr, h, w, res.evaluations); // step
+        double currentError = this->distance(w.yprimal, w.ytest);
         double ratio = 0.0;
         if(currentError <= std::numeric_limits<double>::epsilon())
           ratio = std::numeric_limits<double>::infinity();
@@ -313,10 +465,7 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
         if(ratio >= 1.0)
           {
             // fine set new point!
-            t += h;
-            time.push_back(t);
-            y.push_back(yprimal);
-            ycurr = yprimal;
+            accept(t + h);
             estimatedError += currentError;
             h = std::min(h, T - t);
             // Expand next step if error small, step not previously rejected and
@@ -339,10 +488,7 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
             if(h <= hmin)
               {
                 // we are at the minimum we have to accept it
-                t = t + h;
-                time.push_back(t);
-                y.push_back(yprimal);
-                ycurr = yprimal;
+                accept(t + h);
                 estimatedError += currentError;
                 rejected = false;
                 minimalh = true;
@@ -374,21 +520,14 @@ RKF<B, KIND>::operator()(double T0, double T, const VariableType &y0,
   return res;
 }
 
-// Note that I use trailing return type syntax here since otherwise I had to
-// write
-//
-// std::pair<typename RKFTraits::VariableType, typename RKFTraits::VariableType>
-// RKFstep(const double &tstart, const VariableType &y0, const double &h)
-// const
-//
 template <apsc::ButcherArrayConcept B, RKFKind KIND>
-auto
-RKF<B, KIND>::RKFstep(const double &tstart, const VariableType &y0,
-                      const double &h) const
-  -> std::pair<VariableType, VariableType>
+void
+RKF<B, KIND>::RKFstep(double tstart, const VariableType &y0, double h,
+                      Workspace &w, int &evaluations) const
 {
   auto constexpr Nstages = B::Nstages();
-  std::array<VariableType, Nstages> K{};
+  auto &K = w.K;
+  auto &value = w.value;
   // They are constant expressions!
   auto const &A = ButcherTable.A;
   auto const &c = ButcherTable.c;
@@ -398,10 +537,18 @@ RKF<B, KIND>::RKFstep(const double &tstart, const VariableType &y0,
   //@todo Identify if implicit outside this heavily used routine!
   for(std::size_t i = 0; i < Nstages; ++i)
     {
-      double       time = tstart + c[i] * h;
-      VariableType value = y0;
+      if constexpr(ButcherTable.explicitFirstStage())
+        if(i == 0u)
+          {
+            // f at the start of the step is known
+            K[0] = w.fStart * h;
+            continue;
+          }
+      double time = tstart + c[i] * h;
+      value = y0;
       for(std::size_t j = 0; j < i; ++j)
-        value += A[i][j] * K[j];
+        if(A[i][j] != 0.)
+          value += A[i][j] * K[j];
       if constexpr(ButcherTable.implicit())
         {
           if constexpr(KIND == apsc::RKFKind::VECTOR)
@@ -432,16 +579,20 @@ RKF<B, KIND>::RKFstep(const double &tstart, const VariableType &y0,
             }
         }
       else
-        K[i] = M_f(time, value) * h;
+        {
+          K[i] = M_f(time, value) * h;
+          ++evaluations;
+        }
     }
-  VariableType v1 = y0;
-  VariableType v2 = y0;
+  w.yprimal = y0;
+  w.ytest = y0;
   for(std::size_t i = 0; i < Nstages; ++i)
     {
-      v1 += K[i] * b1[i];
-      v2 += K[i] * b2[i];
+      if(b1[i] != 0.)
+        w.yprimal += K[i] * b1[i];
+      if(b2[i] != 0.)
+        w.ytest += K[i] * b2[i];
     }
-  return {v1, v2};
 }
 
 } // namespace apsc
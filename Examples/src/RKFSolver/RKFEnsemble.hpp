@@ -0,0 +1,426 @@
+/*
+ * RKFEnsemble.hpp
+ *
+ *  Integration of many instances of the same ODE system
+ */
+
+#ifndef SRC_RK45_RKFENSEMBLE_HPP_
+#define SRC_RK45_RKFENSEMBLE_HPP_
+#include "ButcherRKF.hpp"
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+namespace apsc
+{
+/*!
+ * Explicit Runge-Kutta-Fehlberg integration of an ensemble of independent
+ * instances of the same system y'=f_i(t,y), i=0,...,N-1 (for instance, the
+ * same model with different parameters or initial conditions).
+ *
+ * Each instance has its own adaptive time step, controlled as in RKF, so the
+ * time steps, and the solution, of an instance are those computed by RKF on
+ * that instance alone (up to the rounding of the error norm).
+ *
+ * The instances are advanced together in batches of lanes. The states of a
+ * batch are stored as a structure of arrays: an array with a row for each
+ * lane and a column for each component, column-major, so a component of all
+ * the lanes is contiguous and the stages are computed with vector operations
+ * across instances. The forcing term is called once per stage on the whole
+ * batch, so also its evaluation can be vectorized across instances.
+ *
+ * When an instance ends, its lane takes the next instance not yet started,
+ * so the lanes are kept busy even if the number of steps varies among the
+ * instances. With OpenMP each thread runs a batch, and the instances are
+ * dealt to the threads by a shared counter, as they end their work: a thread
+ * with cheap instances takes more of them (dynamic load balancing).
+ *
+ * @tparam B The Butcher table of an explicit scheme
+ */
+template <apsc::ButcherArrayConcept B> class RKFEnsemble
+{
+public:
+  /*!
+   * The states of a batch, or of the ensemble: a row for each instance, a
+   * column for each component
+   */
+  using BatchState = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>;
+  /*!
+   * The forcing term of a batch
+   *
+   * f(ids, t, y, dy) must set, for each lane l, dy.row(l) to f_{ids[l]}(t(l),
+   * y.row(l)). ids are the indexes of the instances in the lanes.
+   */
+  using BatchFunction = std::function<void(
+    std::span<std::size_t const> ids, Eigen::Ref<Eigen::ArrayXd const> t,
+    Eigen::Ref<BatchState const> y, Eigen::Ref<BatchState> dy)>;
+  /*!
+   * Results of the integration of the ensemble
+   */
+  struct RKFEnsembleResult
+  {
+    //! The solution at the final time, a row for each instance
+    BatchState y;
+    //! estimated error of each instance
+    std::vector<double> estimatedError;
+    //! Failure of each instance (maximum number of steps exceeded)
+    std::vector<char> failed;
+    //! Number of accepted steps of each instance
+    std::vector<int> steps;
+    //! Number of time-step contractions of each instance
+    std::vector<int> contractions;
+    //! Number of time-step expansions of each instance
+    std::vector<int> expansions;
+    //! Number of evaluations of the forcing term, on a single instance
+    long evaluations{0};
+    //! Number of instances that used the minimal time step
+    int minimalh{0};
+  };
+
+  //! Constructor taking the forcing term of a batch
+  template <class F = BatchFunction>
+    requires std::convertible_to<F, BatchFunction>
+  RKFEnsemble(F &&f) : M_f{std::forward<F>(f)}
+  {}
+  //! Default constructor
+  RKFEnsemble() = default;
+  //! Set the forcing function
+  void
+  set_function(BatchFunction const &f)
+  {
+    M_f = f;
+  }
+  //! Set the number of lanes of a batch (at least 1)
+  /*!
+   * The number of instances advanced together by a thread. A few tens
+   * are enough to vectorize.
+   */
+  void
+  setLanes(std::size_t n)
+  {
+    if(n == 0u)
+      throw std::invalid_argument("RKFEnsemble: at least one lane");
+    M_lanes = n;
+  }
+  //! Sets the number of threads (0: the default of OpenMP)
+  void
+  setNumThreads(unsigned int n)
+  {
+    M_numThreads = n;
+  }
+  /*!
+   * @param T0 initial time
+   * @param T  final time
+   * @param y0 initial conditions, a row for each instance
+   * @param hInit initial time step
+   * @param tol desired global error of each instance
+   * @param maxStep Safeguard to avoid too many steps (default 2000)
+   */
+  [[nodiscard]] RKFEnsembleResult operator()(double T0, double T,
+                                             BatchState const &y0,
+                                             double hInit, double tol = 1e-6,
+                                             int maxStep = 2000) const;
+
+private:
+  static_assert(!B{}.implicit(), "RKFEnsemble needs an explicit scheme");
+  BatchFunction      M_f;
+  std::size_t        M_lanes = 32u;
+  unsigned int       M_numThreads = 0u;
+  static constexpr B ButcherTable = B{};
+  /*!
+   * The state of a batch, allocated once per thread
+   */
+  struct Batch
+  {
+    Batch(std::size_t lanes, Eigen::Index dim)
+      : id(lanes), t(lanes), h(lanes), time(lanes), error(lanes),
+        estimatedError(lanes), iter(lanes), steps(lanes), contractions(lanes),
+        expansions(lanes), rejected(lanes), minimalh(lanes), y(lanes, dim),
+        fStart(lanes, dim), value(lanes, dim), yprimal(lanes, dim),
+        ytest(lanes, dim), accepted(lanes), acceptedId(lanes)
+    {
+      K.fill(BatchState(lanes, dim));
+    }
+    //! The instance in each lane
+    std::vector<std::size_t> id;
+    //! Time, time step and time of the stage of each lane
+    Eigen::ArrayXd t, h, time;
+    //! Error of the step and estimated error of each lane
+    Eigen::ArrayXd error, estimatedError;
+    //! Counters of each lane
+    std::vector<int> iter, steps, contractions, expansions;
+    //! Flags of each lane
+    std::vector<char> rejected, minimalh;
+    //! The current solution and its derivative
+    BatchState y, fStart;
+    //! The argument of the forcing term in a stage
+    BatchState value;
+    //! The solutions of the two rules
+    BatchState yprimal, ytest;
+    //! The stages, times h
+    std::array<BatchState, B::Nstages()> K;
+    //! The lanes accepted in the last step and their instances
+    std::vector<Eigen::Index> accepted;
+    std::vector<std::size_t>  acceptedId;
+    //! Moves lane from into lane to
+    void
+    move(std::size_t from, std::size_t to)
+    {
+      id[to] = id[from];
+      t(to) = t(from);
+      h(to) = h(from);
+      estimatedError(to) = estimatedError(from);
+      iter[to] = iter[from];
+      steps[to] = steps[from];
+      contractions[to] = contractions[from];
+      expansions[to] = expansions[from];
+      rejected[to] = rejected[from];
+      minimalh[to] = minimalh[from];
+      y.row(to) = y.row(from);
+      fStart.row(to) = fStart.row(from);
+    }
+  };
+  /*!
+   * A step of the first n lanes of a batch, from b.t with step b.h.
+   * On output the two solutions are in b.yprimal and b.ytest, their distance
+   * in b.error
+   */
+  void step(Batch &b, Eigen::Index n, long &evaluations) const;
+};
+
+//   ***********************************************
+//   ******    IMPLEMENTATIONS OF TEMPLATE FUNCTIONS
+//   ***********************************************
+
+template <apsc::ButcherArrayConcept B>
+typename RKFEnsemble<B>::RKFEnsembleResult
+RKFEnsemble<B>::operator()(double T0, double T, BatchState const &y0,
+                           double hInit, double tol, int maxSteps) const
+{
+  double timeInterval = T - T0;
+  if(timeInterval <= 0)
+    throw std::invalid_argument(
+      "RKFEnsemble: time interval must be greater than zero");
+  std::size_t const  N = static_cast<std::size_t>(y0.rows());
+  Eigen::Index const dim = y0.cols();
+  RKFEnsembleResult  res;
+  res.y.resize(y0.rows(), dim);
+  res.estimatedError.resize(N);
+  res.failed.resize(N);
+  res.steps.resize(N);
+  res.contractions.resize(N);
+  res.expansions.resize(N);
+  // The same parameters of the step control of RKF
+  double constexpr reductionFactor = 0.98;
+  double constexpr expansionFactor = 4.;
+  double constexpr maxreduction = 0.1;
+  double const factor_contraction = 1. / (ButcherTable.order);
+  double const factor_expansion = 1. / (ButcherTable.order + 1.0);
+  double const hmin =
+    100 * timeInterval * std::numeric_limits<double>::epsilon();
+  // The next instance to start
+  std::atomic<std::size_t> next{0u};
+  long                     evaluations = 0;
+  int                      minimalh = 0;
+
+#ifdef _OPENMP
+  int const numThreads =
+    M_numThreads > 0u ? static_cast<int>(M_numThreads) : omp_get_max_threads();
+#pragma omp parallel num_threads(numThreads) reduction(+ : evaluations, minimalh)
+#endif
+  {
+    Batch        b(M_lanes, dim);
+    Eigen::Index n = 0; // active lanes
+    // Loads new instances in the free lanes, and computes their derivative
+    auto fill = [&]() {
+      Eigen::Index const first = n;
+      for(; n < static_cast<Eigen::Index>(M_lanes); ++n)
+        {
+          std::size_t const i = next.fetch_add(1u, std::memory_order_relaxed);
+          if(i >= N)
+            break;
+          b.id[n] = i;
+          b.t(n) = T0;
+          b.h(n) = std::max(hInit, hmin);
+          b.estimatedError(n) = 0.;
+          b.iter[n] = 0;
+          b.steps[n] = 0;
+          b.contractions[n] = 0;
+          b.expansions[n] = 0;
+          b.rejected[n] = false;
+          b.minimalh[n] = false;
+          b.y.row(n) = y0.row(i);
+        }
+      if(n > first)
+        {
+          M_f(std::span<std::size_t const>(b.id).subspan(first, n - first),
+              b.t.segment(first, n - first), b.y.middleRows(first, n - first),
+              b.fStart.middleRows(first, n - first));
+          evaluations += n - first;
+        }
+    };
+    fill();
+    while(n > 0)
+      {
+        step(b, n, evaluations);
+        // A new derivative at the start is needed for the accepted lanes
+        // if the scheme is not FSAL
+        Eigen::Index nAccepted = 0;
+        for(Eigen::Index l = 0; l < n; ++l)
+          {
+            ++b.iter[l];
+            double const h = b.h(l);
+            double const errorPerTimeStep =
+              ButcherTable.order == 1 ? tol : tol * (h / timeInterval);
+            double const currentError = b.error(l);
+            double const ratio =
+              currentError <= std::numeric_limits<double>::epsilon()
+                ? std::numeric_limits<double>::infinity()
+                : errorPerTimeStep / currentError;
+            bool const accepted = ratio >= 1.0;
+            // at the minimum step we have to accept it
+            bool const minimal = !accepted && h <= hmin;
+            if(accepted || minimal)
+              {
+                b.y.row(l) = b.yprimal.row(l);
+                if constexpr(ButcherTable.fsal())
+                  b.fStart.row(l) = b.K[B::Nstages() - 1u].row(l) / h;
+                b.accepted[nAccepted++] = l;
+                b.t(l) += h;
+                ++b.steps[l];
+                b.estimatedError(l) += currentError;
+                if(accepted)
+                  {
+                    double hNew = std::min(h, T - b.t(l));
+                    // Expand if the step was not previously rejected
+                    if(!b.rejected[l] && b.t(l) < T)
+                      {
+                        hNew *= std::min(expansionFactor,
+                                         std::pow(ratio, factor_expansion));
+                        hNew = std::min(hNew, T - b.t(l));
+                        ++b.expansions[l];
+                      }
+                    b.h(l) = hNew;
+                  }
+                else
+                  b.minimalh[l] = true;
+                b.rejected[l] = false;
+              }
+            else
+              {
+                double const mu = std::max(
+                  maxreduction, std::pow(ratio, factor_contraction));
+                b.rejected[l] = true;
+                b.h(l) = std::max(h * mu * reductionFactor, hmin);
+                ++b.contractions[l];
+              }
+          }
+        if constexpr(!ButcherTable.fsal())
+          {
+            if(nAccepted == n)
+              M_f(std::span<std::size_t const>(b.id).first(n), b.t.head(n),
+                  b.y.topRows(n), b.fStart.topRows(n));
+            else if(nAccepted > 0)
+              {
+                // The derivative of the rejected lanes is unchanged: gather
+                // the accepted ones in b.time and b.value (free until the
+                // next step), evaluate in b.K[0] and scatter back
+                for(Eigen::Index k = 0; k < nAccepted; ++k)
+                  {
+                    Eigen::Index const l = b.accepted[k];
+                    b.acceptedId[k] = b.id[l];
+                    b.time(k) = b.t(l);
+                    b.value.row(k) = b.y.row(l);
+                  }
+                auto dy = b.K[0].topRows(nAccepted);
+                M_f(std::span<std::size_t const>(b.acceptedId).first(nAccepted),
+                    b.time.head(nAccepted), b.value.topRows(nAccepted), dy);
+                for(Eigen::Index k = 0; k < nAccepted; ++k)
+                  b.fStart.row(b.accepted[k]) = dy.row(k);
+              }
+            evaluations += nAccepted;
+          }
+        // Store the instances that have ended and compact the lanes
+        for(Eigen::Index l = 0; l < n;)
+          {
+            bool const ended = b.t(l) >= T;
+            bool const failed = b.iter[l] > maxSteps;
+            if(!ended && !failed)
+              {
+                ++l;
+                continue;
+              }
+            std::size_t const i = b.id[l];
+            res.y.row(i) = b.y.row(l);
+            res.estimatedError[i] = b.estimatedError(l);
+            res.failed[i] = failed && !ended;
+            res.steps[i] = b.steps[l];
+            res.contractions[i] = b.contractions[l];
+            res.expansions[i] = b.expansions[l];
+            minimalh += b.minimalh[l];
+            if(l != n - 1)
+              b.move(n - 1, l);
+            --n;
+          }
+        fill();
+      }
+  }
+  res.evaluations = evaluations;
+  res.minimalh = minimalh;
+  return res;
+}
+
+template <apsc::ButcherArrayConcept B>
+void
+RKFEnsemble<B>::step(Batch &b, Eigen::Index n, long &evaluations) const
+{
+  auto constexpr Nstages = B::Nstages();
+  auto const &A = ButcherTable.A;
+  auto const &c = ButcherTable.c;
+  auto const &b1 = ButcherTable.b1;
+  auto const &b2 = ButcherTable.b2;
+  auto const  h = b.h.head(n);
+  auto const  y = b.y.topRows(n);
+  auto        value = b.value.topRows(n);
+  std::span<std::size_t const> ids(b.id.data(), n);
+  // The first stage is the derivative at the start of the step
+  b.K[0].topRows(n) = b.fStart.topRows(n).colwise() * h;
+  for(std::size_t i = 1; i < Nstages; ++i)
+    {
+      b.time.head(n) = b.t.head(n) + c[i] * h;
+      value = y;
+      for(std::size_t j = 0; j < i; ++j)
+        if(A[i][j] != 0.)
+          value += A[i][j] * b.K[j].topRows(n);
+      auto Ki = b.K[i].topRows(n);
+      M_f(ids, b.time.head(n), value, Ki);
+      Ki.colwise() *= h;
+      evaluations += n;
+    }
+  auto yprimal = b.yprimal.topRows(n);
+  auto ytest = b.ytest.topRows(n);
+  yprimal = y;
+  ytest = y;
+  for(std::size_t i = 0; i < Nstages; ++i)
+    {
+      if(b1[i] != 0.)
+        yprimal += b.K[i].topRows(n) * b1[i];
+      if(b2[i] != 0.)
+        ytest += b.K[i].topRows(n) * b2[i];
+    }
+  b.error.head(n) = (yprimal - ytest).square().rowwise().sum().sqrt();
+}
+
+} // namespace apsc
+
+#endif /* SRC_RK45_RKFENSEMBLE_HPP_ */
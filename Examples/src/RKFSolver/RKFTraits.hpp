@@ -37,6 +37,12 @@ template <> struct RKFTraits<RKFKind::SCALAR>
   {
     return std::abs(x);
   }
+  //! The norm of x-y
+  static double
+  distance(VariableType const &x, VariableType const &y)
+  {
+    return std::abs(x - y);
+  }
 };
 
 //! Specialization for vector
@@ -50,6 +56,12 @@ template <> struct RKFTraits<RKFKind::VECTOR>
   {
     return x.norm();
   }
+  //! The norm of x-y, without temporaries
+  static double
+  distance(VariableType const &x, VariableType const &y)
+  {
+    return (x - y).norm();
+  }
 };
 //! Specialization for marices
 template <> struct RKFTraits<RKFKind::MATRIX>
@@ -62,6 +74,12 @@ template <> struct RKFTraits<RKFKind::MATRIX>
   {
     return x.norm();
   }
+  //! The norm of x-y, without temporaries
+  static double
+  distance(VariableType const &x, VariableType const &y)
+  {
+    return (x - y).norm();
+  }
 }; //@}
 } // namespace apsc
 
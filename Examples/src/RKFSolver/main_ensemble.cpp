@@ -0,0 +1,174 @@
+#include "RKF.hpp"
+#include "RKFEnsemble.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+/*
+  Integration of an ensemble of N independent instances of the same system.
+
+  The system is the SIR model of two cities connected by a mobility rate m,
+  as in MultiCity (with fractions of the population):
+
+  S_c' = -beta_c S_c I_c + m (S_o - S_c)
+  I_c' =  beta_c S_c I_c - gamma I_c + m (I_o - I_c)
+  R_c' =  gamma I_c + m (R_o - R_c)
+
+  for the city c=1,2, o being the other city. The contact rates beta_1,
+  beta_2, gamma and m are random, different for each instance, so the
+  instances need different numbers of steps. The epidemic starts in city 1.
+
+  We compare the throughput (instances per second) of a loop of RKF calls,
+  one for each instance, with that of RKFEnsemble with different numbers of
+  lanes, and check that the final states are the same.
+
+  Usage: main_ensemble [N]
+ */
+using namespace apsc;
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+//! The parameters of an instance
+struct Parameters
+{
+  double beta1;
+  double beta2;
+  double gamma;
+  double m;
+};
+
+constexpr Eigen::Index dim = 6;
+
+//! The initial state: S1, I1, R1, S2, I2, R2
+Eigen::VectorXd
+initialState()
+{
+  Eigen::VectorXd y0(dim);
+  y0 << 0.99, 0.01, 0., 1., 0., 0.;
+  return y0;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using Scheme = RKFScheme::DP45_t;
+  using Ensemble = RKFEnsemble<Scheme>;
+  std::size_t const N = argc > 1 ? std::stoul(argv[1]) : 10000u;
+  double const      T = 150.;
+  double const      hInit = 0.1;
+  double const      tol = 1.e-8;
+  int const         maxSteps = 100000;
+
+  std::mt19937                           engine(2024u);
+  std::uniform_real_distribution<double> beta(0.15, 0.6);
+  std::uniform_real_distribution<double> gamma(0.05, 0.2);
+  std::uniform_real_distribution<double> mobility(1.e-4, 1.e-2);
+  std::vector<Parameters>                params(N);
+  for(auto &p : params)
+    p = {beta(engine), beta(engine), gamma(engine), mobility(engine)};
+
+  // The forcing term of an instance
+  auto sir = [](Parameters const &p, double const *y, double *dy) {
+    double const infected1 = p.beta1 * y[0] * y[1];
+    double const infected2 = p.beta2 * y[3] * y[4];
+    dy[0] = -infected1 + p.m * (y[3] - y[0]);
+    dy[1] = infected1 - p.gamma * y[1] + p.m * (y[4] - y[1]);
+    dy[2] = p.gamma * y[1] + p.m * (y[5] - y[2]);
+    dy[3] = -infected2 + p.m * (y[0] - y[3]);
+    dy[4] = infected2 - p.gamma * y[4] + p.m * (y[1] - y[4]);
+    dy[5] = p.gamma * y[4] + p.m * (y[2] - y[5]);
+  };
+
+  // A loop of RKF
+  Eigen::VectorXd const    y0 = initialState();
+  Ensemble::BatchState     yLoop(N, dim);
+  std::vector<int>         stepsLoop(N);
+  long                     evaluationsLoop = 0;
+  double const             tLoop = timeIt([&] {
+    for(std::size_t i = 0u; i < N; ++i)
+      {
+        Parameters const p = params[i];
+        RKF<Scheme, RKFKind::VECTOR> solver{
+          [&sir, p](double const &, Eigen::VectorXd const &y) {
+            Eigen::VectorXd dy(dim);
+            sir(p, y.data(), dy.data());
+            return dy;
+          }};
+        Eigen::VectorXd yEnd;
+        auto            summary = solver.solve(
+          [&yEnd](auto const &step) { yEnd = step.yEnd; }, 0., T, y0, hInit,
+          tol, maxSteps);
+        yLoop.row(i) = yEnd.transpose();
+        stepsLoop[i] = summary.steps;
+        evaluationsLoop += summary.evaluations;
+      }
+  });
+
+  // The forcing term of a batch, a loop on the lanes: a component of all
+  // the lanes is contiguous
+  Ensemble solver{[&params](std::span<std::size_t const> ids,
+                            Eigen::Ref<Eigen::ArrayXd const>,
+                            Eigen::Ref<Ensemble::BatchState const> y,
+                            Eigen::Ref<Ensemble::BatchState>       dy) {
+    for(Eigen::Index l = 0; l < y.rows(); ++l)
+      {
+        Parameters const &p = params[ids[l]];
+        double const      infected1 = p.beta1 * y(l, 0) * y(l, 1);
+        double const      infected2 = p.beta2 * y(l, 3) * y(l, 4);
+        dy(l, 0) = -infected1 + p.m * (y(l, 3) - y(l, 0));
+        dy(l, 1) = infected1 - p.gamma * y(l, 1) + p.m * (y(l, 4) - y(l, 1));
+        dy(l, 2) = p.gamma * y(l, 1) + p.m * (y(l, 5) - y(l, 2));
+        dy(l, 3) = -infected2 + p.m * (y(l, 0) - y(l, 3));
+        dy(l, 4) = infected2 - p.gamma * y(l, 4) + p.m * (y(l, 1) - y(l, 4));
+        dy(l, 5) = p.gamma * y(l, 4) + p.m * (y(l, 2) - y(l, 5));
+      }
+  }};
+  Ensemble::BatchState const Y0 = y0.transpose().replicate(N, 1).array();
+
+  int minSteps = stepsLoop[0], maxStepsDone = stepsLoop[0];
+  for(auto s : stepsLoop)
+    {
+      minSteps = std::min(minSteps, s);
+      maxStepsDone = std::max(maxStepsDone, s);
+    }
+  std::cout << N << " instances of a two city SIR model on [0," << T
+            << "], DP45, tol=" << tol << "\nSteps of an instance: from "
+            << minSteps << " to " << maxStepsDone << "\n"
+#ifdef _OPENMP
+            << "OpenMP threads: " << omp_get_max_threads() << "\n"
+#endif
+            << std::left << std::setw(20) << "method" << std::right
+            << std::setw(12) << "time (ms)" << std::setw(14) << "instances/s"
+            << std::setw(12) << "f evals" << std::setw(12) << "diff steps"
+            << std::setw(12) << "max diff" << '\n';
+  auto print = [&](std::string const &name, double time, long evaluations,
+                   int diffSteps, double diff) {
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(12) << std::setprecision(4) << time << std::setw(14)
+              << std::setprecision(3) << std::scientific << N / (time * 1.e-3)
+              << std::defaultfloat << std::setw(12) << evaluations
+              << std::setw(12) << diffSteps << std::setw(12)
+              << std::setprecision(2) << std::scientific << diff
+              << std::defaultfloat << '\n';
+  };
+  print("loop of RKF", tLoop, evaluationsLoop, 0, 0.);
+  for(std::size_t lanes : {1u, 8u, 32u, 128u})
+    {
+      solver.setLanes(lanes);
+      Ensemble::RKFEnsembleResult result;
+      double const                time =
+        timeIt([&] { result = solver(0., T, Y0, hInit, tol, maxSteps); });
+      int diffSteps = 0;
+      for(std::size_t i = 0u; i < N; ++i)
+        diffSteps += result.steps[i] != stepsLoop[i];
+      print("ensemble, " + std::to_string(lanes) + " lanes", time,
+            result.evaluations, diffSteps,
+            (result.y - yLoop).abs().maxCoeff());
+    }
+}
@@ -0,0 +1,141 @@
+#include "RKF.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+/*
+  Streaming integration with RKF::solve().
+
+  1) Dense output: y'=-10y on [0,10], sampled with the dense output at 1001
+     equally spaced times by an observer, for RK45 and the FSAL schemes DP45
+     and BS23. We report the error at the ends of the steps and at the
+     sampling times.
+
+  2) A long integration, on [0,200], of a large system: a chain of n
+     oscillators u_i''= u_{i-1}-2u_i+u_{i+1} (n=10000 by default, or the
+     value given on the command line), a vector of size 2n. We compare
+     operator(), that stores all the steps, with solve(), whose observer
+     computes only the energy at the end of each step, with RK45 and DP45.
+
+  Usage: main_streaming [n]
+ */
+using namespace apsc;
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+template <class Scheme>
+void
+denseOutput(std::string const &name)
+{
+  auto fun = [](double const &, double const &y) { return -10 * y; };
+  auto exact = [](double const &t) { return std::exp(-10. * t); };
+  RKF<Scheme, RKFKind::SCALAR> solver{fun};
+  constexpr int                nSamples = 1001;
+  double const                 T = 10.;
+  int                          next = 0; // next sampling time
+  double                       stepError = 0.;
+  double                       sampleError = 0.;
+  auto                         summary = solver.solve(
+    [&](auto const &step) {
+      stepError =
+        std::max(stepError, std::abs(step.yEnd - exact(step.tEnd)));
+      for(; next < nSamples && next * T / (nSamples - 1) <= step.tEnd; ++next)
+        {
+          double const t = next * T / (nSamples - 1);
+          sampleError = std::max(sampleError, std::abs(step(t) - exact(t)));
+        }
+    },
+    0., T, 1., 0.2, 1.e-4);
+  std::cout << std::left << std::setw(8) << name << std::right << std::setw(8)
+            << summary.steps << std::setw(8) << summary.evaluations
+            << std::scientific << std::setprecision(2) << std::setw(14)
+            << stepError << std::setw(14) << sampleError << std::defaultfloat
+            << std::setw(10) << next << '\n';
+}
+
+template <class Scheme>
+void
+longIntegration(std::string const &name, Eigen::Index n)
+{
+  using Vector = Eigen::VectorXd;
+  auto chain = [n](double const &, Vector const &y) -> Vector {
+    Vector out(2 * n);
+    out.head(n) = y.tail(n);
+    for(Eigen::Index i = 0; i < n; ++i)
+      out(n + i) = (i > 0 ? y(i - 1) : 0.) - 2. * y(i) +
+                   (i + 1 < n ? y(i + 1) : 0.);
+    return out;
+  };
+  auto energy = [n](Vector const &y) {
+    double e = y.tail(n).squaredNorm();
+    for(Eigen::Index i = 0; i <= n; ++i)
+      {
+        double const left = i > 0 ? y(i - 1) : 0.;
+        double const right = i < n ? y(i) : 0.;
+        e += (right - left) * (right - left);
+      }
+    return 0.5 * e;
+  };
+  Vector y0 = Vector::Zero(2 * n);
+  for(Eigen::Index i = 0; i < n; ++i)
+    y0(i) = std::exp(-0.01 * (i - n / 2.) * (i - n / 2.));
+  double const               T = 200.;
+  double const               tol = 1.e-6;
+  int const                  maxSteps = 100000;
+  RKF<Scheme, RKFKind::VECTOR> solver{chain};
+
+  typename RKF<Scheme, RKFKind::VECTOR>::RKFResult result;
+  double const tHistory =
+    timeIt([&] { result = solver(0., T, y0, 0.1, tol, maxSteps); });
+  double const stored = result.y.size() * 2. * n * sizeof(double) / 1.e6;
+  double const drift = std::abs(energy(result.y.back()) - energy(y0));
+  std::cout << std::left << std::setw(22) << name + " operator()" << std::right
+            << std::setw(10) << std::setprecision(4) << tHistory
+            << std::setw(8) << result.time.size() - 1u << std::setw(8)
+            << result.evaluations << std::setw(12) << stored
+            << std::scientific << std::setprecision(2) << std::setw(12)
+            << drift << std::defaultfloat << '\n';
+  result = {}; // free the memory
+
+  double maxDrift = 0.;
+  typename RKF<Scheme, RKFKind::VECTOR>::RKFSummary summary;
+  double const tStreaming = timeIt([&] {
+    summary = solver.solve(
+      [&](auto const &step) {
+        maxDrift =
+          std::max(maxDrift, std::abs(energy(step.yEnd) - energy(y0)));
+      },
+      0., T, y0, 0.1, tol, maxSteps);
+  });
+  std::cout << std::left << std::setw(22) << name + " solve()" << std::right
+            << std::setw(10) << std::setprecision(4) << tStreaming
+            << std::setw(8) << summary.steps << std::setw(8)
+            << summary.evaluations << std::setw(12) << 0 << std::scientific
+            << std::setprecision(2) << std::setw(12) << maxDrift
+            << std::defaultfloat << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  Eigen::Index const n = argc > 1 ? std::stol(argv[1]) : 10000;
+  std::cout << "Dense output of y'=-10y on [0,10], tol=1e-4\n"
+            << std::left << std::setw(8) << "scheme" << std::right
+            << std::setw(8) << "steps" << std::setw(8) << "f evals"
+            << std::setw(14) << "error steps" << std::setw(14)
+            << "error samples" << std::setw(10) << "samples" << '\n';
+  denseOutput<RKFScheme::RK45_t>("RK45");
+  denseOutput<RKFScheme::DP45_t>("DP45");
+  denseOutput<RKFScheme::BS23_t>("BS23");
+
+  std::cout << "\nChain of " << n << " oscillators on [0,200], tol=1e-6\n"
+            << std::left << std::setw(22) << "scheme" << std::right
+            << std::setw(10) << "time (ms)" << std::setw(8) << "steps"
+            << std::setw(8) << "f evals" << std::setw(12) << "stored (MB)"
+            << std::setw(12) << "energy err" << '\n';
+  longIntegration<RKFScheme::RK45_t>("RK45", n);
+  longIntegration<RKFScheme::DP45_t>("DP45", n);
+}
@@ -0,0 +1,303 @@
+#ifndef HPP_ALLINTERSECTIONS_HPP
+#define HPP_ALLINTERSECTIONS_HPP
+#include "SegmentIntersect.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+namespace apsc::Geometry
+{
+//! Options of allIntersections()
+struct AllIntersectionsOptions
+{
+  //! The tolerance passed to segmentIntersect()
+  double tol = std::sqrt(std::numeric_limits<double>::epsilon());
+  //! Whether to store the IntersectionStatus of each intersecting pair
+  bool keepStatus = false;
+  //! The size of the cells of the grid. If 0, it is computed from the
+  //! average size of the segments
+  double cellSize = 0.;
+};
+
+//! The result of allIntersections()
+template <concepts::Point2D POINT = Point> struct AllIntersectionsResult
+{
+  //! The pairs {i,j}, i<j, of intersecting segments, in lexicographic order
+  std::vector<std::array<std::size_t, 2>> pairs;
+  //! The result of segmentIntersect() for each pair (if required)
+  std::vector<IntersectionStatus<POINT>> status;
+  //! The number of pairs tested with segmentIntersect()
+  std::size_t candidates = 0u;
+  //! The number of cells of the grid
+  std::size_t numCells = 0u;
+  //! The number of (segment, cell) entries in the grid
+  std::size_t gridEntries = 0u;
+};
+
+/*!
+  @brief Finds all pairs of intersecting segments
+
+  A uniform grid is used as broad phase: each segment is registered in the
+  cells intersected by its bounding box (enlarged by the tolerance), and
+  segmentIntersect() is called only for pairs of segments sharing a cell and
+  whose bounding boxes intersect. A pair sharing several cells is tested only
+  in the cell containing the lower left corner of the intersection of the two
+  bounding boxes, so no pair is tested twice.
+
+  The cost is proportional to the number of segments plus the number of pairs
+  tested, which for segments of comparable size is proportional to the
+  number of intersections: the algorithm is output sensitive, unless a few
+  segments are much longer than the others, or many segments are crowded in
+  a small region. The cells have the size of the average segment, but they
+  are at most 4 times the number of segments.
+
+  If compiled with OpenMP the bounding boxes, the construction of the grid
+  (counting, prefix sum and fill) and the cells are shared among the
+  threads. The pairs are sorted at the end, so the result does not depend
+  on the number of threads.
+
+  @tparam Edge_t The type of the segments (see segmentIntersect())
+  @param edges The segments (of non null length)
+  @param options The tolerance and other options
+  @return The intersecting pairs and some statistics
+ */
+template <concepts::Edge Edge_t>
+[[nodiscard]] auto
+allIntersections(std::span<Edge_t const>        edges,
+                 AllIntersectionsOptions const &options = {})
+  -> AllIntersectionsResult<typename Edge_t::Point_t>
+{
+  using Box = std::array<double, 4>; // xmin, ymin, xmax, ymax
+  AllIntersectionsResult<typename Edge_t::Point_t> result;
+  std::size_t const                                n = edges.size();
+  if(n < 2u)
+    return result;
+  int numThreads = 1;
+#ifdef _OPENMP
+  numThreads = omp_get_max_threads();
+#endif
+  // The bounding boxes, enlarged by the tolerance on distances used in
+  // segmentIntersect(). The domain and the sum of the sizes are reduced
+  // over blocks of fixed length, so the grid does not depend on the number
+  // of threads
+  std::vector<Box>  boxes(n);
+  std::size_t const boxBlock = 4096u;
+  auto const        numBoxBlocks =
+    static_cast<std::ptrdiff_t>((n + boxBlock - 1u) / boxBlock);
+  std::vector<Box>    blockDomain(numBoxBlocks);
+  std::vector<double> blockSize(numBoxBlocks);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for(std::ptrdiff_t blk = 0; blk < numBoxBlocks; ++blk)
+    {
+      Box    domain{std::numeric_limits<double>::max(),
+                 std::numeric_limits<double>::max(),
+                 std::numeric_limits<double>::lowest(),
+                 std::numeric_limits<double>::lowest()};
+      double sumSize = 0.;
+      for(std::size_t i = blk * boxBlock; i < std::min(n, (blk + 1) * boxBlock);
+          ++i)
+        {
+          auto const  &a = edges[i][0];
+          auto const  &b = edges[i][1];
+          double const dx = std::abs(b[0] - a[0]);
+          double const dy = std::abs(b[1] - a[1]);
+          double const margin = options.tol * std::sqrt(dx * dx + dy * dy);
+          boxes[i] = {std::min<double>(a[0], b[0]) - margin,
+                      std::min<double>(a[1], b[1]) - margin,
+                      std::max<double>(a[0], b[0]) + margin,
+                      std::max<double>(a[1], b[1]) + margin};
+          for(int k = 0; k < 2; ++k)
+            {
+              domain[k] = std::min(domain[k], boxes[i][k]);
+              domain[k + 2] = std::max(domain[k + 2], boxes[i][k + 2]);
+            }
+          sumSize += std::max(dx, dy);
+        }
+      blockDomain[blk] = domain;
+      blockSize[blk] = sumSize;
+    }
+  Box    domain = blockDomain[0];
+  double sumSize = 0.;
+  for(std::ptrdiff_t blk = 0; blk < numBoxBlocks; ++blk)
+    {
+      for(int k = 0; k < 2; ++k)
+        {
+          domain[k] = std::min(domain[k], blockDomain[blk][k]);
+          domain[k + 2] = std::max(domain[k + 2], blockDomain[blk][k + 2]);
+        }
+      sumSize += blockSize[blk];
+    }
+  // The grid
+  double const width = domain[2] - domain[0];
+  double const height = domain[3] - domain[1];
+  double       h = options.cellSize > 0. ? options.cellSize : sumSize / n;
+  // not more than 4n cells
+  h = std::max(h, std::sqrt(width * height / (4. * n)));
+  h = std::max(h, std::max(width, height) / (4. * n));
+  if(!(h > 0.))
+    h = 1.;
+  auto const nx = static_cast<std::size_t>(width / h) + 1u;
+  auto const ny = static_cast<std::size_t>(height / h) + 1u;
+  // The cell containing a coordinate. It is monotone, so a point in a box is
+  // in one of the cells of the box
+  auto const cell = [h](double x, double origin, std::size_t numCells) {
+    return std::min(static_cast<std::size_t>((x - origin) / h),
+                    numCells - 1u);
+  };
+  result.numCells = nx * ny;
+  // The segments of each cell, in CSR format, built by counting sort
+  std::vector<std::size_t> cellStart(nx * ny + 1u, 0u);
+  auto const               forCellsOfBox = [&](Box const &box, auto &&f) {
+    auto const i0 = cell(box[0], domain[0], nx);
+    auto const i1 = cell(box[2], domain[0], nx);
+    auto const j0 = cell(box[1], domain[1], ny);
+    auto const j1 = cell(box[3], domain[1], ny);
+    for(auto j = j0; j <= j1; ++j)
+      for(auto i = i0; i <= i1; ++i)
+        f(j * nx + i);
+  };
+  auto const numEdges = static_cast<std::ptrdiff_t>(n);
+  // The counters are shared by the threads
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for(std::ptrdiff_t s = 0; s < numEdges; ++s)
+    forCellsOfBox(boxes[s], [&cellStart](std::size_t c) {
+      std::atomic_ref<std::size_t>(cellStart[c + 1u])
+        .fetch_add(1u, std::memory_order_relaxed);
+    });
+  // Prefix sum: each thread scans a block of cells, then adds the total of
+  // the previous blocks
+  {
+    auto const numBlocks = static_cast<std::ptrdiff_t>(numThreads);
+    std::size_t const blockLength = (nx * ny + numBlocks - 1u) / numBlocks;
+    std::vector<std::size_t> blockTotal(numBlocks + 1u, 0u);
+    auto const               blockRange = [&](std::ptrdiff_t blk) {
+      std::size_t const first = std::min(blk * blockLength, nx * ny);
+      return std::pair{first, std::min(first + blockLength, nx * ny)};
+    };
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads)
+#endif
+    for(std::ptrdiff_t blk = 0; blk < numBlocks; ++blk)
+      {
+        auto const [first, last] = blockRange(blk);
+        for(std::size_t c = first + 1u; c < last; ++c)
+          cellStart[c + 1u] += cellStart[c];
+        blockTotal[blk + 1] = first < last ? cellStart[last] : 0u;
+      }
+    for(std::ptrdiff_t blk = 0; blk < numBlocks; ++blk)
+      blockTotal[blk + 1] += blockTotal[blk];
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads)
+#endif
+    for(std::ptrdiff_t blk = 1; blk < numBlocks; ++blk)
+      {
+        auto const [first, last] = blockRange(blk);
+        for(std::size_t c = first; c < last; ++c)
+          cellStart[c + 1u] += blockTotal[blk];
+      }
+  }
+  result.gridEntries = cellStart.back();
+  // The order of the segments in a cell depends on the threads, but the
+  // pairs are sorted at the end
+  std::vector<std::size_t> cellSegments(cellStart.back());
+  {
+    std::vector<std::size_t> next(cellStart.begin(), cellStart.end() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for(std::ptrdiff_t s = 0; s < numEdges; ++s)
+      forCellsOfBox(boxes[s], [&](std::size_t c) {
+        cellSegments[std::atomic_ref<std::size_t>(next[c]).fetch_add(
+          1u, std::memory_order_relaxed)] = s;
+      });
+  }
+
+  // The narrow phase, cell by cell. Each thread collects its results
+  using Pair = std::array<std::size_t, 2>;
+  using Status = IntersectionStatus<typename Edge_t::Point_t>;
+  std::vector<std::vector<Pair>>   foundPairs(numThreads);
+  std::vector<std::vector<Status>> foundStatus(numThreads);
+  std::size_t                      candidates = 0u;
+  auto const numCells = static_cast<std::ptrdiff_t>(nx * ny);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : candidates)
+#endif
+  for(std::ptrdiff_t c = 0; c < numCells; ++c)
+    {
+      int thread = 0;
+#ifdef _OPENMP
+      thread = omp_get_thread_num();
+#endif
+      for(auto k = cellStart[c]; k < cellStart[c + 1]; ++k)
+        for(auto l = k + 1u; l < cellStart[c + 1]; ++l)
+          {
+            auto const   s = std::min(cellSegments[k], cellSegments[l]);
+            auto const   t = std::max(cellSegments[k], cellSegments[l]);
+            Box const   &a = boxes[s];
+            Box const   &b = boxes[t];
+            double const x = std::max(a[0], b[0]);
+            double const y = std::max(a[1], b[1]);
+            // boxes do not intersect
+            if(x > std::min(a[2], b[2]) || y > std::min(a[3], b[3]))
+              continue;
+            // the pair is tested in another cell
+            if(cell(y, domain[1], ny) * nx + cell(x, domain[0], nx) !=
+               static_cast<std::size_t>(c))
+              continue;
+            ++candidates;
+            auto status = segmentIntersect(edges[s], edges[t], options.tol);
+            if(status.intersect)
+              {
+                foundPairs[thread].push_back({s, t});
+                if(options.keepStatus)
+                  foundStatus[thread].push_back(status);
+              }
+          }
+    }
+  result.candidates = candidates;
+
+  // Merge in lexicographic order
+  for(int t = 0; t < numThreads; ++t)
+    {
+      result.pairs.insert(result.pairs.end(), foundPairs[t].begin(),
+                          foundPairs[t].end());
+      result.status.insert(result.status.end(), foundStatus[t].begin(),
+                           foundStatus[t].end());
+    }
+  if(!options.keepStatus)
+    std::sort(result.pairs.begin(), result.pairs.end());
+  else
+    {
+      std::vector<std::size_t> order(result.pairs.size());
+      for(std::size_t k = 0u; k < order.size(); ++k)
+        order[k] = k;
+      std::sort(order.begin(), order.end(),
+                [&result](std::size_t a, std::size_t b) {
+                  return result.pairs[a] < result.pairs[b];
+                });
+      std::vector<Pair>   pairs(order.size());
+      std::vector<Status> status(order.size());
+      for(std::size_t k = 0u; k < order.size(); ++k)
+        {
+          pairs[k] = result.pairs[order[k]];
+          status[k] = result.status[order[k]];
+        }
+      result.pairs = std::move(pairs);
+      result.status = std::move(status);
+    }
+  return result;
+}
+} // namespace apsc::Geometry
+#endif
@@ -0,0 +1,134 @@
+// Benchmark of allIntersections() against the pairwise test of all pairs
+//
+// Usage: main_allIntersections [maxN] [maxBruteForce]
+//
+// Two networks of N segments in the unit square:
+//  - random: segments with random center and orientation and length 2/sqrt(N),
+//    so that each segment intersects a few others;
+//  - lattice: the edges of a square lattice, with the vertices moved by
+//    1e-13 (much less than the tolerance), so that all segments meet at the
+//    ends, plus some diagonals through the vertices and some segments
+//    overlapping the lattice edges: a nearly degenerate fracture network.
+//
+#include "AllIntersections.hpp"
+#include "EdgeGeo.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+namespace
+{
+using Edge = apsc::Geometry::EdgeGeo<>;
+using apsc::Geometry::Point;
+
+std::vector<Edge>
+randomNetwork(std::size_t n)
+{
+  std::mt19937                           engine(2024u);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  double const                           length = 2. / std::sqrt(n);
+  std::vector<Edge>                      edges;
+  edges.reserve(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      double const x = uniform(engine);
+      double const y = uniform(engine);
+      double const theta = std::numbers::pi * uniform(engine);
+      double const dx = 0.5 * length * std::cos(theta);
+      double const dy = 0.5 * length * std::sin(theta);
+      edges.emplace_back(Point{x - dx, y - dy}, Point{x + dx, y + dy});
+    }
+  return edges;
+}
+
+std::vector<Edge>
+latticeNetwork(std::size_t n)
+{
+  // about 2 m^2 edges
+  auto const m = static_cast<std::size_t>(std::sqrt(n / 2.)) + 1u;
+  double const                           h = 1. / m;
+  std::mt19937                           engine(2025u);
+  std::uniform_real_distribution<double> noise(-1.e-13, 1.e-13);
+  auto const node = [&](std::size_t i, std::size_t j) {
+    return Point{i * h + noise(engine), j * h + noise(engine)};
+  };
+  std::vector<Edge> edges;
+  edges.reserve(n);
+  for(std::size_t i = 0u; i < m && edges.size() < n; ++i)
+    for(std::size_t j = 0u; j < m && edges.size() < n; ++j)
+      {
+        edges.emplace_back(node(i, j), node(i + 1u, j));
+        edges.emplace_back(node(i, j), node(i, j + 1u));
+        if((i + j) % 7u == 0u)
+          // a diagonal of the cell, through two vertices
+          edges.emplace_back(node(i, j), node(i + 1u, j + 1u));
+        if((i + 2u * j) % 11u == 0u)
+          // overlapping half of the horizontal edge
+          edges.emplace_back(Point{(i + 0.25) * h, j * h},
+                             Point{(i + 0.75) * h, j * h});
+      }
+  edges.resize(std::min(n, edges.size()), edges.back());
+  return edges;
+}
+
+//! All pairs, as done up to now
+std::vector<std::array<std::size_t, 2>>
+bruteForce(std::vector<Edge> const &edges)
+{
+  std::vector<std::array<std::size_t, 2>> pairs;
+  for(std::size_t i = 0u; i < edges.size(); ++i)
+    for(std::size_t j = i + 1u; j < edges.size(); ++j)
+      if(apsc::Geometry::segmentIntersect(edges[i], edges[j]).intersect)
+        pairs.push_back({i, j});
+  return pairs;
+}
+
+void
+benchmark(std::string const &name, std::vector<Edge> const &edges,
+          std::size_t maxBruteForce)
+{
+  Timings::Chrono clock;
+  clock.start();
+  auto const result =
+    apsc::Geometry::allIntersections(std::span<Edge const>(edges));
+  clock.stop();
+  double const tGrid = clock.wallTime() * 1.e-3;
+  std::cout << std::setw(8) << name << std::setw(9) << edges.size()
+            << std::setw(11) << result.pairs.size() << std::setw(12)
+            << result.candidates << std::setw(10) << result.numCells
+            << std::fixed << std::setprecision(1) << std::setw(12) << tGrid;
+  if(edges.size() <= maxBruteForce)
+    {
+      clock.start();
+      auto const pairs = bruteForce(edges);
+      clock.stop();
+      std::cout << std::setw(12) << clock.wallTime() * 1.e-3 << std::setw(7)
+                << (pairs == result.pairs ? "yes" : "NO");
+    }
+  else
+    std::cout << std::setw(12) << "-" << std::setw(7) << "-";
+  std::cout << std::defaultfloat << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const maxN = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  std::size_t const maxBruteForce = argc > 2 ? std::stoul(argv[2]) : 10000u;
+  std::cout << "Times in ms. same: the brute force finds the same pairs\n"
+            << std::setw(8) << "network" << std::setw(9) << "N"
+            << std::setw(11) << "pairs" << std::setw(12) << "candidates"
+            << std::setw(10) << "cells" << std::setw(12) << "grid"
+            << std::setw(12) << "all pairs" << std::setw(7) << "same"
+            << '\n';
+  for(std::size_t n = 1000u; n <= maxN; n *= 10u)
+    {
+      benchmark("random", randomNetwork(n), maxBruteForce);
+      benchmark("lattice", latticeNetwork(n), maxBruteForce);
+    }
+}
@@ -85,6 +85,21 @@ operator<<(std::ostream &out, Chrono const &c)
   out.flags(oldf);
   return out;
 }
+
+/*!
+ * Wall time taken by a call of f(), in milliseconds (not in microseconds
+ * as Chrono::wallTime()). Used by the benchmarks of the examples.
+ */
+template <class F>
+inline double
+timeIt(F &&f)
+{
+  Chrono clock;
+  clock.start();
+  f();
+  clock.stop();
+  return clock.wallTime() * 1.e-3;
+}
 } // namespace Timings
 
 #endif
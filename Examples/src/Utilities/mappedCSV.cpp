@@ -0,0 +1,306 @@
+/*
+ * mappedCSV.cpp
+ *
+ *  A multithreaded reader of csv files mapped in memory
+ */
+#include "mappedCSV.hpp"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+namespace Utility
+{
+namespace
+{
+  bool
+  isBlank(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+  //! Removes leading and trailing blanks
+  std::string_view
+  trim(char const *begin, char const *end)
+  {
+    while(begin < end && isBlank(*begin))
+      ++begin;
+    while(end > begin && isBlank(*(end - 1)))
+      --end;
+    return {begin, static_cast<std::size_t>(end - begin)};
+  }
+  //! The end of the line starting at p
+  char const *
+  endOfLine(char const *p, char const *end)
+  {
+    auto const *eol =
+      static_cast<char const *>(std::memchr(p, '\n', end - p));
+    return eol ? eol : end;
+  }
+
+  //! Records and fields found by a thread
+  struct Chunk
+  {
+    std::vector<std::string_view>     fields;
+    std::vector<MappedCSV::size_type> numFields;
+    MappedCSV::size_type              emptyLines = 0u;
+  };
+
+  //! Splits the lines in [begin,end) into fields
+  void
+  splitLines(char const *begin, char const *end,
+             MappedCSV::Options const &options, Chunk &chunk)
+  {
+    char const sep = options.separator;
+    for(char const *p = begin; p < end;)
+      {
+        char const *eol = endOfLine(p, end);
+        auto const  line = trim(p, eol);
+        p = eol + 1;
+        if(line.empty())
+          {
+            ++chunk.emptyLines;
+            continue;
+          }
+        std::size_t count = 0u;
+        char const *q = line.data();
+        char const *e = line.data() + line.size();
+        while(true)
+          {
+            while(q < e && isBlank(*q))
+              ++q;
+            char const *fieldEnd;
+            if(q < e && *q == '"')
+              {
+                // text field: look for the closing quotation mark
+                char const *close = q + 1;
+                while((close = std::find(close, e, '"')) < e &&
+                      close + 1 < e && close[1] == '"')
+                  close += 2;
+                fieldEnd = std::min(close + 1, e);
+                char const *next = std::find(fieldEnd, e, sep);
+                if(options.stripQuotation && close < e)
+                  chunk.fields.emplace_back(
+                    q + 1, static_cast<std::size_t>(close - q - 1));
+                else
+                  chunk.fields.push_back(trim(q, next));
+                fieldEnd = next;
+              }
+            else
+              {
+                fieldEnd = std::find(q, e, sep);
+                chunk.fields.push_back(trim(q, fieldEnd));
+              }
+            ++count;
+            if(fieldEnd == e)
+              break;
+            q = fieldEnd + 1;
+          }
+        chunk.numFields.push_back(count);
+      }
+  }
+} // namespace
+
+MappedCSV::MappedCSV(std::string const &fileName, Options const &options)
+{
+  int const fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error("MappedCSV: cannot open file " + fileName);
+  struct stat st;
+  if(::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      throw std::runtime_error("MappedCSV: cannot read file " + fileName);
+    }
+  M_length = st.st_size;
+  if(M_length > 0u)
+    {
+      void *address = ::mmap(nullptr, M_length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(address == MAP_FAILED)
+        {
+          ::close(fd);
+          throw std::runtime_error("MappedCSV: cannot map file " + fileName);
+        }
+      M_data = static_cast<char const *>(address);
+      // We will read the whole file sequentially
+      ::madvise(address, M_length, MADV_SEQUENTIAL);
+    }
+  // the mapping stays valid after closing the file
+  ::close(fd);
+  M_numThreads = options.numThreads > 0u
+                   ? options.numThreads
+                   : std::max(std::thread::hardware_concurrency(), 1u);
+  split(options);
+}
+
+MappedCSV::MappedCSV(std::string const &fileName)
+  : MappedCSV(fileName, Options{})
+{}
+
+MappedCSV::MappedCSV(MappedCSV &&other) noexcept
+  : M_data(std::exchange(other.M_data, nullptr)),
+    M_length(std::exchange(other.M_length, 0u)),
+    M_numThreads(other.M_numThreads),
+    M_emptyLines(std::exchange(other.M_emptyLines, 0u)),
+    M_fields(std::move(other.M_fields)),
+    M_recordStart(std::exchange(other.M_recordStart, {0u}))
+{}
+
+MappedCSV &
+MappedCSV::operator=(MappedCSV &&other) noexcept
+{
+  if(this != &other)
+    {
+      if(M_data)
+        ::munmap(const_cast<char *>(M_data), M_length);
+      M_data = std::exchange(other.M_data, nullptr);
+      M_length = std::exchange(other.M_length, 0u);
+      M_numThreads = other.M_numThreads;
+      M_emptyLines = std::exchange(other.M_emptyLines, 0u);
+      M_fields = std::move(other.M_fields);
+      M_recordStart = std::exchange(other.M_recordStart, {0u});
+    }
+  return *this;
+}
+
+MappedCSV::~MappedCSV()
+{
+  if(M_data)
+    ::munmap(const_cast<char *>(M_data), M_length);
+}
+
+void
+MappedCSV::parallelRanges(
+  size_type n, std::function<void(size_type, size_type)> const &f) const
+{
+  auto const numThreads =
+    static_cast<unsigned>(std::clamp<size_type>(M_numThreads, 1u, n));
+  if(numThreads <= 1u)
+    {
+      f(0u, n);
+      return;
+    }
+  // exceptions cannot leave a thread: the first one is stored and rethrown
+  std::exception_ptr error;
+  std::mutex         errorMutex;
+  auto               work = [&](unsigned t) {
+    try
+      {
+        f(n * t / numThreads, n * (t + 1u) / numThreads);
+      }
+    catch(...)
+      {
+        std::lock_guard lock(errorMutex);
+        if(!error)
+          error = std::current_exception();
+      }
+  };
+  std::vector<std::thread> threads;
+  for(unsigned t = 1u; t < numThreads; ++t)
+    threads.emplace_back(work, t);
+  work(0u);
+  for(auto &th : threads)
+    th.join();
+  if(error)
+    std::rethrow_exception(error);
+}
+
+void
+MappedCSV::split(Options const &options)
+{
+  char const *begin = M_data;
+  char const *end = M_data + M_length;
+  for(unsigned i = 0u; i < options.skippedLines && begin < end; ++i)
+    begin = endOfLine(begin, end) + 1;
+  begin = std::min(begin, end);
+  // Chunk boundaries, moved to the beginning of a line
+  unsigned const numChunks = static_cast<unsigned>(std::clamp<size_type>(
+    M_numThreads, 1u, std::max<size_type>((end - begin) / 4096u, 1u)));
+  std::vector<char const *> bounds(numChunks + 1u, end);
+  bounds[0] = begin;
+  for(unsigned t = 1u; t < numChunks; ++t)
+    {
+      char const *p = begin + (end - begin) * t / numChunks;
+      p = std::max(p, bounds[t - 1u]);
+      bounds[t] = p == end ? end : std::min(endOfLine(p, end) + 1, end);
+    }
+  // Each thread splits one chunk, waits for the others, and copies its
+  // fields in their final place. The barrier completion, run by the last
+  // thread to arrive, computes where the records and fields of each chunk
+  // go. The fields of the first chunk are moved, not copied: with a single
+  // chunk there is no copy at all.
+  std::vector<Chunk>     chunks(numChunks);
+  std::vector<size_type> recordOffset(numChunks + 1u, 0u);
+  std::vector<size_type> fieldOffset(numChunks + 1u, 0u);
+  // a thread that fails does not merge, but must not block the others
+  std::atomic<bool>  failed{false};
+  std::exception_ptr mergeError;
+  auto               merge = [&]() noexcept {
+    if(failed)
+      return;
+    M_emptyLines = 0u;
+    for(unsigned c = 0u; c < numChunks; ++c)
+      {
+        recordOffset[c + 1u] = recordOffset[c] + chunks[c].numFields.size();
+        fieldOffset[c + 1u] = fieldOffset[c] + chunks[c].fields.size();
+        M_emptyLines += chunks[c].emptyLines;
+      }
+    try
+      {
+        M_fields = std::move(chunks[0].fields);
+        M_fields.resize(fieldOffset.back());
+        M_recordStart.resize(recordOffset.back() + 1u);
+        M_recordStart[0] = 0u;
+      }
+    catch(...)
+      {
+        mergeError = std::current_exception();
+        failed = true;
+      }
+  };
+  // parallelRanges() runs one thread per chunk, since numChunks is not
+  // greater than the number of threads
+  std::barrier sync(static_cast<std::ptrdiff_t>(numChunks), merge);
+  parallelRanges(numChunks, [&](size_type first, size_type last) {
+    try
+      {
+        for(auto c = first; c < last; ++c)
+          splitLines(bounds[c], bounds[c + 1u], options, chunks[c]);
+      }
+    catch(...)
+      {
+        failed = true;
+        sync.arrive_and_drop();
+        throw;
+      }
+    sync.arrive_and_wait();
+    if(failed)
+      return;
+    for(auto c = first; c < last; ++c)
+      {
+        // the fields of the first chunk are already in place
+        if(c > 0u)
+          std::copy(chunks[c].fields.begin(), chunks[c].fields.end(),
+                    M_fields.begin() + fieldOffset[c]);
+        size_type position = fieldOffset[c];
+        size_type record = recordOffset[c];
+        for(auto n : chunks[c].numFields)
+          {
+            position += n;
+            M_recordStart[++record] = position;
+          }
+        // release memory as soon as possible
+        chunks[c] = Chunk{};
+      }
+  });
+  if(mergeError)
+    std::rethrow_exception(mergeError);
+}
+
+} // namespace Utility
@@ -0,0 +1,195 @@
+#ifndef HH_MAPPEDCSV_HH
+#define HH_MAPPEDCSV_HH
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+namespace Utility
+{
+/*!
+ * A csv file mapped in memory and split into records and fields.
+ *
+ * The file is mapped read-only with mmap and divided into chunks, one per
+ * thread, starting at the beginning of a line. Each thread splits the lines
+ * of its chunk into fields, which are stored as std::string_view pointing
+ * into the mapped memory: no string is allocated, the only memory used is
+ * that of the two arrays that index records and fields.
+ *
+ * Fields are trimmed of white spaces. A field starting with a double
+ * quotation mark " is a text field that may contain the separator, until
+ * the closing quotation mark ("" inside a text field is a quotation mark
+ * and does not close it, it is not replaced by a single "). A record is a
+ * line, so text fields cannot span more lines. Empty lines are ignored.
+ *
+ * Columns can be extracted into contiguous arrays of double, integers,
+ * std::string_view or std::string with column<T>(j), again in parallel.
+ *
+ * The object is movable but not copyable; views returned by its methods
+ * are valid as long as the object exists.
+ */
+class MappedCSV
+{
+public:
+  using size_type = std::size_t;
+  //! How to read the file
+  struct Options
+  {
+    //! The separator of fields
+    char separator = ',';
+    //! Number of lines at the beginning of the file that are skipped
+    unsigned skippedLines = 0u;
+    //! Strip quotation marks from text fields
+    bool stripQuotation = false;
+    //! Number of threads (0 means all hardware threads)
+    unsigned numThreads = 0u;
+  };
+
+  MappedCSV() = default;
+  /*!
+   * Maps and splits a file
+   * @param fileName The file name
+   * @param options The options
+   * @throw std::runtime_error if the file cannot be read
+   */
+  MappedCSV(std::string const &fileName, Options const &options);
+  //! Maps and splits a file with default options
+  explicit MappedCSV(std::string const &fileName);
+  MappedCSV(MappedCSV const &) = delete;
+  MappedCSV &operator=(MappedCSV const &) = delete;
+  MappedCSV(MappedCSV &&other) noexcept;
+  MappedCSV &operator=(MappedCSV &&other) noexcept;
+  ~MappedCSV();
+
+  //! The number of records
+  size_type
+  numRecords() const noexcept
+  {
+    return M_recordStart.size() - 1u;
+  }
+  //! The number of fields of record i
+  size_type
+  numFields(size_type i) const noexcept
+  {
+    return M_recordStart[i + 1u] - M_recordStart[i];
+  }
+  //! The fields of record i
+  std::span<std::string_view const>
+  record(size_type i) const noexcept
+  {
+    return {M_fields.data() + M_recordStart[i], numFields(i)};
+  }
+  //! Field j of record i
+  std::string_view
+  field(size_type i, size_type j) const noexcept
+  {
+    return M_fields[M_recordStart[i] + j];
+  }
+  //! The size of the file in bytes
+  size_type
+  fileSize() const noexcept
+  {
+    return M_length;
+  }
+  //! The number of empty lines that have been ignored
+  size_type
+  numEmptyLines() const noexcept
+  {
+    return M_emptyLines;
+  }
+
+  /*!
+   * Converts column j into an array
+   *
+   * Supported types are arithmetic types (converted with std::from_chars,
+   * surrounding quotation marks are ignored), std::string_view (no copy)
+   * and std::string.
+   * @tparam T The type of the values
+   * @param j The column
+   * @return The values of column j, one per record
+   * @throw std::runtime_error if a record has no field j, or the field
+   * cannot be converted
+   */
+  template <class T>
+  std::vector<T>
+  column(size_type j) const
+  {
+    std::vector<T> values(numRecords());
+    column<T>(j, values);
+    return values;
+  }
+  /*!
+   * Converts column j into a given array
+   * @param j The column
+   * @param values The values, of size numRecords()
+   */
+  template <class T> void column(size_type j, std::span<T> values) const;
+
+private:
+  //! Calls f(begin, end) on a partition of [0,n) among the threads
+  void
+  parallelRanges(size_type                                          n,
+                 std::function<void(size_type, size_type)> const &f) const;
+  //! Splits the file into records and fields
+  void split(Options const &options);
+  //! The conversion of a field
+  template <class T>
+  static T convert(std::string_view s, size_type i, size_type j);
+  char const                   *M_data = nullptr;
+  size_type                     M_length = 0u;
+  unsigned                      M_numThreads = 1u;
+  size_type                     M_emptyLines = 0u;
+  std::vector<std::string_view> M_fields;
+  std::vector<size_type>        M_recordStart{0u};
+};
+
+template <class T>
+T
+MappedCSV::convert(std::string_view s, size_type i, size_type j)
+{
+  if constexpr(std::is_same_v<T, std::string_view>)
+    return s;
+  else if constexpr(std::is_same_v<T, std::string>)
+    return std::string(s);
+  else
+    {
+      static_assert(std::is_arithmetic_v<T>,
+                    "MappedCSV: unsupported column type");
+      if(s.size() >= 2u && s.front() == '"' && s.back() == '"')
+        s = s.substr(1u, s.size() - 2u);
+      if(!s.empty() && s.front() == '+')
+        s.remove_prefix(1u);
+      T    value{};
+      auto res = std::from_chars(s.data(), s.data() + s.size(), value);
+      if(res.ec != std::errc{} || res.ptr != s.data() + s.size())
+        throw std::runtime_error(
+          "MappedCSV: cannot convert field " + std::to_string(j) +
+          " of record " + std::to_string(i) + ": " + std::string(s));
+      return value;
+    }
+}
+
+template <class T>
+void
+MappedCSV::column(size_type j, std::span<T> values) const
+{
+  if(values.size() != numRecords())
+    throw std::invalid_argument("MappedCSV: wrong size of column array");
+  parallelRanges(numRecords(), [&](size_type begin, size_type end) {
+    for(size_type i = begin; i < end; ++i)
+      {
+        if(j >= numFields(i))
+          throw std::runtime_error("MappedCSV: record " + std::to_string(i) +
+                                   " has no field " + std::to_string(j));
+        values[i] = convert<T>(field(i, j), i, j);
+      }
+  });
+}
+
+} // namespace Utility
+
+#endif
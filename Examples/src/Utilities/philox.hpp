@@ -0,0 +1,145 @@
+/*
+ * philox.hpp
+ *
+ *  A counter based random number generator
+ */
+
+#ifndef EXAMPLES_SRC_UTILITIES_PHILOX_HPP_
+#define EXAMPLES_SRC_UTILITIES_PHILOX_HPP_
+#include <array>
+#include <cstdint>
+#include <limits>
+namespace apsc
+{
+/*!
+ * @brief The Philox4x32-10 counter based random number generator
+ *
+ * Proposed in J.K. Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3", SC11. The random numbers are obtained by a bijection, parametrized by
+ * a key, of a counter: block() maps a counter of 4 32-bit words and a key of
+ * 2 words into 4 random 32-bit words. So the n-th number of a sequence is
+ * computed directly, without generating the previous ones, and different
+ * keys, or different ranges of counters, give independent streams. This is
+ * what we need for reproducible parallel computations: the random numbers
+ * used by a task depend only on the task, not on the thread running it.
+ *
+ * The class is also a uniform random bit generator, usable with the
+ * distributions of the standard library. The seed is the key, the stream
+ * the upper half of the counter, and the position in the stream (in groups
+ * of 4 numbers) the lower half.
+ *
+ * @code
+ * apsc::Philox4x32 engine(seed, threadId);
+ * std::normal_distribution<double> normal;
+ * double x = normal(engine);
+ * @endcode
+ */
+class Philox4x32
+{
+public:
+  using result_type = std::uint32_t;
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+  /*!
+   * @param seed The seed (the key)
+   * @param stream The stream
+   */
+  explicit constexpr Philox4x32(std::uint64_t seed = 0u,
+                                std::uint64_t stream = 0u) noexcept
+    : M_key{low(seed), high(seed)}, M_counter{0u, 0u, low(stream),
+                                              high(stream)}
+  {}
+  //! The 10 rounds of Philox4x32 on a counter
+  static constexpr Counter
+  block(Counter ctr, Key key) noexcept
+  {
+    for(int round = 0; round < 10; ++round)
+      {
+        std::uint64_t const p0 = std::uint64_t{M0} * ctr[0];
+        std::uint64_t const p1 = std::uint64_t{M1} * ctr[2];
+        ctr = {high(p1) ^ ctr[1] ^ key[0], low(p1), high(p0) ^ ctr[3] ^ key[1],
+               low(p0)};
+        key[0] += W0;
+        key[1] += W1;
+      }
+    return ctr;
+  }
+  /*!
+   * A double in [0,1) from two random words, with 53 random bits
+   */
+  static constexpr double
+  toUnit(std::uint32_t hi, std::uint32_t lo) noexcept
+  {
+    return static_cast<double>(((std::uint64_t{hi} << 32) | lo) >> 11) *
+           0x1.0p-53;
+  }
+  //! The next random number
+  constexpr result_type
+  operator()() noexcept
+  {
+    if(M_used == 4u)
+      {
+        M_output = block(M_counter, M_key);
+        if(++M_counter[0] == 0u)
+          ++M_counter[1];
+        M_used = 0u;
+      }
+    return M_output[M_used++];
+  }
+  //! Moves to the start of the n-th group of 4 numbers of the stream
+  constexpr void
+  seek(std::uint64_t n) noexcept
+  {
+    M_counter[0] = low(n);
+    M_counter[1] = high(n);
+    M_used = 4u;
+  }
+  //! Skips n numbers
+  constexpr void
+  discard(unsigned long long n) noexcept
+  {
+    for(; n > 0u && M_used < 4u; --n)
+      ++M_used;
+    if(n == 0u)
+      return;
+    std::uint64_t const position =
+      ((std::uint64_t{M_counter[1]} << 32) | M_counter[0]) + n / 4u;
+    seek(position);
+    for(n %= 4u; n > 0u; --n)
+      (*this)();
+  }
+  static constexpr result_type
+  min() noexcept
+  {
+    return 0u;
+  }
+  static constexpr result_type
+  max() noexcept
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+
+private:
+  static constexpr std::uint32_t
+  low(std::uint64_t x) noexcept
+  {
+    return static_cast<std::uint32_t>(x);
+  }
+  static constexpr std::uint32_t
+  high(std::uint64_t x) noexcept
+  {
+    return static_cast<std::uint32_t>(x >> 32);
+  }
+  // The constants of Philox4x32
+  static constexpr std::uint32_t M0 = 0xD2511F53u;
+  static constexpr std::uint32_t M1 = 0xCD9E8D57u;
+  static constexpr std::uint32_t W0 = 0x9E3779B9u;
+  static constexpr std::uint32_t W1 = 0xBB67AE85u;
+  Key                            M_key;
+  Counter                        M_counter;
+  Counter                        M_output{};
+  unsigned int                   M_used = 4u;
+};
+} // namespace apsc
+
+#endif /* EXAMPLES_SRC_UTILITIES_PHILOX_HPP_ */
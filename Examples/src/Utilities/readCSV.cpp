@@ -6,6 +6,8 @@
  *      Author: forma
  */
 #include "readCSV.hpp"
+#include "mappedCSV.hpp"
+#include <algorithm>
 namespace Utility
 {
 // Implementations
@@ -144,6 +146,51 @@ ReadCSV::read(std::basic_istream<CharT> &in)
   allRecords.shrink_to_fit();
 }
 
+void
+ReadCSV::readFile(std::string const &fileName, unsigned numThreads)
+{
+  MappedCSV::Options options;
+  options.separator = sep;
+  options.skippedLines = skip;
+  options.stripQuotation = stripApexes;
+  options.numThreads = numThreads;
+  MappedCSV csv(fileName, options);
+
+  allRecords.reserve(allRecords.size() +
+                     std::max<std::size_t>(minRecords, csv.numRecords()));
+  std::size_t maxtokens = 0u;
+  std::size_t mintokens = csv.numRecords() > 0u ? 999999u : 0u;
+  for(std::size_t i = 0u; i < csv.numRecords(); ++i)
+    {
+      auto const fields = csv.record(i);
+      Record     tokens;
+      tokens.reserve(std::max<std::size_t>(fields.size(), minTokens));
+      tokens.assign(fields.begin(), fields.end());
+      maxtokens = std::max(maxtokens, tokens.size());
+      mintokens = std::min(mintokens, tokens.size());
+      // autocomplete as read() does
+      while(tokens.size() < minTokens)
+        tokens.emplace_back(1u, sep);
+      allRecords.push_back(std::move(tokens));
+    }
+  if(verbose)
+    {
+      std::clog << " Read " << csv.fileSize() << " bytes from " << fileName
+                << ", " << csv.numEmptyLines() << " empty lines ignored"
+                << std::endl;
+      std::clog << " Max/Min number of tokens " << maxtokens << "/" << mintokens
+                << std::endl;
+      std::clog << " Read " << csv.numRecords() << " valid records"
+                << std::endl;
+      if(!allRecords.empty())
+        {
+          std::clog << " Last meaningful line read:\n";
+          this->writeRecord(std::clog, allRecords.back());
+          std::clog << "\n";
+        }
+    }
+}
+
 void
 ReadCSV::writeRecord(std::basic_ostream<CharT> &out, const Record &tokens) const
 {
@@ -98,6 +98,20 @@ public:
    * @param in The input stream
    */
   void read(std::basic_istream<CharT> &in);
+  /*!
+   * Get all tokens from a file
+   *
+   * The file is mapped in memory and parsed in parallel by a MappedCSV,
+   * which is much faster than read() for large files. Tokens are those
+   * given by read(), except that a text token cannot span more lines and
+   * keeps the separators it contains, and that a separator at the end of a
+   * line is followed by an empty token.
+   *
+   * @param fileName The file name
+   * @param numThreads The number of threads (0 means all hardware threads)
+   * @throw std::runtime_error if the file cannot be read
+   */
+  void readFile(std::string const &fileName, unsigned numThreads = 0u);
   //! Writes all the tokens on a file
   void writeAllRecords(std::basic_ostream<CharT> &) const;
 
@@ -0,0 +1,126 @@
+/*
+ * test_csvBenchmark.cpp
+ *
+ *  Compares the reading speed of ReadCSV::read(), ReadCSV::readFile() and
+ *  MappedCSV on a large csv file
+ */
+#include "chrono.hpp"
+#include "mappedCSV.hpp"
+#include "readCSV.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+/*
+ * A file with n records of the form
+ *   id, value, name, "text, with separators"
+ * is written in the temporary directory and read in various ways. The
+ * speed is given in MB/s; the values read are checked against those
+ * written.
+ *
+ * Usage: test_csvBenchmark [n] (number of records, 10^6 by default)
+ */
+namespace
+{
+using Timings::timeIt; // time in milliseconds
+
+void
+report(std::string const &what, double ms, std::size_t bytes)
+{
+  std::cout << std::left << std::setw(36) << what << std::right
+            << std::setw(12) << ms << std::setw(12)
+            << bytes / 1048576. / (ms * 1.e-3) << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  using namespace Utility;
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 1000000u;
+  auto const        fileName =
+    (std::filesystem::temp_directory_path() / "test_csvBenchmark.csv")
+      .string();
+
+  // The data
+  std::mt19937                           urbg{2021};
+  std::uniform_real_distribution<double> uniform(-1.e3, 1.e3);
+  std::vector<int>                       ids(n);
+  std::vector<double>                    values(n);
+  std::vector<std::string>               names(n);
+  {
+    std::ofstream out(fileName);
+    out << "id, value, name, comment\n";
+    out << std::setprecision(17);
+    for(std::size_t i = 0u; i < n; ++i)
+      {
+        ids[i] = static_cast<int>(i) - 1000;
+        values[i] = uniform(urbg);
+        names[i] = "name" + std::to_string(urbg() % 10000u);
+        out << ids[i] << ", " << values[i] << ", " << names[i]
+            << ", \"text number " << i << ", with a comma\"\n";
+      }
+  }
+  std::size_t const bytes = std::filesystem::file_size(fileName);
+  unsigned const    numThreads =
+    std::max(std::thread::hardware_concurrency(), 1u);
+  std::cout << "File of " << n << " records, " << bytes / 1048576.
+            << " MB, hardware threads " << numThreads << "\n";
+  std::cout << std::left << std::setw(36) << "Reader" << std::right
+            << std::setw(12) << "time (ms)" << std::setw(12) << "MB/s"
+            << '\n';
+
+  // The original reader
+  ReadCSV reader;
+  reader.setSkippedLines(1u);
+  reader.setMinRecords(n);
+  double t = timeIt([&] {
+    std::ifstream in(fileName);
+    reader.read(in);
+  });
+  report("ReadCSV::read()", t, bytes);
+  auto const streamed = reader.getTokens();
+  bool       ok = streamed.size() == n;
+
+  reader.clear();
+  t = timeIt([&] { reader.readFile(fileName); });
+  report("ReadCSV::readFile()", t, bytes);
+  auto const mapped = reader.getTokens();
+  ok = ok && mapped.size() == n;
+  // Text tokens differ: read() drops the separators they contain
+  for(std::size_t i = 0u; ok && i < n; ++i)
+    ok = mapped[i].size() == 4u && mapped[i][0] == streamed[i][0] &&
+         mapped[i][1] == streamed[i][1] && mapped[i][2] == streamed[i][2];
+
+  // The mapped file alone, at least up to 4 threads to check the splitting
+  MappedCSV::Options options;
+  options.skippedLines = 1u;
+  for(unsigned threads = 1u; threads <= std::max(numThreads, 4u); threads *= 2u)
+    {
+      options.numThreads = threads;
+      MappedCSV csv;
+      t = timeIt([&] { csv = MappedCSV(fileName, options); });
+      report("MappedCSV, threads " + std::to_string(threads), t, bytes);
+      std::vector<int>              col0;
+      std::vector<double>           col1;
+      std::vector<std::string_view> col2;
+      t = timeIt([&] {
+        col0 = csv.column<int>(0u);
+        col1 = csv.column<double>(1u);
+        col2 = csv.column<std::string_view>(2u);
+      });
+      report("  + three typed columns", t, bytes);
+      ok = ok && csv.numRecords() == n && col0 == ids && col1 == values;
+      for(std::size_t i = 0u; ok && i < n; ++i)
+        ok = col2[i] == names[i];
+    }
+  std::filesystem::remove(fileName);
+  std::cout << "Values read " << (ok ? "agree" : "DO NOT agree")
+            << " with those written\n";
+  return ok ? 0 : 1;
+}
@@ -5,6 +5,7 @@
  *      Author: forma
  */
 
+#include "mappedCSV.hpp"
 #include "readCSV.hpp"
 #include <fstream>
 #include <iostream>
@@ -29,4 +30,23 @@ main()
   reader.read(db);
   // Write!
   reader.writeAllRecords(std::cout);
+  auto const records = reader.getTokens();
+
+  // The same with the file mapped in memory and parsed in parallel
+  reader.clear();
+  reader.setVerbose(false);
+  reader.readFile("test.csv");
+  std::cout << "readFile() gives "
+            << (reader.getTokens() == records ? "the same" : "DIFFERENT")
+            << " records\n";
+
+  // Typed columns without copies of the file content
+  MappedCSV::Options options;
+  options.skippedLines = 1u;
+  options.stripQuotation = true;
+  MappedCSV csv("test.csv", options);
+  std::cout << "Professions:";
+  for(auto profession : csv.column<std::string_view>(2u))
+    std::cout << " " << profession;
+  std::cout << std::endl;
 }
@@ -0,0 +1,65 @@
+/*
+ * test_philox.cpp
+ *
+ *  Tests the Philox4x32 generator against the known answers of the authors
+ *  (Random123, kat_vectors) and checks that seek() and discard() move in
+ *  the stream as expected.
+ */
+#include "philox.hpp"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+int
+main()
+{
+  using apsc::Philox4x32;
+  struct Kat
+  {
+    Philox4x32::Counter ctr;
+    Philox4x32::Key     key;
+    Philox4x32::Counter expected;
+  };
+  Kat const kats[] = {
+    {{0u, 0u, 0u, 0u},
+     {0u, 0u},
+     {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}},
+    {{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+     {0xffffffffu, 0xffffffffu},
+     {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}},
+    {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+     {0xa4093822u, 0x299f31d0u},
+     {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}}};
+  bool ok = true;
+  for(auto const &kat : kats)
+    {
+      auto const result = Philox4x32::block(kat.ctr, kat.key);
+      ok = ok && result == kat.expected;
+      std::cout << std::hex;
+      for(auto w : result)
+        std::cout << std::setw(9) << w;
+      std::cout << std::dec << (result == kat.expected ? "  OK" : "  WRONG")
+                << '\n';
+    }
+  // The stream of the engine is the sequence of blocks
+  Philox4x32 engine(123u, 7u);
+  Philox4x32 other(123u, 7u);
+  for(int i = 0; i < 10; ++i)
+    engine();
+  other.discard(10u);
+  ok = ok && engine() == other();
+  other.seek(3u);
+  engine.seek(0u);
+  engine.discard(12u);
+  ok = ok && engine() == other();
+  // Different streams are different
+  ok = ok && Philox4x32(123u, 7u)() != Philox4x32(123u, 8u)();
+  // It works with the distributions of the standard library
+  std::uniform_real_distribution<double> uniform;
+  double                                 sum = 0.;
+  for(int i = 0; i < 100000; ++i)
+    sum += uniform(engine);
+  std::cout << "Mean of 100000 uniform numbers: " << sum / 100000 << '\n';
+  std::cout << (ok ? "All tests passed" : "Some test FAILED") << '\n';
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+/*
+ * AdtBatchSearch.hpp
+ *
+ *  Batched and multithreaded intersection searches on an adt tree
+ */
+
+#ifndef ADTTREE_ADTBATCHSEARCH_HPP_
+#define ADTTREE_ADTBATCHSEARCH_HPP_
+#include "AdtBox.hpp"
+#include "AdtVisitors.hpp"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+namespace apsc
+{
+namespace adt
+{
+  /*!
+   * @brief The result of a batch of searches
+   *
+   * Stored in compressed sparse row (CSR) format: the indexes of the nodes
+   * found by query q are hits[offsets[q]],...,hits[offsets[q+1]-1], in the
+   * same order returned by a single search with IntersectionVisitor.
+   */
+  struct BatchResult
+  {
+    //! Position in hits of the first result of each query (size numQueries+1)
+    std::vector<std::size_t> offsets{0u};
+    //! Indexes of the nodes found, query after query
+    std::vector<std::size_t> hits;
+    //! The number of queries
+    std::size_t
+    numQueries() const noexcept
+    {
+      return offsets.size() - 1u;
+    }
+    //! The total number of hits
+    std::size_t
+    numHits() const noexcept
+    {
+      return hits.size();
+    }
+    //! The nodes found by query q
+    std::span<std::size_t const>
+    operator[](std::size_t q) const noexcept
+    {
+      return {hits.data() + offsets[q], offsets[q + 1] - offsets[q]};
+    }
+  };
+
+  //! Options for batchIntersect()
+  struct BatchOptions
+  {
+    //! Number of threads (0 means all hardware threads)
+    unsigned numThreads = 0u;
+    //! Whether queries are processed in Morton order
+    bool sortQueries = true;
+    //! Number of consecutive queries given to a thread at a time
+    std::size_t blockSize = 256u;
+  };
+
+  /*!
+   * @brief Orders boxes along the Morton curve of their centers
+   *
+   * Boxes close in space are likely to be close in the returned order, so
+   * consecutive searches visit the same part of the tree.
+   *
+   * @param boxes Normalised boxes
+   * @return The permutation that sorts the boxes
+   */
+  template <std::size_t DIM, AdtType Type>
+  std::vector<std::size_t>
+  mortonOrder(std::span<Box<DIM, Type> const> boxes)
+  {
+    std::vector<std::pair<std::uint64_t, std::size_t>> keys(boxes.size());
+    for(std::size_t i = 0u; i < boxes.size(); ++i)
+      {
+        Point<DIM> center;
+        for(std::size_t d = 0u; d < DIM; ++d)
+          center[d] = 0.5 * (boxes[i].corner(0)[d] + boxes[i].corner(1)[d]);
+        keys[i] = {mortonKey(center), i};
+      }
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::size_t> order(boxes.size());
+    for(std::size_t i = 0u; i < keys.size(); ++i)
+      order[i] = keys[i].second;
+    return order;
+  }
+
+  namespace internals
+  {
+    //! Runs work(t), t=0,...,numThreads-1, on numThreads threads
+    template <class Work>
+    void
+    runThreads(unsigned numThreads, Work const &work)
+    {
+      std::vector<std::thread> threads;
+      for(unsigned t = 1u; t < numThreads; ++t)
+        threads.emplace_back(work, t);
+      work(0u);
+      for(auto &th : threads)
+        th.join();
+    }
+  } // namespace internals
+
+  /*!
+   * @brief Searches the nodes intersecting each of a set of boxes
+   *
+   * The result for query q is the same returned by
+   * @code
+   * tree.visit(IntersectionVisitor{queries[q]}).intersectingIndexes()
+   * @endcode
+   * but queries are processed in Morton order (so that consecutive
+   * searches traverse the same branches of the tree, which are likely to be
+   * in cache) and distributed among threads in blocks of consecutive
+   * queries. Each thread reuses its visitor and traversal stack, and stores
+   * the hits in a local buffer. The buffers are then copied into the CSR
+   * structure, in the order of the queries.
+   *
+   * @tparam Tree A tree providing visit(Visitor &, VisitStack &) const
+   * @param tree The tree
+   * @param queries The query boxes, normalised with the tree Normaliser
+   * @param options Number of threads, sorting and block size
+   * @return The hits in CSR format
+   */
+  template <class Tree, std::size_t DIM, AdtType Type>
+  BatchResult
+  batchIntersect(Tree const &tree, std::span<Box<DIM, Type> const> queries,
+                 BatchOptions const &options = BatchOptions{})
+  {
+    std::size_t const nq = queries.size();
+    BatchResult       result;
+    result.offsets.assign(nq + 1u, 0u);
+    if(nq == 0u)
+      return result;
+    std::vector<std::size_t> order;
+    if(options.sortQueries)
+      order = mortonOrder(queries);
+    else
+      {
+        order.resize(nq);
+        std::iota(order.begin(), order.end(), 0u);
+      }
+    std::size_t const blockSize = std::max<std::size_t>(options.blockSize, 1u);
+    std::size_t const numBlocks = (nq + blockSize - 1u) / blockSize;
+    unsigned          numThreads = options.numThreads > 0u
+                                   ? options.numThreads
+                                   : std::thread::hardware_concurrency();
+    numThreads = static_cast<unsigned>(
+      std::clamp<std::size_t>(numThreads, 1u, numBlocks));
+
+    // Hits found by each thread, and for each query (in sorted order) the
+    // position of its hits in the buffer of the thread that processed it
+    std::vector<std::vector<std::size_t>> buffers(numThreads);
+    std::vector<unsigned>                 blockOwner(numBlocks);
+    std::vector<std::size_t>              start(nq);
+    std::atomic<std::size_t>              nextBlock{0u};
+    internals::runThreads(numThreads, [&](unsigned t) {
+      IntersectionVisitor<DIM, Type> visitor;
+      typename Tree::VisitStack      stack;
+      auto                          &buffer = buffers[t];
+      for(std::size_t b = nextBlock++; b < numBlocks; b = nextBlock++)
+        {
+          blockOwner[b] = t;
+          for(std::size_t p = b * blockSize;
+              p < std::min(nq, (b + 1u) * blockSize); ++p)
+            {
+              auto const q = order[p];
+              visitor.setIntersector(queries[q]);
+              tree.visit(visitor, stack);
+              auto const &found = visitor.intersectingIndexes();
+              start[p] = buffer.size();
+              result.offsets[q + 1u] = found.size();
+              buffer.insert(buffer.end(), found.begin(), found.end());
+            }
+        }
+    });
+    // Counts to offsets
+    std::partial_sum(result.offsets.begin(), result.offsets.end(),
+                     result.offsets.begin());
+    // Copy the buffers into the final structure
+    result.hits.resize(result.offsets.back());
+    nextBlock = 0u;
+    internals::runThreads(numThreads, [&](unsigned) {
+      for(std::size_t b = nextBlock++; b < numBlocks; b = nextBlock++)
+        {
+          auto const &buffer = buffers[blockOwner[b]];
+          for(std::size_t p = b * blockSize;
+              p < std::min(nq, (b + 1u) * blockSize); ++p)
+            {
+              auto const q = order[p];
+              std::copy_n(buffer.begin() + start[p],
+                          result.offsets[q + 1u] - result.offsets[q],
+                          result.hits.begin() + result.offsets[q]);
+            }
+        }
+    });
+    return result;
+  }
+
+  //! Version taking a vector of boxes
+  template <class Tree, std::size_t DIM, AdtType Type>
+  BatchResult
+  batchIntersect(Tree const &tree, std::vector<Box<DIM, Type>> const &queries,
+                 BatchOptions const &options = BatchOptions{})
+  {
+    return batchIntersect(tree, std::span<Box<DIM, Type> const>(queries),
+                          options);
+  }
+} // namespace adt
+} // namespace apsc
+
+#endif /* ADTTREE_ADTBATCHSEARCH_HPP_ */
@@ -7,7 +7,9 @@
 
 #ifndef ADTTREE_ADTBOX_HPP_
 #define ADTTREE_ADTBOX_HPP_
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -421,6 +423,43 @@ namespace adt
     Point<DIM>              origin;
   };
 
+  /*!
+   * @brief The key of a point along the Morton (Z-order) space filling curve
+   *
+   * Coordinates are assumed normalised in [0,1] (values outside are
+   * clamped) and are quantized with 63/DIM bits (at most 32), whose bits
+   * are then interleaved, starting from the most significant ones.
+   *
+   * The quantization is exact: the bit of coordinate i at position k (the
+   * most significant bit having position 0) tells whether the coordinate is
+   * on the left or on the right of the split tested by an adt tree at level
+   * k*DIM+i. Sorting points (or boxes seen as points with size()
+   * coordinates) by key orders them as a visit of the tree would, at
+   * least for the first 63/DIM * DIM levels.
+   *
+   * @tparam DIM The dimension
+   * @param p The point
+   * @return The key
+   */
+  template <std::size_t DIM>
+  std::uint64_t
+  mortonKey(Point<DIM> const &p) noexcept
+  {
+    constexpr unsigned      bits = std::min<std::size_t>(63u / DIM, 32u);
+    constexpr std::uint64_t maxCoord = (std::uint64_t{1} << bits) - 1u;
+    constexpr double scale = static_cast<double>(std::uint64_t{1} << bits);
+    std::array<std::uint64_t, DIM> c;
+    for(std::size_t d = 0u; d < DIM; ++d)
+      c[d] = std::min(
+        static_cast<std::uint64_t>(std::clamp(p[d], 0., 1.) * scale),
+        maxCoord);
+    std::uint64_t key = 0u;
+    for(unsigned bit = bits; bit-- > 0u;)
+      for(std::size_t d = 0u; d < DIM; ++d)
+        key = (key << 1) | ((c[d] >> bit) & 1u);
+    return key;
+  }
+
   template <std::size_t DIM, AdtType Type>
   std::ostream &
   operator<<(std::ostream &out, Box<DIM, Type> const &box)
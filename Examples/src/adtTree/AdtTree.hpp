@@ -7,8 +7,8 @@
 #include "AdtBox.hpp"
 #include "IndexList.hpp"
 #include <algorithm>
-#include <stack>
 #include <tuple>
+#include <vector>
 #ifndef ADTTREE_ADTTREE_HPP_
 #define ADTTREE_ADTTREE_HPP_
 namespace apsc
@@ -271,6 +271,85 @@ namespace adt
     static constexpr std::size_t DIM = BOX::dim();
   };
 
+  /*!
+   * The information stored during a visit for each pending right branch:
+   * the node, its level and the NodeControl at the node
+   */
+  template <std::size_t BOXDIMS>
+  using LevelInfo = std::tuple<std::size_t, std::size_t, NodeControl<BOXDIMS>>;
+
+  /*!
+   * @brief Preorder traversal of a tree driven by a visitor
+   *
+   * The implementation of AdtTree::visit(), shared by the trees with nodes
+   * stored in an indexable container, which have links l and r to the left
+   * and right child, 0 meaning no child.
+   *
+   * @tparam BOXDIMS The size of the box stored in the nodes
+   * @param nodes The container of nodes
+   * @param root The index of the root (0 if the tree is empty)
+   * @param visitor The visitor
+   * @param levelStack A stack for the pending right branches
+   */
+  template <std::size_t BOXDIMS, class Nodes, class Visitor>
+  void
+  visitTree(Nodes const &nodes, std::size_t root, Visitor &visitor,
+            std::vector<LevelInfo<BOXDIMS>> &levelStack)
+  {
+    levelStack.clear();
+    // We start at root
+    auto start = root;
+    // Check if tree is empty!
+    if(start == 0u)
+      return;
+    std::size_t          level = 0u; // root level
+    NodeControl<BOXDIMS> control;
+    // @todo a bit cumbersome probably I can replace with a do-while
+    // Iterate until stack
+    while(start != 0 || (!levelStack.empty()))
+      {
+        // Visit current node
+        auto const &thisNode = nodes[start];
+        Action      status = visitor(thisNode, control, level);
+        std::size_t newStart = 0u;
+        // Set move according to status
+        if((status & GoRight) == GoRight)
+          {
+            // Keep track for later move to right
+            levelStack.emplace_back(start, level, control);
+          }
+        if((status & GoLeft) == GoLeft)
+          {
+            // Move to left brach
+            newStart = thisNode.l;
+            control.advance(level % BOXDIMS, Left);
+          }
+        else
+          {
+            // Stop here
+            newStart = 0u;
+          }
+        start = newStart; // Adjourn node
+        ++level;          // I have moved one level down
+        if(start == 0u)
+          {
+            // I have traversed the left branches, now I have to go right!
+            while(start == 0u && (!levelStack.empty()))
+            {
+              // Find the first not empty right branch
+              // Get back stored node info
+              std::tie(start, level, control) = levelStack.back();
+              levelStack.pop_back();
+              // Move right, the test is on the coordinate of the parent level
+              start = nodes[start].r;
+              if(start != 0u)
+                control.advance(level % BOXDIMS, Right);
+              ++level; // I am on the next level
+            }
+          }
+      }
+  }
+
   template <typename NODE> class AdtTree
   {
   public:
@@ -321,7 +400,25 @@ namespace adt
      * @param visitor A visitor object
      * @return A copy of the internal representation of the visitor object visitor
      */
-    template <class Visitor> Visitor visit(Visitor visitor);
+    template <class Visitor> Visitor visit(Visitor visitor) const;
+    //! The stack used by visit() to store the pending right branches
+    using VisitStack = std::vector<LevelInfo<NODE::BOXDIMS>>;
+    /*!
+     * @brief Visit the adtTree using a given stack
+     *
+     * Same as visit(Visitor), but the visitor is taken by reference and the
+     * stack is provided by the caller, so that it can be reused by many
+     * visits (for instance one per query in a batch search) avoiding a
+     * memory allocation at each visit. The tree is not modified, so
+     * several threads may visit the same tree concurrently, each one with
+     * its own visitor and stack.
+     *
+     * @tparam Visitor A class that implementss a Visitor concept
+     * @param visitor A visitor object
+     * @param stack A stack. It is cleared before the visit
+     */
+    template <class Visitor>
+    void visit(Visitor &visitor, VisitStack &stack) const;
     /*!
      * @brief The total number of nodes
      *
@@ -333,6 +430,19 @@ namespace adt
       return num_elements;
     }
 
+    /*!
+     * @brief The maximum level reached by the nodes
+     *
+     * @note It is not updated by erase(), so it is an upper bound if nodes
+     * have been erased
+     * @return The maximum level (the root has level 0)
+     */
+    auto
+    maxLevel() const noexcept
+    {
+      return max_level;
+    }
+
     /*!
      * @brief A tree node
      *
@@ -507,71 +617,21 @@ namespace adt
   template <class NODE>
   template <class Visitor>
   Visitor
-  AdtTree<NODE>::visit(Visitor visitor)
+  AdtTree<NODE>::visit(Visitor visitor) const
   {
-    // a tuple storing all info about a tree node level
-    using levelInfo =
-      std::tuple<std::size_t, std::size_t, NodeControl<NODE::BOXDIMS>>;
-    std::stack<levelInfo> levelStack;
-    // We start at root
-    auto start = root;
-    // Check if tree is empty!
-    if(start == 0u || num_elements == 0u)
-      return visitor;
-    auto                       level = 0u; // root level
-    NodeControl<NODE::BOXDIMS> control;
-    // @todo a bit cumbersome probably I can replace with a do-while
-    // Iterate until stack
-    while(start != 0 || (!levelStack.empty()))
-      {
-        //std::cout << "start=" << start << std::endl;
-        // Visit current node
-        auto const &thisNode = data_[start];
-        Action      status = visitor(thisNode, control, level);
-        std::size_t newStart = 0u;
-        // Set move according to status
-        if((status & GoRight) == GoRight)
-          {
-            // Keep track for later move to right
-            levelStack.push({start, level, control});
-          }
-        if((status & GoLeft) == GoLeft)
-          {
-            // Move to left brach
-            newStart = thisNode.l;
-            //std::cout << "NewStart=" << newStart << std::endl;
-            control.advance(level % NODE::BOXDIMS, Left);
-          }
-        else
-          {
-            // Stop here
-            newStart = 0u;
-          }
-        start = newStart; // Adjourn node
-        ++level;          // I have moved one level down
-        if(start == 0u)
-          {
-            // I have traversed the left branches, now I have to go right!
-            while(start == 0u && (!levelStack.empty()))
-            {
-              // Find the first not empty right branch
-              // Get back stored node info
-              std::tie(start, level, control) = levelStack.top();
-              levelStack.pop();
-              // Move right
-              start = data_[start].r;
-              ++level; // I am on the next level
-            }
-            if(start != 0u)// found a noon-leaf
-              {
-                // Adjust control since I have moved to the right
-                control.advance(level, Right);
-              }
-          }
-      }
+    VisitStack levelStack;
+    this->visit(visitor, levelStack);
     return visitor;
   }
 
+  template <class NODE>
+  template <class Visitor>
+  void
+  AdtTree<NODE>::visit(Visitor &visitor, VisitStack &levelStack) const
+  {
+    visitTree<NODE::BOXDIMS>(data_, num_elements == 0u ? 0u : root, visitor,
+                             levelStack);
+  }
 
 } // end namespace adt
 } // end namespace apsc
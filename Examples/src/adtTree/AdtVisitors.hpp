@@ -10,6 +10,8 @@
 #include "AdtTree.hpp"
 #include "AdtBox.hpp"
 #include <iostream>
+#include <utility>
+#include <vector>
 namespace apsc
 {
   namespace adt
@@ -168,12 +170,14 @@ namespace apsc
           if(intersect) intersectingNodes.emplace_back(node.Id());
         }
       // Now we need to decide where to go!
+      // Nodes on the left have the coordinate tested at this level smaller
+      // than x, those on the right greater or equal to x
       double x = control.center(level);
-      if constexpr (node.type()==AdtType::Point)
+      if constexpr (ADTNODE::type()==AdtType::Point)
     {
-          if(intersectExtension[1] <= x)
+          if(intersectExtension[1] < x)
             return Action::GoLeft;
-          else if(intersectExtension[0] > x)
+          else if(intersectExtension[0] >= x)
             return Action::GoRight;
           else
             return Action::GoAll;
@@ -182,10 +186,12 @@ namespace apsc
         {
           // adtTree is a box. Things are slightly more complex
           // The index of the corner we are using at this level
+          // If it is the lower left one, nodes on the right start after x,
+          // if it is the upper right one nodes on the left end before x
           const BoxLocation whichCorner=node.location(level);
-          if(whichCorner==BoxLocation::LowerLeft and intersectExtension[1] <= x)
+          if(whichCorner==BoxLocation::LowerLeft and intersectExtension[1] < x)
             return Action::GoLeft;
-          else if(intersectExtension[0] > x)
+          else if(whichCorner==BoxLocation::UpperRight and intersectExtension[0] >= x)
             return Action::GoRight;
           else
             return Action::GoAll;
@@ -196,7 +202,9 @@ namespace apsc
      *
      * @return A vector of indexes.
      */
-    auto intersectingIndexes()const {return intersectingNodes;}
+    auto const & intersectingIndexes()const & {return intersectingNodes;}
+    //! Version for a temporary visitor (e.g. the one returned by visit())
+    auto intersectingIndexes()&& {return std::move(intersectingNodes);}
   private:
     Box<DIM,BOXTYPE> intersector_;
     std::vector<std::size_t> intersectingNodes;
@@ -0,0 +1,382 @@
+/*
+ * LinearAdtTree.hpp
+ *
+ *  An adt tree built in one go and stored in a contiguous array
+ */
+
+#ifndef ADTTREE_LINEARADTTREE_HPP_
+#define ADTTREE_LINEARADTTREE_HPP_
+#include "AdtBox.hpp"
+#include "AdtTree.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+namespace apsc
+{
+namespace adt
+{
+  //! The possible orderings of the nodes in the array of a LinearAdtTree
+  enum class TreeLayout
+  {
+    BreadthFirst, //!< Level by level
+    VanEmdeBoas   //!< Recursive blocking of subtrees (cache oblivious)
+  };
+
+  /*!
+   * @brief The node of a LinearAdtTree
+   *
+   * Same interface of AdtNode, but links and identifier are 32 bit
+   * integers, so a node storing a 2D box takes 48 bytes instead of 64.
+   *
+   * @tparam BOX The Box type
+   * @tparam Args Possible other classes that enrich the node interface
+   */
+  template <typename BOX, typename... Args>
+  struct LinearAdtNode : public BOX, public Args...
+  {
+    using BOX::BOX;
+    LinearAdtNode() = default;
+    /*!
+     * @brief A Constructor that takes a Box and elements of each additional
+     * component
+     *
+     * @param box The box
+     * @param ext The additional objects
+     */
+    template <typename... T>
+    LinearAdtNode(BOX const &box, T &&...ext)
+      : BOX{box}, Args(std::forward<T>(ext))...{};
+    /*!
+     * @brief Copies the box and the additional components of a node
+     *
+     * @param node An AdtNode<BOX, Args...> (or any object derived from BOX
+     * and Args...)
+     * @return The node, with no links
+     */
+    template <typename N>
+    static LinearAdtNode
+    fromNode(N const &node)
+    {
+      return LinearAdtNode(static_cast<BOX const &>(node),
+                           static_cast<Args const &>(node)...);
+    }
+    //! The box type
+    using BoxType = BOX;
+    //! Next node on the left or the right
+    std::size_t
+    next(Direction d) const
+    {
+      return d == Left ? l : r;
+    }
+    //! The identifier of the node
+    std::size_t
+    Id() const
+    {
+      return id;
+    }
+    //! Is this node a leaf?
+    bool
+    leaf() const
+    {
+      return l == 0u and r == 0u;
+    }
+    std::uint32_t l{0u};  //!< the left node
+    std::uint32_t r{0u};  //!< the right node
+    std::uint32_t up{0u}; //!< the parent node
+    std::uint32_t id{0u}; //!< the node id
+    //! I get the size of the Box
+    static constexpr std::size_t BOXDIMS = BOX::size();
+    //! I get the dimension of the space of box vertices
+    static constexpr std::size_t DIM = BOX::dim();
+  };
+
+  //! The LinearAdtNode corresponding to an AdtNode
+  template <typename NODE> struct LinearNodeOf;
+
+  template <typename BOX, typename... Args>
+  struct LinearNodeOf<AdtNode<BOX, Args...>>
+  {
+    using type = LinearAdtNode<BOX, Args...>;
+  };
+
+  /*!
+   * @brief An adt tree built from all its nodes at once
+   *
+   * The tree is built by sorting the nodes along the Morton curve of their
+   * box coordinates, which is the order of the adt splits: the nodes in a
+   * subtree form a contiguous range of the sorted nodes, and the nodes
+   * that go to the left and to the right at a given level are separated
+   * with a binary search. One node of each range is chosen to be the root
+   * of the corresponding subtree, taking it from the largest half, to keep
+   * the tree balanced as much as the data allows.
+   *
+   * Nodes are then stored in a contiguous array, in breadth first or van
+   * Emde Boas order, with 32 bit links. In the latter layout a subtree of
+   * height h is split into a top tree of height h/2 followed by the bottom
+   * trees, recursively, so that a path from the root to a leaf touches few
+   * cache lines whatever the size of the cache.
+   *
+   * The tree cannot be modified, but it is visited with the same visitors
+   * of AdtTree, with the same semantic. The identifier Id() of a node is
+   * its position in the input range plus one: the id it would have if the
+   * nodes were added one after the other to an empty AdtTree.
+   *
+   * @tparam NODE The type of the nodes of the corresponding AdtTree
+   */
+  template <typename NODE> class LinearAdtTree
+  {
+  public:
+    using NodeType = typename LinearNodeOf<NODE>::type;
+    using BoxType = typename NodeType::BoxType;
+    static constexpr auto BOXDIMS = BoxType::size();
+    static constexpr auto DIM = BoxType::dim();
+    //! The stack used by visit() to store the pending right branches
+    using VisitStack = std::vector<LevelInfo<BOXDIMS>>;
+
+    LinearAdtTree() = default;
+    /*!
+     * @brief Builds the tree
+     *
+     * @tparam Range A random access range of NODE (or of objects
+     * derived from the box and the additional components of NODE)
+     * @param nodes The nodes, with coordinates normalised in [0,1]
+     * @param layout The order of the nodes in memory
+     * @throws std::invalid_argument if there are too many nodes for 32 bit
+     * indexes
+     */
+    template <std::ranges::random_access_range Range>
+    explicit LinearAdtTree(Range const     &nodes,
+                           TreeLayout const layout = TreeLayout::VanEmdeBoas)
+    {
+      build(nodes, layout);
+    }
+    //! Builds the tree, replacing the current content
+    template <std::ranges::random_access_range Range>
+    void build(Range const &nodes,
+               TreeLayout   layout = TreeLayout::VanEmdeBoas);
+
+    //! Visit the tree (see AdtTree::visit())
+    template <class Visitor>
+    Visitor
+    visit(Visitor visitor) const
+    {
+      VisitStack levelStack;
+      this->visit(visitor, levelStack);
+      return visitor;
+    }
+    //! Visit the tree reusing a stack (see AdtTree::visit())
+    template <class Visitor>
+    void
+    visit(Visitor &visitor, VisitStack &stack) const
+    {
+      visitTree<BOXDIMS>(nodes_, numNodes() == 0u ? 0u : 1u, visitor, stack);
+    }
+    //! The total number of nodes
+    std::size_t
+    numNodes() const noexcept
+    {
+      return nodes_.empty() ? 0u : nodes_.size() - 1u;
+    }
+    //! The number of levels of the tree
+    std::size_t
+    height() const noexcept
+    {
+      return height_;
+    }
+    //! The layout of the nodes
+    TreeLayout
+    layout() const noexcept
+    {
+      return layout_;
+    }
+    //! The memory used by the nodes, in bytes
+    std::size_t
+    memoryUsage() const noexcept
+    {
+      return nodes_.capacity() * sizeof(NodeType);
+    }
+    /*!
+     * @brief The node at a given position in the array
+     *
+     * @param index The position, from 1 to numNodes(). The root is at 1.
+     * @return The node
+     */
+    NodeType const &
+    operator[](std::size_t index) const noexcept
+    {
+      return nodes_[index];
+    }
+
+  private:
+    //! The layout of the subtree rooted at root, for levels less than h
+    void vanEmdeBoas(std::vector<NodeType> const &tree, std::uint32_t root,
+                     std::size_t h, std::vector<std::uint32_t> &order,
+                     std::vector<std::uint32_t> &frontier) const;
+    //! The nodes. Position 0 is unused, 0 meaning no node in the links
+    std::vector<NodeType> nodes_;
+    std::size_t           height_ = 0u;
+    TreeLayout            layout_ = TreeLayout::VanEmdeBoas;
+  };
+
+  template <typename NODE>
+  template <std::ranges::random_access_range Range>
+  void
+  LinearAdtTree<NODE>::build(Range const &nodes, TreeLayout layout)
+  {
+    std::size_t const n = std::ranges::size(nodes);
+    if(n >= std::numeric_limits<std::uint32_t>::max())
+      throw std::invalid_argument("Too many nodes for a LinearAdtTree");
+    nodes_.clear();
+    height_ = 0u;
+    layout_ = layout;
+    if(n == 0u)
+      return;
+    // Sort the nodes along the Morton curve of the box coordinates
+    auto const input = std::ranges::begin(nodes);
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(n);
+    for(std::size_t i = 0u; i < n; ++i)
+      {
+        BoxType const &box = input[i];
+        Point<BOXDIMS> p;
+        for(std::size_t k = 0u; k < BOXDIMS; ++k)
+          p[k] = box[k];
+        keys[i] = {mortonKey(p), static_cast<std::uint32_t>(i)};
+      }
+    std::sort(keys.begin(), keys.end());
+    // Levels that are resolved by the key
+    constexpr std::size_t keyLevels =
+      std::min<std::size_t>(63u / BOXDIMS, 32u) * BOXDIMS;
+
+    // Build the tree in preorder. Each task is a range of sorted nodes
+    // to be put in the subtree of a given parent
+    struct Task
+    {
+      std::size_t          begin;
+      std::size_t          end;
+      std::uint32_t        parent;
+      Direction            side;
+      std::size_t          level;
+      NodeControl<BOXDIMS> control;
+    };
+    std::vector<NodeType> tree;
+    tree.reserve(n + 1u);
+    tree.emplace_back();
+    std::vector<Task> tasks{{0u, n, 0u, Left, 0u, NodeControl<BOXDIMS>{}}};
+    while(!tasks.empty())
+      {
+        Task task = tasks.back();
+        tasks.pop_back();
+        auto const dim = task.level % BOXDIMS;
+        auto const goesLeft = [&](auto const &key) {
+          BoxType const &box = input[key.second];
+          return task.control.test(dim, box[dim]) == Left;
+        };
+        auto const first = keys.begin() + task.begin;
+        auto const last = keys.begin() + task.end;
+        // Below the resolution of the key we have to partition explicitly
+        auto const split = task.level < keyLevels
+                             ? std::partition_point(first, last, goesLeft)
+                             : std::partition(first, last, goesLeft);
+        std::size_t middle = split - keys.begin();
+        // The root of the subtree, at one end of the largest half
+        std::size_t chosen;
+        if(middle - task.begin > task.end - middle)
+          {
+            chosen = task.begin++;
+          }
+        else
+          {
+            chosen = --task.end;
+          }
+        auto const index = static_cast<std::uint32_t>(tree.size());
+        auto const id = keys[chosen].second;
+        tree.push_back(NodeType::fromNode(input[id]));
+        tree.back().id = id + 1u;
+        tree.back().up = task.parent;
+        if(task.parent != 0u)
+          (task.side == Left ? tree[task.parent].l : tree[task.parent].r) =
+            index;
+        height_ = std::max(height_, task.level + 1u);
+        // Right first, so that the left subtree is built first
+        if(middle < task.end)
+          {
+            Task right{middle, task.end, index, Right, task.level + 1u,
+                       task.control};
+            right.control.advance(dim, Right);
+            tasks.push_back(right);
+          }
+        if(task.begin < middle)
+          {
+            Task left{task.begin, middle, index, Left, task.level + 1u,
+                      task.control};
+            left.control.advance(dim, Left);
+            tasks.push_back(left);
+          }
+      }
+
+    // The new position of the nodes
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    if(layout == TreeLayout::BreadthFirst)
+      {
+        order.push_back(1u);
+        for(std::size_t i = 0u; i < order.size(); ++i)
+          {
+            auto const &node = tree[order[i]];
+            if(node.l != 0u)
+              order.push_back(node.l);
+            if(node.r != 0u)
+              order.push_back(node.r);
+          }
+      }
+    else
+      {
+        std::vector<std::uint32_t> frontier;
+        vanEmdeBoas(tree, 1u, height_, order, frontier);
+      }
+    std::vector<std::uint32_t> newIndex(n + 1u, 0u);
+    for(std::size_t i = 0u; i < n; ++i)
+      newIndex[order[i]] = static_cast<std::uint32_t>(i + 1u);
+    nodes_.reserve(n + 1u);
+    nodes_.emplace_back();
+    for(auto const old : order)
+      {
+        nodes_.push_back(std::move(tree[old]));
+        auto &node = nodes_.back();
+        node.l = newIndex[node.l];
+        node.r = newIndex[node.r];
+        node.up = newIndex[node.up];
+      }
+  }
+
+  template <typename NODE>
+  void
+  LinearAdtTree<NODE>::vanEmdeBoas(std::vector<NodeType> const &tree,
+                                   std::uint32_t root, std::size_t h,
+                                   std::vector<std::uint32_t> &order,
+                                   std::vector<std::uint32_t> &frontier) const
+  {
+    if(h == 1u)
+      {
+        order.push_back(root);
+        if(tree[root].l != 0u)
+          frontier.push_back(tree[root].l);
+        if(tree[root].r != 0u)
+          frontier.push_back(tree[root].r);
+        return;
+      }
+    std::size_t const          top = h / 2u;
+    std::vector<std::uint32_t> middle;
+    vanEmdeBoas(tree, root, top, order, middle);
+    for(auto const m : middle)
+      vanEmdeBoas(tree, m, h - top, order, frontier);
+  }
+
+} // namespace adt
+} // namespace apsc
+
+#endif /* ADTTREE_LINEARADTTREE_HPP_ */
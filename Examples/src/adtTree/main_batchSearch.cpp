@@ -0,0 +1,150 @@
+/*
+ * main_batchSearch.cpp
+ *
+ *  Throughput of single and batched intersection searches on an adt tree
+ */
+#include "AdtBatchSearch.hpp"
+#include "AdtTree.hpp"
+#include "AdtVisitors.hpp"
+#include "chrono.hpp" // in Utilities
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+/*
+ * Builds a tree with n random boxes in the unit square and searches the
+ * boxes intersecting m random query boxes, one at a time and with
+ * batchIntersect(), with and without sorting the queries and with
+ * different number of threads. Results are checked against the single
+ * searches and, for the first queries, against a brute force search.
+ *
+ * Usage: main_batchSearch [n] [m] [numThreads]
+ */
+namespace
+{
+using namespace apsc::adt;
+constexpr std::size_t DIM = 2u;
+using BOX = Box<DIM, AdtType::Box>;
+using NODE = AdtNode<BOX>;
+
+//! Random boxes with side at most maxSide, normalised in the unit square
+std::vector<BOX>
+randomBoxes(std::size_t n, double maxSide, std::mt19937 &urbg)
+{
+  std::uniform_real_distribution<double> pos(0., 1. - maxSide);
+  std::uniform_real_distribution<double> side(0., maxSide);
+  std::vector<BOX>                       boxes;
+  boxes.reserve(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      Point<DIM> l{pos(urbg), pos(urbg)};
+      Point<DIM> u{l[0] + side(urbg), l[1] + side(urbg)};
+      boxes.emplace_back(l, u);
+    }
+  return boxes;
+}
+
+bool
+intersect(BOX const &a, BOX const &b)
+{
+  for(std::size_t d = 0u; d < DIM; ++d)
+    if(a.corner(0)[d] > b.corner(1)[d] || b.corner(0)[d] > a.corner(1)[d])
+      return false;
+  return true;
+}
+
+using Timings::timeIt; // time in milliseconds
+
+void
+report(std::string const &what, double time, double reference,
+       std::size_t numQueries)
+{
+  std::cout << std::left << std::setw(34) << what << std::right
+            << std::setw(12) << time << std::setw(14)
+            << numQueries / time * 1.e-3 << std::setw(10) << reference / time
+            << '\n';
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 200000u;
+  std::size_t const m = argc > 2 ? std::stoul(argv[2]) : 200000u;
+  unsigned const    numThreads = argc > 3 ? std::stoul(argv[3]) : 0u;
+  std::mt19937      urbg{123};
+  // Boxes of average side about 1/sqrt(n): a few hits per query
+  double const     maxSide = 2. / std::sqrt(static_cast<double>(n));
+  std::vector<BOX> boxes = randomBoxes(n, maxSide, urbg);
+  std::vector<BOX> queries = randomBoxes(m, maxSide, urbg);
+
+  AdtTree<NODE> tree(n);
+  double const  tBuild = timeIt([&] {
+    for(auto const &b : boxes)
+      tree.add(NODE{b});
+  });
+  std::cout << "Tree with " << tree.numNodes() << " boxes built in " << tBuild
+            << " ms, " << m << " queries\n\n";
+  std::cout << std::left << std::setw(34) << "Search" << std::right
+            << std::setw(12) << "time (ms)" << std::setw(14) << "Mqueries/s"
+            << std::setw(10) << "speedup" << '\n';
+
+  // The reference: a visit for each query, as with the plain interface
+  std::vector<std::vector<std::size_t>> single(m);
+  double const                          tSingle = timeIt([&] {
+    for(std::size_t q = 0u; q < m; ++q)
+      single[q] =
+        tree.visit(IntersectionVisitor{queries[q]}).intersectingIndexes();
+  });
+  report("single queries", tSingle, tSingle, m);
+
+  BatchResult result;
+  bool        ok = true;
+  auto        check = [&](BatchResult const &r) {
+    if(r.numQueries() != m)
+      return false;
+    for(std::size_t q = 0u; q < m; ++q)
+      if(!std::ranges::equal(r[q], single[q]))
+        return false;
+    return true;
+  };
+  auto runBatch = [&](std::string const &what, BatchOptions const &options) {
+    double const t =
+      timeIt([&] { result = batchIntersect(tree, queries, options); });
+    report(what, t, tSingle, m);
+    ok = check(result) && ok;
+  };
+  unsigned const allThreads =
+    numThreads > 0u ? numThreads : std::thread::hardware_concurrency();
+  runBatch("batch, unsorted, 1 thread",
+           {.numThreads = 1u, .sortQueries = false});
+  runBatch("batch, Morton order, 1 thread", {.numThreads = 1u});
+  runBatch("batch, Morton order, " + std::to_string(allThreads) + " threads",
+           {.numThreads = allThreads});
+
+  // Brute force check on the first queries
+  std::size_t const numChecked = std::min<std::size_t>(m, 1000u);
+  for(std::size_t q = 0u; q < numChecked; ++q)
+    {
+      std::vector<std::size_t> found(result[q].begin(), result[q].end());
+      std::vector<std::size_t> expected;
+      for(std::size_t i = 0u; i < n; ++i)
+        if(intersect(boxes[i], queries[q]))
+          expected.push_back(i);
+      // node ids start from 1, in insertion order
+      for(auto &i : found)
+        --i;
+      std::ranges::sort(found);
+      ok = ok && found == expected;
+    }
+  std::cout << "\nTotal hits " << result.numHits() << " ("
+            << std::setprecision(3)
+            << static_cast<double>(result.numHits()) / m << " per query)\n";
+  std::cout << "Results " << (ok ? "agree" : "DO NOT agree")
+            << " with single queries and with brute force on the first "
+            << numChecked << " queries\n";
+  return ok ? 0 : 1;
+}
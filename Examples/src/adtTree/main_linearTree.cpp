@@ -0,0 +1,167 @@
+/*
+ * main_linearTree.cpp
+ *
+ *  Compares the incremental AdtTree with the bulk built LinearAdtTree
+ */
+#include "AdtBatchSearch.hpp"
+#include "AdtTree.hpp"
+#include "LinearAdtTree.hpp"
+#include "chrono.hpp" // in Utilities
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+/*
+ * Builds an AdtTree, by adding the nodes one at a time, and a
+ * LinearAdtTree, with breadth first and van Emde Boas layouts, with n boxes
+ * and compares build time, memory, height and the time needed for m
+ * intersection searches (on one thread, with the queries in random and in
+ * Morton order). Two sets of boxes are used: uniformly distributed in the
+ * unit square, and clustered around a few points.
+ *
+ * Usage: main_linearTree [n] [m]
+ */
+namespace
+{
+using namespace apsc::adt;
+constexpr std::size_t DIM = 2u;
+using BOX = Box<DIM, AdtType::Box>;
+using NODE = AdtNode<BOX>;
+
+//! Random boxes, with lower left corner given by center()
+template <class Center>
+std::vector<NODE>
+randomBoxes(std::size_t n, double maxSide, Center &&center, std::mt19937 &urbg)
+{
+  std::uniform_real_distribution<double> side(0., maxSide);
+  std::vector<NODE>                      boxes;
+  boxes.reserve(n);
+  for(std::size_t i = 0u; i < n; ++i)
+    {
+      Point<DIM> l = center();
+      Point<DIM> u{l[0] + side(urbg), l[1] + side(urbg)};
+      boxes.emplace_back(l, u);
+    }
+  // normalise in the unit square
+  Normaliser<DIM> normalise;
+  normalise.setBoundingBox(boxes);
+  for(auto &b : boxes)
+    normalise(b);
+  return boxes;
+}
+
+using Timings::timeIt; // time in milliseconds
+
+//! The results of the searches, each one sorted
+std::vector<std::vector<std::size_t>>
+sorted(BatchResult const &result)
+{
+  std::vector<std::vector<std::size_t>> s(result.numQueries());
+  for(std::size_t q = 0u; q < s.size(); ++q)
+    {
+      s[q].assign(result[q].begin(), result[q].end());
+      std::ranges::sort(s[q]);
+    }
+  return s;
+}
+
+void
+row(std::string const &what, double build, double memory, std::size_t height,
+    double tRandom, double tSorted)
+{
+  std::cout << std::left << std::setw(22) << what << std::right
+            << std::setw(11) << build << std::setw(11) << memory
+            << std::setw(8) << height << std::setw(14) << tRandom
+            << std::setw(14) << tSorted << '\n';
+}
+
+bool
+runCase(std::string const &title, std::vector<NODE> const &nodes,
+        std::vector<BOX> const &queries)
+{
+  std::size_t const n = nodes.size();
+  std::cout << title << ": " << n << " boxes, " << queries.size()
+            << " queries\n";
+  std::cout << std::left << std::setw(22) << "tree" << std::right
+            << std::setw(11) << "build(ms)" << std::setw(11) << "mem(MB)"
+            << std::setw(8) << "height" << std::setw(14) << "random(ms)"
+            << std::setw(14) << "Morton(ms)" << '\n';
+  BatchOptions const random{.numThreads = 1u, .sortQueries = false};
+  BatchOptions const morton{.numThreads = 1u};
+  BatchResult        reference;
+  BatchResult        result;
+  bool               ok = true;
+
+  AdtTree<NODE> tree(n);
+  double const  tBuild = timeIt([&] {
+    for(auto const &node : nodes)
+      tree.add(node);
+  });
+  double const tRandom =
+    timeIt([&] { reference = batchIntersect(tree, queries, random); });
+  double const tSorted =
+    timeIt([&] { result = batchIntersect(tree, queries, morton); });
+  row("AdtTree (incremental)", tBuild, (n + 1u) * sizeof(NODE) / 1048576.,
+      tree.maxLevel() + 1u, tRandom, tSorted);
+  auto const expected = sorted(reference);
+
+  for(auto layout : {TreeLayout::BreadthFirst, TreeLayout::VanEmdeBoas})
+    {
+      LinearAdtTree<NODE> linear;
+      double const tBuild = timeIt([&] { linear.build(nodes, layout); });
+      double const tRandom =
+        timeIt([&] { result = batchIntersect(linear, queries, random); });
+      ok = ok && sorted(result) == expected;
+      double const tSorted =
+        timeIt([&] { result = batchIntersect(linear, queries, morton); });
+      ok = ok && sorted(result) == expected;
+      row(layout == TreeLayout::BreadthFirst ? "Linear, breadth first"
+                                             : "Linear, van Emde Boas",
+          tBuild, linear.memoryUsage() / 1048576., linear.height(), tRandom,
+          tSorted);
+    }
+  std::cout << "Average hits per query "
+            << static_cast<double>(reference.numHits()) / queries.size()
+            << ", results " << (ok ? "agree" : "DO NOT agree") << "\n\n";
+  return ok;
+}
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 500000u;
+  std::size_t const m = argc > 2 ? std::stoul(argv[2]) : 200000u;
+  std::mt19937      urbg{123};
+  double const      maxSide = 2. / std::sqrt(static_cast<double>(n));
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  auto uniformCenter = [&] { return Point<DIM>{uniform(urbg), uniform(urbg)}; };
+
+  // Queries are uniform in the unit square
+  std::vector<BOX> queries;
+  for(auto const &node : randomBoxes(m, maxSide, uniformCenter, urbg))
+    queries.push_back(node);
+
+  bool ok = runCase("Uniform boxes",
+                    randomBoxes(n, maxSide, uniformCenter, urbg), queries);
+
+  // Ten clusters with standard deviation 0.02
+  std::vector<Point<DIM>> clusters(10);
+  for(auto &c : clusters)
+    c = uniformCenter();
+  std::uniform_int_distribution<std::size_t> whichCluster(0u,
+                                                          clusters.size() - 1u);
+  std::normal_distribution<double>           spread(0., 0.02);
+  auto                                       clusteredCenter = [&] {
+    auto const &c = clusters[whichCluster(urbg)];
+    return Point<DIM>{c[0] + spread(urbg), c[1] + spread(urbg)};
+  };
+  ok = runCase("Clustered boxes",
+               randomBoxes(n, 0.1 * maxSide, clusteredCenter, urbg),
+               queries) &&
+       ok;
+  return ok ? 0 : 1;
+}